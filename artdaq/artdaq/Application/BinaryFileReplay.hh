@@ -0,0 +1,93 @@
+#ifndef artdaq_Application_BinaryFileReplay_hh
+#define artdaq_Application_BinaryFileReplay_hh
+
+#include "fhiclcpp/fwd.h"
+#include "artdaq/Application/CommandableFragmentGenerator.hh"
+#include "artdaq/DAQdata/BinaryFileMap.hh"
+#include "artdaq/DAQdata/ReplayPacer.hh"
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace artdaq
+{
+	/**
+	 * \brief BinaryFileReplay sends the Fragments stored in files written by BinaryFileOutput, so that recorded data
+	 * can be replayed through the DAQ chain (e.g. to test EventBuilder and DataLogger throughput with real data)
+	 *
+	 * The files are mapped into memory with BinaryFileMap. For each event, the Fragments with this generator's Fragment IDs
+	 * are copied once, into Fragments from the FragmentPool; events which have none of them are skipped.
+	 */
+	class BinaryFileReplay : public CommandableFragmentGenerator
+	{
+	public:
+		/**
+		 * \brief BinaryFileReplay Constructor
+		 * \param ps ParameterSet used to configure BinaryFileReplay
+		 *
+		 * \verbatim
+		 * BinaryFileReplay accepts the following Parameters, in addition to those of CommandableFragmentGenerator:
+		 * "fileNames" (REQUIRED): The files to replay, in order
+		 * "loop" (Default: false): Start again with the first file after the last one, instead of ending the data
+		 * "renumber_sequence_ids" (Default: true): Give the replayed events Sequence IDs starting at 1 with each run, as the
+		 *   rest of the DAQ chain expects: an event recorded with Sequence ID N is sent as N - (first recorded Sequence ID) + 1,
+		 *   and each pass over the files (see "loop") continues from the end of the last one. Every generator replaying the same
+		 *   files therefore numbers the same event the same way, even when some of them skip events without their Fragment IDs.
+		 *   If false, the recorded Sequence IDs are kept
+		 * "pacing" (Default: "none"): How fast events are sent: "none" (as fast as possible), "fixed" (at "rate_hz"),
+		 *   or "recorded" (at the intervals given by the Fragment timestamps)
+		 * "rate_hz" (Default: 10.0): The event rate for "fixed" pacing
+		 * "timestamp_ticks_per_second" (Default: 1e9): The frequency of the Fragment timestamp clock, for "recorded" pacing
+		 * \endverbatim
+		 */
+		explicit BinaryFileReplay(fhicl::ParameterSet const& ps);
+
+		/**
+		 * \brief BinaryFileReplay Destructor
+		 */
+		virtual ~BinaryFileReplay() = default;
+
+		/**
+		 * \brief Start replaying from the beginning of the first file
+		 */
+		void start() override;
+
+		/**
+		 * \brief Perform immediate stop actions. No-Op
+		 */
+		void stopNoMutex() override {}
+
+		/**
+		 * \brief Perform stop actions. No-Op: the data thread may still be in getNext_, so the current file stays mapped
+		 * until the next start() or the destructor
+		 */
+		void stop() override {}
+
+	private:
+		bool getNext_(FragmentPtrs& output) override;
+
+		bool nextEvent_();
+
+		Fragment::sequence_id_t sequenceID_(Fragment::sequence_id_t recorded) const;
+
+		std::vector<std::string> file_names_;
+		bool loop_;
+		bool renumber_sequence_ids_;
+		std::set<Fragment::fragment_id_t> fragment_id_set_;
+		ReplayPacer pacer_;
+
+		size_t file_index_;
+		std::unique_ptr<BinaryFileMap> file_;
+		FragmentViews event_; // Fragments of the next event to send, which belong to this generator
+		bool event_pending_;
+		Fragment::sequence_id_t event_sequence_id_; // Recorded Sequence ID of event_
+		Fragment::sequence_id_t first_recorded_sequence_id_; // Recorded Sequence ID of the first event in the files
+		Fragment::sequence_id_t last_recorded_sequence_id_; // Highest recorded Sequence ID seen in the current pass over the files
+		Fragment::sequence_id_t pass_sequence_id_offset_; // Added to the renumbered Sequence IDs, so that each pass continues from the last
+	};
+}
+
+#endif // artdaq_Application_BinaryFileReplay_hh
@@ -0,0 +1,126 @@
+#define TRACE_NAME "BinaryFileReplay"
+
+#include "artdaq/Application/BinaryFileReplay.hh"
+
+#include "artdaq/Application/GeneratorMacros.hh"
+#include "artdaq/DAQdata/FragmentPool.hh"
+#include "artdaq/DAQdata/Globals.hh"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+
+#include <algorithm>
+
+artdaq::BinaryFileReplay::BinaryFileReplay(fhicl::ParameterSet const& ps)
+	: CommandableFragmentGenerator(ps)
+	, file_names_(ps.get<std::vector<std::string>>("fileNames"))
+	, loop_(ps.get<bool>("loop", false))
+	, renumber_sequence_ids_(ps.get<bool>("renumber_sequence_ids", true))
+	, fragment_id_set_()
+	, pacer_(ReplayPacer::ModeFromString(ps.get<std::string>("pacing", "none")), ps.get<double>("rate_hz", 10.0), ps.get<double>("timestamp_ticks_per_second", 1e9))
+	, file_index_(0)
+	, file_()
+	, event_()
+	, event_pending_(false)
+	, event_sequence_id_(0)
+	, first_recorded_sequence_id_(Fragment::InvalidSequenceID)
+	, last_recorded_sequence_id_(0)
+	, pass_sequence_id_offset_(0)
+{
+	if (file_names_.empty())
+	{
+		throw cet::exception("BinaryFileReplay") << "No files to replay were given in the fileNames parameter";
+	}
+	auto ids = fragmentIDs();
+	fragment_id_set_.insert(ids.begin(), ids.end());
+}
+
+void artdaq::BinaryFileReplay::start()
+{
+	// The data thread of the previous run has ended, so the views into the previous file can be released
+	event_.clear();
+	file_index_ = 0;
+	file_.reset(nullptr);
+	event_pending_ = false;
+	first_recorded_sequence_id_ = Fragment::InvalidSequenceID;
+	last_recorded_sequence_id_ = 0;
+	pass_sequence_id_offset_ = 0;
+	pacer_.Reset();
+}
+
+bool artdaq::BinaryFileReplay::getNext_(FragmentPtrs& frags)
+{
+	if (should_stop()) return false;
+	if (!event_pending_ && !nextEvent_())
+	{
+		TLOG(TLVL_INFO) << "Replayed all of the events in " << file_names_.size() << " files";
+		return false;
+	}
+	event_pending_ = true;
+
+	// Wait in short steps, so that a stop is not held up by a long gap between events
+	if (!pacer_.Wait(event_.front().timestamp())) return true;
+	event_pending_ = false;
+
+	auto sequence_id = renumber_sequence_ids_ ? sequenceID_(event_sequence_id_) : event_sequence_id_;
+	for (auto& view : event_)
+	{
+		auto frag = FragmentPool::Instance().Get(view.size() - detail::RawFragmentHeader::num_words());
+		std::copy(view.headerAddress(), view.headerAddress() + view.size(), frag->headerAddress());
+		frag->setSequenceID(sequence_id);
+		frags.emplace_back(std::move(frag));
+	}
+	TLOG(TLVL_TRACE) << "Sending " << event_.size() << " Fragments with sequence ID " << sequence_id;
+	ev_counter_inc();
+	return true;
+}
+
+bool artdaq::BinaryFileReplay::nextEvent_()
+{
+	size_t files_opened = 0;
+	while (true)
+	{
+		if (!file_)
+		{
+			if (file_index_ == file_names_.size())
+			{
+				if (!loop_) return false;
+				file_index_ = 0;
+				if (first_recorded_sequence_id_ != Fragment::InvalidSequenceID)
+				{
+					pass_sequence_id_offset_ = sequenceID_(last_recorded_sequence_id_);
+				}
+			}
+			if (++files_opened > file_names_.size()) return false; // A whole pass over the files found nothing to send
+			file_ = std::make_unique<BinaryFileMap>(file_names_[file_index_++]);
+			pacer_.Reset(); // Timestamps start again with each file
+			TLOG(TLVL_DEBUG) << "Replaying " << file_->fileName();
+		}
+
+		if (!file_->NextEvent(event_))
+		{
+			file_.reset(nullptr);
+			continue;
+		}
+
+		// Every event is counted, including those skipped below, so that all generators replaying these files agree
+		event_sequence_id_ = event_.front().sequenceID();
+		if (first_recorded_sequence_id_ == Fragment::InvalidSequenceID) first_recorded_sequence_id_ = event_sequence_id_;
+		last_recorded_sequence_id_ = std::max(last_recorded_sequence_id_, event_sequence_id_);
+
+		event_.erase(std::remove_if(event_.begin(), event_.end(), [this](FragmentView const& view) { return !fragment_id_set_.count(view.fragmentID()); }),
+		             event_.end());
+		if (!event_.empty()) return true;
+	}
+}
+
+artdaq::Fragment::sequence_id_t artdaq::BinaryFileReplay::sequenceID_(Fragment::sequence_id_t recorded) const
+{
+	if (recorded < first_recorded_sequence_id_)
+	{
+		TLOG(TLVL_WARNING) << "Recorded Sequence ID " << recorded << " is before the first one (" << first_recorded_sequence_id_ << "), sending it as the first event of the pass";
+		recorded = first_recorded_sequence_id_;
+	}
+	return pass_sequence_id_offset_ + recorded - first_recorded_sequence_id_ + 1;
+}
+
+DEFINE_ARTDAQ_COMMANDABLE_GENERATOR(artdaq::BinaryFileReplay)
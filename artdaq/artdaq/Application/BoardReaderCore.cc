@@ -277,6 +277,7 @@ void artdaq::BoardReaderCore::process_fragments()
 	artdaq::MonitoredQuantityStats::TIME_POINT_T startTime;
 	double delta_time;
 	artdaq::FragmentPtrs frags;
+	artdaq::GatheredFragmentPtrs gatheredFrags;
 	bool active = true;
 
 	while (active)
@@ -284,7 +285,7 @@ void artdaq::BoardReaderCore::process_fragments()
 		startTime = artdaq::MonitoredQuantity::getCurrentTime();
 
 		TLOG(18) << "process_fragments getNext start";
-		active = generator_ptr_->getNext(frags);
+		active = generator_ptr_->getNext(frags, gatheredFrags);
 		TLOG(18) << "process_fragments getNext done (active=" << active << ")";
 		// 08-May-2015, KAB & JCF: if the generator getNext() method returns false
 		// (which indicates that the data flow has stopped) *and* the reason that
@@ -303,7 +304,7 @@ void artdaq::BoardReaderCore::process_fragments()
 		TLOG(16) << "process_fragments INPUT_WAIT=" << delta_time;
 
 		if (!active) { break; }
-		statsHelper_.addSample(FRAGMENTS_PER_READ_STAT_KEY, frags.size());
+		statsHelper_.addSample(FRAGMENTS_PER_READ_STAT_KEY, frags.size() + gatheredFrags.size());
 
 		for (auto& fragPtr : frags)
 		{
@@ -313,50 +314,16 @@ void artdaq::BoardReaderCore::process_fragments()
 					<< "This is most likely caused by a problem with the Fragment Generator!";
 				continue;
 			}
-			artdaq::Fragment::sequence_id_t sequence_id = fragPtr->sequenceID();
-			SetMFIteration("Sequence ID " + std::to_string(sequence_id));
-			statsHelper_.addSample(FRAGMENTS_PROCESSED_STAT_KEY, fragPtr->size());
-
-			/*if ((fragment_count_ % 250) == 0)
-			{
-				TLOG(TLVL_DEBUG)
-					<< "Sending fragment " << fragment_count_
-					<< " with sequence id " << sequence_id << ".";
-			}*/
-
-			// check for continous sequence IDs
-			if (!skip_seqId_test_ && abs(static_cast<int64_t>(sequence_id) - static_cast<int64_t>(prev_seq_id_)) > 1)
-			{
-				TLOG(TLVL_WARNING)
-					<< "Missing sequence IDs: current sequence ID = "
-					<< sequence_id << ", previous sequence ID = "
-					<< prev_seq_id_ << ".";
-			}
-			prev_seq_id_ = sequence_id;
-
-			startTime = artdaq::MonitoredQuantity::getCurrentTime();
-			TLOG(17) << "process_fragments seq=" << sequence_id << " sendFragment start";
-			auto res = sender_ptr_->sendFragment(std::move(*fragPtr));
-			TLOG(17) << "process_fragments seq=" << sequence_id << " sendFragment done (dest=" << res.first << ", sts=" << TransferInterface::CopyStatusToString(res.second) << ")";
-			++fragment_count_;
-			statsHelper_.addSample(OUTPUT_WAIT_STAT_KEY,
-				artdaq::MonitoredQuantity::getCurrentTime() - startTime);
-
-			bool readyToReport = statsHelper_.readyToReport(fragment_count_);
-			if (readyToReport)
-			{
-				std::string statString = buildStatisticsString_();
-				TLOG(TLVL_INFO) << statString;
-			}
-			if (fragment_count_ % 250 == 1 || readyToReport)
-			{
-				TLOG(TLVL_DEBUG)
-					<< "Sending fragment " << fragment_count_
-					<< " with SeqID " << sequence_id << ".";
-			}
+			sendFragment_(fragPtr->sequenceID(), fragPtr->size(), [&]() { return sender_ptr_->sendFragment(std::move(*fragPtr)); });
+		}
+		// ContainerFragments gathered from the generator's data buffer refer to the buffered Fragments, which are written out directly
+		for (auto& gathered : gatheredFrags)
+		{
+			sendFragment_(gathered->sequenceID(), gathered->sizeBytes() / sizeof(artdaq::RawDataType), [&]() { return sender_ptr_->sendFragment(*gathered); });
 		}
 		if (statsHelper_.statsRollingWindowHasMoved()) { sendMetrics_(); }
 		frags.clear();
+		gatheredFrags.clear();
 	}
 
 	sender_ptr_.reset(nullptr);
@@ -369,6 +336,50 @@ void artdaq::BoardReaderCore::process_fragments()
 	TLOG(TLVL_DEBUG) << "process_fragments loop end";
 }
 
+void artdaq::BoardReaderCore::sendFragment_(artdaq::Fragment::sequence_id_t sequence_id, size_t words, std::function<std::pair<int, TransferInterface::CopyStatus>()> const& send)
+{
+	SetMFIteration("Sequence ID " + std::to_string(sequence_id));
+	statsHelper_.addSample(FRAGMENTS_PROCESSED_STAT_KEY, words);
+
+	/*if ((fragment_count_ % 250) == 0)
+	{
+		TLOG(TLVL_DEBUG)
+			<< "Sending fragment " << fragment_count_
+			<< " with sequence id " << sequence_id << ".";
+	}*/
+
+	// check for continous sequence IDs
+	if (!skip_seqId_test_ && abs(static_cast<int64_t>(sequence_id) - static_cast<int64_t>(prev_seq_id_)) > 1)
+	{
+		TLOG(TLVL_WARNING)
+			<< "Missing sequence IDs: current sequence ID = "
+			<< sequence_id << ", previous sequence ID = "
+			<< prev_seq_id_ << ".";
+	}
+	prev_seq_id_ = sequence_id;
+
+	auto startTime = artdaq::MonitoredQuantity::getCurrentTime();
+	TLOG(17) << "process_fragments seq=" << sequence_id << " sendFragment start";
+	auto res = send();
+	TLOG(17) << "process_fragments seq=" << sequence_id << " sendFragment done (dest=" << res.first << ", sts=" << TransferInterface::CopyStatusToString(res.second) << ")";
+	++fragment_count_;
+	statsHelper_.addSample(OUTPUT_WAIT_STAT_KEY,
+		artdaq::MonitoredQuantity::getCurrentTime() - startTime);
+
+	bool readyToReport = statsHelper_.readyToReport(fragment_count_);
+	if (readyToReport)
+	{
+		std::string statString = buildStatisticsString_();
+		TLOG(TLVL_INFO) << statString;
+	}
+	if (fragment_count_ % 250 == 1 || readyToReport)
+	{
+		TLOG(TLVL_DEBUG)
+			<< "Sending fragment " << fragment_count_
+			<< " with SeqID " << sequence_id << ".";
+	}
+}
+
 std::string artdaq::BoardReaderCore::report(std::string const& which) const
 {
 	std::string resultString;
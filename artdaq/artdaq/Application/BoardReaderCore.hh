@@ -1,6 +1,7 @@
 #ifndef artdaq_Application_MPI2_BoardReaderCore_hh
 #define artdaq_Application_MPI2_BoardReaderCore_hh
 
+#include <functional>
 #include <string>
 
 #include "artdaq/Application/CommandableFragmentGenerator.hh"
@@ -184,6 +185,9 @@ private:
 
 	void sendMetrics_();
 
+	// Check the sequence ID of a Fragment, send it with the given function and record the statistics
+	void sendFragment_(artdaq::Fragment::sequence_id_t sequence_id, size_t words, std::function<std::pair<int, TransferInterface::CopyStatus>()> const& send);
+
 	bool verbose_; ///< Whether to log transition messages
 
 	/**
@@ -25,6 +25,7 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <future>
 #include <sys/poll.h>
 #include "artdaq/DAQdata/TCPConnect.hh"
 
@@ -55,6 +56,11 @@ artdaq::CommandableFragmentGenerator::CommandableFragmentGenerator()
 	, windows_sent_ooo_()
 	, missing_request_window_timeout_us_(1000000)
 	, window_close_timeout_us_(2000000)
+	, containerFillThreads_(1)
+	, parallelContainerFillMinBytes_(1048576)
+	, gatherWindowContainers_(false)
+	, gatheredOutput_()
+	, fragmentPins_()
 	, useDataThread_(false)
 	, circularDataBufferMode_(false)
 	, sleep_on_no_data_us_(0)
@@ -63,12 +69,17 @@ artdaq::CommandableFragmentGenerator::CommandableFragmentGenerator()
 	, dataBufferDepthBytes_(0)
 	, maxDataBufferDepthFragments_(1000)
 	, maxDataBufferDepthBytes_(1000)
+	, dataBufferMetricsIntervalMs_(100)
+	, lastDataBufferMetricsTime_()
+	, dataRing_(1024)
 	, useMonitoringThread_(false)
 	, monitoringInterval_(0)
 	, lastMonitoringCall_()
 	, isHardwareOK_(true)
 	, dataBuffer_()
 	, newDataBuffer_()
+	, dataBufferIndex_()
+	, dataBufferContentBytes_(0)
 	, run_number_(-1)
 	, subrun_number_(-1)
 	, timeout_(std::numeric_limits<uint64_t>::max())
@@ -94,6 +105,11 @@ artdaq::CommandableFragmentGenerator::CommandableFragmentGenerator(const fhicl::
 	, windows_sent_ooo_()
 	, missing_request_window_timeout_us_(ps.get<size_t>("missing_request_window_timeout_us", 5000000))
 	, window_close_timeout_us_(ps.get<size_t>("window_close_timeout_us", 2000000))
+	, containerFillThreads_(ps.get<size_t>("container_fill_threads", 4))
+	, parallelContainerFillMinBytes_(ps.get<size_t>("parallel_container_fill_min_bytes", 1048576))
+	, gatherWindowContainers_(ps.get<bool>("gather_window_containers", false))
+	, gatheredOutput_()
+	, fragmentPins_()
 	, useDataThread_(ps.get<bool>("separate_data_thread", false))
 	, circularDataBufferMode_(ps.get<bool>("circular_buffer_mode", false))
 	, sleep_on_no_data_us_(ps.get<size_t>("sleep_on_no_data_us", 0))
@@ -102,12 +118,17 @@ artdaq::CommandableFragmentGenerator::CommandableFragmentGenerator(const fhicl::
 	, dataBufferDepthBytes_(0)
 	, maxDataBufferDepthFragments_(ps.get<int>("data_buffer_depth_fragments", 1000))
 	, maxDataBufferDepthBytes_(ps.get<size_t>("data_buffer_depth_mb", 1000) * 1024 * 1024)
+	, dataBufferMetricsIntervalMs_(ps.get<size_t>("data_buffer_metrics_interval_ms", 100))
+	, lastDataBufferMetricsTime_()
+	, dataRing_(ps.get<size_t>("data_handoff_ring_size", 1024))
 	, useMonitoringThread_(ps.get<bool>("separate_monitoring_thread", false))
 	, monitoringInterval_(ps.get<int64_t>("hardware_poll_interval_us", 0))
 	, lastMonitoringCall_()
 	, isHardwareOK_(true)
 	, dataBuffer_()
 	, newDataBuffer_()
+	, dataBufferIndex_()
+	, dataBufferContentBytes_(0)
 	, run_number_(-1)
 	, subrun_number_(-1)
 	, timeout_(std::numeric_limits<uint64_t>::max())
@@ -143,8 +164,10 @@ artdaq::CommandableFragmentGenerator::CommandableFragmentGenerator(const fhicl::
 
 	sleep_on_stop_us_ = ps.get<int>("sleep_on_stop_us", 0);
 
-	dataBuffer_.emplace_back(FragmentPtr(new Fragment()));
-	(*dataBuffer_.begin())->setSystemType(Fragment::EmptyFragmentType);
+	newDataBuffer_.emplace_back(FragmentPtr(new Fragment()));
+	(*newDataBuffer_.begin())->setSystemType(Fragment::EmptyFragmentType);
+	pushToDataRing_(std::move(newDataBuffer_));
+	newDataBuffer_.clear();
 
 	std::string modeString = ps.get<std::string>("request_mode", "ignored");
 	if (modeString == "single" || modeString == "Single")
@@ -165,6 +188,12 @@ artdaq::CommandableFragmentGenerator::CommandableFragmentGenerator(const fhicl::
 	}
 	TLOG(TLVL_DEBUG) << "Request mode is " << printMode_();
 
+	if ((mode_ == RequestMode::Buffer || mode_ == RequestMode::Window) && fragment_ids_.size() == 0)
+	{
+		latest_exception_report_ = "Error in CommandableFragmentGenerator: Buffer and Window request modes need \"fragment_id\" or \"fragment_ids\" to be set in FHiCL document";
+		throw cet::exception(latest_exception_report_);
+	}
+
 	if (mode_ != RequestMode::Ignored)
 	{
 		if (!useDataThread_)
@@ -194,6 +223,17 @@ void artdaq::CommandableFragmentGenerator::joinThreads()
 }
 
 bool artdaq::CommandableFragmentGenerator::getNext(FragmentPtrs& output)
+{
+	GatheredFragmentPtrs gathered;
+	auto result = getNext(output, gathered);
+	for (auto& frag : gathered)
+	{
+		output.emplace_back(new Fragment(frag->toFragment()));
+	}
+	return result;
+}
+
+bool artdaq::CommandableFragmentGenerator::getNext(FragmentPtrs& output, GatheredFragmentPtrs& gathered)
 {
 	bool result = true;
 
@@ -221,6 +261,7 @@ bool artdaq::CommandableFragmentGenerator::getNext(FragmentPtrs& output)
 		{
 			TLOG(TLVL_TRACE) << "getNext: Calling applyRequests";
 			result = applyRequests(output);
+			gathered.splice(gathered.end(), gatheredOutput_);
 			TLOG(TLVL_TRACE) << "getNext: Done with applyRequests result=" << std::boolalpha << result;
 			for (auto dataIter = output.begin(); dataIter != output.end(); ++dataIter)
 			{
@@ -361,7 +402,9 @@ void artdaq::CommandableFragmentGenerator::StartCmd(int run, uint64_t timeout, u
 	timestamp_ = timestamp;
 	ev_counter_.store(1);
     windows_sent_ooo_.clear();
-	dataBuffer_.clear();
+	clearDataBuffer_();
+	discardDataRing_();
+	resetLastDataTimes_();
 	should_stop_.store(false);
 	force_stop_.store(false);
 	exception_.store(false);
@@ -423,7 +466,9 @@ void artdaq::CommandableFragmentGenerator::ResumeCmd(uint64_t timeout, uint64_t
 	should_stop_ = false;
     {
         std::unique_lock<std::mutex> lk(dataBufferMutex_);
-	dataBuffer_.clear();
+	clearDataBuffer_();
+	discardDataRing_();
+	resetLastDataTimes_();
     }
 	// no lock required: thread not started yet
 	resume();
@@ -610,37 +655,46 @@ void artdaq::CommandableFragmentGenerator::getDataLoop()
 		TLOG(TLVL_GETDATALOOP) << "getDataLoop: processing data";
 		if (data && !force_stop_)
 		{
-			std::unique_lock<std::mutex> lock(dataBufferMutex_);
+			// The data buffer belongs to the thread calling applyRequests; hand new data over through dataRing_ so that
+			// readout never waits on dataBufferMutex_
 			switch (mode_)
 			{
 			case RequestMode::Single:
 				// While here, if for some strange reason more than one event's worth of data is returned from getNext_...
+				// Each event is handed over separately, so that the request thread only ever sees complete events
 				while (newDataBuffer_.size() >= fragment_ids_.size())
 				{
-					dataBuffer_.clear();
+					FragmentPtrs event;
 					auto it = newDataBuffer_.begin();
 					std::advance(it, fragment_ids_.size());
-					dataBuffer_.splice(dataBuffer_.end(), newDataBuffer_, newDataBuffer_.begin(), it);
+					event.splice(event.end(), newDataBuffer_, newDataBuffer_.begin(), it);
+					if (!pushToDataRing_(std::move(event)))
+					{
+						// pushToDataRing_ has already reported the event it dropped; the events after it cannot be handed over either
+						if (newDataBuffer_.size() > 0)
+						{
+							TLOG(TLVL_WARNING) << "getDataLoop: Dropping " << newDataBuffer_.size() << " more Fragments returned by getNext_, since the data hand-off ring is not accepting data";
+							if (metricMan)
+							{
+								metricMan->sendMetric("Dropped Fragments", newDataBuffer_.size(), "fragments", 1, MetricMode::Accumulate);
+							}
+							newDataBuffer_.clear();
+						}
+						break;
+					}
 				}
 				break;
 			case RequestMode::Buffer:
 			case RequestMode::Ignored:
 			case RequestMode::Window:
 			default:
-				//dataBuffer_.reserve(dataBuffer_.size() + newDataBuffer_.size());
-				dataBuffer_.splice(dataBuffer_.end(), newDataBuffer_);
+				pushToDataRing_(std::move(newDataBuffer_));
+				newDataBuffer_.clear();
 				break;
 			}
-			getDataBufferStats();
+			dataCondition_.notify_all();
 		}
 
-		{
-			std::unique_lock<std::mutex> lock(dataBufferMutex_);
-			if (dataBuffer_.size() > 0)
-			{
-				dataCondition_.notify_all();
-			}
-		}
 		if (!data || force_stop_)
 		{
 			TLOG(TLVL_INFO) << "Data flow has stopped. Ending data collection thread";
@@ -660,62 +714,34 @@ bool artdaq::CommandableFragmentGenerator::waitForDataBufferReady()
 	auto first = true;
 	auto lastwaittime = 0ULL;
 
+	// In circular data buffer mode, readout never waits. The request thread drops the oldest Fragments when it takes
+	// new data out of dataRing_ (see drainDataRing_)
+	while (dataBufferIsTooLarge() && !circularDataBufferMode_)
 	{
-		std::unique_lock<std::mutex> lock(dataBufferMutex_);
-		getDataBufferStats();
-	}
-
-	while (dataBufferIsTooLarge())
-	{
-		if (!circularDataBufferMode_)
+		if (should_stop())
 		{
-			if (should_stop())
-			{
-				TLOG(TLVL_DEBUG) << "Run ended while waiting for buffer to shrink!";
-				std::unique_lock<std::mutex> lock(dataBufferMutex_);
-				getDataBufferStats();
-				dataCondition_.notify_all();
-				data_thread_running_ = false;
-				return false;
-			}
-			auto waittime = TimeUtils::GetElapsedTimeMilliseconds(startwait);
+			TLOG(TLVL_DEBUG) << "Run ended while waiting for buffer to shrink!";
+			data_thread_running_ = false;
+			dataCondition_.notify_all();
+			return false;
+		}
+		auto waittime = TimeUtils::GetElapsedTimeMilliseconds(startwait);
 
-			if (first || (waittime != lastwaittime && waittime % 1000 == 0))
-			{
-				TLOG(TLVL_WARNING) << "Bad Omen: Data Buffer has exceeded its size limits. "
-					<< "(seq_id=" << ev_counter()
-					<< ", frags=" << dataBufferDepthFragments_ << "/" << maxDataBufferDepthFragments_
-					<< ", szB=" << dataBufferDepthBytes_ << "/" << maxDataBufferDepthBytes_ << ")";
-				TLOG(TLVL_TRACE) << "Bad Omen: Possible causes include requests not getting through or Ignored-mode BR issues";
-				first = false;
-			}
-			if (waittime % 5 && waittime != lastwaittime)
-			{
-				TLOG(TLVL_WAITFORBUFFERREADY) << "getDataLoop: Data Retreival paused for " << waittime << " ms waiting for data buffer to drain";
-			}
-			lastwaittime = waittime;
-			usleep(1000);
+		if (first || (waittime != lastwaittime && waittime % 1000 == 0))
+		{
+			TLOG(TLVL_WARNING) << "Bad Omen: Data Buffer has exceeded its size limits. "
+				<< "(seq_id=" << ev_counter()
+				<< ", frags=" << dataBufferDepthFragments_ << "/" << maxDataBufferDepthFragments_
+				<< ", szB=" << dataBufferDepthBytes_ << "/" << maxDataBufferDepthBytes_ << ")";
+			TLOG(TLVL_TRACE) << "Bad Omen: Possible causes include requests not getting through or Ignored-mode BR issues";
+			first = false;
 		}
-		else
+		if (waittime % 5 && waittime != lastwaittime)
 		{
-			std::unique_lock<std::mutex> lock(dataBufferMutex_);
-			getDataBufferStats(); // Re-check under lock
-			if (dataBufferIsTooLarge())
-			{
-				if (dataBuffer_.begin() == dataBuffer_.end())
-				{
-					TLOG(TLVL_WARNING) << "Data buffer is reported as too large, but doesn't contain any Fragments! Possible corrupt memory!";
-					continue;
-				}
-				if (*dataBuffer_.begin())
-				{
-					TLOG(TLVL_WAITFORBUFFERREADY) << "waitForDataBufferReady: Dropping Fragment with timestamp " << (*dataBuffer_.begin())->timestamp() << " from data buffer (Buffer over-size, circular data buffer mode)";
-				}
-				dataBuffer_.erase(dataBuffer_.begin());
-				getDataBufferStats();
-			}
-
+			TLOG(TLVL_WAITFORBUFFERREADY) << "getDataLoop: Data Retreival paused for " << waittime << " ms waiting for data buffer to drain";
 		}
+		lastwaittime = waittime;
+		usleep(1000);
 	}
 	return true;
 }
@@ -728,20 +754,11 @@ bool artdaq::CommandableFragmentGenerator::dataBufferIsTooLarge()
 void artdaq::CommandableFragmentGenerator::getDataBufferStats()
 {
 	/// dataBufferMutex must be owned by the calling thread!
-	dataBufferDepthFragments_ = dataBuffer_.size();
-	size_t acc = 0;
-	TLOG(TLVL_GETBUFFERSTATS) << "getDataBufferStats: Calculating buffer size";
-	for (auto i = dataBuffer_.begin(); i != dataBuffer_.end(); ++i)
-	{
-		if (i->get() != nullptr)
-		{
-			acc += (*i)->sizeBytes();
-		}
-	}
-	dataBufferDepthBytes_ = acc;
-
-	if (metricMan)
+	// dataBufferDepthFragments_ and dataBufferDepthBytes_ are maintained by pushToDataRing_, eraseFromDataBuffer_ and clearDataBuffer_
+	auto now = std::chrono::steady_clock::now();
+	if (metricMan && TimeUtils::GetElapsedTimeMilliseconds(lastDataBufferMetricsTime_, now) >= dataBufferMetricsIntervalMs_)
 	{
+		lastDataBufferMetricsTime_ = now;
 		TLOG(TLVL_GETBUFFERSTATS) << "getDataBufferStats: Sending Metrics";
 		metricMan->sendMetric("Buffer Depth Fragments", dataBufferDepthFragments_.load(), "fragments", 1, MetricMode::LastPoint);
 		metricMan->sendMetric("Buffer Depth Bytes", dataBufferDepthBytes_.load(), "bytes", 1, MetricMode::LastPoint);
@@ -753,33 +770,37 @@ void artdaq::CommandableFragmentGenerator::getDataBufferStats()
 void artdaq::CommandableFragmentGenerator::checkDataBuffer()
 {
 	std::unique_lock<std::mutex> lock(dataBufferMutex_);
-	dataCondition_.wait_for(lock, std::chrono::milliseconds(10));
-	if (dataBufferDepthFragments_ > 0)
+	dataCondition_.wait_for(lock, std::chrono::milliseconds(10), [this]() { return !dataRing_.empty(); });
+	drainDataRing_();
+	if (dataBuffer_.size() > 0)
 	{
 		if ((mode_ == RequestMode::Buffer || mode_ == RequestMode::Window))
 		{
 			// Eliminate extra fragments
-			while (dataBufferIsTooLarge())
+			while (dataBufferIsTooLarge() && dataBuffer_.size() > 0)
 			{
 				TLOG(TLVL_CHECKDATABUFFER) << "checkDataBuffer: Dropping Fragment with timestamp " << (*dataBuffer_.begin())->timestamp() << " from data buffer (Buffer over-size)";
-				dataBuffer_.erase(dataBuffer_.begin());
-				getDataBufferStats();
+				eraseFromDataBuffer_(dataBuffer_.begin());
 			}
 			if (dataBuffer_.size() > 0)
 			{
 				TLOG(TLVL_CHECKDATABUFFER) << "Determining if Fragments can be dropped from data buffer";
-				Fragment::timestamp_t last = dataBuffer_.back()->timestamp();
+				// Staleness is measured from the newest Fragment of any Fragment ID, so that an ID which stops sending data is still trimmed
+				Fragment::timestamp_t last = 0;
+				for (auto& index : dataBufferIndex_)
+				{
+					if (index.second.size() > 0 && index.second.rbegin()->first > last) last = index.second.rbegin()->first;
+				}
 				Fragment::timestamp_t min = last > staleTimeout_ ? last - staleTimeout_ : 0;
-				for (auto it = dataBuffer_.begin(); it != dataBuffer_.end();)
+
+				// Each index is ordered by timestamp, so only the stale Fragments at its beginning need to be visited
+				for (auto& index : dataBufferIndex_)
 				{
-					if ((*it)->timestamp() < min)
-					{
-						TLOG(TLVL_CHECKDATABUFFER) << "checkDataBuffer: Dropping Fragment with timestamp " << (*it)->timestamp() << " from data buffer (timeout=" << staleTimeout_ << ", min=" << min << ")";
-						it = dataBuffer_.erase(it);
-					}
-					else
+					auto it = index.second.begin();
+					while (it != index.second.end() && it->first < min)
 					{
-						++it;
+						TLOG(TLVL_CHECKDATABUFFER) << "checkDataBuffer: Dropping Fragment with timestamp " << it->first << " and Fragment ID " << index.first << " from data buffer (timeout=" << staleTimeout_ << ", min=" << min << ")";
+						it = eraseFromDataBuffer_(index.second, it);
 					}
 				}
 				getDataBufferStats();
@@ -790,10 +811,235 @@ void artdaq::CommandableFragmentGenerator::checkDataBuffer()
 			// Eliminate extra fragments
 			while (dataBuffer_.size() > fragment_ids_.size())
 			{
-				dataBuffer_.erase(dataBuffer_.begin());
+				eraseFromDataBuffer_(dataBuffer_.begin());
+			}
+		}
+	}
+}
+
+bool artdaq::CommandableFragmentGenerator::pushToDataRing_(FragmentPtrs&& frags)
+{
+	if (frags.size() == 0) return true;
+
+	// Count the new data before the request thread can see it, so that the depth never goes negative
+	size_t bytes = 0;
+	for (auto& frag : frags)
+	{
+		if (frag.get() != nullptr) bytes += frag->sizeBytes();
+	}
+	auto count = frags.size();
+	dataBufferDepthFragments_ += count;
+	dataBufferDepthBytes_ += bytes;
+
+	auto first = true;
+	while (!dataRing_.push(std::move(frags)))
+	{
+		if (force_stop_ || circularDataBufferMode_)
+		{
+			TLOG(TLVL_WARNING) << "pushToDataRing_: Data hand-off ring is full, dropping " << count << " Fragments"
+				<< (circularDataBufferMode_ ? " (circular data buffer mode)" : " (stopping)");
+			dataBufferDepthFragments_ -= count;
+			dataBufferDepthBytes_ -= bytes;
+			if (metricMan)
+			{
+				metricMan->sendMetric("Dropped Fragments", count, "fragments", 1, MetricMode::Accumulate);
+			}
+			return false;
+		}
+		if (first)
+		{
+			TLOG(TLVL_WAITFORBUFFERREADY) << "pushToDataRing_: Data hand-off ring is full, waiting for the request thread to catch up";
+			first = false;
+		}
+		dataCondition_.notify_all();
+
+		// drainDataRing_ notifies dataRingCondition_ once it has made room. The timeout is only there to notice force_stop_
+		std::unique_lock<std::mutex> lock(dataRingMutex_);
+		dataRingCondition_.wait_for(lock, std::chrono::milliseconds(10), [this]() { return dataRing_.size() < dataRing_.capacity() || force_stop_; });
+	}
+	return true;
+}
+
+void artdaq::CommandableFragmentGenerator::drainDataRing_()
+{
+	FragmentPtrs frags;
+	auto drained = false;
+	while (dataRing_.pop(frags))
+	{
+		if (mode_ == RequestMode::Single)
+		{
+			// Each entry is a complete event, and Single mode only keeps the latest one
+			clearDataBuffer_();
+		}
+		appendToDataBuffer_(frags, frags.end());
+		drained = true;
+	}
+	if (drained) notifyDataRingDrained_();
+
+	if (circularDataBufferMode_)
+	{
+		while (dataBufferIsTooLarge() && dataBuffer_.size() > 0)
+		{
+			if (*dataBuffer_.begin())
+			{
+				TLOG(TLVL_WAITFORBUFFERREADY) << "drainDataRing_: Dropping Fragment with timestamp " << (*dataBuffer_.begin())->timestamp() << " from data buffer (Buffer over-size, circular data buffer mode)";
+			}
+			eraseFromDataBuffer_(dataBuffer_.begin());
+		}
+	}
+	getDataBufferStats();
+}
+
+void artdaq::CommandableFragmentGenerator::discardDataRing_()
+{
+	FragmentPtrs frags;
+	while (dataRing_.pop(frags))
+	{
+		for (auto& frag : frags)
+		{
+			dataBufferDepthFragments_--;
+			if (frag.get() != nullptr) dataBufferDepthBytes_ -= frag->sizeBytes();
+		}
+		frags.clear();
+	}
+	notifyDataRingDrained_();
+}
+
+void artdaq::CommandableFragmentGenerator::notifyDataRingDrained_()
+{
+	// Taking the lock orders this notification after the data thread's check of the ring, so that it cannot be missed
+	std::lock_guard<std::mutex> lock(dataRingMutex_);
+	dataRingCondition_.notify_all();
+}
+
+void artdaq::CommandableFragmentGenerator::appendToDataBuffer_(FragmentPtrs& src, FragmentPtrs::iterator last)
+{
+	if (src.begin() == last) return;
+	auto first = src.begin();
+	dataBuffer_.splice(dataBuffer_.end(), src, first, last);
+
+	// splice does not invalidate iterators, so first now points at the first moved Fragment in dataBuffer_
+	DataBufferIndex* index = nullptr;
+	Fragment::fragment_id_t index_id = 0;
+	auto now = std::chrono::steady_clock::now();
+	for (auto it = first; it != dataBuffer_.end(); ++it)
+	{
+		auto ts = it->get() != nullptr ? (*it)->timestamp() : 0;
+		auto id = indexFragmentID_(*it);
+		if (index == nullptr || id != index_id)
+		{
+			index = &dataBufferIndex_[id];
+			index_id = id;
+			lastDataTime_[id] = now;
+		}
+		// Data normally arrives in timestamp order, so hint the insertion at the end of the index
+		index->emplace_hint(index->end(), ts, it);
+		if (it->get() != nullptr) dataBufferContentBytes_ += (*it)->sizeBytes();
+	}
+}
+
+artdaq::FragmentPtrs::iterator artdaq::CommandableFragmentGenerator::eraseFromDataBuffer_(FragmentPtrs::iterator it)
+{
+	auto ts = it->get() != nullptr ? (*it)->timestamp() : 0;
+	auto index = dataBufferIndex_.find(indexFragmentID_(*it));
+	if (index != dataBufferIndex_.end())
+	{
+		auto range = index->second.equal_range(ts);
+		for (auto idx = range.first; idx != range.second; ++idx)
+		{
+			if (idx->second == it)
+			{
+				auto next = std::next(it);
+				eraseFromDataBuffer_(index->second, idx);
+				return next;
 			}
 		}
 	}
+	TLOG(TLVL_WARNING) << "eraseFromDataBuffer_: Fragment with timestamp " << ts << " was not found in the data buffer index!";
+	dataBufferDepthFragments_--;
+	if (it->get() != nullptr)
+	{
+		dataBufferDepthBytes_ -= (*it)->sizeBytes();
+		dataBufferContentBytes_ -= (*it)->sizeBytes();
+	}
+	unpinFragment_(*it);
+	return dataBuffer_.erase(it);
+}
+
+artdaq::CommandableFragmentGenerator::DataBufferIndex::iterator artdaq::CommandableFragmentGenerator::eraseFromDataBuffer_(DataBufferIndex& index, DataBufferIndex::iterator idx)
+{
+	auto it = idx->second;
+	dataBufferDepthFragments_--;
+	if (it->get() != nullptr)
+	{
+		dataBufferDepthBytes_ -= (*it)->sizeBytes();
+		dataBufferContentBytes_ -= (*it)->sizeBytes();
+	}
+	unpinFragment_(*it);
+	dataBuffer_.erase(it);
+	return index.erase(idx);
+}
+
+void artdaq::CommandableFragmentGenerator::resetLastDataTimes_()
+{
+	// Every Fragment ID is waited for until it has been silent for window_close_timeout_us
+	lastDataTime_.clear();
+	auto now = std::chrono::steady_clock::now();
+	for (auto fid : fragment_ids_)
+	{
+		lastDataTime_[fid] = now;
+	}
+}
+
+artdaq::Fragment::fragment_id_t artdaq::CommandableFragmentGenerator::indexFragmentID_(FragmentPtr const& frag) const
+{
+	// A generator with a single Fragment ID owns all of its data, whatever ID getNext_ put in the header
+	if (fragment_ids_.size() == 1) return fragment_ids_[0];
+	return frag.get() != nullptr ? frag->fragmentID() : Fragment::InvalidFragmentID;
+}
+
+void artdaq::CommandableFragmentGenerator::clearDataBuffer_()
+{
+	// Fragments still in dataRing_ remain part of the depth
+	dataBufferDepthFragments_ -= dataBuffer_.size();
+	dataBufferDepthBytes_ -= dataBufferContentBytes_;
+	dataBufferContentBytes_ = 0;
+	dataBufferIndex_.clear();
+	if (!fragmentPins_.empty())
+	{
+		for (auto& frag : dataBuffer_)
+		{
+			unpinFragment_(frag);
+		}
+		fragmentPins_.clear();
+	}
+	dataBuffer_.clear();
+}
+
+std::shared_ptr<artdaq::CommandableFragmentGenerator::FragmentPin> artdaq::CommandableFragmentGenerator::pinFragment_(Fragment const* frag)
+{
+	// Overlapping windows refer to the same Fragment, and share its pin
+	auto& entry = fragmentPins_[frag];
+	auto pin = entry.lock();
+	if (!pin)
+	{
+		pin = std::make_shared<FragmentPin>();
+		entry = pin;
+	}
+	return pin;
+}
+
+void artdaq::CommandableFragmentGenerator::unpinFragment_(FragmentPtr& frag)
+{
+	if (fragmentPins_.empty() || frag.get() == nullptr) return;
+	auto entry = fragmentPins_.find(frag.get());
+	if (entry == fragmentPins_.end()) return;
+
+	// GatheredFragments which have not been sent yet still refer to the Fragment, so the last of them deletes it.
+	// The Fragment itself is not moved, so the data they refer to stays where it is.
+	auto pin = entry->second.lock();
+	if (pin) pin->fragment = std::move(frag);
+	fragmentPins_.erase(entry);
 }
 
 void artdaq::CommandableFragmentGenerator::getMonitoringDataLoop()
@@ -824,7 +1070,7 @@ void artdaq::CommandableFragmentGenerator::applyRequestsIgnoredMode(artdaq::Frag
 	// We just copy everything that's here into the output.
 	TLOG(TLVL_APPLYREQUESTS) << "Mode is Ignored; Copying data to output";
 	std::move(dataBuffer_.begin(), dataBuffer_.end(), std::inserter(frags, frags.end()));
-	dataBuffer_.clear();
+	clearDataBuffer_();
 }
 
 void artdaq::CommandableFragmentGenerator::applyRequestsSingleMode(artdaq::FragmentPtrs& frags)
@@ -861,6 +1107,7 @@ void artdaq::CommandableFragmentGenerator::applyRequestsSingleMode(artdaq::Fragm
 	{
 		sendEmptyFragment(frags, ev_counter(), "No data for");
 	}
+	sendRequestEmissionMetric_(ev_counter());
 	requestReceiver_->RemoveRequest(ev_counter());
 	ev_counter_inc(1, true);
 }
@@ -880,24 +1127,103 @@ void artdaq::CommandableFragmentGenerator::applyRequestsBufferMode(artdaq::Fragm
 	// If no requests remain after sendEmptyFragments, return
 	if (requests.size() == 0 || !requests.count(ev_counter())) return;
 
-	TLOG(TLVL_DEBUG) << "Creating ContainerFragment for Buffered Fragments";
-	frags.emplace_back(new artdaq::Fragment(ev_counter(), fragment_id()));
-	frags.back()->setTimestamp(requests[ev_counter()]);
-	ContainerFragmentLoader cfl(*frags.back());
-	cfl.set_missing_data(false); // Buffer mode is never missing data, even if there IS no data.
-
-	// Buffer mode TFGs should simply copy out the whole dataBuffer_ into a ContainerFragment
+	// Buffer mode TFGs should simply copy out the whole dataBuffer_ into one ContainerFragment per Fragment ID
 	// Window mode TFGs must do a little bit more work to decide which fragments to send for a given request
-	for (auto it = dataBuffer_.begin(); it != dataBuffer_.end();)
+	std::vector<ContainerFill> fills;
+	fills.reserve(fragment_ids_.size());
+	size_t indexed = 0;
+	for (auto fid : fragment_ids_)
 	{
-		TLOG(TLVL_APPLYREQUESTS) << "ApplyRequests: Adding Fragment with timestamp " << (*it)->timestamp() << " to Container with sequence ID " << ev_counter();
-		cfl.addFragment(*it);
-		it = dataBuffer_.erase(it);
+		TLOG(TLVL_DEBUG) << "Creating ContainerFragment for Buffered Fragments with Fragment ID " << fid;
+		auto& index = dataBufferIndex_[fid];
+		frags.emplace_back(new artdaq::Fragment(ev_counter(), fid));
+		frags.back()->setTimestamp(requests[ev_counter()]);
+
+		size_t bytes = 0;
+		for (auto& entry : index)
+		{
+			bytes += (*entry.second)->sizeBytes();
+		}
+		indexed += index.size();
+		// Buffer mode is never missing data, even if there IS no data.
+		fills.push_back(ContainerFill{ frags.back().get(), &index, index.begin(), index.end(), bytes, false });
 	}
+	fillContainers_(fills);
+
+	if (indexed < dataBuffer_.size())
+	{
+		TLOG(TLVL_WARNING) << "applyRequestsBufferMode: Dropping " << dataBuffer_.size() - indexed << " Fragments whose Fragment ID is not in the configured list";
+	}
+	clearDataBuffer_();
+	sendRequestEmissionMetric_(ev_counter());
 	requestReceiver_->RemoveRequest(ev_counter());
 	ev_counter_inc(1, true);
 }
 
+void artdaq::CommandableFragmentGenerator::reserveContainerSpace_(artdaq::Fragment& container, size_t bytes)
+{
+	if (bytes == 0) return;
+
+	// Grow the container once, so that ContainerFragmentLoader::addFragment copies each Fragment directly into
+	// its final location, instead of reallocating (and re-copying) the container every time it grows
+	TLOG(TLVL_APPLYREQUESTS) << "reserveContainerSpace_: Reserving " << bytes << " bytes in ContainerFragment with sequence ID " << container.sequenceID();
+	container.reserve(container.dataSize() + (bytes + sizeof(RawDataType) - 1) / sizeof(RawDataType));
+}
+
+void artdaq::CommandableFragmentGenerator::fillContainers_(std::vector<ContainerFill>& fills)
+{
+	size_t bytes = 0;
+	for (auto& fill : fills)
+	{
+		bytes += fill.bytes;
+	}
+
+	// Each ContainerFragment only reads from the data buffer, so the containers for different Fragment IDs may be filled at the same time.
+	// Starting threads is only worth it when there is a reasonable amount of data to copy
+	auto threads = std::min(containerFillThreads_, fills.size());
+	if (threads <= 1 || bytes < parallelContainerFillMinBytes_)
+	{
+		for (auto& fill : fills)
+		{
+			fillContainer_(fill);
+		}
+		return;
+	}
+
+	TLOG(TLVL_APPLYREQUESTS) << "fillContainers_: Filling " << fills.size() << " ContainerFragments (" << bytes << " bytes) using " << threads << " threads";
+	std::vector<std::future<void>> results;
+	for (size_t thread = 1; thread < threads; ++thread)
+	{
+		results.emplace_back(std::async(std::launch::async, [this, &fills, thread, threads]() {
+			for (auto ii = thread; ii < fills.size(); ii += threads)
+			{
+				fillContainer_(fills[ii]);
+			}
+		}));
+	}
+	for (size_t ii = 0; ii < fills.size(); ii += threads)
+	{
+		fillContainer_(fills[ii]);
+	}
+	for (auto& result : results)
+	{
+		result.get();
+	}
+}
+
+void artdaq::CommandableFragmentGenerator::fillContainer_(ContainerFill& fill)
+{
+	if (fill.container == nullptr) return; // Gathered without copying
+	ContainerFragmentLoader cfl(*fill.container);
+	cfl.set_missing_data(fill.missing_data);
+	reserveContainerSpace_(*fill.container, fill.bytes);
+	for (auto it = fill.begin; it != fill.end; ++it)
+	{
+		TLOG(TLVL_APPLYREQUESTS) << "applyRequests: Adding Fragment with timestamp " << it->first << " to Container with sequence ID " << fill.container->sequenceID() << " and Fragment ID " << fill.container->fragmentID();
+		cfl.addFragment(*it->second);
+	}
+}
+
 void artdaq::CommandableFragmentGenerator::applyRequestsWindowMode(artdaq::FragmentPtrs& frags)
 {
 	TLOG(TLVL_APPLYREQUESTS) << "applyRequestsWindowMode BEGIN";
@@ -922,70 +1248,120 @@ void artdaq::CommandableFragmentGenerator::applyRequestsWindowMode(artdaq::Fragm
 		TLOG(TLVL_APPLYREQUESTS) << "applyRequests: Checking that data exists for request window " << req->first;
 		Fragment::timestamp_t min = ts > windowOffset_ ? ts - windowOffset_ : 0;
 		Fragment::timestamp_t max = min + windowWidth_;
-		TLOG(TLVL_APPLYREQUESTS) << "ApplyRequests: min is " << min << ", max is " << max
-			<< " and last point in buffer is " << (dataBuffer_.size() > 0 ? dataBuffer_.back()->timestamp() : 0) << " (sz=" << dataBuffer_.size() << ")";
-		bool windowClosed = dataBuffer_.size() > 0 && dataBuffer_.back()->timestamp() >= max;
+
+		// The request is answered once the window is closed for every Fragment ID which is producing data. A Fragment ID which
+		// has not added data for window_close_timeout_us is not waited for, so that one idle link does not hold up every request.
+		bool windowClosed = true;
+		size_t closedIDs = 0;
+		for (auto fid : fragment_ids_)
+		{
+			auto& index = dataBufferIndex_[fid];
+			Fragment::timestamp_t bufferEnd = index.size() > 0 ? index.rbegin()->first : 0;
+			TLOG(TLVL_APPLYREQUESTS) << "ApplyRequests: min is " << min << ", max is " << max
+				<< " and last point in buffer for Fragment ID " << fid << " is " << bufferEnd << " (sz=" << index.size() << ")";
+			if (index.size() > 0 && bufferEnd >= max)
+			{
+				++closedIDs;
+				continue;
+			}
+			auto lastData = lastDataTime_.find(fid);
+			if (lastData != lastDataTime_.end() && TimeUtils::GetElapsedTimeMicroseconds(lastData->second) > window_close_timeout_us_)
+			{
+				TLOG(TLVL_APPLYREQUESTS) << "ApplyRequests: Fragment ID " << fid << " has not produced data for "
+					<< TimeUtils::GetElapsedTimeMicroseconds(lastData->second) << " us, not waiting for it";
+				continue;
+			}
+			windowClosed = false;
+			break;
+		}
+		if (closedIDs == 0) windowClosed = false;
 		bool windowTimeout = !windowClosed && TimeUtils::GetElapsedTimeMicroseconds(requestReceiver_->GetRequestTime(req->first)) > window_close_timeout_us_;
 		if (windowTimeout)
 		{
 			TLOG(TLVL_WARNING) << "applyRequests: A timeout occurred waiting for data to close the request window ({" << min << "-" << max
-				<< "}, buffer={" << (dataBuffer_.size() > 0 ? dataBuffer_.front()->timestamp() : 0) << "-"
-				<< (dataBuffer_.size() > 0 ? dataBuffer_.back()->timestamp() : 0)
-				<< "} ). Time waiting: "
+				<< "}, buffer depth=" << dataBuffer_.size()
+				<< " ). Time waiting: "
 				<< TimeUtils::GetElapsedTimeMicroseconds(requestReceiver_->GetRequestTime(req->first)) << " us "
 				<< "(> " << window_close_timeout_us_ << " us).";
 		}
 		if (windowClosed || !data_thread_running_ || windowTimeout)
 		{
-			TLOG(TLVL_DEBUG) << "applyRequests: Creating ContainerFragment for Window-requested Fragments";
-			frags.emplace_back(new artdaq::Fragment(req->first, fragment_id()));
-			frags.back()->setTimestamp(ts);
-			ContainerFragmentLoader cfl(*frags.back());
-
-			// In the spirit of NOvA's MegaPool: (RS = Request start (min), RE = Request End (max))
-			//  --- | Buffer Start | --- | Buffer End | ---
-			//1. RS RE |           |     |            | 
-			//2. RS |              |  RE |            |   
-			//3. RS |              |     |            | RE
-			//4.    |              | RS RE |          |
-			//5.    |              | RS  |            | RE
-			//6.    |              |     |            | RS RE
-			//
-			// If RE (or RS) is after the end of the buffer, we wait for window_close_timeout_us_. If we're here, then that means that windowClosed is false, and the missing_data flag should be set.
-			// If RS (or RE) is before the start of the buffer, then missing_data should be set to true, as data is assumed to arrive in the buffer in timestamp order
-			// If the dataBuffer has size 0, then windowClosed will be false
-			if (!windowClosed || (dataBuffer_.size() > 0 && dataBuffer_.front()->timestamp() > min))
+			std::vector<ContainerFill> fills;
+			fills.reserve(fragment_ids_.size());
+			for (auto fid : fragment_ids_)
 			{
-				TLOG(TLVL_DEBUG) << "applyRequests: Request window starts before and/or ends after the current data buffer, setting ContainerFragment's missing_data flag!"
-					<< " (requestWindowRange=[" << min << "," << max << "], "
-					<< "buffer={" << (dataBuffer_.size() > 0 ? dataBuffer_.front()->timestamp() : 0) << "-"
-					<< (dataBuffer_.size() > 0 ? dataBuffer_.back()->timestamp() : 0) << "}";
-				cfl.set_missing_data(true);
-			}
-
-			// Buffer mode TFGs should simply copy out the whole dataBuffer_ into a ContainerFragment
-			// Window mode TFGs must do a little bit more work to decide which fragments to send for a given request
-			for (auto it = dataBuffer_.begin(); it != dataBuffer_.end();)
-			{
-				Fragment::timestamp_t fragT = (*it)->timestamp();
-				if (fragT < min || fragT > max || (fragT == max && windowWidth_ > 0))
+				TLOG(TLVL_DEBUG) << "applyRequests: Creating ContainerFragment for Window-requested Fragments with Fragment ID " << fid;
+				auto& index = dataBufferIndex_[fid];
+
+				Fragment::timestamp_t bufferStart = index.size() > 0 ? index.begin()->first : 0;
+				Fragment::timestamp_t bufferEnd = index.size() > 0 ? index.rbegin()->first : 0;
+
+				// In the spirit of NOvA's MegaPool: (RS = Request start (min), RE = Request End (max))
+				//  --- | Buffer Start | --- | Buffer End | ---
+				//1. RS RE |           |     |            | 
+				//2. RS |              |  RE |            |   
+				//3. RS |              |     |            | RE
+				//4.    |              | RS RE |          |
+				//5.    |              | RS  |            | RE
+				//6.    |              |     |            | RS RE
+				//
+				// If RE (or RS) is after the end of the buffer, we wait for window_close_timeout_us_. If we're here, then that means that the window is not closed, and the missing_data flag should be set.
+				// If RS (or RE) is before the start of the buffer, then missing_data should be set to true, as data is assumed to arrive in the buffer in timestamp order
+				// If the dataBuffer has size 0, then the window is not closed
+				bool missing_data = index.size() == 0 || bufferEnd < max || bufferStart > min;
+				if (missing_data)
 				{
-					++it;
-					continue;
+					TLOG(TLVL_DEBUG) << "applyRequests: Request window starts before and/or ends after the current data buffer, setting ContainerFragment's missing_data flag!"
+						<< " (requestWindowRange=[" << min << "," << max << "], "
+						<< "buffer={" << bufferStart << "-" << bufferEnd << "}, Fragment ID " << fid << ")";
 				}
 
-				TLOG(TLVL_APPLYREQUESTS) << "applyRequests: Adding Fragment with timestamp " << (*it)->timestamp() << " to Container";
-				cfl.addFragment(*it);
+				// Window mode TFGs look up the Fragments in [min, max) (or [min, max] for zero-width windows) in the timestamp index
+				auto it = index.lower_bound(min);
+				auto end = windowWidth_ > 0 ? index.lower_bound(max) : index.upper_bound(max);
+
+				if (gatherWindowContainers_ && GatheredFragment::ContainerGatheringSupported())
+				{
+					std::vector<GatheredFragment::ContainerPart> parts;
+					for (auto part = it; part != end; ++part)
+					{
+						parts.emplace_back(part->second->get(), pinFragment_(part->second->get()));
+					}
+					auto gathered = GatheredFragment::MakeContainer(req->first, fid, ts, missing_data, parts);
+					if (gathered)
+					{
+						TLOG(TLVL_APPLYREQUESTS) << "applyRequests: Gathered " << parts.size() << " Fragments into Container with sequence ID " << req->first << " and Fragment ID " << fid;
+						gatheredOutput_.push_back(std::move(gathered));
+						// Nothing to copy, the entry is only kept so that the Fragments are erased with the others
+						fills.push_back(ContainerFill{ nullptr, &index, it, end, 0, missing_data });
+						continue;
+					}
+				}
 
-				if (uniqueWindows_)
+				frags.emplace_back(new artdaq::Fragment(req->first, fid));
+				frags.back()->setTimestamp(ts);
+				size_t windowBytes = 0;
+				for (auto sz = it; sz != end; ++sz)
 				{
-					it = dataBuffer_.erase(it);
+					windowBytes += (*sz->second)->sizeBytes();
 				}
-				else
+				fills.push_back(ContainerFill{ frags.back().get(), &index, it, end, windowBytes, missing_data });
+			}
+			fillContainers_(fills);
+
+			if (uniqueWindows_)
+			{
+				// Erasing from one index does not invalidate the iterators of the others
+				for (auto& fill : fills)
 				{
-					++it;
+					auto it = fill.begin;
+					while (it != fill.end)
+					{
+						it = eraseFromDataBuffer_(*fill.index, it);
+					}
 				}
 			}
+			sendRequestEmissionMetric_(req->first);
 			requestReceiver_->RemoveRequest(req->first);
 			checkOutOfOrderWindows(req->first);
 			requestReceiver_->RemoveRequest(req->first);
@@ -1036,6 +1412,7 @@ bool artdaq::CommandableFragmentGenerator::applyRequests(artdaq::FragmentPtrs& f
 
 	{
 		std::unique_lock<std::mutex> dlk(dataBufferMutex_);
+		drainDataRing_();
 
 		switch (mode_)
 		{
@@ -1057,14 +1434,15 @@ bool artdaq::CommandableFragmentGenerator::applyRequests(artdaq::FragmentPtrs& f
 		if (!data_thread_running_ || force_stop_)
 		{
 			TLOG(TLVL_INFO) << "Data thread has stopped; Clearing data buffer";
-			dataBuffer_.clear();
+			clearDataBuffer_();
+			discardDataRing_();
 		}
 
 		getDataBufferStats();
 	}
 
 	if (frags.size() > 0)
-		TLOG(TLVL_APPLYREQUESTS) << "Finished Processing Event " << (*frags.begin())->sequenceID() << " for fragment_id " << fragment_id() << ".";
+		TLOG(TLVL_APPLYREQUESTS) << "Finished Processing Event " << (*frags.begin())->sequenceID() << " (" << frags.size() << " Fragments for " << fragment_ids_.size() << " Fragment IDs).";
 	return true;
 }
 
@@ -1095,6 +1473,14 @@ void artdaq::CommandableFragmentGenerator::sendEmptyFragments(artdaq::FragmentPt
 	}
 }
 
+void artdaq::CommandableFragmentGenerator::sendRequestEmissionMetric_(artdaq::Fragment::sequence_id_t seq)
+{
+	if (metricMan)
+	{
+		metricMan->sendMetric("Request to Emission Latency", TimeUtils::GetElapsedTime(requestReceiver_->GetRequestTime(seq)), "s", 3, MetricMode::Average);
+	}
+}
+
 void artdaq::CommandableFragmentGenerator::checkOutOfOrderWindows(artdaq::Fragment::sequence_id_t seq)
 {
 	windows_sent_ooo_[seq] = std::chrono::steady_clock::now();
@@ -15,15 +15,20 @@
 #include <chrono>
 #include <array>
 #include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
 
 #include "fhiclcpp/fwd.h"
 #include "fhiclcpp/ParameterSet.h"
 
 #include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQdata/GatheredFragment.hh"
 #include "artdaq-core/Data/Fragment.hh"
 #include "artdaq-core/Generators/FragmentGenerator.hh"
 #include "artdaq-utilities/Plugins/MetricManager.hh"
 #include "artdaq/DAQrate/RequestReceiver.hh"
+#include "artdaq/DAQrate/detail/SPSCRing.hh"
 
 namespace artdaq
 {
@@ -102,8 +107,8 @@ namespace artdaq
 			fhicl::Atom<bool> request_windows_are_unique             { fhicl::Name{"request_windows_are_unique"       }, fhicl::Comment{"Whether Fragments should be removed from the buffer when matched to a request window"}, true };
 			/// "missing_request_window_timeout_us" (Default: 5000000) : How long to track missing requests in the "out-of-order Windows" list
 			fhicl::Atom<size_t> missing_request_window_timeout_us    { fhicl::Name{"missing_request_window_timeout_us"}, fhicl::Comment{"How long to track missing requests in the \"out - of - order Windows\" list"}, 5000000 };
-			/// "window_close_timeout_us" (Default: 2000000) : How long to wait for the end of the data buffer to pass the end of a request window(measured from the time the request was received)
-			fhicl::Atom<size_t> window_close_timeout_us              { fhicl::Name{"window_close_timeout_us"          }, fhicl::Comment{"How long to wait for the end of the data buffer to pass the end of a request window (measured from the time the request was received)"}, 2000000 };
+			/// "window_close_timeout_us" (Default: 2000000) : How long to wait for the end of the data buffer to pass the end of a request window(measured from the time the request was received). A Fragment ID which has not produced data for this long is not waited for
+			fhicl::Atom<size_t> window_close_timeout_us              { fhicl::Name{"window_close_timeout_us"          }, fhicl::Comment{"How long to wait for the end of the data buffer to pass the end of a request window (measured from the time the request was received). A Fragment ID which has not produced data for this long is not waited for"}, 2000000 };
 			/// "separate_data_thread" (Default: false) : Whether data collection should proceed on its own thread.Required for all data request processing
 			fhicl::Atom<bool> separate_data_thread                   { fhicl::Name{"separate_data_thread"             }, fhicl::Comment{"Whether data collection should proceed on its own thread. Required for all data request processing"}, false };
 			/// "circular_buffer_mode" (Default: false) : Whether the data buffer should be treated as a circular buffer on the input side (i.e. old fragments are automatically discarded when the buffer is full to always call getNext_).
@@ -114,6 +119,16 @@ namespace artdaq
 			fhicl::Atom<int> data_buffer_depth_fragments             { fhicl::Name{"data_buffer_depth_fragments"      }, fhicl::Comment{"How many Fragments to store in the buffer"}, 1000 };
 			/// "data_buffer_depth_mb" (Default: 1000) : The maximum size of the data buffer in MB
 			fhicl::Atom<size_t> data_buffer_depth_mb                 { fhicl::Name{"data_buffer_depth_mb"             }, fhicl::Comment{"The maximum size of the data buffer in MB"}, 1000 };
+			/// "data_buffer_metrics_interval_ms" (Default: 100) : Minimum time between reports of the data buffer depth metrics
+			fhicl::Atom<size_t> data_buffer_metrics_interval_ms      { fhicl::Name{"data_buffer_metrics_interval_ms"  }, fhicl::Comment{"Minimum time between reports of the data buffer depth metrics"}, 100 };
+			/// "container_fill_threads" (Default: 4) : Maximum number of threads used to fill the ContainerFragments for one request, when there is more than one Fragment ID
+			fhicl::Atom<size_t> container_fill_threads               { fhicl::Name{"container_fill_threads"           }, fhicl::Comment{"Maximum number of threads used to fill the ContainerFragments for one request, when there is more than one Fragment ID"}, 4 };
+			/// "parallel_container_fill_min_bytes" (Default: 1048576) : Requests selecting less data than this fill their ContainerFragments on the request thread only
+			fhicl::Atom<size_t> parallel_container_fill_min_bytes    { fhicl::Name{"parallel_container_fill_min_bytes"}, fhicl::Comment{"Requests selecting less data than this fill their ContainerFragments on the request thread only"}, 1048576 };
+			/// "gather_window_containers" (Default: false) : In Window mode, send ContainerFragments which refer to the buffered Fragments instead of copying them (overlapping windows then share the data)
+			fhicl::Atom<bool> gather_window_containers               { fhicl::Name{"gather_window_containers"         }, fhicl::Comment{"In Window mode, send ContainerFragments which refer to the buffered Fragments instead of copying them (overlapping windows then share the data)"}, false };
+			/// "data_handoff_ring_size" (Default: 1024) : Number of getNext_ results which may be waiting to be moved from the data thread into the data buffer
+			fhicl::Atom<size_t> data_handoff_ring_size               { fhicl::Name{"data_handoff_ring_size"           }, fhicl::Comment{"Number of getNext_ results which may be waiting to be moved from the data thread into the data buffer"}, 1024 };
 			/// "separate_monitoring_thread" (Default: false) : Whether a thread that calls the checkHWStatus_ method should be created
 			fhicl::Atom<bool> separate_monitoring_thread             { fhicl::Name{"separate_monitoring_thread"       }, fhicl::Comment{"Whether a thread that calls the checkHWStatus_ method should be created"}, false };
 			/// "hardware_poll_interval_us" (Default: 0) : If a separate monitoring thread is used, how often should it call checkHWStatus_
@@ -140,6 +155,12 @@ namespace artdaq
 		};
 		using Parameters = fhicl::WrappedTable<Config>;
 
+		/// Index of the Fragments in the data buffer, ordered by timestamp
+		typedef std::multimap<Fragment::timestamp_t, FragmentPtrs::iterator> DataBufferIndex;
+
+		/// Timestamp index of the data buffer for each Fragment ID
+		typedef std::map<Fragment::fragment_id_t, DataBufferIndex> DataBufferIndexMap;
+
 		/**
 		 * \brief CommandableFragmentGenerator default constructor
 		 *
@@ -176,6 +197,16 @@ namespace artdaq
 		 */
 		bool getNext(FragmentPtrs& output) override final;
 
+		/**
+		 * \brief getNext, also returning the ContainerFragments which were gathered from the data buffer without copying
+		 * \param output FragmentPtrs object containing Fragments ready for transmission
+		 * \param gathered GatheredFragments ready for transmission. They refer to Fragments of the data buffer, which are kept until they are destroyed
+		 * \return Whether getNext completed without exceptions
+		 *
+		 * The single-argument getNext copies the GatheredFragments into ordinary Fragments.
+		 */
+		bool getNext(FragmentPtrs& output, GatheredFragmentPtrs& gathered);
+
 
 		/// <summary>
 		/// Create fragments using data buffer for request mode Ignored.
@@ -193,6 +224,7 @@ namespace artdaq
 
 		/// <summary>
 		/// Create fragments using data buffer for request mode Buffer.
+		/// One ContainerFragment is created for each Fragment ID, holding all of the buffered Fragments with that ID.
 		/// Precondition: dataBufferMutex_ and request_mutex_ are locked
 		/// </summary>
 		/// <param name="frags">Ouput fragments</param>
@@ -200,11 +232,25 @@ namespace artdaq
 
 		/// <summary>
 		/// Create fragments using data buffer for request mode Window.
+		/// One ContainerFragment is created for each Fragment ID, once the request window is closed for all of them which are producing data (or times out).
 		/// Precondition: dataBufferMutex_ and request_mutex_ are locked
 		/// </summary>
 		/// <param name="frags">Ouput fragments</param>
 		void applyRequestsWindowMode(artdaq::FragmentPtrs& frags);
 
+		/**
+		 * \brief Reserve space in a ContainerFragment for Fragments which are about to be added to it
+		 * \param container ContainerFragment which will receive the Fragments
+		 * \param bytes Total size of the Fragments, in bytes
+		 */
+		void reserveContainerSpace_(artdaq::Fragment& container, size_t bytes);
+
+		/**
+		 * \brief Report the time between the arrival of a request and the emission of its data
+		 * \param seq Sequence ID of the request
+		 */
+		void sendRequestEmissionMetric_(Fragment::sequence_id_t seq);
+
 		/**
 		 * \brief See if any requests have been received, and add the corresponding data Fragment objects to the output list
 		 * \param[out] output list of FragmentPtr objects ready for transmission
@@ -273,7 +319,7 @@ namespace artdaq
 		bool dataBufferIsTooLarge();
 
 		/**
-		 * \brief Calculate the size of the dataBuffer and report appropriate metrics
+		 * \brief Report the size of the dataBuffer, sending metrics at most once per data_buffer_metrics_interval_ms
 		 */
 		void getDataBufferStats();
 
@@ -284,6 +330,84 @@ namespace artdaq
 		 */
 		void checkDataBuffer();
 
+		/**
+		 * \brief Hand a list of Fragments from the data thread to the thread calling applyRequests, without locking
+		 * \param frags Fragments to hand over. Only moved from if the hand-off succeeds
+		 * \return Whether the Fragments were handed over. In circular data buffer mode (or when stopping), Fragments are dropped
+		 * instead of waiting for room in the hand-off ring
+		 *
+		 * Only the data thread may call this function
+		 */
+		bool pushToDataRing_(FragmentPtrs&& frags);
+
+		/**
+		 * \brief Move all Fragments handed over by the data thread into the data buffer
+		 *
+		 * dataBufferMutex must be owned by the calling thread!
+		 */
+		void drainDataRing_();
+
+		/**
+		 * \brief Drop all Fragments handed over by the data thread which have not yet been moved into the data buffer
+		 *
+		 * May only be called while the data thread is not running, or from the thread calling applyRequests
+		 */
+		void discardDataRing_();
+
+		/**
+		 * \brief Wake the data thread if it is waiting in pushToDataRing_ for room in the hand-off ring
+		 */
+		void notifyDataRingDrained_();
+
+		/**
+		 * \brief Move Fragments from the front of a list to the end of the data buffer, adding them to the timestamp index
+		 * \param src List to take Fragments from
+		 * \param last End of the range of Fragments to move (Fragments from src.begin() up to but not including last are moved)
+		 *
+		 * dataBufferMutex must be owned by the calling thread!
+		 */
+		void appendToDataBuffer_(FragmentPtrs& src, FragmentPtrs::iterator last);
+
+		/**
+		 * \brief Remove a Fragment from the data buffer and from the timestamp index
+		 * \param it Iterator to the Fragment in dataBuffer_
+		 * \return Iterator to the next Fragment in dataBuffer_
+		 *
+		 * dataBufferMutex must be owned by the calling thread!
+		 */
+		FragmentPtrs::iterator eraseFromDataBuffer_(FragmentPtrs::iterator it);
+
+		/**
+		 * \brief Remove a Fragment from the data buffer and from the timestamp index
+		 * \param index Timestamp index containing idx
+		 * \param idx Iterator to the Fragment's entry in the timestamp index
+		 * \return Iterator to the next entry in the timestamp index
+		 *
+		 * dataBufferMutex must be owned by the calling thread!
+		 */
+		DataBufferIndex::iterator eraseFromDataBuffer_(DataBufferIndex& index, DataBufferIndex::iterator idx);
+
+		/**
+		 * \brief Get the Fragment ID under which a Fragment is kept in the timestamp index
+		 * \param frag Fragment in the data buffer
+		 * \return The Fragment ID of frag, or the only configured Fragment ID if there is just one
+		 */
+		Fragment::fragment_id_t indexFragmentID_(FragmentPtr const& frag) const;
+
+		/**
+		 * \brief Start the idle time of every Fragment ID over, at the start of a run or after a pause
+		 *
+		 * dataBufferMutex must be owned by the calling thread!
+		 */
+		void resetLastDataTimes_();
+
+		/**
+		 * \brief Remove all Fragments from the data buffer and the timestamp index
+		 *
+		 * dataBufferMutex must be owned by the calling thread!
+		 */
+		void clearDataBuffer_();
+
 		/**
 		 * \brief This function regularly calls checkHWStatus_(), and sets the isHardwareOK flag accordingly.
 		 */
@@ -510,6 +634,30 @@ namespace artdaq
 		std::mutex mutex_; ///< Mutex used to ensure that multiple transition commands do not run at the same time
 
 	private:
+		// Range of the timestamp index to copy into a ContainerFragment
+		struct ContainerFill
+		{
+			Fragment* container;
+			DataBufferIndex* index;
+			DataBufferIndex::iterator begin;
+			DataBufferIndex::iterator end;
+			size_t bytes;
+			bool missing_data;
+		};
+
+		void fillContainers_(std::vector<ContainerFill>& fills);
+		void fillContainer_(ContainerFill& fill);
+
+		// Keeps a buffered Fragment alive for the GatheredFragments which refer to it, once it has left the data buffer
+		struct FragmentPin
+		{
+			FragmentPtr fragment;
+		};
+
+		// dataBufferMutex_ must be owned by the calling thread
+		std::shared_ptr<FragmentPin> pinFragment_(Fragment const* frag);
+		void unpinFragment_(FragmentPtr& frag);
+
 		// FHiCL-configurable variables. Note that the C++ variable names
 		// are the FHiCL variable names with a "_" appended
 
@@ -526,6 +674,11 @@ namespace artdaq
 		std::map<Fragment::sequence_id_t, std::chrono::steady_clock::time_point> windows_sent_ooo_;
 		size_t missing_request_window_timeout_us_;
 		size_t window_close_timeout_us_;
+		size_t containerFillThreads_;
+		size_t parallelContainerFillMinBytes_;
+		bool gatherWindowContainers_;
+		GatheredFragmentPtrs gatheredOutput_; // Filled by applyRequestsWindowMode, emptied by getNext
+		std::unordered_map<Fragment const*, std::weak_ptr<FragmentPin>> fragmentPins_; // Buffered Fragments referred to by GatheredFragments
 
 		bool useDataThread_;
 		bool circularDataBufferMode_;
@@ -538,6 +691,11 @@ namespace artdaq
 		std::atomic<size_t> dataBufferDepthBytes_;
 		int maxDataBufferDepthFragments_;
 		size_t maxDataBufferDepthBytes_;
+		size_t dataBufferMetricsIntervalMs_;
+		std::chrono::steady_clock::time_point lastDataBufferMetricsTime_;
+		detail::SPSCRing<FragmentPtrs> dataRing_; // Data thread to request thread hand-off
+		std::mutex dataRingMutex_; // Only used to wait on dataRingCondition_
+		std::condition_variable dataRingCondition_; // Notified when the request thread takes data out of dataRing_
 
 		bool useMonitoringThread_;
 		boost::thread monitoringThread_;
@@ -547,6 +705,9 @@ namespace artdaq
 
 		FragmentPtrs dataBuffer_;
 		FragmentPtrs newDataBuffer_;
+		DataBufferIndexMap dataBufferIndex_; // Entries of dataBuffer_, ordered by timestamp, for each Fragment ID
+		std::map<Fragment::fragment_id_t, std::chrono::steady_clock::time_point> lastDataTime_; // When each Fragment ID last added data, or the start of the run
+		size_t dataBufferContentBytes_; // Size of the Fragments in dataBuffer_ (dataBufferDepthBytes_ also includes dataRing_)
 		std::mutex dataBufferMutex_;
 
 		std::vector<artdaq::Fragment::fragment_id_t> fragment_ids_;
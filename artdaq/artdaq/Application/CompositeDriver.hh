@@ -4,6 +4,11 @@
 #include "fhiclcpp/fwd.h"
 #include "artdaq/Application/CommandableFragmentGenerator.hh"
 #include "artdaq-core/Data/Fragment.hh"
+#include <boost/thread.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 
 namespace artdaq
@@ -25,6 +30,14 @@ namespace artdaq
 		 * CompositeDriver accepts the following Parameters:
 		 * "generator_config_list" (REQUIRED): A FHiCL sequence of FHiCL tables, each one configuring
 		 * a CommandableFragmentGenerator instance.
+		 * "parallel_children" (Default: false): Read out each CommandableFragmentGenerator on its own thread,
+		 * and merge their output by sequence ID
+		 * "child_queue_size" (Default: 1000): In parallel mode, the maximum number of Fragments waiting in the
+		 * output queue of each CommandableFragmentGenerator. The child thread waits when its queue is full
+		 * "child_stall_timeout_ms" (Default: 1000): In parallel mode, a CommandableFragmentGenerator which has not
+		 * returned data for this long, while another one has returned later sequence IDs, is reported as stalled,
+		 * and no longer holds back the output of the others. If it resumes, its Fragments with sequence IDs lower than
+		 * ones already sent are dropped (and counted in the "<name> Late Fragments" metric), so that the output stays in order
 		 * \endverbatim
 		 */
 		explicit CompositeDriver(fhicl::ParameterSet const& ps);
@@ -66,8 +79,43 @@ namespace artdaq
 
 		bool makeChildGenerator_(fhicl::ParameterSet const&);
 
+		void checkChildException_(size_t idx);
+
+		bool getNextParallel_(artdaq::FragmentPtrs& output);
+
+		void startChildThreads_();
+
+		void joinChildThreads_();
+
+		void runChild_(size_t idx);
+
 		std::vector<std::unique_ptr<CommandableFragmentGenerator>> generator_list_;
 		std::vector<bool> generator_active_list_;
+
+		// Output of one child generator in parallel mode. Guarded by child_mutex_
+		struct ChildState
+		{
+			artdaq::FragmentPtrs queue;
+			size_t queue_depth = 0;
+			bool running = false;
+			bool failed = false;
+			bool stalled = false;
+			bool has_data = false;
+			artdaq::Fragment::sequence_id_t last_sequence_id = 0;
+			std::chrono::steady_clock::time_point last_data_time;
+			boost::thread thread;
+		};
+
+		bool parallel_children_;
+		size_t child_queue_size_;
+		size_t child_stall_timeout_us_;
+		std::vector<std::unique_ptr<ChildState>> child_states_;
+		std::mutex child_mutex_;
+		std::condition_variable child_data_cv_;
+		std::condition_variable child_space_cv_;
+		std::atomic<bool> child_threads_stop_;
+		bool has_sent_sequence_id_; // Guarded by child_mutex_
+		artdaq::Fragment::sequence_id_t highest_sent_sequence_id_; // Highest sequence ID sent in parallel mode. Guarded by child_mutex_
 	};
 }
 #endif /* artdaq_Application_CompositeDriver_hh */
@@ -4,6 +4,8 @@
 
 #include "artdaq/Application/GeneratorMacros.hh"
 #include "artdaq/Application/makeCommandableFragmentGenerator.hh"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq-core/Utilities/TimeUtils.hh"
 #include "canvas/Utilities/Exception.h"
 #include "cetlib_except/exception.h"
 #include <boost/algorithm/string.hpp>
@@ -12,6 +14,12 @@ using fhicl::ParameterSet;
 
 artdaq::CompositeDriver::CompositeDriver(ParameterSet const& ps):
 																CommandableFragmentGenerator(ps)
+																, parallel_children_(ps.get<bool>("parallel_children", false))
+																, child_queue_size_(ps.get<size_t>("child_queue_size", 1000))
+																, child_stall_timeout_us_(ps.get<size_t>("child_stall_timeout_ms", 1000) * 1000)
+																, child_threads_stop_(false)
+																, has_sent_sequence_id_(false)
+																, highest_sent_sequence_id_(0)
 {
 	std::vector<ParameterSet> psetList =
 		ps.get<std::vector<ParameterSet>>("generator_config_list");
@@ -32,10 +40,22 @@ artdaq::CompositeDriver::CompositeDriver(ParameterSet const& ps):
 		compositeMetricName.append(generator->metricsReportingInstanceName());
 	}
 	this->metricsReportingInstanceName(compositeMetricName);
+
+	if (parallel_children_)
+	{
+		for (size_t idx = 0; idx < generator_list_.size(); ++idx)
+		{
+			child_states_.emplace_back(new ChildState());
+		}
+	}
 }
 
 artdaq::CompositeDriver::~CompositeDriver() noexcept
 {
+	child_threads_stop_ = true;
+	child_space_cv_.notify_all();
+	joinChildThreads_();
+
 	// 15-Feb-2014, KAB - explicitly destruct the generators so that
 	// we can control the order in which they are destructed
 	size_t listSize = generator_list_.size();
@@ -65,6 +85,7 @@ void artdaq::CompositeDriver::start()
 	{
 		generator->StartCmd(run_number(), timeout(), timestamp());
 	}
+	if (parallel_children_) startChildThreads_();
 }
 
 void artdaq::CompositeDriver::stopNoMutex()
@@ -106,6 +127,7 @@ void artdaq::CompositeDriver::resume()
 	{
 		generator->ResumeCmd(timeout(), timestamp());
 	}
+	if (parallel_children_) startChildThreads_();
 }
 
 std::vector<artdaq::Fragment::fragment_id_t> artdaq::CompositeDriver::fragmentIDs()
@@ -122,6 +144,8 @@ std::vector<artdaq::Fragment::fragment_id_t> artdaq::CompositeDriver::fragmentID
 
 bool artdaq::CompositeDriver::getNext_(artdaq::FragmentPtrs& frags)
 {
+	if (parallel_children_) return getNextParallel_(frags);
+
 	bool anyGeneratorIsActive = false;
 	for (size_t idx = 0; idx < generator_list_.size(); ++idx)
 	{
@@ -136,33 +160,277 @@ bool artdaq::CompositeDriver::getNext_(artdaq::FragmentPtrs& frags)
 			// we throw an exception so that the process will move to the
 			// InRunError state. We do our best to try to reproduce the original
 			// exception message.
-			if (! status && generator_list_[idx]->exception())
+			if (! status) checkChildException_(idx);
+			generator_active_list_[idx] = status;
+			if (status) { anyGeneratorIsActive = true; }
+		}
+	}
+	return anyGeneratorIsActive;
+}
+
+void artdaq::CompositeDriver::checkChildException_(size_t idx)
+{
+	if (generator_list_[idx]->exception())
+	{
+		std::string reportString =
+			generator_list_[idx]->ReportCmd("latest_exception");
+		if (std::string::npos !=
+			boost::algorithm::to_lower_copy(reportString).find("exception"))
+		{
+			throw cet::exception("CompositeDriver_generator")
+				  << "The FragmentGenerator for "
+				  << generator_list_[idx]->metricsReportingInstanceName()
+				  << " threw an exception: " << reportString;
+		}
+		else
+		{
+			throw cet::exception("CompositeDriver_generator")
+				  << "The FragmentGenerator for "
+				  << generator_list_[idx]->metricsReportingInstanceName()
+				  << " threw an exception.";
+		}
+	}
+}
+
+bool artdaq::CompositeDriver::getNextParallel_(artdaq::FragmentPtrs& frags)
+{
+	std::vector<size_t> finished;
+	bool anyGeneratorIsActive = false;
+	{
+		std::unique_lock<std::mutex> lk(child_mutex_);
+		child_data_cv_.wait_for(lk, std::chrono::milliseconds(10), [this]() {
+			for (auto& child : child_states_)
 			{
-				std::string reportString =
-					generator_list_[idx]->ReportCmd("latest_exception");
-				if (std::string::npos !=
-					boost::algorithm::to_lower_copy(reportString).find("exception"))
+				if (child->queue_depth > 0 || !child->running) return true;
+			}
+			return false;
+		});
+
+		// A child can only be behind the others if one of them has reached a later sequence ID.
+		// When no data is arriving at all (e.g. no triggers), none of the children is stalled.
+		bool anyChildHasData = false;
+		artdaq::Fragment::sequence_id_t highest = 0;
+		for (auto& child : child_states_)
+		{
+			if (!child->running || !child->has_data) continue;
+			if (!anyChildHasData || child->last_sequence_id > highest) highest = child->last_sequence_id;
+			anyChildHasData = true;
+		}
+
+		// Fragments up to the lowest sequence ID that every running child has reached can be sent in order.
+		// Children which have finished, or which have fallen behind and stopped returning data, do not hold back the others.
+		bool haveWatermark = false;
+		artdaq::Fragment::sequence_id_t watermark = 0;
+		for (size_t idx = 0; idx < child_states_.size(); ++idx)
+		{
+			auto& child = *child_states_[idx];
+			if (!child.running)
+			{
+				if (generator_active_list_[idx] && child.queue_depth == 0)
+				{
+					generator_active_list_[idx] = false;
+					finished.push_back(idx);
+				}
+				continue;
+			}
+			anyGeneratorIsActive = true;
+
+			auto behind = anyChildHasData && (!child.has_data || child.last_sequence_id < highest);
+			auto stalled = behind && TimeUtils::GetElapsedTimeMicroseconds(child.last_data_time) > child_stall_timeout_us_;
+			if (stalled != child.stalled)
+			{
+				child.stalled = stalled;
+				if (stalled)
+				{
+					TLOG(TLVL_WARNING) << "The FragmentGenerator for " << generator_list_[idx]->metricsReportingInstanceName()
+						<< " has not returned data for " << child_stall_timeout_us_ / 1000 << " ms while the others reached sequence ID " << highest
+						<< ", no longer waiting for it";
+				}
+				if (metricMan)
 				{
-					throw cet::exception("CompositeDriver_generator")
-						  << "The FragmentGenerator for "
-						  << generator_list_[idx]->metricsReportingInstanceName()
-						  << " threw an exception: " << reportString;
+					metricMan->sendMetric(generator_list_[idx]->metricsReportingInstanceName() + " Stalled", stalled ? 1 : 0, "", 1, MetricMode::LastPoint);
+				}
+			}
+			if (stalled) continue;
+
+			if (!child.has_data)
+			{
+				// This child has not sent anything yet, so any sequence ID could still come from it.
+				// The remaining children are still checked, so that their stall state stays up to date
+				haveWatermark = true;
+				watermark = 0;
+				continue;
+			}
+			if (!haveWatermark || child.last_sequence_id < watermark) watermark = child.last_sequence_id; // Stays 0 once a child without data was seen
+			haveWatermark = true;
+		}
+
+		auto compare = [](artdaq::FragmentPtr const& a, artdaq::FragmentPtr const& b) { return a->sequenceID() < b->sequenceID(); };
+		auto highest_sent = highest_sent_sequence_id_;
+		for (size_t idx = 0; idx < child_states_.size(); ++idx)
+		{
+			auto& child = *child_states_[idx];
+			auto it = child.queue.begin();
+			size_t count = 0;
+			while (it != child.queue.end() && (!haveWatermark || (*it)->sequenceID() <= watermark))
+			{
+				++it;
+				++count;
+			}
+			if (count == 0) continue;
+
+			artdaq::FragmentPtrs ready;
+			ready.splice(ready.end(), child.queue, child.queue.begin(), it);
+			child.queue_depth -= count;
+
+			// A child which resumes after being reported stalled can return sequence IDs which the others have already passed
+			size_t late = 0;
+			for (auto fit = ready.begin(); fit != ready.end();)
+			{
+				if (has_sent_sequence_id_ && (*fit)->sequenceID() < highest_sent_sequence_id_)
+				{
+					fit = ready.erase(fit);
+					++late;
 				}
 				else
 				{
-					throw cet::exception("CompositeDriver_generator")
-						  << "The FragmentGenerator for "
-						  << generator_list_[idx]->metricsReportingInstanceName()
-						  << " threw an exception.";
+					if ((*fit)->sequenceID() > highest_sent) highest_sent = (*fit)->sequenceID();
+					++fit;
 				}
 			}
-			generator_active_list_[idx] = status;
-			if (status) { anyGeneratorIsActive = true; }
+			if (late > 0)
+			{
+				TLOG(TLVL_WARNING) << "Dropping " << late << " Fragments from " << generator_list_[idx]->metricsReportingInstanceName()
+					<< " with sequence IDs lower than " << highest_sent_sequence_id_ << ", which has already been sent";
+				if (metricMan)
+				{
+					metricMan->sendMetric(generator_list_[idx]->metricsReportingInstanceName() + " Late Fragments", late, "fragments", 1, MetricMode::Accumulate);
+				}
+			}
+			if (ready.empty()) continue;
+
+			frags.merge(ready, compare);
+			has_sent_sequence_id_ = true;
+		}
+		highest_sent_sequence_id_ = highest_sent;
+		for (auto& child : child_states_)
+		{
+			if (child->queue_depth > 0) anyGeneratorIsActive = true;
+		}
+	}
+	child_space_cv_.notify_all();
+
+	for (auto idx : finished)
+	{
+		if (child_states_[idx]->failed)
+		{
+			throw cet::exception("CompositeDriver_generator")
+				  << "The readout thread for "
+				  << generator_list_[idx]->metricsReportingInstanceName()
+				  << " caught an exception.";
 		}
+		checkChildException_(idx);
 	}
 	return anyGeneratorIsActive;
 }
 
+void artdaq::CompositeDriver::startChildThreads_()
+{
+	joinChildThreads_();
+	child_threads_stop_ = false;
+	for (size_t idx = 0; idx < child_states_.size(); ++idx)
+	{
+		auto& child = *child_states_[idx];
+		{
+			std::unique_lock<std::mutex> lk(child_mutex_);
+			child.queue.clear();
+			child.queue_depth = 0;
+			child.running = true;
+			child.failed = false;
+			child.stalled = false;
+			child.has_data = false;
+			child.last_data_time = std::chrono::steady_clock::now();
+		}
+		child.thread = boost::thread(&CompositeDriver::runChild_, this, idx);
+	}
+	std::unique_lock<std::mutex> lk(child_mutex_);
+	has_sent_sequence_id_ = false;
+	highest_sent_sequence_id_ = 0;
+}
+
+void artdaq::CompositeDriver::joinChildThreads_()
+{
+	for (auto& child : child_states_)
+	{
+		if (child->thread.joinable()) child->thread.join();
+	}
+}
+
+void artdaq::CompositeDriver::runChild_(size_t idx)
+{
+	auto& child = *child_states_[idx];
+	auto& generator = generator_list_[idx];
+	auto name = generator->metricsReportingInstanceName();
+	TLOG(TLVL_DEBUG) << "Starting readout thread for " << name;
+
+	bool status = true;
+	while (status && !child_threads_stop_)
+	{
+		artdaq::FragmentPtrs frags;
+		auto read_start = std::chrono::steady_clock::now();
+		try
+		{
+			status = generator->getNext(frags);
+		}
+		catch (...)
+		{
+			TLOG(TLVL_ERROR) << "Unhandled exception in the readout thread for " << name;
+			std::unique_lock<std::mutex> lk(child_mutex_);
+			child.failed = true;
+			status = false;
+		}
+		auto read_time = TimeUtils::GetElapsedTime(read_start);
+
+		auto count = frags.size();
+		auto wait_start = std::chrono::steady_clock::now();
+		size_t depth = 0;
+		{
+			std::unique_lock<std::mutex> lk(child_mutex_);
+			while (count > 0 && child.queue_depth >= child_queue_size_ && !child_threads_stop_)
+			{
+				child_space_cv_.wait(lk);
+			}
+			if (count > 0)
+			{
+				child.has_data = true;
+				child.last_sequence_id = frags.back()->sequenceID();
+				child.last_data_time = std::chrono::steady_clock::now();
+				child.queue.splice(child.queue.end(), frags);
+				child.queue_depth += count;
+			}
+			if (!status) child.running = false;
+			depth = child.queue_depth;
+		}
+		child_data_cv_.notify_all();
+
+		if (metricMan)
+		{
+			metricMan->sendMetric(name + " Fragment Rate", count, "fragments/s", 1, MetricMode::Rate);
+			metricMan->sendMetric(name + " Read Time", read_time, "s", 3, MetricMode::Average);
+			metricMan->sendMetric(name + " Output Wait Time", TimeUtils::GetElapsedTime(wait_start), "s", 3, MetricMode::Accumulate);
+			metricMan->sendMetric(name + " Queue Depth", depth, "fragments", 3, MetricMode::LastPoint);
+		}
+	}
+
+	if (status)
+	{
+		std::unique_lock<std::mutex> lk(child_mutex_);
+		child.running = false;
+	}
+	child_data_cv_.notify_all();
+	TLOG(TLVL_DEBUG) << "Readout thread for " << name << " exiting";
+}
+
 bool artdaq::CompositeDriver::makeChildGenerator_(fhicl::ParameterSet const& pset)
 {
 	// pull out the relevant parts of the ParameterSet
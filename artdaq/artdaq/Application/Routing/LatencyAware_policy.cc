@@ -0,0 +1,131 @@
+#include "artdaq/Application/Routing/RoutingMasterPolicy.hh"
+#include "artdaq/Application/Routing/PolicyMacros.hh"
+#include "fhiclcpp/ParameterSet.h"
+#include "tracemf.h"
+#define TRACE_NAME "LatencyAware_policy"
+
+#include <functional>
+#include <queue>
+
+namespace artdaq
+{
+	/**
+	 * \brief A RoutingMasterPolicy which sends each event to the receiver expected to finish it soonest,
+	 * using the shared memory occupancy and art latency reported in the RoutingTokens.
+	 */
+	class LatencyAwarePolicy : public RoutingMasterPolicy
+	{
+	public:
+		/**
+		 * \brief LatencyAwarePolicy Constructor
+		 * \param ps ParameterSet used to configure the LatencyAwarePolicy
+		 *
+		 * \verbatim
+		 * LatencyAwarePolicy accepts the following Parameters:
+		 * "max_completion_ratio" (Default: 2.0): Tokens from a receiver are only used while its estimated completion time is
+		 *   less than this factor times the best estimate of any receiver with tokens. Other tokens are kept for later tables.
+		 * \endverbatim
+		 */
+		explicit LatencyAwarePolicy(fhicl::ParameterSet ps);
+
+		/**
+		 * \brief Default virtual Destructor
+		 */
+		virtual ~LatencyAwarePolicy() = default;
+
+		/**
+		 * \brief Create a Routing Table using the tokens that have been received
+		 * \return A detail::RoutingPacket containing the table update
+		 *
+		 * The estimated completion time of an event sent to a receiver is its reported art latency, scaled up by how full
+		 * its shared memory will be once the event arrives: latency * (1 + (occupied + assigned) / buffer_count).
+		 * Each Sequence ID is assigned to the receiver with the lowest estimate. Receivers which have not reported a
+		 * latency are assumed to have the average latency of the others. Assignment stops when the best remaining estimate
+		 * exceeds max_completion_ratio times the best initial estimate, so that slow receivers (stragglers) are only used
+		 * when faster receivers have no free slots.
+		 */
+		detail::RoutingPacket GetCurrentTable() override;
+
+	private:
+		double max_completion_ratio_;
+	};
+
+	LatencyAwarePolicy::LatencyAwarePolicy(fhicl::ParameterSet ps)
+		: RoutingMasterPolicy(ps)
+		, max_completion_ratio_(ps.get<double>("max_completion_ratio", 2.0))
+	{
+		if (max_completion_ratio_ < 1.0) max_completion_ratio_ = 1.0;
+	}
+
+	detail::RoutingPacket LatencyAwarePolicy::GetCurrentTable()
+	{
+		TLOG(12) << "LatencyAwarePolicy::GetCurrentTable start";
+		auto tokens = getTokensSnapshot();
+		std::map<int, int> table;
+		for (auto token : *tokens.get())
+		{
+			table[token]++;
+		}
+		tokens->clear();
+
+		auto status = getReceiverStatus();
+		std::map<int, ReceiverStatus> status_by_rank;
+		double latency_sum = 0;
+		size_t latency_count = 0;
+		for (auto& s : status)
+		{
+			status_by_rank[s.rank] = s;
+			if (s.art_latency_us > 0)
+			{
+				latency_sum += s.art_latency_us;
+				latency_count++;
+			}
+		}
+		auto default_latency = latency_count > 0 ? latency_sum / latency_count : 1.0;
+
+		std::map<int, int> assigned;
+		auto estimate = [&](int rank) {
+			auto& s = status_by_rank[rank];
+			double latency = s.art_latency_us > 0 ? s.art_latency_us : default_latency;
+			double occupancy = s.buffer_count > 0 ? (s.buffers_occupied + assigned[rank]) / static_cast<double>(s.buffer_count) : 0.0;
+			return latency * (1.0 + occupancy);
+		};
+
+		typedef std::pair<double, int> candidate_t;
+		std::priority_queue<candidate_t, std::vector<candidate_t>, std::greater<candidate_t>> candidates;
+		for (auto& r : table)
+		{
+			candidates.emplace(estimate(r.first), r.first);
+		}
+
+		detail::RoutingPacket output;
+		auto threshold = candidates.empty() ? 0.0 : candidates.top().first * max_completion_ratio_;
+		TLOG(13) << "LatencyAwarePolicy::GetCurrentTable " << table.size() << " receivers have tokens, threshold is " << threshold << " us";
+
+		while (!candidates.empty() && candidates.top().first <= threshold)
+		{
+			auto rank = candidates.top().second;
+			candidates.pop();
+
+			TLOG(14) << "LatencyAwarePolicy::GetCurrentTable assigning sequenceID " << next_sequence_id_ << " to rank " << rank;
+			output.emplace_back(detail::RoutingPacketEntry(next_sequence_id_++, rank));
+			assigned[rank]++;
+			if (--table[rank] > 0) candidates.emplace(estimate(rank), rank);
+		}
+
+		for (auto r : table)
+		{
+			for (auto i = 0; i < r.second; ++i)
+			{
+				tokens->push_back(r.first);
+			}
+		}
+		TLOG(13) << "LatencyAwarePolicy::GetCurrentTable " << tokens->size() << " unused tokens will be saved for later";
+		addUnusedTokens(std::move(tokens));
+
+		TLOG(12) << "LatencyAwarePolicy::GetCurrentTable return with table size " << output.size();
+		return output;
+	}
+}
+
+DEFINE_ARTDAQ_ROUTING_POLICY(artdaq::LatencyAwarePolicy)
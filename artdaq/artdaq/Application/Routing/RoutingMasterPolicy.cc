@@ -5,43 +5,85 @@
 
 artdaq::RoutingMasterPolicy::RoutingMasterPolicy(fhicl::ParameterSet ps)
 	: next_sequence_id_(1)
-	, tokens_()
+	, receiver_ranks_()
+	, receiver_index_()
+	, tokens_(new std::deque<int>())
+	, pending_tokens_()
+	, spare_pending_tokens_()
+	, pending_token_count_(0)
 	, max_token_count_(0)
+	, receiver_status_()
 {
 	auto receiver_ranks = ps.get<std::vector<int>>("receiver_ranks");
-	receiver_ranks_.insert(receiver_ranks.begin(), receiver_ranks.end());
+	for (auto rank : receiver_ranks)
+	{
+		if (receiver_index_.count(rank)) continue;
+		receiver_index_[rank] = receiver_ranks_.size();
+		receiver_ranks_.push_back(rank);
+	}
+	pending_tokens_.resize(receiver_ranks_.size(), 0);
+	spare_pending_tokens_.resize(receiver_ranks_.size(), 0);
+	for (auto rank : receiver_ranks_)
+	{
+		receiver_status_.push_back(ReceiverStatus{ rank, 0, 0, 0 });
+	}
 }
 
 void artdaq::RoutingMasterPolicy::AddReceiverToken(int rank, unsigned new_slots_free)
 {
-	if (!receiver_ranks_.count(rank)) return;
+	auto index = receiver_index_.find(rank);
+	if (index == receiver_index_.end()) return;
 	TLOG(10) << "AddReceiverToken BEGIN" ;
 	std::unique_lock<std::mutex> lk(tokens_mutex_);
 	if (new_slots_free == 1) 
 	{
-		tokens_.push_back(rank);
+		tokens_->push_back(rank);
 	}
 	else 
 	{
-		// Randomly distribute multitokens through the token list
-		// Only used at start run time, so we can take the performance hit
-		for (unsigned i = 0; i < new_slots_free; ++i)
-		{
-			auto it = tokens_.begin();
-			if(tokens_.size()) std::advance(it, rand() % tokens_.size());
-			tokens_.insert(it, rank);
-		}
+		// Multitokens are counted per-receiver, and will be interleaved through the token list by getTokensSnapshot
+		pending_tokens_[index->second] += new_slots_free;
+		pending_token_count_ += new_slots_free;
 	}
-	if (tokens_.size() > max_token_count_) max_token_count_ = tokens_.size();
+	if (tokens_->size() + pending_token_count_ > max_token_count_) max_token_count_ = tokens_->size() + pending_token_count_;
 	TLOG(10) << "AddReceiverToken END" ;
 }
 
+void artdaq::RoutingMasterPolicy::UpdateReceiverStatus(detail::RoutingToken const& token)
+{
+	auto index = receiver_index_.find(token.rank);
+	if (index == receiver_index_.end() || token.buffer_count == 0) return;
+	std::unique_lock<std::mutex> lk(status_mutex_);
+	auto& status = receiver_status_[index->second];
+	status.buffers_occupied = token.buffers_occupied;
+	status.buffer_count = token.buffer_count;
+	status.art_latency_us = token.art_latency_us;
+}
+
+std::vector<artdaq::RoutingMasterPolicy::ReceiverStatus> artdaq::RoutingMasterPolicy::getReceiverStatus() const
+{
+	std::unique_lock<std::mutex> lk(status_mutex_);
+	return receiver_status_;
+}
+
 std::unique_ptr<std::deque<int>> artdaq::RoutingMasterPolicy::getTokensSnapshot()
 {
 	TLOG(10) << "getTokensSnapshot BEGIN" ;
-	std::unique_lock<std::mutex> lk(tokens_mutex_);
-	auto out = std::make_unique<std::deque<int>>(tokens_);
-	tokens_.clear();
+	auto out = std::make_unique<std::deque<int>>();
+	bool have_pending = false;
+	{
+		std::unique_lock<std::mutex> lk(tokens_mutex_);
+		out.swap(tokens_);
+		if (pending_token_count_ > 0)
+		{
+			pending_tokens_.swap(spare_pending_tokens_);
+			pending_token_count_ = 0;
+			have_pending = true;
+		}
+	}
+
+	// spare_pending_tokens_ is only touched here and under the lock above, and getTokensSnapshot is only called from the table thread
+	if (have_pending) drainPendingTokens_(spare_pending_tokens_, *out);
 	TLOG(10) << "getTokensSnapshot END" ;
 	return out;
 }
@@ -49,9 +91,29 @@ std::unique_ptr<std::deque<int>> artdaq::RoutingMasterPolicy::getTokensSnapshot(
 void artdaq::RoutingMasterPolicy::addUnusedTokens(std::unique_ptr<std::deque<int>> tokens)
 {
 	std::unique_lock<std::mutex> lk(tokens_mutex_);
-	for (auto token = tokens.get()->rbegin(); token != tokens.get()->rend(); ++token)
+	if (tokens_->empty())
 	{
-		tokens_.push_front(*token);
+		tokens_.swap(tokens);
+	}
+	else
+	{
+		tokens_->insert(tokens_->begin(), tokens->begin(), tokens->end());
+	}
+	if (tokens_->size() + pending_token_count_ > max_token_count_) max_token_count_ = tokens_->size() + pending_token_count_;
+}
+
+void artdaq::RoutingMasterPolicy::drainPendingTokens_(std::vector<unsigned>& pending, std::deque<int>& tokens) const
+{
+	// Interleave the multitokens (r1, r2, r3, r1, r2, ...) so that no single receiver is given a long run of events
+	bool remaining = true;
+	while (remaining)
+	{
+		remaining = false;
+		for (size_t ii = 0; ii < pending.size(); ++ii)
+		{
+			if (pending[ii] == 0) continue;
+			tokens.push_back(receiver_ranks_[ii]);
+			if (--pending[ii] > 0) remaining = true;
+		}
 	}
-	if (tokens_.size() > max_token_count_) max_token_count_ = tokens_.size();
 }
@@ -8,7 +8,9 @@
 #include "fhiclcpp/fwd.h"
 #include <mutex>
 #include <deque>
-#include <unordered_set>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace artdaq
 {
@@ -18,6 +20,17 @@ namespace artdaq
 	class RoutingMasterPolicy
 	{
 	public:
+		/**
+		 * \brief The most recent occupancy and latency information reported by a receiver in its RoutingTokens
+		 */
+		struct ReceiverStatus
+		{
+			int rank; ///< Rank of the receiver
+			unsigned buffers_occupied; ///< Number of buffers in use in the receiver
+			unsigned buffer_count; ///< Total number of buffers in the receiver (0 if no status has been received)
+			uint32_t art_latency_us; ///< Recent average art processing latency in the receiver, in microseconds (0 if unknown)
+		};
+
 		/**
 		 * \brief RoutingMasterPolicy Constructor
 		 * \param ps ParameterSet used to configure the RoutingMasterPolicy
@@ -57,9 +70,19 @@ namespace artdaq
 		 * \brief Add a token to the token list
 		 * \param rank Rank that the token is from
 		 * \param new_slots_free Number of slots that are now free (should usually be 1)
+		 *
+		 * Single tokens are appended to the token list in arrival order. Multi-slot tokens (usually only seen at
+		 * start of run) are added to a per-receiver counter, and are interleaved into the token list when the next
+		 * snapshot is taken. Either way, this function is O(1).
 		 */
 		void AddReceiverToken(int rank, unsigned new_slots_free);
 
+		/**
+		 * \brief Record the occupancy and latency information carried by a RoutingToken
+		 * \param token RoutingToken received from a receiver
+		 */
+		void UpdateReceiverStatus(detail::RoutingToken const& token);
+
 		/**
 		 * \brief Reset the policy, setting the next sequence ID to be used to 1
 		 */
@@ -67,14 +90,24 @@ namespace artdaq
 	protected:
 		Fragment::sequence_id_t next_sequence_id_; ///< The next sequence ID to be assigned
 
-		std::unique_ptr<std::deque<int>> getTokensSnapshot(); ///< Gets the current token list, used for building Routing Tables
+		std::unique_ptr<std::deque<int>> getTokensSnapshot(); ///< Gets the current token list, used for building Routing Tables. The list is swapped out, not copied.
 		void addUnusedTokens(std::unique_ptr<std::deque<int>> tokens); ///< If necessary, return unused tokens to the token list, for subsequent updates
+		std::vector<ReceiverStatus> getReceiverStatus() const; ///< Gets the latest status reported by each receiver, in receiver_ranks order
 	private:
+		void drainPendingTokens_(std::vector<unsigned>& pending, std::deque<int>& tokens) const;
+
 		mutable std::mutex tokens_mutex_;
-		std::unordered_set<int> receiver_ranks_;
-		std::deque<int> tokens_;
+		std::vector<int> receiver_ranks_;
+		std::unordered_map<int, size_t> receiver_index_;
+		std::unique_ptr<std::deque<int>> tokens_;
+		std::vector<unsigned> pending_tokens_; // Per-receiver count of multi-slot tokens not yet in tokens_, indexed by receiver_index_
+		std::vector<unsigned> spare_pending_tokens_; // Swapped with pending_tokens_ by getTokensSnapshot, so the lock is never held for a copy
+		size_t pending_token_count_;
 		size_t max_token_count_;
 
+		mutable std::mutex status_mutex_;
+		std::vector<ReceiverStatus> receiver_status_;
+
 	};
 }
 
@@ -1,6 +1,8 @@
 #include <sys/un.h>
 #include <sys/time.h>
 #include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <pthread.h>
@@ -30,9 +32,19 @@ artdaq::RoutingMasterCore::RoutingMasterCore()
 	, shutdown_requested_(false)
 	, stop_requested_(false)
 	, pause_requested_(false)
+	, table_updates_enabled_(false)
+	, tokens_since_last_table_(0)
+	, outstanding_table_()
+	, outstanding_acks_()
+	, outstanding_ack_count_(0)
+	, ack_resend_count_(0)
+	, epoll_fd_(-1)
 	, token_socket_(-1)
 	, table_socket_(-1)
 	, ack_socket_(-1)
+	, table_timer_fd_(-1)
+	, ack_timer_fd_(-1)
+	, wakeup_fd_(-1)
 {
 	TLOG(TLVL_DEBUG) << "Constructor" ;
 	statsHelper_.addMonitoredQuantityName(TABLE_UPDATES_STAT_KEY);
@@ -42,7 +54,8 @@ artdaq::RoutingMasterCore::RoutingMasterCore()
 artdaq::RoutingMasterCore::~RoutingMasterCore()
 {
 	TLOG(TLVL_DEBUG) << "Destructor" ;
-	if (ev_token_receive_thread_.joinable()) ev_token_receive_thread_.join();
+	stop_reactor_thread_();
+	if (wakeup_fd_ != -1) close(wakeup_fd_);
 }
 
 bool artdaq::RoutingMasterCore::initialize(fhicl::ParameterSet const& pset, uint64_t, uint64_t)
@@ -89,6 +102,9 @@ bool artdaq::RoutingMasterCore::initialize(fhicl::ParameterSet const& pset, uint
 		return false;
 	}
 
+	// The reactor thread uses the policy, make sure it is not running while the policy is replaced
+	stop_reactor_thread_();
+
 	// pull out the Metric part of the ParameterSet
 	fhicl::ParameterSet metric_pset;
 	try
@@ -142,14 +158,17 @@ bool artdaq::RoutingMasterCore::initialize(fhicl::ParameterSet const& pset, uint
 	sender_ranks_ = daq_pset.get<std::vector<int>>("sender_ranks");
 	num_receivers_ = policy_->GetReceiverCount();
 
-	receive_ack_events_ = std::vector<epoll_event>(sender_ranks_.size());
-	receive_token_events_ = std::vector<epoll_event>(num_receivers_ + 1);
+	// Listen socket, ack socket, two timers and the wakeup eventfd, plus one connection per receiver
+	epoll_events_ = std::vector<epoll_event>(num_receivers_ + 5);
 
 	auto mode = daq_pset.get<bool>("senders_send_by_send_count", false);
 	routing_mode_ = mode ? detail::RoutingMasterMode::RouteBySendCount : detail::RoutingMasterMode::RouteBySequenceID;
 	max_table_update_interval_ms_ = daq_pset.get<size_t>("table_update_interval_ms", 1000);
-	current_table_interval_ms_ = max_table_update_interval_ms_;
+	if (max_table_update_interval_ms_ < 1) max_table_update_interval_ms_ = 1;
+	table_update_token_count_ = daq_pset.get<size_t>("table_update_token_count", num_receivers_);
+	if (table_update_token_count_ < 1) table_update_token_count_ = 1;
 	max_ack_cycle_count_ = daq_pset.get<size_t>("table_ack_retry_count", 5);
+	if (max_ack_cycle_count_ < 1) max_ack_cycle_count_ = 1;
 	receive_token_port_ = daq_pset.get<int>("routing_token_port", 35555);
 	send_tables_port_ = daq_pset.get<int>("table_update_port", 35556);
 	receive_acks_port_ = daq_pset.get<int>("table_acknowledge_port", 35557);
@@ -159,15 +178,17 @@ bool artdaq::RoutingMasterCore::initialize(fhicl::ParameterSet const& pset, uint
 	// fetch the monitoring parameters and create the MonitoredQuantity instances
 	statsHelper_.createCollectors(daq_pset, 100, 30.0, 60.0, TABLE_UPDATES_STAT_KEY);
 
-	shutdown_requested_.store(false);
-	start_recieve_token_thread_();
+	start_reactor_thread_();
 	return true;
 }
 
 bool artdaq::RoutingMasterCore::start(art::RunID id, uint64_t, uint64_t)
 {
-	stop_requested_.store(false);
-	pause_requested_.store(false);
+	{
+		std::unique_lock<std::mutex> lk(run_mutex_);
+		stop_requested_.store(false);
+		pause_requested_.store(false);
+	}
 
 	statsHelper_.resetStatistics();
 	policy_->Reset();
@@ -186,7 +207,12 @@ bool artdaq::RoutingMasterCore::stop(uint64_t, uint64_t)
 	TLOG(TLVL_INFO) << "Stopping run " << run_id_.run()
 		<< " after " << table_update_count_ << " table updates."
 		<< " and " << received_token_count_ << " received tokens." ;
-	stop_requested_.store(true);
+	{
+		std::unique_lock<std::mutex> lk(run_mutex_);
+		stop_requested_.store(true);
+	}
+	run_cv_.notify_all();
+	wake_reactor_();
 	return true;
 }
 
@@ -195,7 +221,12 @@ bool artdaq::RoutingMasterCore::pause(uint64_t, uint64_t)
 	TLOG(TLVL_INFO) << "Pausing run " << run_id_.run()
 		<< " after " << table_update_count_ << " table updates."
 		<< " and " << received_token_count_ << " received tokens." ;
-	pause_requested_.store(true);
+	{
+		std::unique_lock<std::mutex> lk(run_mutex_);
+		pause_requested_.store(true);
+	}
+	run_cv_.notify_all();
+	wake_reactor_();
 	return true;
 }
 
@@ -203,15 +234,22 @@ bool artdaq::RoutingMasterCore::resume(uint64_t, uint64_t)
 {
 	TLOG(TLVL_INFO) << "Resuming run " << run_id_.run() ;
 	policy_->Reset();
-	pause_requested_.store(false);
+	{
+		std::unique_lock<std::mutex> lk(run_mutex_);
+		pause_requested_.store(false);
+	}
 	metricMan->do_start();
 	return true;
 }
 
 bool artdaq::RoutingMasterCore::shutdown(uint64_t)
 {
-    shutdown_requested_.store(true);
-	if (ev_token_receive_thread_.joinable()) ev_token_receive_thread_.join();
+	{
+		std::unique_lock<std::mutex> lk(run_mutex_);
+		shutdown_requested_.store(true);
+	}
+	run_cv_.notify_all();
+	stop_reactor_thread_();
 	policy_.reset(nullptr);
 	metricMan->shutdown();
 	return true;
@@ -235,430 +273,560 @@ bool artdaq::RoutingMasterCore::reinitialize(fhicl::ParameterSet const& pset, ui
 
 void artdaq::RoutingMasterCore::process_event_table()
 {
-	if (rt_priority_ > 0)
+	TLOG(TLVL_DEBUG) << "Enabling table updates, initial table will be sent when tokens are available." ;
+	table_updates_enabled_.store(true);
+	wake_reactor_();
+
 	{
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
-		sched_param s_param = {};
-		s_param.sched_priority = rt_priority_;
-		if (pthread_setschedparam(pthread_self(), SCHED_RR, &s_param))
-			TLOG(TLVL_WARNING) << "setting realtime priority failed" ;
-#pragma GCC diagnostic pop
+		std::unique_lock<std::mutex> lk(run_mutex_);
+		run_cv_.wait(lk, [this] { return stop_requested_ || pause_requested_ || shutdown_requested_; });
 	}
 
-	// try-catch block here?
+	table_updates_enabled_.store(false);
+	wake_reactor_();
+	TLOG(TLVL_DEBUG) << "Table updates disabled after " << table_update_count_ << " table updates." ;
 
-	// how to turn RT PRI off?
-	if (rt_priority_ > 0)
+	metricMan->do_stop();
+}
+
+void artdaq::RoutingMasterCore::send_event_table(detail::RoutingPacket packet)
+{
+	outstanding_table_ = std::move(packet);
+	outstanding_acks_.clear();
+	for (auto& r : sender_ranks_)
 	{
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
-		sched_param s_param = {};
-		s_param.sched_priority = rt_priority_;
-		int status = pthread_setschedparam(pthread_self(), SCHED_RR, &s_param);
-		if (status != 0)
-		{
-			TLOG(TLVL_ERROR)
-				<< "Failed to set realtime priority to " << rt_priority_
-				<< ", return code = " << status ;
-		}
-#pragma GCC diagnostic pop
+		outstanding_acks_[r] = false;
 	}
+	outstanding_ack_count_ = outstanding_acks_.size();
+	ack_resend_count_ = 0;
+	table_send_time_ = std::chrono::steady_clock::now();
 
-	//MPI_Barrier(local_group_comm_);
+	send_table_datagrams_();
 
-	TLOG(TLVL_DEBUG) << "Sending initial table." ;
-	auto startTime = artdaq::MonitoredQuantity::getCurrentTime();
-	auto nextSendTime = startTime;
-	double delta_time;
-	while (!stop_requested_ && !pause_requested_)
+	if (outstanding_ack_count_ == 0)
 	{
-		startTime = artdaq::MonitoredQuantity::getCurrentTime();
+		complete_table_();
+		return;
+	}
+	arm_timer_(ack_timer_fd_, max_table_update_interval_ms_ / max_ack_cycle_count_, false);
+}
 
-		if (startTime >= nextSendTime)
-		{
-			auto table = policy_->GetCurrentTable();
-			if (table.size() > 0)
-			{
-				send_event_table(table);
-				++table_update_count_;
-				delta_time = artdaq::MonitoredQuantity::getCurrentTime() - startTime;
-				statsHelper_.addSample(TABLE_UPDATES_STAT_KEY, delta_time);
-				TLOG(16) << "process_fragments TABLE_UPDATES_STAT_KEY=" << delta_time ;
-			}
-			else
-			{
-			  TLOG(TLVL_DEBUG) << "No tokens received in this update interval (" << current_table_interval_ms_ << " ms)! This most likely means that the receivers are not keeping up!" ;
-			}
-			auto max_tokens = policy_->GetMaxNumberOfTokens();
-			if (max_tokens > 0)
-			{
-				auto frac = table.size() / static_cast<double>(max_tokens);
-				if (frac > 0.75) current_table_interval_ms_ = 9 * current_table_interval_ms_ / 10;
-				if (frac < 0.5) current_table_interval_ms_ = 11 * current_table_interval_ms_ / 10;
-				if (current_table_interval_ms_ > max_table_update_interval_ms_) current_table_interval_ms_ = max_table_update_interval_ms_;
-				if (current_table_interval_ms_ < 1) current_table_interval_ms_ = 1;
-			}
-			nextSendTime = startTime + current_table_interval_ms_ / 1000.0;
-			TLOG(TLVL_DEBUG) << "current_table_interval_ms is now " << current_table_interval_ms_ ;
-		}
-		else
-		{
-			usleep(current_table_interval_ms_ * 10); // 1/100 of the table update interval
-		}
+void artdaq::RoutingMasterCore::send_table_datagrams_()
+{
+	auto header = detail::RoutingPacketHeader(routing_mode_, outstanding_table_.size());
+	auto packetSize = sizeof(detail::RoutingPacketEntry) * outstanding_table_.size();
+
+	TLOG(TLVL_DEBUG) << "Sending table information for " << header.nEntries << " events to multicast group " << send_tables_address_ << ", port " << send_tables_port_ ;
+	TRACE(16,"headerData:0x%016lx%016lx packetData:0x%016lx%016lx"
+	      ,((unsigned long*)&header)[0],((unsigned long*)&header)[1], ((unsigned long*)&outstanding_table_[0])[0],((unsigned long*)&outstanding_table_[0])[1] );
+	auto hdrsts = sendto(table_socket_, &header, sizeof(detail::RoutingPacketHeader), 0, reinterpret_cast<struct sockaddr *>(&send_tables_addr_), sizeof(send_tables_addr_));
+	if (hdrsts != sizeof(detail::RoutingPacketHeader))
+	{
+		TLOG(TLVL_ERROR) << "Error sending routing message header. hdrsts=" << hdrsts;
+	}
+	auto pktsts = sendto(table_socket_, &outstanding_table_[0], packetSize, 0, reinterpret_cast<struct sockaddr *>(&send_tables_addr_), sizeof(send_tables_addr_));
+	if (pktsts != (ssize_t)packetSize)
+	{
+		TLOG(TLVL_ERROR) << "Error sending routing message data. hdrsts="<<hdrsts<<" pktsts="<<pktsts;
 	}
 
-	metricMan->do_stop();
+	TLOG(TLVL_DEBUG) << "Sent " << hdrsts <<"+"<< pktsts << ". Expecting acks to have first= " << outstanding_table_[0].sequence_id
+		<< ", and last= " << outstanding_table_.rbegin()->sequence_id ;
 }
 
-void artdaq::RoutingMasterCore::send_event_table(detail::RoutingPacket packet)
+void artdaq::RoutingMasterCore::complete_table_()
 {
-	// Reconnect table socket, if necessary
-	if (table_socket_ == -1)
+	arm_timer_(ack_timer_fd_, 0, false);
+
+	artdaq::TimeUtils::seconds delta = std::chrono::steady_clock::now() - table_send_time_;
+	statsHelper_.addSample(TABLE_UPDATES_STAT_KEY, delta.count());
+	TLOG(16) << "complete_table_ TABLE_UPDATES_STAT_KEY=" << delta.count() ;
+	if (metricMan)
 	{
-		table_socket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-		if (table_socket_ < 0)
-		{
-			TLOG(TLVL_ERROR) << "I failed to create the socket for sending Data Requests! Errno: " << errno ;
-			exit(1);
-		}
-		auto sts = ResolveHost(send_tables_address_.c_str(), send_tables_port_, send_tables_addr_);
-		if (sts == -1)
+		metricMan->sendMetric("Avg Table Acknowledge Time", delta.count(), "seconds", 3, MetricMode::Average);
+	}
+
+	outstanding_table_.clear();
+	outstanding_acks_.clear();
+	outstanding_ack_count_ = 0;
+}
+
+void artdaq::RoutingMasterCore::try_send_table_(bool timer_expired)
+{
+	if (!table_updates_enabled_ || stop_requested_ || pause_requested_)
+	{
+		if (outstanding_table_.size() > 0)
 		{
-			TLOG(TLVL_ERROR) << "Unable to resolve table_update_address" ;
-			exit(1);
+			TLOG(TLVL_DEBUG) << "Table updates disabled, no longer waiting for acks for outstanding table" ;
+			arm_timer_(ack_timer_fd_, 0, false);
+			outstanding_table_.clear();
+			outstanding_acks_.clear();
+			outstanding_ack_count_ = 0;
 		}
+		return;
+	}
+	if (outstanding_table_.size() > 0) return;
+	if (!timer_expired && tokens_since_last_table_ < table_update_token_count_) return;
 
-		auto yes = 1;
-		if (receive_address_ != "localhost")
-		{
-			TLOG(TLVL_DEBUG) << "Making sure that multicast sending uses the correct interface for hostname " << receive_address_ ;
-			struct in_addr addr;
-			sts = ResolveHost(receive_address_.c_str(), addr);
-			if (sts == -1)
-			{
-				throw art::Exception(art::errors::Configuration) << "RoutingMasterCore: Unable to resolve routing_master_address" << std::endl;;
-			}
+	TLOG(17) << "try_send_table_: " << tokens_since_last_table_ << " tokens since last table, timer_expired=" << std::boolalpha << timer_expired ;
+	tokens_since_last_table_ = 0;
+	auto table = policy_->GetCurrentTable();
+	if (table.size() > 0)
+	{
+		send_event_table(table);
+		++table_update_count_;
+	}
+	else if (timer_expired)
+	{
+		TLOG(TLVL_DEBUG) << "No tokens received in this update interval (" << max_table_update_interval_ms_ << " ms)! This most likely means that the receivers are not keeping up!" ;
+	}
 
-			if (setsockopt(table_socket_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0)
-			{
-				throw art::Exception(art::errors::Configuration) <<
-					"RoutingMasterCore: Unable to enable port reuse on table update socket" << std::endl;
-				exit(1);
-			}
+	// Restart the interval so that the timer only fires when tokens have not triggered an update
+	arm_timer_(table_timer_fd_, max_table_update_interval_ms_, true);
+}
 
-			if (setsockopt(table_socket_, IPPROTO_IP, IP_MULTICAST_LOOP, &yes, sizeof(yes)) < 0)
-			{
-				TLOG(TLVL_ERROR) << "Unable to enable multicast loopback on table socket" ;
-				exit(1);
-			}
-			if (setsockopt(table_socket_, IPPROTO_IP, IP_MULTICAST_IF, &addr, sizeof(addr)) == -1)
-			{
-				TLOG(TLVL_ERROR) << "Cannot set outgoing interface. Errno: " << errno ;
-				exit(1);
-			}
-		}
-		if (setsockopt(table_socket_, SOL_SOCKET, SO_BROADCAST, (void*)&yes, sizeof(int)) == -1)
+void artdaq::RoutingMasterCore::arm_timer_(int fd, size_t interval_ms, bool periodic)
+{
+	struct itimerspec spec;
+	memset(&spec, 0, sizeof(spec));
+	spec.it_value.tv_sec = interval_ms / 1000;
+	spec.it_value.tv_nsec = (interval_ms % 1000) * 1000000;
+	if (interval_ms > 0 && spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) spec.it_value.tv_nsec = 1;
+	if (periodic) spec.it_interval = spec.it_value;
+	if (timerfd_settime(fd, 0, &spec, nullptr) == -1)
+	{
+		TLOG(TLVL_ERROR) << "Unable to set timer on fd " << fd << ", errno=" << errno ;
+	}
+}
+
+void artdaq::RoutingMasterCore::wake_reactor_()
+{
+	if (wakeup_fd_ == -1) return;
+	uint64_t one = 1;
+	if (write(wakeup_fd_, &one, sizeof(one)) != sizeof(one))
+	{
+		TLOG(TLVL_WARNING) << "Unable to wake the RoutingMasterCore reactor thread, errno=" << errno ;
+	}
+}
+
+void artdaq::RoutingMasterCore::setup_sockets_()
+{
+	epoll_fd_ = epoll_create1(0);
+	if (epoll_fd_ == -1)
+	{
+		TLOG(TLVL_ERROR) << "Could not create epoll fd, errno=" << errno ;
+		exit(3);
+	}
+	auto register_fd = [this](int fd, uint32_t events, std::string const& name)
+	{
+		struct epoll_event ev;
+		ev.events = events;
+		ev.data.fd = fd;
+		if (fd == -1 || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1)
 		{
-			TLOG(TLVL_ERROR) << "Cannot set request socket to broadcast. Errno: " << errno ;
-			exit(1);
+			TLOG(TLVL_ERROR) << "Could not register " << name << " to epoll fd, errno=" << errno ;
+			exit(3);
 		}
+	};
+
+	TLOG(TLVL_DEBUG) << "Opening token listener socket" ;
+	token_socket_ = TCP_listen_fd(receive_token_port_, 3 * sizeof(detail::RoutingToken));
+	fcntl(token_socket_, F_SETFL, O_NONBLOCK); // set O_NONBLOCK
+	register_fd(token_socket_, EPOLLIN | EPOLLPRI, "listen socket");
+
+	table_socket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (table_socket_ < 0)
+	{
+		TLOG(TLVL_ERROR) << "I failed to create the socket for sending Data Requests! Errno: " << errno ;
+		exit(1);
+	}
+	auto sts = ResolveHost(send_tables_address_.c_str(), send_tables_port_, send_tables_addr_);
+	if (sts == -1)
+	{
+		TLOG(TLVL_ERROR) << "Unable to resolve table_update_address" ;
+		exit(1);
 	}
 
-	// Reconnect ack socket, if necessary
-	if (ack_socket_ == -1)
+	auto yes = 1;
+	if (receive_address_ != "localhost")
 	{
-		ack_socket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-		if (ack_socket_ < 0)
+		TLOG(TLVL_DEBUG) << "Making sure that multicast sending uses the correct interface for hostname " << receive_address_ ;
+		struct in_addr addr;
+		sts = ResolveHost(receive_address_.c_str(), addr);
+		if (sts == -1)
 		{
-			throw art::Exception(art::errors::Configuration) << "RoutingMasterCore: Error creating socket for receiving table update acks!" << std::endl;
-			exit(1);
+			throw art::Exception(art::errors::Configuration) << "RoutingMasterCore: Unable to resolve routing_master_address" << std::endl;;
 		}
 
-		struct sockaddr_in si_me_request;
-
-		auto yes = 1;
-		if (setsockopt(ack_socket_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0)
+		if (setsockopt(table_socket_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0)
 		{
 			throw art::Exception(art::errors::Configuration) <<
-				"RoutingMasterCore: Unable to enable port reuse on ack socket" << std::endl;
+				"RoutingMasterCore: Unable to enable port reuse on table update socket" << std::endl;
 			exit(1);
 		}
-		memset(&si_me_request, 0, sizeof(si_me_request));
-		si_me_request.sin_family = AF_INET;
-		si_me_request.sin_port = htons(receive_acks_port_);
-		si_me_request.sin_addr.s_addr = htonl(INADDR_ANY);
-		if (bind(ack_socket_, reinterpret_cast<struct sockaddr *>(&si_me_request), sizeof(si_me_request)) == -1)
+
+		if (setsockopt(table_socket_, IPPROTO_IP, IP_MULTICAST_LOOP, &yes, sizeof(yes)) < 0)
 		{
-			throw art::Exception(art::errors::Configuration) <<
-				"RoutingMasterCore: Cannot bind request socket to port " << receive_acks_port_ << std::endl;
+			TLOG(TLVL_ERROR) << "Unable to enable multicast loopback on table socket" ;
+			exit(1);
+		}
+		if (setsockopt(table_socket_, IPPROTO_IP, IP_MULTICAST_IF, &addr, sizeof(addr)) == -1)
+		{
+			TLOG(TLVL_ERROR) << "Cannot set outgoing interface. Errno: " << errno ;
 			exit(1);
 		}
-		TLOG(TLVL_DEBUG) << "Listening for acks on 0.0.0.0 port " << receive_acks_port_ ;
+	}
+	if (setsockopt(table_socket_, SOL_SOCKET, SO_BROADCAST, (void*)&yes, sizeof(int)) == -1)
+	{
+		TLOG(TLVL_ERROR) << "Cannot set request socket to broadcast. Errno: " << errno ;
+		exit(1);
 	}
 
-	auto acks = std::unordered_map<int, bool>();
-	for (auto& r : sender_ranks_)
+	ack_socket_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+	if (ack_socket_ < 0)
+	{
+		throw art::Exception(art::errors::Configuration) << "RoutingMasterCore: Error creating socket for receiving table update acks!" << std::endl;
+		exit(1);
+	}
+
+	struct sockaddr_in si_me_request;
+	if (setsockopt(ack_socket_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0)
 	{
-		acks[r] = false;
+		throw art::Exception(art::errors::Configuration) <<
+			"RoutingMasterCore: Unable to enable port reuse on ack socket" << std::endl;
+		exit(1);
 	}
-	auto counter = 0U;
-	auto start_time = std::chrono::steady_clock::now();
-	while (std::count_if(acks.begin(), acks.end(), [](std::pair<int, bool> p) {return !p.second; }) > 0 && !stop_requested_)
+	memset(&si_me_request, 0, sizeof(si_me_request));
+	si_me_request.sin_family = AF_INET;
+	si_me_request.sin_port = htons(receive_acks_port_);
+	si_me_request.sin_addr.s_addr = htonl(INADDR_ANY);
+	if (bind(ack_socket_, reinterpret_cast<struct sockaddr *>(&si_me_request), sizeof(si_me_request)) == -1)
 	{
-		// Send table update
-		auto header = detail::RoutingPacketHeader(routing_mode_, packet.size());
-		auto packetSize = sizeof(detail::RoutingPacketEntry) * packet.size();
+		throw art::Exception(art::errors::Configuration) <<
+			"RoutingMasterCore: Cannot bind request socket to port " << receive_acks_port_ << std::endl;
+		exit(1);
+	}
+	TLOG(TLVL_DEBUG) << "Listening for acks on 0.0.0.0 port " << receive_acks_port_ ;
+	register_fd(ack_socket_, EPOLLIN, "ack socket");
+
+	table_timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+	register_fd(table_timer_fd_, EPOLLIN, "table update timer");
+	ack_timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+	register_fd(ack_timer_fd_, EPOLLIN, "table ack timer");
+	register_fd(wakeup_fd_, EPOLLIN, "wakeup eventfd");
+}
 
-		TLOG(TLVL_DEBUG) << "Sending table information for " << header.nEntries << " events to multicast group " << send_tables_address_ << ", port " << send_tables_port_ ;
-		TRACE(16,"headerData:0x%016lx%016lx packetData:0x%016lx%016lx"
-		      ,((unsigned long*)&header)[0],((unsigned long*)&header)[1], ((unsigned long*)&packet[0])[0],((unsigned long*)&packet[0])[1] );
-		auto hdrsts = sendto(table_socket_, &header, sizeof(detail::RoutingPacketHeader), 0, reinterpret_cast<struct sockaddr *>(&send_tables_addr_), sizeof(send_tables_addr_));
-		if (hdrsts != sizeof(detail::RoutingPacketHeader))
-		{
-			TLOG(TLVL_ERROR) << "Error sending routing message header. hdrsts=" << hdrsts;
-		}
-		auto pktsts = sendto(table_socket_, &packet[0], packetSize, 0, reinterpret_cast<struct sockaddr *>(&send_tables_addr_), sizeof(send_tables_addr_));
-		if (pktsts != (ssize_t)packetSize)
+void artdaq::RoutingMasterCore::close_sockets_()
+{
+	for (auto& conn : receive_token_addrs_)
+	{
+		close(conn.first);
+	}
+	receive_token_addrs_.clear();
+	receive_token_partials_.clear();
+	for (auto fd : { &token_socket_, &table_socket_, &ack_socket_, &table_timer_fd_, &ack_timer_fd_, &epoll_fd_ })
+	{
+		if (*fd != -1) close(*fd);
+		*fd = -1;
+	}
+	outstanding_table_.clear();
+	outstanding_acks_.clear();
+	outstanding_ack_count_ = 0;
+}
+
+void artdaq::RoutingMasterCore::run_reactor_()
+{
+	if (rt_priority_ > 0)
+	{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+		sched_param s_param = {};
+		s_param.sched_priority = rt_priority_;
+		int status = pthread_setschedparam(pthread_self(), SCHED_RR, &s_param);
+		if (status != 0)
 		{
-			TLOG(TLVL_ERROR) << "Error sending routing message data. hdrsts="<<hdrsts<<" pktsts="<<pktsts;
+			TLOG(TLVL_ERROR)
+				<< "Failed to set realtime priority to " << rt_priority_
+				<< ", return code = " << status ;
 		}
+#pragma GCC diagnostic pop
+	}
 
-		// Collect acks
-
-		auto first = packet[0].sequence_id;
-		auto last = packet.rbegin()->sequence_id;
-		TLOG(TLVL_DEBUG) << "Sent " << hdrsts <<"+"<< pktsts << ". Expecting acks to have first= " << first << ", and last= " << last ;
+	setup_sockets_();
+	tokens_since_last_table_ = 0;
+	arm_timer_(table_timer_fd_, max_table_update_interval_ms_, true);
 
+	while (!shutdown_requested_)
+	{
+		auto nfds = epoll_wait(epoll_fd_, &epoll_events_[0], epoll_events_.size(), -1);
+		if (nfds == -1)
+		{
+			if (errno == EINTR) continue;
+			perror("epoll_wait");
+			exit(EXIT_FAILURE);
+		}
 
-		auto startTime = std::chrono::steady_clock::now();
-		while (std::count_if(acks.begin(), acks.end(), [](std::pair<int, bool> p) {return !p.second; }) > 0)
+		TLOG(20) << "Reactor received " << nfds << " events" ;
+		auto timer_expired = false;
+		for (auto n = 0; n < nfds; ++n)
 		{
-			auto table_ack_wait_time_ms = current_table_interval_ms_ / max_ack_cycle_count_;
-			if (TimeUtils::GetElapsedTimeMilliseconds(startTime) > table_ack_wait_time_ms)
+			auto fd = epoll_events_[n].data.fd;
+			uint64_t expirations;
+			if (fd == token_socket_)
 			{
-				if (counter > max_ack_cycle_count_ && table_update_count_ > 0)
-				{
-					TLOG(TLVL_ERROR) << "Did not receive acks from all senders after resending table " << counter
-						<< " times during the table_update_interval. Check the status of the senders!" ;
-					break;
-				}
-				TLOG(TLVL_WARNING) << "Did not receive acks from all senders within the timeout (" << table_ack_wait_time_ms << " ms). Resending table update" ;
-				break;
+				accept_token_connection_();
 			}
-
-			TLOG(20) << "send_event_table: Polling Request socket for new requests" ;
-			auto ready = true;
-			while (ready)
+			else if (fd == ack_socket_)
+			{
+				receive_acks_();
+			}
+			else if (fd == table_timer_fd_)
 			{
-				detail::RoutingAckPacket buffer;
-				if (recvfrom(ack_socket_, &buffer, sizeof(detail::RoutingAckPacket), MSG_DONTWAIT, NULL, NULL) < 0)
+				if (read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) timer_expired = true;
+			}
+			else if (fd == ack_timer_fd_)
+			{
+				if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations) || outstanding_ack_count_ == 0) continue;
+
+				auto table_ack_wait_time_ms = max_table_update_interval_ms_ / max_ack_cycle_count_;
+				if (++ack_resend_count_ > max_ack_cycle_count_ && table_update_count_ > 1)
 				{
-					if (errno == EWOULDBLOCK || errno == EAGAIN)
-					{
-						TLOG(20) << "send_event_table: No more ack datagrams on ack socket." ;
-						ready = false;
-					}
-					else
-					{
-						TLOG(TLVL_ERROR) << "An unexpected error occurred during ack packet receive" ;
-						exit(2);
-					}
+					TLOG(TLVL_ERROR) << "Did not receive acks from all senders after resending table " << ack_resend_count_
+						<< " times during the table_update_interval. Check the status of the senders!" ;
 				}
 				else
 				{
-					TLOG(TLVL_DEBUG) << "Ack packet from rank " << buffer.rank << " has first= " << buffer.first_sequence_id
-						<< " and last= " << buffer.last_sequence_id ;
-					if (acks.count(buffer.rank) && buffer.first_sequence_id == first && buffer.last_sequence_id == last)
-					{
-						TLOG(TLVL_DEBUG) << "Received table update acknowledgement from sender with rank " << buffer.rank << "." ;
-						acks[buffer.rank] = true;
-						TLOG(TLVL_DEBUG) << "There are now " << std::count_if(acks.begin(), acks.end(), [](std::pair<int, bool> p) {return !p.second; })
-							<< " acks outstanding" ;
-					}
-					else
-					{
-						if (!acks.count(buffer.rank))
-						{
-							TLOG(TLVL_ERROR) << "Received acknowledgement from invalid rank " << buffer.rank << "!"
-								<< " Cross-talk between RoutingMasters means there's a configuration error!" ;
-						}
-						else
-						{
-							TLOG(TLVL_WARNING) << "Received acknowledgement from rank " << buffer.rank
-								<< " that had incorrect sequence ID information. Discarding." ;
-						}
-					}
+					TLOG(TLVL_WARNING) << "Did not receive acks from all senders within the timeout (" << table_ack_wait_time_ms << " ms). Resending table update" ;
 				}
+				send_table_datagrams_();
+				arm_timer_(ack_timer_fd_, table_ack_wait_time_ms, false);
+			}
+			else if (fd == wakeup_fd_)
+			{
+				// State change (start/stop/pause/shutdown); the table trigger is re-evaluated below
+				if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) continue;
+			}
+			else
+			{
+				receive_tokens_(fd);
 			}
-			usleep(table_ack_wait_time_ms * 1000 / 10);
 		}
+
+		try_send_table_(timer_expired);
 	}
-	if (metricMan)
+
+	TLOG(TLVL_DEBUG) << "Reactor loop ending, closing sockets" ;
+	close_sockets_();
+}
+
+void artdaq::RoutingMasterCore::accept_token_connection_()
+{
+	TLOG(TLVL_DEBUG) << "Accepting new connection on token_socket" ;
+	sockaddr_in addr;
+	socklen_t arglen = sizeof(addr);
+	auto conn_sock = accept(token_socket_, (struct sockaddr *)&addr, &arglen);
+
+	if (conn_sock == -1)
 	{
-		artdaq::TimeUtils::seconds delta = std::chrono::steady_clock::now() - start_time;
-		metricMan->sendMetric("Avg Table Acknowledge Time", delta.count(), "seconds", 3, MetricMode::Average);
+		if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+		perror("accept");
+		exit(EXIT_FAILURE);
+	}
+	fcntl(conn_sock, F_SETFL, O_NONBLOCK); // set O_NONBLOCK
+
+	receive_token_addrs_[conn_sock] = std::string(inet_ntoa(addr.sin_addr));
+	receive_token_partials_[conn_sock].second = 0;
+	TLOG(TLVL_DEBUG) << "New fd is " << conn_sock << " for receiver at " << receive_token_addrs_[conn_sock];
+	if (receive_token_addrs_.size() + 5 > epoll_events_.size()) epoll_events_.resize(receive_token_addrs_.size() + 5);
+
+	struct epoll_event ev;
+	ev.events = EPOLLIN | EPOLLET;
+	ev.data.fd = conn_sock;
+	if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn_sock, &ev) == -1)
+	{
+		perror("epoll_ctl: conn_sock");
+		exit(EXIT_FAILURE);
 	}
 }
 
-void artdaq::RoutingMasterCore::receive_tokens_()
+void artdaq::RoutingMasterCore::receive_acks_()
 {
-	while (!shutdown_requested_)
+	TLOG(20) << "receive_acks_: Reading ack datagrams from ack socket" ;
+	while (true)
 	{
-		TLOG(TLVL_DEBUG) << "Receive Token loop start" ;
-		if (token_socket_ == -1)
+		detail::RoutingAckPacket buffer;
+		if (recvfrom(ack_socket_, &buffer, sizeof(detail::RoutingAckPacket), MSG_DONTWAIT, NULL, NULL) < 0)
 		{
-			TLOG(TLVL_DEBUG) << "Opening token listener socket" ;
-			token_socket_ = TCP_listen_fd(receive_token_port_, 3 * sizeof(detail::RoutingToken));
-			fcntl(token_socket_, F_SETFL, O_NONBLOCK); // set O_NONBLOCK
-
-			if (token_epoll_fd_ != -1) close(token_epoll_fd_);
-			struct epoll_event ev;
-			token_epoll_fd_ = epoll_create1(0);
-			ev.events = EPOLLIN | EPOLLPRI;
-			ev.data.fd = token_socket_;
-			if (epoll_ctl(token_epoll_fd_, EPOLL_CTL_ADD, token_socket_, &ev) == -1)
+			if (errno == EWOULDBLOCK || errno == EAGAIN)
 			{
-				TLOG(TLVL_ERROR) << "Could not register listen socket to epoll fd" ;
-				exit(3);
+				TLOG(20) << "receive_acks_: No more ack datagrams on ack socket." ;
+				return;
 			}
+			TLOG(TLVL_ERROR) << "An unexpected error occurred during ack packet receive" ;
+			exit(2);
 		}
-		if (token_socket_ == -1 || token_epoll_fd_ == -1)
+
+		TLOG(TLVL_DEBUG) << "Ack packet from rank " << buffer.rank << " has first= " << buffer.first_sequence_id
+			<< " and last= " << buffer.last_sequence_id ;
+		if (outstanding_table_.size() == 0)
 		{
-			TLOG(TLVL_DEBUG) << "One of the listen sockets was not opened successfully." ;
-			return;
+			TLOG(TLVL_DEBUG) << "No table is outstanding, discarding ack from rank " << buffer.rank ;
+			continue;
 		}
 
-		auto nfds = epoll_wait(token_epoll_fd_, &receive_token_events_[0], receive_token_events_.size(), current_table_interval_ms_);
-		if (nfds == -1)
+		auto first = outstanding_table_[0].sequence_id;
+		auto last = outstanding_table_.rbegin()->sequence_id;
+		auto it = outstanding_acks_.find(buffer.rank);
+		if (it != outstanding_acks_.end() && buffer.first_sequence_id == first && buffer.last_sequence_id == last)
 		{
-			perror("epoll_wait");
-			exit(EXIT_FAILURE);
+			if (it->second) continue;
+			TLOG(TLVL_DEBUG) << "Received table update acknowledgement from sender with rank " << buffer.rank << "." ;
+			it->second = true;
+			--outstanding_ack_count_;
+			TLOG(TLVL_DEBUG) << "There are now " << outstanding_ack_count_ << " acks outstanding" ;
+			if (outstanding_ack_count_ == 0) complete_table_();
 		}
-
-		TLOG(TLVL_DEBUG) << "Received " << nfds << " events" ;
-		for (auto n = 0; n < nfds; ++n)
+		else
 		{
-			if (receive_token_events_[n].data.fd == token_socket_)
+			if (it == outstanding_acks_.end())
 			{
-				TLOG(TLVL_DEBUG) << "Accepting new connection on token_socket" ;
-				sockaddr_in addr;
-				socklen_t arglen = sizeof(addr);
-				auto conn_sock = accept(token_socket_, (struct sockaddr *)&addr, &arglen);
-				fcntl(conn_sock, F_SETFL, O_NONBLOCK); // set O_NONBLOCK
+				TLOG(TLVL_ERROR) << "Received acknowledgement from invalid rank " << buffer.rank << "!"
+					<< " Cross-talk between RoutingMasters means there's a configuration error!" ;
+			}
+			else
+			{
+				TLOG(TLVL_WARNING) << "Received acknowledgement from rank " << buffer.rank
+					<< " that had incorrect sequence ID information. Discarding." ;
+			}
+		}
+	}
+}
 
-				if (conn_sock == -1)
-				{
-					perror("accept");
-					exit(EXIT_FAILURE);
-				}
+void artdaq::RoutingMasterCore::receive_tokens_(int fd)
+{
+	auto startTime = artdaq::MonitoredQuantity::getCurrentTime();
+	bool reading = true;
 
-				receive_token_addrs_[conn_sock] = std::string(inet_ntoa(addr.sin_addr));
-				TLOG(TLVL_DEBUG) << "New fd is " << conn_sock << " for receiver at " << receive_token_addrs_[conn_sock];
-				struct epoll_event ev;
-				ev.events = EPOLLIN | EPOLLET;
-				ev.data.fd = conn_sock;
-				if (epoll_ctl(token_epoll_fd_, EPOLL_CTL_ADD, conn_sock, &ev) == -1)
-				{
-					perror("epoll_ctl: conn_sock");
-					exit(EXIT_FAILURE);
-				}
+	// The socket is edge-triggered, so a token may arrive split across two wakeups; keep the partial token per connection
+	auto& partial = receive_token_partials_[fd];
+	auto& buff = partial.first;
+	auto& sts = partial.second;
+	while (reading)
+	{
+		auto this_sts = read(fd, reinterpret_cast<uint8_t*>(&buff) + sts, sizeof(detail::RoutingToken) - sts);
+		if (this_sts == 0)
+		{
+			TLOG(TLVL_INFO) << "Connection closed by " << receive_token_addrs_[fd];
+			close_token_connection_(fd);
+			reading = false;
+		}
+		else if (this_sts < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			TLOG(TLVL_DEBUG) << "No more tokens from this rank. Continuing poll loop.";
+			reading = false;
+		}
+		else if (this_sts < 0)
+		{
+			TLOG(TLVL_ERROR) << "Error reading from token socket: sts=" << this_sts << ", errno=" << errno;
+			close_token_connection_(fd);
+			reading = false;
+		}
+		else if ((sts += this_sts) < sizeof(detail::RoutingToken))
+		{
+			continue;
+		}
+		else if (buff.header != TOKEN_MAGIC)
+		{
+			// There is no way to find the start of the next token, so drop the connection rather than misread every token after this one
+			TLOG(TLVL_ERROR) << "Received invalid token from " << receive_token_addrs_[fd] << " (header=0x" << std::hex << buff.header << std::dec
+				<< "), closing the connection. Is the sender running a different version of artdaq?";
+			close_token_connection_(fd);
+			reading = false;
+		}
+		else
+		{
+			sts = 0;
+			TLOG(TLVL_DEBUG) << "Received token from " << buff.rank << " indicating " << buff.new_slots_free << " slots are free." ;
+			received_token_count_ += buff.new_slots_free;
+			policy_->UpdateReceiverStatus(buff);
+			if (routing_mode_ == detail::RoutingMasterMode::RouteBySequenceID)
+			{
+				policy_->AddReceiverToken(buff.rank, buff.new_slots_free);
+				tokens_since_last_table_ += buff.new_slots_free;
 			}
-			else
+			else if (routing_mode_ == detail::RoutingMasterMode::RouteBySendCount)
 			{
-			  /*if (receive_token_events_[n].events & (EPOLLRDHUP | EPOLLERR | EPOLLHUP))
-				{
-					TLOG(TLVL_DEBUG) << "Closing connection on fd " << receive_token_events_[n].data.fd << " (" << receive_token_addrs_[receive_token_events_[n].data.fd] << ")";
-					receive_token_addrs_.erase(receive_token_events_[n].data.fd);
-					close(receive_token_events_[n].data.fd);
-					epoll_ctl(token_epoll_fd_, EPOLL_CTL_DEL, receive_token_events_[n].data.fd, NULL);
-					continue;
-					}*/
-
-				auto startTime = artdaq::MonitoredQuantity::getCurrentTime();
-				bool reading = true;
-				int sts = 0;
-				while(reading)
-				  {
-					detail::RoutingToken buff;
-					sts += read(receive_token_events_[n].data.fd, &buff, sizeof(detail::RoutingToken) - sts);
-					if (sts == 0)
-					  {
-						TLOG(TLVL_INFO) << "Received 0-size token from " << receive_token_addrs_[receive_token_events_[n].data.fd];
-						reading = false;
-					  }
-					else if(sts < 0 && errno == EAGAIN)
-					  {
-						TLOG(TLVL_DEBUG) << "No more tokens from this rank. Continuing poll loop.";
-						reading = false;
-					  }
-					else if(sts < 0)
-					  {
-						TLOG(TLVL_ERROR) << "Error reading from token socket: sts=" << sts << ", errno=" << errno;
-						receive_token_addrs_.erase(receive_token_events_[n].data.fd);
-						close(receive_token_events_[n].data.fd);
-						epoll_ctl(token_epoll_fd_, EPOLL_CTL_DEL, receive_token_events_[n].data.fd, NULL);
-						reading = false;
-					  }
-					else if (sts == sizeof(detail::RoutingToken) && buff.header != TOKEN_MAGIC)
-					  {
-						TLOG(TLVL_ERROR) << "Received invalid token from " << receive_token_addrs_[receive_token_events_[n].data.fd] << " sts=" << sts;
-						reading = false;
-					  }
-					else if(sts == sizeof(detail::RoutingToken))
-					  {
-						sts = 0;
-						TLOG(TLVL_DEBUG) << "Received token from " << buff.rank << " indicating " << buff.new_slots_free << " slots are free." ;
-						received_token_count_ += buff.new_slots_free;
-						if (routing_mode_ == detail::RoutingMasterMode::RouteBySequenceID)
-						  {
-							policy_->AddReceiverToken(buff.rank, buff.new_slots_free);
-						  }
-						else if (routing_mode_ == detail::RoutingMasterMode::RouteBySendCount)
-						  {
-							if (!received_token_counter_.count(buff.rank)) received_token_counter_[buff.rank] = 0;
-							received_token_counter_[buff.rank] += buff.new_slots_free;
-							TLOG(TLVL_DEBUG) << "RoutingMasterMode is RouteBySendCount. I have " << received_token_counter_[buff.rank] << " tokens for rank " << buff.rank << " and I need " << sender_ranks_.size() << "." ;
-							while (received_token_counter_[buff.rank] >= sender_ranks_.size())
-							  {
-								TLOG(TLVL_DEBUG) << "RoutingMasterMode is RouteBySendCount. I have " << received_token_counter_[buff.rank] << " tokens for rank " << buff.rank << " and I need " << sender_ranks_.size()
-												 << "... Sending token to policy" ;
-								policy_->AddReceiverToken(buff.rank, 1);
-								received_token_counter_[buff.rank] -= sender_ranks_.size();
-							  }
-						  }
-					  }
-				  }
-				auto delta_time = artdaq::MonitoredQuantity::getCurrentTime() - startTime;
-				statsHelper_.addSample(TOKENS_RECEIVED_STAT_KEY, delta_time);
-				bool readyToReport = statsHelper_.readyToReport(delta_time);
-				if (readyToReport)
+				if (!received_token_counter_.count(buff.rank)) received_token_counter_[buff.rank] = 0;
+				received_token_counter_[buff.rank] += buff.new_slots_free;
+				TLOG(TLVL_DEBUG) << "RoutingMasterMode is RouteBySendCount. I have " << received_token_counter_[buff.rank] << " tokens for rank " << buff.rank << " and I need " << sender_ranks_.size() << "." ;
+				while (received_token_counter_[buff.rank] >= sender_ranks_.size())
 				{
-				std::string statString = buildStatisticsString_();
-					TLOG(TLVL_INFO) << statString;
-				sendMetrics_();
+					TLOG(TLVL_DEBUG) << "RoutingMasterMode is RouteBySendCount. I have " << received_token_counter_[buff.rank] << " tokens for rank " << buff.rank << " and I need " << sender_ranks_.size()
+						<< "... Sending token to policy" ;
+					policy_->AddReceiverToken(buff.rank, 1);
+					++tokens_since_last_table_;
+					received_token_counter_[buff.rank] -= sender_ranks_.size();
+				}
 			}
+		}
 	}
-}
+	auto delta_time = artdaq::MonitoredQuantity::getCurrentTime() - startTime;
+	statsHelper_.addSample(TOKENS_RECEIVED_STAT_KEY, delta_time);
+	bool readyToReport = statsHelper_.readyToReport(delta_time);
+	if (readyToReport)
+	{
+		std::string statString = buildStatisticsString_();
+		TLOG(TLVL_INFO) << statString;
+		sendMetrics_();
 	}
 }
 
-void artdaq::RoutingMasterCore::start_recieve_token_thread_()
+void artdaq::RoutingMasterCore::close_token_connection_(int fd)
+{
+	receive_token_addrs_.erase(fd);
+	receive_token_partials_.erase(fd);
+	epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, NULL);
+	close(fd);
+}
+
+void artdaq::RoutingMasterCore::stop_reactor_thread_()
+{
+	if (!reactor_thread_.joinable()) return;
+
+	TLOG(TLVL_DEBUG) << "Stopping Routing Master Reactor Thread" ;
+	shutdown_requested_.store(true);
+	wake_reactor_();
+	reactor_thread_.join();
+}
+
+void artdaq::RoutingMasterCore::start_reactor_thread_()
 {
-	if (ev_token_receive_thread_.joinable()) ev_token_receive_thread_.join();
+	stop_reactor_thread_();
+	shutdown_requested_.store(false);
+
+	if (wakeup_fd_ == -1)
+	{
+		wakeup_fd_ = eventfd(0, EFD_NONBLOCK);
+		if (wakeup_fd_ == -1)
+		{
+			TLOG(TLVL_ERROR) << "Could not create wakeup eventfd, errno=" << errno ;
+			exit(3);
+		}
+	}
+
 	boost::thread::attributes attrs;
 	attrs.set_stack_size(4096 * 2000); // 8000 KB
 	
-	TLOG(TLVL_INFO) << "Starting Token Reception Thread" ;
+	TLOG(TLVL_INFO) << "Starting Routing Master Reactor Thread" ;
 	try {
-		ev_token_receive_thread_ = boost::thread(attrs, boost::bind(&RoutingMasterCore::receive_tokens_, this));
+		reactor_thread_ = boost::thread(attrs, boost::bind(&RoutingMasterCore::run_reactor_, this));
 	}
 	catch(boost::exception const& e)
 	{
-		std::cerr << "Exception encountered starting Token Reception thread: " << boost::diagnostic_information(e) << ", errno=" << errno << std::endl;
+		std::cerr << "Exception encountered starting Routing Master Reactor thread: " << boost::diagnostic_information(e) << ", errno=" << errno << std::endl;
 		exit(3);
 	}
-	TLOG(TLVL_INFO) << "Started Token Reception Thread";
+	TLOG(TLVL_INFO) << "Started Routing Master Reactor Thread";
 }
 
 std::string artdaq::RoutingMasterCore::report(std::string const&) const
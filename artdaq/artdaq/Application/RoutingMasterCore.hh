@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <condition_variable>
 
 // Socket Includes
 #include <netinet/in.h>
@@ -68,8 +69,10 @@ public:
 	*   "rt_priority" (Default: 0): Unix process priority to assign to RoutingMasterCore
 	*   "sender_ranks" (REQUIRED): List of ranks (integers) for the senders (that receive table updates)
 	*   "table_update_interval_ms" (Default: 1000): Maximum amount of time between table updates
+	*   "table_update_token_count" (Default: number of receivers): A table update is sent as soon as this many tokens have been received since the last update
 	*   "senders_send_by_send_count" (Default: false): If true, senders will use the current send count to lookup routing information in the table, instead of sequence ID.
-	*   "table_ack_retry_count" (Default: 5): The number of times the table will be resent while waiting for acknowledements
+	*   "table_ack_retry_count" (Default: 5): The number of times the table will be resent while waiting for acknowledements.
+	*     The table is resent every table_update_interval_ms / table_ack_retry_count ms until all senders have acknowledged it.
 	*   "routing_token_port" (Default: 35555): The port on which to listen for RoutingToken packets
 	*   "table_update_port" (Default: 35556): The port on which to send table updates
 	*   "table_acknowledge_port" (Default: 35557): The port on which to listen for RoutingAckPacket datagrams
@@ -130,8 +133,12 @@ public:
 	bool reinitialize(fhicl::ParameterSet const& pset, uint64_t timeout, uint64_t timestamp);
 
 	/**
-	 * \brief Main loop of the RoutingMasterCore. Determines when to send the next table update,
-	 * asks the RoutingMasterPolicy for the table to send, and sends it.
+	 * \brief Enables table updates for the duration of the run. Returns once stop, pause or shutdown is requested.
+	 *
+	 * Table updates are sent by the reactor thread (started by initialize), which waits on the token sockets,
+	 * the ack socket and the table update timer at the same time. A table update is sent as soon as
+	 * table_update_token_count tokens have arrived since the last one, or when table_update_interval_ms
+	 * has elapsed, whichever comes first.
 	 */
 	void process_event_table();
 
@@ -139,11 +146,10 @@ public:
 	 * \brief Sends a detail::RoutingPacket to the table receivers
 	 * \param table The detail::RoutingPacket to send
 	 *
-	 * send_event_table checks the table update socket and the acknowledge socket before
-	 * sending the table update the first time. It then enters a loop where it sends the table
-	 * update, then waits for acknowledgement packets. It keeps track of which senders have sent
-	 * their acknowledgement packets, and discards duplicate acks. It leaves this loop once all
-	 * senders have sent a valid acknowledgement packet.
+	 * send_event_table sends the table update and records it as outstanding. Acknowledgement packets are
+	 * handled by the reactor thread as they arrive; duplicate acks are discarded. The table is resent when
+	 * the ack timer expires, until all senders have sent a valid acknowledgement packet. No new table is
+	 * sent while one is outstanding. Must be called from the reactor thread.
 	 */
 	void send_event_table(detail::RoutingPacket table);
 
@@ -161,8 +167,20 @@ public:
 	size_t get_update_count() const { return table_update_count_; }
 
 private:
-	void receive_tokens_();
-	void start_recieve_token_thread_();
+	void run_reactor_();
+	void start_reactor_thread_();
+	void stop_reactor_thread_();
+	void wake_reactor_();
+	void setup_sockets_();
+	void close_sockets_();
+	void accept_token_connection_();
+	void receive_tokens_(int fd);
+	void close_token_connection_(int fd);
+	void receive_acks_();
+	void send_table_datagrams_();
+	void complete_table_();
+	void try_send_table_(bool timer_expired);
+	void arm_timer_(int fd, size_t interval_ms, bool periodic);
 
 	art::RunID run_id_;
 
@@ -170,9 +188,9 @@ private:
 	int rt_priority_;
 
 	size_t max_table_update_interval_ms_;
+	size_t table_update_token_count_;
 	size_t max_ack_cycle_count_;
 	detail::RoutingMasterMode routing_mode_;
-	std::atomic<size_t> current_table_interval_ms_;
 	std::atomic<size_t> table_update_count_;
 	std::atomic<size_t> received_token_count_;
 	std::unordered_map<int, size_t> received_token_counter_;
@@ -185,6 +203,17 @@ private:
 	std::atomic<bool> shutdown_requested_;
 	std::atomic<bool> stop_requested_;
 	std::atomic<bool> pause_requested_;
+	std::atomic<bool> table_updates_enabled_;
+	std::mutex run_mutex_;
+	std::condition_variable run_cv_;
+
+	// Reactor thread state
+	size_t tokens_since_last_table_;
+	detail::RoutingPacket outstanding_table_;
+	std::unordered_map<int, bool> outstanding_acks_;
+	size_t outstanding_ack_count_;
+	size_t ack_resend_count_;
+	std::chrono::steady_clock::time_point table_send_time_;
 
 	// attributes and methods for statistics gathering & reporting
 	artdaq::StatisticsHelper statsHelper_;
@@ -202,17 +231,20 @@ private:
 	std::string send_tables_address_;
 	std::string receive_address_;
 	struct sockaddr_in send_tables_addr_;
-	std::vector<epoll_event> receive_ack_events_;
-	std::vector<epoll_event> receive_token_events_;
+	std::vector<epoll_event> epoll_events_;
 	std::unordered_map<int, std::string> receive_token_addrs_;
-	int token_epoll_fd_;
+	std::unordered_map<int, std::pair<detail::RoutingToken, size_t>> receive_token_partials_; ///< Token being read from each connection, and how many of its bytes have arrived
+	int epoll_fd_;
 
 	//Socket parameters
 	int token_socket_;
 	int table_socket_;
 	int ack_socket_;
+	int table_timer_fd_;
+	int ack_timer_fd_;
+	int wakeup_fd_;
 	mutable std::mutex request_mutex_;
-	boost::thread ev_token_receive_thread_;
+	boost::thread reactor_thread_;
 
 };
 
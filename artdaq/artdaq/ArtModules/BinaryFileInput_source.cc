@@ -0,0 +1,231 @@
+#define TRACE_NAME "BinaryFileInput"
+
+#include "art/Framework/Core/FileBlock.h"
+#include "art/Framework/Core/InputSourceMacros.h"
+#include "art/Framework/Core/ProductRegistryHelper.h"
+#include "art/Framework/IO/Sources/Source.h"
+#include "art/Framework/IO/Sources/SourceHelper.h"
+#include "art/Framework/IO/Sources/put_product_in_principal.h"
+#include "art/Framework/Principal/EventPrincipal.h"
+#include "art/Framework/Principal/RunPrincipal.h"
+#include "art/Framework/Principal/SubRunPrincipal.h"
+#include "canvas/Persistency/Provenance/FileFormatVersion.h"
+#include "fhiclcpp/ParameterSet.h"
+
+#include "artdaq/ArtModules/detail/ContainedFragmentType.hh"
+#include "artdaq/DAQdata/BinaryFileMap.hh"
+#include "artdaq/DAQdata/FragmentView.hh"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQdata/ReplayPacer.hh"
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace artdaq
+{
+	namespace detail
+	{
+		class BinaryFileInputDetail;
+	}
+}
+
+/**
+ * \brief Reads the files written by BinaryFileOutput back into art, for reprocessing and replay tests
+ *
+ * Each file is mapped into memory with BinaryFileMap, and each run of Fragments with the same Sequence ID becomes an
+ * art::Event whose event number is the Sequence ID. Each input file is a new SubRun. The Fragments are put into the
+ * event by type, with the same product instance names as RawInput uses.
+ */
+class artdaq::detail::BinaryFileInputDetail
+{
+public:
+	/**
+	 * \brief BinaryFileInputDetail Constructor
+	 * \param ps ParameterSet used to configure BinaryFileInput
+	 * \param help art::ProductRegistryHelper which is used to inform art about the products
+	 * \param pm art::SourceHelper used to make the principals
+	 *
+	 * \verbatim
+	 * BinaryFileInput accepts the following Parameters, in addition to "fileNames":
+	 * "raw_data_label" (Default: "daq"): The label used to store artdaq data
+	 * "run_number" (Default: 1): The run number of the events
+	 * "fragment_type_map" (Default: []): Additional (type, name) pairs. The artdaq system types are always known
+	 * "use_fragment_views" (Default: false): Put artdaq::FragmentViews of the mapped file into the event instead of
+	 *   copying the data into artdaq::Fragments
+	 * "pacing" (Default: "none"): How fast events are read: "none" (as fast as possible), "fixed" (at "rate_hz"),
+	 *   or "recorded" (at the intervals given by the Fragment timestamps)
+	 * "rate_hz" (Default: 10.0): The event rate for "fixed" pacing
+	 * "timestamp_ticks_per_second" (Default: 1e9): The frequency of the Fragment timestamp clock, for "recorded" pacing
+	 * \endverbatim
+	 */
+	BinaryFileInputDetail(fhicl::ParameterSet const& ps, art::ProductRegistryHelper& help, art::SourceHelper const& pm);
+
+	/**
+	 * \brief Map the next input file
+	 * \param name Name of the file
+	 * \param[out] fb art::FileBlock for the file
+	 */
+	void readFile(std::string const& name, art::FileBlock*& fb);
+
+	/**
+	 * \brief Unmap the current input file
+	 */
+	void closeCurrentFile();
+
+	/**
+	 * \brief Read the next event from the current file
+	 * \param inR Input art::RunPrincipal
+	 * \param inSR Input art::SubRunPrincipal
+	 * \param[out] outR Output art::RunPrincipal
+	 * \param[out] outSR Output art::SubRunPrincipal
+	 * \param[out] outE Output art::EventPrincipal
+	 * \return False at the end of the file
+	 */
+	bool readNext(art::RunPrincipal* const& inR, art::SubRunPrincipal* const& inSR,
+	              art::RunPrincipal*& outR, art::SubRunPrincipal*& outSR, art::EventPrincipal*& outE);
+
+private:
+	template <class T>
+	void putFragments_(std::map<std::string, std::unique_ptr<std::vector<T>>>& products, FragmentView const& view, T&& product);
+
+	art::SourceHelper const& pmaker_;
+	std::string raw_data_label_;
+	std::string unidentified_instance_name_;
+	art::RunNumber_t run_;
+	art::SubRunNumber_t subrun_;
+	bool use_fragment_views_;
+	std::map<Fragment::type_t, std::string> fragment_type_map_;
+	ReplayPacer pacer_;
+	std::unique_ptr<BinaryFileMap> file_;
+	FragmentViews event_;
+};
+
+artdaq::detail::BinaryFileInputDetail::BinaryFileInputDetail(fhicl::ParameterSet const& ps, art::ProductRegistryHelper& help, art::SourceHelper const& pm)
+	: pmaker_(pm)
+	, raw_data_label_(ps.get<std::string>("raw_data_label", "daq"))
+	, unidentified_instance_name_("unidentified")
+	, run_(ps.get<art::RunNumber_t>("run_number", 1))
+	, subrun_(0)
+	, use_fragment_views_(ps.get<bool>("use_fragment_views", false))
+	, fragment_type_map_(Fragment::MakeSystemTypeMap())
+	, pacer_(ReplayPacer::ModeFromString(ps.get<std::string>("pacing", "none")), ps.get<double>("rate_hz", 10.0), ps.get<double>("timestamp_ticks_per_second", 1e9))
+	, file_()
+	, event_()
+{
+	auto extraTypes = ps.get<std::vector<std::pair<Fragment::type_t, std::string>>>("fragment_type_map", std::vector<std::pair<Fragment::type_t, std::string>>());
+	for (auto& type : extraTypes)
+	{
+		fragment_type_map_[type.first] = type.second;
+	}
+
+	auto reconstitutes = [&](std::string const& instance)
+	{
+		if (use_fragment_views_)
+		{
+			help.reconstitutes<FragmentViews, art::InEvent>(raw_data_label_, instance);
+		}
+		else
+		{
+			help.reconstitutes<Fragments, art::InEvent>(raw_data_label_, instance);
+		}
+	};
+	reconstitutes(unidentified_instance_name_);
+	for (auto& type : fragment_type_map_)
+	{
+		reconstitutes(type.second);
+		reconstitutes("Container" + type.second);
+	}
+}
+
+void artdaq::detail::BinaryFileInputDetail::readFile(std::string const& name, art::FileBlock*& fb)
+{
+	file_ = std::make_unique<BinaryFileMap>(name);
+	++subrun_;
+	pacer_.Reset(); // Timestamps start again with each file
+	TLOG(TLVL_INFO) << "Reading " << file_->sizeBytes() << " bytes from " << name << " as run " << run_ << ", subrun " << subrun_;
+	fb = new art::FileBlock(art::FileFormatVersion(1, "RawEvent2011"), name);
+}
+
+void artdaq::detail::BinaryFileInputDetail::closeCurrentFile()
+{
+	event_.clear();
+	file_.reset(nullptr);
+}
+
+bool artdaq::detail::BinaryFileInputDetail::readNext(art::RunPrincipal* const& inR, art::SubRunPrincipal* const& inSR,
+                                                     art::RunPrincipal*& outR, art::SubRunPrincipal*& outSR, art::EventPrincipal*& outE)
+{
+	outR = nullptr;
+	outSR = nullptr;
+	outE = nullptr;
+	if (!file_ || !file_->NextEvent(event_)) return false;
+
+	while (!pacer_.Wait(event_.front().timestamp())) {}
+
+	timespec hi_res_time;
+	art::Timestamp currentTime = 0;
+	if (clock_gettime(CLOCK_REALTIME, &hi_res_time) == 0)
+	{
+		currentTime = ((hi_res_time.tv_sec & 0xffffffff) << 32) | (hi_res_time.tv_nsec & 0xffffffff);
+	}
+
+	if (inR == nullptr || inR->run() != run_)
+	{
+		outR = pmaker_.makeRunPrincipal(run_, currentTime);
+	}
+	if (inSR == nullptr || inSR->id() != art::SubRunID(run_, subrun_))
+	{
+		outSR = pmaker_.makeSubRunPrincipal(run_, subrun_, currentTime);
+	}
+	auto sequence_id = event_.front().sequenceID();
+	outE = pmaker_.makeEventPrincipal(run_, subrun_, sequence_id, currentTime);
+	TLOG(TLVL_TRACE) << "Event " << sequence_id << " has " << event_.size() << " Fragments";
+
+	if (use_fragment_views_)
+	{
+		std::map<std::string, std::unique_ptr<FragmentViews>> products;
+		for (auto& view : event_) putFragments_(products, view, FragmentView(view));
+		for (auto& product : products) art::put_product_in_principal(std::move(product.second), *outE, raw_data_label_, product.first);
+	}
+	else
+	{
+		std::map<std::string, std::unique_ptr<Fragments>> products;
+		for (auto& view : event_) putFragments_(products, view, view.copy());
+		for (auto& product : products) art::put_product_in_principal(std::move(product.second), *outE, raw_data_label_, product.first);
+	}
+	return true;
+}
+
+template <class T>
+void artdaq::detail::BinaryFileInputDetail::putFragments_(std::map<std::string, std::unique_ptr<std::vector<T>>>& products, FragmentView const& view, T&& product)
+{
+	// Same instance names as SharedMemoryReader: ContainerFragments are sorted by the type of Fragment they hold
+	std::string instance = unidentified_instance_name_;
+	auto type = fragment_type_map_.find(view.type());
+	if (type != fragment_type_map_.end())
+	{
+		instance = type->second;
+		if (view.type() == Fragment::ContainerFragmentType)
+		{
+			auto contained_type = fragment_type_map_.find(containedFragmentType(view));
+			if (contained_type != fragment_type_map_.end()) instance += contained_type->second;
+		}
+	}
+
+	auto& out = products[instance];
+	if (!out) out = std::make_unique<std::vector<T>>();
+	out->emplace_back(std::move(product));
+}
+
+namespace artdaq
+{
+	/**
+	 * \brief BinaryFileInput is a typedef of art::Source<detail::BinaryFileInputDetail>
+	 */
+	typedef art::Source<detail::BinaryFileInputDetail> BinaryFileInput;
+}
+
+DEFINE_ART_INPUT_SOURCE(artdaq::BinaryFileInput)
@@ -16,8 +16,11 @@
 #include "fhiclcpp/ParameterSet.h"
 
 #include "artdaq-core/Data/Fragment.hh"
+#include "artdaq/ArtModules/detail/AsyncFileWriter.hh"
+#include "artdaq/DAQdata/BinaryFileIndex.hh"
 #include "artdaq/DAQdata/Globals.hh"
 
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
@@ -52,6 +55,13 @@ public:
 	 * BinaryFileOutput also expects the following Parameters:
 	 * "fileName" (REQUIRED): Name of the file to write
 	 * "directIO" (Default: false): Whether to use O_DIRECT
+	 * "asyncIO" (Default: false): Whether to gather Fragments into large aligned buffers which are written by a background thread.
+	 *   The event loop then only waits for the disk when all buffers are full. Combines with directIO.
+	 * "asyncBufferSizeBytes" (Default: 0x1000000): Size of each buffer used by asyncIO
+	 * "asyncBufferCount" (Default: 3): Number of buffers used by asyncIO
+	 * "writeIndex" (Default: false): Whether to write an index file (the file name + ".idx") which records the
+	 *   Sequence ID, Fragment ID, offset and size of each Fragment which was written without error. It is flushed after each event.
+	 *   See artdaq::BinaryFileIndex for reading it
 	 */
 	explicit BinaryFileOutput(ParameterSet const& ps);
 
@@ -80,8 +90,15 @@ private:
 	std::string name_ = "BinaryFileOutput";
 	std::string file_name_ = "/tmp/artdaqdemo.binary";
 	bool do_direct_ = false;
+	bool do_async_ = false;
+	size_t async_buffer_size_ = 0x1000000;
+	size_t async_buffer_count_ = 3;
 	int fd_ = -1; // Used for direct IO
 	std::unique_ptr<std::ofstream> file_ptr_ = {nullptr};
+	std::unique_ptr<artdaq::detail::AsyncFileWriter> async_writer_ = {nullptr}; // Used for async IO
+	bool write_index_ = false;
+	std::unique_ptr<artdaq::BinaryFileIndexWriter> index_writer_ = {nullptr};
+	uint64_t bytes_written_ = 0; // Offset of the next Fragment in the file
 	art::FileStatsCollector fstats_;
 };
 
@@ -125,7 +142,16 @@ art::BinaryFileOutput::
 initialize_FILE_()
 {
 	std::string file_name = PostCloseFileRenamer{ fstats_ }.applySubstitutions(file_name_);
-	if (do_direct_)
+	bytes_written_ = 0;
+	if (write_index_)
+	{
+		index_writer_ = std::make_unique<artdaq::BinaryFileIndexWriter>(artdaq::BinaryFileIndex::IndexFileName(file_name));
+	}
+	if (do_async_)
+	{
+		async_writer_ = std::make_unique<artdaq::detail::AsyncFileWriter>(file_name, async_buffer_size_, async_buffer_count_, do_direct_);
+	}
+	else if (do_direct_)
 	{
 		fd_ = open(file_name.c_str(), O_WRONLY | O_CREAT | O_DIRECT, 0660);
 		TLOG(TLVL_TRACE) << "initialize_FILE_ fd_=" << fd_;
@@ -143,13 +169,23 @@ void
 art::BinaryFileOutput::
 deinitialize_FILE_()
 {
-	if (do_direct_)
+	if (do_async_)
+	{
+		async_writer_->Close();
+		async_writer_.reset(nullptr);
+	}
+	else if (do_direct_)
 	{
 		close(fd_);
 		fd_ = -1;
 	}
 	else
 		file_ptr_.reset(nullptr);
+	if (index_writer_)
+	{
+		index_writer_->Close();
+		index_writer_.reset(nullptr);
+	}
 	fstats_.recordFileClose();
 }
 
@@ -174,6 +210,10 @@ readParameterSet_(fhicl::ParameterSet const& pset)
 		return false;
 	}
 	do_direct_ = pset.get<bool>("directIO", false);
+	do_async_ = pset.get<bool>("asyncIO", false);
+	async_buffer_size_ = pset.get<size_t>("asyncBufferSizeBytes", 0x1000000);
+	async_buffer_count_ = pset.get<size_t>("asyncBufferCount", 3);
+	write_index_ = pset.get<bool>("writeIndex", false);
 	// determine the data sending parameters
 	return true;
 }
@@ -210,10 +250,24 @@ write(EventPrincipal& ep)
 			TLOG(TLVL_TRACE) << "BinaryFileOutput::write seq=" << sequence_id
 				<< " frag=" << fragid_id << " " << reinterpret_cast<const void*>(fragment.headerBeginBytes())
 				<< " bytes=0x" << std::hex << fragment.sizeBytes() << " start";
-			if (do_direct_)
+			bool written = true;
+			if (do_async_)
+			{
+				async_writer_->Write(fragment.headerBeginBytes(), fragment.sizeBytes());
+				TLOG(5) << "BinaryFileOutput::write seq=" << sequence_id << " frag=" << fragid_id << " buffered";
+			}
+			else if (do_direct_)
 			{
 				ssize_t sts = ::write(fd_, reinterpret_cast<const char*>(fragment.headerBeginBytes()), fragment.sizeBytes());
 				TLOG(5) << "BinaryFileOutput::write seq=" << sequence_id << " frag=" << fragid_id << " done sts=" << sts << " errno=" << errno;
+				if (sts != static_cast<ssize_t>(fragment.sizeBytes()))
+				{
+					TLOG(TLVL_ERROR) << "BinaryFileOutput::write seq=" << sequence_id << " frag=" << fragid_id << " wrote " << sts
+						<< " of " << fragment.sizeBytes() << " bytes, errno=" << errno << " (" << strerror(errno) << ")";
+					written = false;
+					// A short write still moves the file offset, so later Fragments are indexed at the right place
+					if (sts > 0) bytes_written_ += sts;
+				}
 			}
 			else
 			{
@@ -223,9 +277,19 @@ write(EventPrincipal& ep)
 				file_ptr_->write(reinterpret_cast<const char*>(fragment.headerBeginBytes()), fragment.sizeBytes());
 #          endif
 				TLOG(5) << "BinaryFileOutput::write seq=" << sequence_id << " frag=" << fragid_id << " done errno=" << errno;
+				if (!*file_ptr_)
+				{
+					TLOG(TLVL_ERROR) << "BinaryFileOutput::write seq=" << sequence_id << " frag=" << fragid_id << " failed, errno=" << errno << " (" << strerror(errno) << ")";
+					written = false;
+				}
 			}
+			if (!written) continue;
+
+			if (index_writer_) index_writer_->Add(fragment, bytes_written_);
+			bytes_written_ += fragment.sizeBytes();
 		}
 	}
+	if (index_writer_) index_writer_->Flush();
 	fstats_.recordEvent(ep.id());
 	return;
 }
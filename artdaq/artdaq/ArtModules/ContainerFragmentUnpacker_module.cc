@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////
+// Class:       ContainerFragmentUnpacker
+// Module Type: producer
+// File:        ContainerFragmentUnpacker_module.cc
+// Description: Sorts ContainerFragments by the type of Fragment they hold
+////////////////////////////////////////////////////////////////////////
+
+#define TRACE_NAME "ContainerFragmentUnpacker"
+
+#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "fhiclcpp/ParameterSet.h"
+
+#include "artdaq/ArtModules/detail/ContainedFragmentType.hh"
+#include "artdaq/DAQdata/FragmentView.hh"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace artdaq
+{
+	class ContainerFragmentUnpacker;
+}
+
+/**
+ * \brief Sorts the ContainerFragments of an event into one product per contained Fragment type
+ *
+ * This does the work which SharedMemoryReader does for every event when its "unpack_container_fragments"
+ * parameter is true. Placed in a trigger path after the filters, it only runs for the events which pass them.
+ * By default the products are Fragments, as SharedMemoryReader makes them. With "use_fragment_views", they are
+ * FragmentViews of the ContainerFragments in the input product, so nothing is copied; they are valid while the
+ * event is being processed.
+ */
+class artdaq::ContainerFragmentUnpacker : public art::EDProducer
+{
+public:
+	/**
+	 * \brief ContainerFragmentUnpacker Constructor
+	 * \param p ParameterSet used to configure ContainerFragmentUnpacker
+	 *
+	 * \verbatim
+	 * ContainerFragmentUnpacker accepts the following Parameters:
+	 * "raw_data_label" (Default: "daq"): The label used to store artdaq data
+	 * "container_instance_name" (Default: "Container"): The instance name of the ContainerFragments in the input
+	 * "fragment_type_map" (Default: []): Additional (type, name) pairs, as for the input source. The artdaq system types are always known
+	 * "use_fragment_views" (Default: false): Put artdaq::FragmentViews into the event instead of copies of the ContainerFragments.
+	 *   Set it to the value used by the input source, so that the products have the same type as when the source sorts them
+	 * \endverbatim
+	 *
+	 * Each ContainerFragment is put into the product with instance name "container_instance_name" + the name of its
+	 * contained type, or "container_instance_name" if the type is not known. The input can be either Fragments or FragmentViews.
+	 */
+	explicit ContainerFragmentUnpacker(fhicl::ParameterSet const& p);
+
+	/**
+	 * \brief Default virtual Destructor
+	 */
+	virtual ~ContainerFragmentUnpacker() = default;
+
+	/**
+	 * \brief Sort the ContainerFragments of the event and put the resulting products
+	 * \param e The art::Event to process
+	 */
+	void produce(art::Event& e) override;
+
+private:
+	template <class Product>
+	void produce_(art::Event& e);
+
+	std::string raw_data_label_;
+	std::string container_instance_name_;
+	std::map<Fragment::type_t, std::string> fragment_type_map_;
+	bool use_fragment_views_;
+};
+
+artdaq::ContainerFragmentUnpacker::ContainerFragmentUnpacker(fhicl::ParameterSet const& p)
+	: raw_data_label_(p.get<std::string>("raw_data_label", "daq"))
+	, container_instance_name_(p.get<std::string>("container_instance_name", "Container"))
+	, fragment_type_map_(Fragment::MakeSystemTypeMap())
+	, use_fragment_views_(p.get<bool>("use_fragment_views", false))
+{
+	auto extraTypes = p.get<std::vector<std::pair<Fragment::type_t, std::string>>>("fragment_type_map", std::vector<std::pair<Fragment::type_t, std::string>>());
+	for (auto& type : extraTypes)
+	{
+		fragment_type_map_[type.first] = type.second;
+	}
+
+	auto declare = [&](std::string const& instance) {
+		if (use_fragment_views_)
+		{
+			produces<FragmentViews>(instance);
+		}
+		else
+		{
+			produces<Fragments>(instance);
+		}
+	};
+
+	declare(container_instance_name_);
+	for (auto& type : fragment_type_map_)
+	{
+		declare(container_instance_name_ + type.second);
+	}
+}
+
+void artdaq::ContainerFragmentUnpacker::produce(art::Event& e)
+{
+	if (use_fragment_views_)
+	{
+		produce_<FragmentViews>(e);
+	}
+	else
+	{
+		produce_<Fragments>(e);
+	}
+}
+
+template <class Product>
+void artdaq::ContainerFragmentUnpacker::produce_(art::Event& e)
+{
+	std::map<std::string, std::unique_ptr<Product>> products;
+	products[container_instance_name_] = std::make_unique<Product>();
+
+	art::Handle<Fragments> fragments;
+	art::Handle<FragmentViews> views;
+	if (e.getByLabel(raw_data_label_, container_instance_name_, fragments))
+	{
+		detail::sortContainerFragments(*fragments, fragment_type_map_, container_instance_name_, products);
+	}
+	else if (e.getByLabel(raw_data_label_, container_instance_name_, views))
+	{
+		detail::sortContainerFragments(*views, fragment_type_map_, container_instance_name_, products);
+	}
+	else
+	{
+		TLOG(TLVL_DEBUG) << "Event " << e.event() << " has no ContainerFragments with label " << raw_data_label_ << ":" << container_instance_name_;
+	}
+
+	for (auto& product : products)
+	{
+		e.put(std::move(product.second), product.first);
+	}
+}
+
+DEFINE_ART_MODULE(artdaq::ContainerFragmentUnpacker)
@@ -5,6 +5,7 @@
 
 #include "artdaq/ArtModules/NetMonTransportServiceInterface.h"
 #include "artdaq/DAQrate/DataSenderManager.hh"
+#include "artdaq/DAQrate/detail/SharedMemoryEventSignal.hh"
 #include "artdaq-core/Core/SharedMemoryEventReceiver.hh"
 
 // ----------------------------------------------------------------------
@@ -92,6 +93,7 @@ private:
 
 	std::unique_ptr<artdaq::DataSenderManager> sender_ptr_;
 	std::unique_ptr<artdaq::SharedMemoryEventReceiver> incoming_events_;
+	std::unique_ptr<artdaq::detail::SharedMemoryEventSignal> event_signal_;
 	std::unique_ptr<std::vector<artdaq::Fragment>> recvd_fragments_;
 
 	void setupEventReceiver_();
@@ -2,6 +2,7 @@
 
 #include "artdaq/DAQdata/Globals.hh"
 #include "artdaq/ArtModules/NetMonTransportService.h"
+#include "artdaq/ArtModules/detail/FragmentReadBufferFile.hh"
 #include "artdaq/DAQrate/DataSenderManager.hh"
 #include "artdaq-core/Core/SharedMemoryEventReceiver.hh"
 
@@ -40,6 +41,7 @@ NetMonTransportService(fhicl::ParameterSet const& pset, art::ActivityRegistry&)
 	, init_received_(false)
 	, sender_ptr_(nullptr)
 	, incoming_events_(nullptr)
+	, event_signal_(nullptr)
 	, recvd_fragments_(nullptr)
 {
 	TLOG(TLVL_TRACE) << "NetMonTransportService CONSTRUCTOR" ;
@@ -68,6 +70,7 @@ listen()
 	if (!incoming_events_)
 	{
 		incoming_events_.reset(new artdaq::SharedMemoryEventReceiver(data_pset_.get<int>("shared_memory_key", 0xBEE70000 + getppid()), data_pset_.get<int>("broadcast_shared_memory_key", 0xCEE70000 + getppid())));
+		event_signal_.reset(new artdaq::detail::SharedMemoryEventSignal(data_pset_.get<int>("shared_memory_key", 0xBEE70000 + getppid()), false));
 		if (data_pset_.has_key("rank")) my_rank = data_pset_.get<int>("rank");
 		else my_rank = incoming_events_->GetRank();
 	}
@@ -127,6 +130,7 @@ receiveMessage(TBufferFile*& msg)
 			got_event = incoming_events_->ReadyForRead();
 			if (!got_event)
 			{
+				event_signal_->Wait(100000);
 				keep_looping = true;
 			}
 		}
@@ -214,23 +218,23 @@ receiveMessage(TBufferFile*& msg)
 	}
 
 	TLOG(TLVL_TRACE) << "receiveMessage: Returning top Fragment" ;
-	artdaq::Fragment topFrag = std::move(recvd_fragments_->at(0));
+	artdaq::FragmentPtr topFrag(new artdaq::Fragment(std::move(recvd_fragments_->at(0))));
 	recvd_fragments_->erase(recvd_fragments_->begin());
 	if (recvd_fragments_->size() == 0)
 	{
 		recvd_fragments_.reset(nullptr);
 	}
 
-	TLOG(TLVL_TRACE) << "receiveMessage: Copying Fragment into TBufferFile, length=" << topFrag.metadata<artdaq::NetMonHeader>()->data_length ;
-	auto header = topFrag.metadata<artdaq::NetMonHeader>();
-	auto buffer = static_cast<char *>(malloc(header->data_length));
-	memcpy(buffer, &*topFrag.dataBegin(), header->data_length);
-	msg = new TBufferFile(TBuffer::kRead, header->data_length, buffer, kTRUE, 0);
+	TLOG(TLVL_TRACE) << "receiveMessage: Reading TBufferFile from Fragment, length=" << topFrag->metadata<artdaq::NetMonHeader>()->data_length ;
+#if DUMP_RECEIVE_MESSAGE
+	auto sequence_id = topFrag->sequenceID();
+#endif
+	msg = new artdaq::detail::FragmentReadBufferFile(std::move(topFrag));
 
 #if DUMP_RECEIVE_MESSAGE
-	std::string fileName = "receiveMessage_" + std::to_string(my_rank) + "_" + std::to_string(getpid()) + "_" + std::to_string(topFrag.sequenceID()) + ".bin";
+	std::string fileName = "receiveMessage_" + std::to_string(my_rank) + "_" + std::to_string(getpid()) + "_" + std::to_string(sequence_id) + ".bin";
 	std::fstream ostream(fileName.c_str(), std::ios::out | std::ios::binary);
-	ostream.write(buffer, header->data_length);
+	ostream.write(msg->Buffer(), msg->BufferSize());
 	ostream.close();
 #endif
 
@@ -252,8 +256,10 @@ receiveInitMessage(TBufferFile*& msg)
 		while (!got_init) {
 
 			bool got_event = false;
+			got_event = incoming_events_->ReadyForRead(true);
 			while (!got_event)
 			{
+				event_signal_->Wait(100000);
 				got_event = incoming_events_->ReadyForRead(true);
 			}
 
@@ -314,28 +320,23 @@ receiveInitMessage(TBufferFile*& msg)
 	}
 
 	TLOG(TLVL_TRACE) << "receiveInitMessage: Returning top Fragment" ;
-	artdaq::Fragment topFrag = std::move(recvd_fragments_->at(0));
+	artdaq::FragmentPtr topFrag(new artdaq::Fragment(std::move(recvd_fragments_->at(0))));
 	recvd_fragments_->erase(recvd_fragments_->begin());
 	if (recvd_fragments_->size() == 0)
 	{
 		recvd_fragments_.reset(nullptr);
 	}
 
-	auto header = topFrag.metadata<artdaq::NetMonHeader>();
-	TLOG(TLVL_TRACE) << "receiveInitMessage: Copying Fragment into TBufferFile: message length: " << header->data_length ;
-	auto buffer = new char[header->data_length];
-	//auto buffer = static_cast<char *>(malloc(header->data_length)); // Fix alloc-dealloc-mismatch
-	memcpy(buffer, &*topFrag.dataBegin(), header->data_length);
+	TLOG(TLVL_TRACE) << "receiveInitMessage: Reading TBufferFile from Fragment: message length: " << topFrag->metadata<artdaq::NetMonHeader>()->data_length ;
+	msg = new artdaq::detail::FragmentReadBufferFile(std::move(topFrag));
 
 #if DUMP_RECEIVE_MESSAGE
 	std::string fileName = "receiveInitMessage_" + std::to_string(getpid()) + ".bin";
 	std::fstream ostream(fileName.c_str(), std::ios::out | std::ios::binary);
-	ostream.write(buffer, header->data_length);
+	ostream.write(msg->Buffer(), msg->BufferSize());
 	ostream.close();
 #endif
 
-	msg = new TBufferFile(TBuffer::kRead, header->data_length, buffer, kTRUE, 0);
-
 	TLOG(TLVL_TRACE) << "receiveInitMessage END" ;
 	init_received_ = true;
 }
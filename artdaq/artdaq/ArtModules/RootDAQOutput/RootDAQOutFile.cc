@@ -53,9 +53,13 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "fhiclcpp/ParameterSetID.h"
 #include "fhiclcpp/ParameterSetRegistry.h"
+#include "artdaq/DAQdata/Globals.hh"	// metricMan
 #include "tracemf.h"				// TLOG
 #define TRACE_NAME "RootDAQOutFile"
 
+#include "Compression.h"
+#include "TList.h"
+
 #include <algorithm>
 #include <utility>
 #include <vector>
@@ -313,10 +317,27 @@ namespace {
 
 } // unnamed namespace
 
+int
+art::detail::compressionAlgorithmFromName(string const& name)
+{
+  if (name == "ZLIB")
+    return ROOT::kZLIB;
+  if (name == "LZMA")
+    return ROOT::kLZMA;
+  if (name == "LZ4")
+    return ROOT::kLZ4;
+  if (name == "Global")
+    return ROOT::kUseGlobalCompressionSetting;
+  throw Exception(errors::Configuration)
+    << "Unknown compressionAlgorithm \"" << name
+    << "\". Valid values are \"ZLIB\", \"LZMA\", \"LZ4\" and \"Global\".\n";
+}
+
 art::RootDAQOutFile::RootDAQOutFile(OutputModule* om,
                                     string const& fileName,
                                     ClosingCriteria const& fileSwitchCriteria,
                                     int const compressionLevel,
+                                    int const compressionAlgorithm,
                                     unsigned freePercent,
                                     unsigned freeMB,
                                     int64_t const saveMemoryObjectThreshold,
@@ -330,6 +351,7 @@ art::RootDAQOutFile::RootDAQOutFile(OutputModule* om,
   , file_{fileName}
   , fileSwitchCriteria_{fileSwitchCriteria}
   , compressionLevel_{compressionLevel}
+  , compressionAlgorithm_{compressionAlgorithm}
   , freePercent_{freePercent}
   , freeMB_{freeMB}
   , saveMemoryObjectThreshold_{saveMemoryObjectThreshold}
@@ -339,7 +361,13 @@ art::RootDAQOutFile::RootDAQOutFile(OutputModule* om,
   , dropMetaData_{dropMetaData}
   , dropMetaDataForDroppedData_{dropMetaDataForDroppedData}
   , fastCloningEnabledAtConstruction_{fastCloningRequested}
-  , filePtr_{TFile::Open(file_.c_str(), "recreate", "", compressionLevel)}
+  , filePtr_{TFile::Open(
+      file_.c_str(),
+      "recreate",
+      "",
+      ROOT::CompressionSettings(
+        static_cast<ROOT::ECompressionAlgorithm>(compressionAlgorithm),
+        compressionLevel))}
   , treePointers_{{// Order (and number) must match BranchTypes.h!
                    std::make_unique<RootOutputTree>(
                      filePtr_.get(),
@@ -568,6 +596,7 @@ art::RootDAQOutFile::requestsToCloseFile()
 void
 art::RootDAQOutFile::writeOne(EventPrincipal const& e)
 {
+  auto const start = std::chrono::steady_clock::now();
   // Auxiliary branch.
   // Note: pEventAux_ must be set before calling fillBranches
   // since it gets written out in that routine.
@@ -598,6 +627,8 @@ art::RootDAQOutFile::writeOne(EventPrincipal const& e)
   // Add event to index
   fileIndex_.addEntry(pEventAux_->id(), fp_.eventEntryNumber());
   fp_.update<Granularity::Event>(status_);
+  ++eventsWritten_;
+  writeTime_ += std::chrono::steady_clock::now() - start;
 }
 
 void
@@ -847,6 +878,7 @@ art::RootDAQOutFile::writeResults(ResultsPrincipal& resp)
 void
 art::RootDAQOutFile::writeTTrees()
 {
+  auto const start = std::chrono::steady_clock::now();
   RootOutputTree::writeTTree(metaDataTree_);
   RootOutputTree::writeTTree(fileIndexTree_);
   RootOutputTree::writeTTree(parentageTree_);
@@ -855,6 +887,46 @@ art::RootDAQOutFile::writeTTrees()
     auto const branchType = static_cast<BranchType>(i);
     treePointers_[branchType]->writeTree();
   }
+  writeTime_ += std::chrono::steady_clock::now() - start;
+  reportStatistics();
+}
+
+void
+art::RootDAQOutFile::reportStatistics()
+{
+  // Sum over all of the trees in the file, including the metadata trees
+  Long64_t totBytes{0};
+  Long64_t zipBytes{0};
+  TIter next{filePtr_->GetList()};
+  while (auto const obj = next()) {
+    if (auto const tree = dynamic_cast<TTree const*>(obj)) {
+      totBytes += tree->GetTotBytes();
+      zipBytes += tree->GetZipBytes();
+    }
+  }
+
+  using namespace std::chrono;
+  double const fileSeconds{
+    duration_cast<duration<double>>(steady_clock::now() - beginTime_).count()};
+  double const writeSeconds{
+    duration_cast<duration<double>>(writeTime_).count()};
+  double const bytesWritten{static_cast<double>(filePtr_->GetBytesWritten())};
+  double const ratio{zipBytes > 0 ? static_cast<double>(totBytes) / zipBytes : 0.};
+  double const rateMBps{writeSeconds > 0 ? bytesWritten / writeSeconds / 1e6 : 0.};
+
+  TLOG(TLVL_INFO) << "File " << file_ << ": " << eventsWritten_ << " events, "
+                  << totBytes << " bytes compressed to " << zipBytes
+                  << " (ratio " << ratio << ", algorithm "
+                  << compressionAlgorithm_ << " level " << compressionLevel_
+                  << "), " << bytesWritten / 1e6 << " MB written at "
+                  << rateMBps << " MB/s; " << writeSeconds << " of "
+                  << fileSeconds << " s spent writing";
+  if (metricMan) {
+    metricMan->sendMetric("RootDAQOut Compression Ratio", ratio, "", 3, artdaq::MetricMode::LastPoint);
+    metricMan->sendMetric("RootDAQOut Write Rate", rateMBps, "MB/s", 3, artdaq::MetricMode::LastPoint);
+    metricMan->sendMetric("RootDAQOut Write Time", writeSeconds, "s", 3, artdaq::MetricMode::LastPoint);
+    metricMan->sendMetric("RootDAQOut Write Time Fraction", fileSeconds > 0 ? writeSeconds / fileSeconds : 0., "", 3, artdaq::MetricMode::LastPoint);
+  }
 }
 
 template <art::BranchType BT>
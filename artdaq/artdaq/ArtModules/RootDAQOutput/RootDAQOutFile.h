@@ -45,6 +45,13 @@ namespace art {
   class RunAuxiliary;
   class ResultsAuxiliary;
   class RootFileBlock;
+
+  namespace detail {
+    // Map a RootDAQOut compressionAlgorithm name ("ZLIB", "LZMA", "LZ4" or
+    // "Global") to its ROOT::ECompressionAlgorithm value.  Throws an
+    // art::Exception (Configuration) for any other name.
+    int compressionAlgorithmFromName(std::string const& name);
+  }
 }
 
 class art::RootDAQOutFile {
@@ -81,6 +88,7 @@ public: // MEMBER FUNCTIONS
                           std::string const& fileName,
                           ClosingCriteria const& fileSwitchCriteria,
                           int const compressionLevel,
+                          int const compressionAlgorithm,
                           unsigned freePercent,
                           unsigned freeMB,
                           int64_t const saveMemoryObjectThreshold,
@@ -137,6 +145,7 @@ public: // MEMBER FUNCTIONS
 
 private: // MEMBER FUNCTIONS
   void createDatabaseTables();
+  void reportStatistics();
 
   template <BranchType>
   void fillBranches(Principal const&,
@@ -161,6 +170,7 @@ private: // MEMBER DATA
   ClosingCriteria fileSwitchCriteria_;
   OutputFileStatus status_{OutputFileStatus::Closed};
   int const compressionLevel_;
+  int const compressionAlgorithm_;
   unsigned freePercent_;
   unsigned freeMB_;
   int64_t const saveMemoryObjectThreshold_;
@@ -208,6 +218,10 @@ private: // MEMBER DATA
   unsigned runRSID_{-1u};
   std::chrono::steady_clock::time_point beginTime_{
     std::chrono::steady_clock::now()};
+  // Time the art thread spent filling trees (serializing, compressing and
+  // writing baskets), i.e. blocked on output.
+  std::chrono::steady_clock::duration writeTime_{};
+  size_t eventsWritten_{0};
 };
 
 // Local Variables:
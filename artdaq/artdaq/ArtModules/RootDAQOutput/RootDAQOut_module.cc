@@ -34,6 +34,8 @@
 #include "tracemf.h"			// TLOG
 #define TRACE_NAME "RootDAQOut"
 
+#include "TROOT.h"
+
 #include <iomanip>
 #include <memory>
 #include <sstream>
@@ -67,6 +69,15 @@ public:
     OptionalAtom<bool> fastCloning{Name("fastCloning")};
     Atom<std::string> tmpDir{Name("tmpDir"), default_tmpDir};
     Atom<int> compressionLevel{Name("compressionLevel"), 7};
+    // "ZLIB", "LZMA", "LZ4", or "Global" (ROOT's default algorithm)
+    Atom<std::string> compressionAlgorithm{Name("compressionAlgorithm"),
+                                           "Global"};
+    // Threads used by ROOT to compress and flush baskets in parallel with
+    // TTree::Fill; 0 leaves ROOT implicit multi-threading alone.  A non-zero
+    // value turns on ROOT implicit multi-threading for the whole art process,
+    // so every other module's TTrees and RDataFrames also use ROOT's thread
+    // pool, and it stays on after this module is destroyed.
+    Atom<unsigned> compressionThreads{Name("compressionThreads"), 0};
     Atom<unsigned> freePercent{Name("freePercent"), 0};
     Atom<unsigned> freeMB{Name("freeMB"), 0};
     Atom<int64_t> saveMemoryObjectThreshold{Name("saveMemoryObjectThreshold"),
@@ -173,6 +184,7 @@ private:
 
   // We keep this set of data members for the use of RootDAQOutFile.
   int const compressionLevel_;
+  int const compressionAlgorithm_;
   unsigned freePercent_;
   unsigned freeMB_;
   int64_t const saveMemoryObjectThreshold_;
@@ -207,6 +219,8 @@ art::RootDAQOut::RootDAQOut(Parameters const& config)
   , tmpDir_{config().tmpDir() == default_tmpDir ? parent_path(filePattern_) :
                                                   config().tmpDir()}
   , compressionLevel_{config().compressionLevel()}
+  , compressionAlgorithm_{
+      detail::compressionAlgorithmFromName(config().compressionAlgorithm())}
   , freePercent_{config().freePercent()}
   , freeMB_{config().freeMB()}
   , saveMemoryObjectThreshold_{config().saveMemoryObjectThreshold()}
@@ -236,6 +250,20 @@ art::RootDAQOut::RootDAQOut(Parameters const& config)
   fastCloningEnabled_ = detail::shouldFastClone(
     fastCloningSet, fastCloningEnabled_, wantAllEvents(), fileProperties_);
 
+  auto const compressionThreads = config().compressionThreads();
+  if (compressionThreads > 0) {
+    // Implicit MT is process-wide: every TTree created afterwards compresses
+    // and writes its baskets from the ROOT thread pool.
+    if (ROOT::IsImplicitMTEnabled()) {
+      TLOG(TLVL_INFO) << "ROOT implicit multi-threading is already enabled with "
+                      << ROOT::GetImplicitMTPoolSize() << " threads";
+    } else {
+      ROOT::EnableImplicitMT(compressionThreads);
+      TLOG(TLVL_INFO) << "Enabled ROOT implicit multi-threading with "
+                      << compressionThreads << " threads for basket compression";
+    }
+  }
+
   if (!writeParameterSets_) {
     mf::LogWarning("PROVENANCE")
       << "Output module " << moduleLabel_
@@ -517,6 +545,7 @@ art::RootDAQOut::doOpenFile()
                                      unique_filename(tmpDir_ + "/RootDAQOut"),
                                      fileProperties_,
                                      compressionLevel_,
+                                     compressionAlgorithm_,
 	                                 freePercent_,
 	                                 freeMB_,
                                      saveMemoryObjectThreshold_,
@@ -4,6 +4,7 @@
 #include "art/Framework/Principal/OutputHandle.h"
 #include "art/Framework/Principal/RunPrincipal.h"
 #include "art/Framework/Principal/SubRunPrincipal.h"
+#include "artdaq/ArtModules/detail/ProductSerializationPlan.hh"
 #include <TBufferFile.h>
 
 namespace art
@@ -39,6 +40,8 @@ private:
 
 	virtual void closeFile();
 
+	virtual void respondToOpenInputFile(FileBlock const&);
+
 	virtual void respondToCloseInputFile(FileBlock const&);
 
 	virtual void respondToCloseOutputFiles(FileBlock const&);
@@ -51,8 +54,9 @@ private:
 
 	virtual void writeSubRun(SubRunPrincipal&);
 
-	void writeDataProducts(TBufferFile&, const Principal&, std::vector<BranchKey*>&);
+	void writeDataProducts(TBufferFile&, const Principal&);
 
 private:
 	bool initMsgSent_;
+	artdaq::detail::ProductSerializationPlan plan_;
 };
\ No newline at end of file
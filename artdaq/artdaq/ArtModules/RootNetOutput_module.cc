@@ -66,6 +66,7 @@ art::RootNetOutput::
 RootNetOutput(fhicl::ParameterSet const& ps)
 	: OutputModule(ps)
 	, initMsgSent_(false)
+	, plan_()
 {
 	TLOG(TLVL_DEBUG) << "Begin: RootNetOutput::RootNetOutput(ParameterSet const& ps)";
 	ServiceHandle<NetMonTransportService> transport;
@@ -96,6 +97,14 @@ closeFile()
 	TLOG(TLVL_CLOSEFILE) << "Begin/End: RootNetOutput::closeFile()";
 }
 
+void
+art::RootNetOutput::
+respondToOpenInputFile(FileBlock const&)
+{
+	TLOG(TLVL_RESPONDTOCLOSEINPUTFILE) << "Begin/End: RootNetOutput::respondToOpenInputFile(FileBlock const&): The kept products may have changed";
+	plan_.Reset();
+}
+
 void
 art::RootNetOutput::
 respondToCloseInputFile(FileBlock const&)
@@ -288,139 +297,14 @@ send_init_message()
 
 void
 art::RootNetOutput::
-writeDataProducts(TBufferFile& msg, const Principal& principal,
-	std::vector<BranchKey*>& bkv)
+writeDataProducts(TBufferFile& msg, const Principal& principal)
 {
 	TLOG(TLVL_WRITEDATAPRODUCTS) << "Begin: RootNetOutput::writeDataProducts(...)";
 	//
-	//  Fetch the class dictionaries we need for
-	//  writing out the data products.
-	//
-	static TClass* branch_key_class = TClass::GetClass("art::BranchKey");
-	if (branch_key_class == nullptr)
-	{
-		throw art::Exception(art::errors::DictionaryNotFound) <<
-			"RootNetOutput::writeDataProducts(...): "
-			"Could not get TClass for art::BranchKey!";
-	}
-	static TClass* prdprov_class = TClass::GetClass("art::ProductProvenance");
-	if (prdprov_class == nullptr)
-	{
-		throw art::Exception(art::errors::DictionaryNotFound) <<
-			"RootNetOutput::writeDataProducts(...): "
-			"Could not get TClass for art::ProductProvenance!";
-	}
-
-	//
-	//  Calculate the data product count.
-	//
-	unsigned long prd_cnt = 0;
-	//std::map<art::BranchID, std::shared_ptr<art::Group>>::const_iterator
-	for (auto I = principal.begin(), E = principal.end(); I != E; ++I)
-	{
-		auto const& productDescription = I->second->productDescription();
-		auto const& refs = keptProducts()[productDescription.branchType()];
-		bool found = false;
-		for (auto const& ref : refs)
-		{
-			if (*ref == productDescription)
-			{
-				found = true;
-				break;
-			}
-		}
-		if (I->second->productUnavailable() || !found)
-		{
-			continue;
-		}
-		++prd_cnt;
-	}
-	//
-	//  Write the data product count.
+	//  The kept products do not change while an input file is open, so their
+	//  BranchKeys and TClasses are resolved once, by the serialization plan.
 	//
-	TLOG(TLVL_WRITEDATAPRODUCTS) << "RootNetOutput::writeDataProducts(...): Streaming product count: " + std::to_string(prd_cnt);
-	msg.WriteULong(prd_cnt);
-	TLOG(TLVL_WRITEDATAPRODUCTS) << "RootNetOutput::writeDataProducts(...): Finished streaming product count.";
-
-	//
-	//  Loop over the groups in the RunPrincipal and
-	//  write out the data products.
-	//
-	// Note: We need this vector of keys because the ROOT I/O mechanism
-	//       requires that each object inserted in the message has a
-	//       unique address, so we force that by holding on to each
-	//       branch key manufactured in the loop until after we are
-	//       done constructing the message.
-	//
-	bkv.reserve(prd_cnt);
-	//std::map<art::BranchID, std::shared_ptr<art::Group>>::const_iterator
-	for (auto I = principal.begin(), E = principal.end(); I != E; ++I)
-	{
-		auto const& productDescription = I->second->productDescription();
-		auto const& refs = keptProducts()[productDescription.branchType()];
-		bool found = false;
-		for (auto const& ref : refs)
-		{
-			if (*ref == productDescription)
-			{
-				found = true;
-				break;
-			}
-		}
-		if (I->second->productUnavailable() || !found)
-		{
-			continue;
-		}
-		const BranchDescription& bd(I->second->productDescription());
-		bkv.push_back(new BranchKey(bd));
-		TLOG(TLVL_WRITEDATAPRODUCTS_VERBOSE) << "RootNetOutput::writeDataProducts(...): Dumping branch key           of class: '"
-			<< bkv.back()->friendlyClassName_
-			<< "' modlbl: '"
-			<< bkv.back()->moduleLabel_
-			<< "' instnm: '"
-			<< bkv.back()->productInstanceName_
-			<< "' procnm: '"
-			<< bkv.back()->processName_
-			<< "'";
-		TLOG(TLVL_WRITEDATAPRODUCTS) << "RootNetOutput::writeDataProducts(...): "
-			"Streaming branch key         of class: '"
-			<< bd.producedClassName()
-			<< "' modlbl: '"
-			<< bd.moduleLabel()
-			<< "' instnm: '"
-			<< bd.productInstanceName()
-			<< "' procnm: '"
-			<< bd.processName()
-			<< "'";
-		msg.WriteObjectAny(bkv.back(), branch_key_class);
-		TLOG(TLVL_WRITEDATAPRODUCTS) << "RootNetOutput::writeDataProducts(...): "
-			"Streaming product            of class: '"
-			<< bd.producedClassName()
-			<< "' modlbl: '"
-			<< bd.moduleLabel()
-			<< "' instnm: '"
-			<< bd.productInstanceName()
-			<< "' procnm: '"
-			<< bd.processName()
-			<< "'";
-
-		OutputHandle oh = principal.getForOutput(bd.productID(), true);
-		const EDProduct* prd = oh.wrapper();
-		TLOG(TLVL_WRITEDATAPRODUCTS) << "Class for branch " << bd.wrappedName() << " is " << (void*)TClass::GetClass(bd.wrappedName().c_str());
-		msg.WriteObjectAny(prd, TClass::GetClass(bd.wrappedName().c_str()));
-		TLOG(TLVL_WRITEDATAPRODUCTS) << "RootNetOutput::writeDataProducts(...): "
-			"Streaming product provenance of class: '"
-			<< bd.producedClassName()
-			<< "' modlbl: '"
-			<< bd.moduleLabel()
-			<< "' instnm: '"
-			<< bd.productInstanceName()
-			<< "' procnm: '"
-			<< bd.processName()
-			<< "'";
-		const ProductProvenance* prdprov = I->second->productProvenancePtr().get();
-		msg.WriteObjectAny(prdprov, prdprov_class);
-	}
+	plan_.WriteDataProducts(msg, principal, keptProducts());
 	TLOG(TLVL_WRITEDATAPRODUCTS) << "End:   RootNetOutput::writeDataProducts(...)";
 }
 
@@ -515,8 +399,7 @@ write(EventPrincipal& ep)
 	//
 	//  Write data products.
 	//
-	std::vector<BranchKey*> bkv;
-	writeDataProducts(msg, ep, bkv);
+	writeDataProducts(msg, ep);
 	//
 	//  Send message.
 	//
@@ -531,14 +414,6 @@ write(EventPrincipal& ep)
 		transport->sendMessage(ep.id().event(), artdaq::Fragment::DataFragmentType, msg);
 		TLOG(TLVL_WRITE) << "RootNetOutput::write(const EventPrincipal& ep): Message sent.";
 	}
-	//
-	//  Delete the branch keys we created for the message.
-	//
-	for (auto I = bkv.begin(), E = bkv.end(); I != E; ++I)
-	{
-		delete *I;
-		*I = 0;
-	}
 	TLOG(TLVL_WRITE) << "End:   RootNetOutput::write(const EventPrincipal& ep)";
 }
 
@@ -627,8 +502,7 @@ writeRun(RunPrincipal& rp)
 	//
 	//  Write data products.
 	//
-	std::vector<BranchKey*> bkv;
-	writeDataProducts(msg, rp, bkv);
+	writeDataProducts(msg, rp);
 	//
 	//  Send message.
 	//
@@ -643,14 +517,6 @@ writeRun(RunPrincipal& rp)
 		transport->sendMessage(0, artdaq::Fragment::EndOfRunFragmentType, msg);
 		TLOG(TLVL_WRITERUN) << "writeRun: message sent.";
 	}
-	//
-	//  Delete the branch keys we created for the message.
-	//
-	for (auto I = bkv.begin(), E = bkv.end(); I != E; ++I)
-	{
-		delete *I;
-		*I = 0;
-	}
 #endif // 0
 	TLOG(TLVL_WRITERUN) << "End:   RootNetOutput::writeRun(const RunPrincipal& rp)";
 }
@@ -742,8 +608,7 @@ art::RootNetOutput::writeSubRun(SubRunPrincipal& srp)
 	//
 	//  Write data products.
 	//
-	std::vector<BranchKey*> bkv;
-	writeDataProducts(msg, srp, bkv);
+	writeDataProducts(msg, srp);
 	//
 	//  Send message.
 	//
@@ -761,14 +626,6 @@ art::RootNetOutput::writeSubRun(SubRunPrincipal& srp)
 	// allow components downstream to flush data and clean up.
 	//transport->disconnect();
 
-	//
-	//  Delete the branch keys we created for the message.
-	//
-	for (auto I = bkv.begin(), E = bkv.end(); I != E; ++I)
-	{
-		delete *I;
-		*I = 0;
-	}
 	TLOG(TLVL_WRITESUBRUN) << "End:   RootNetOutput::writeSubRun(const SubRunPrincipal& srp)";
 }
 
@@ -32,11 +32,13 @@
 #include "fhiclcpp/ParameterSetID.h"
 #include "fhiclcpp/ParameterSetRegistry.h"
 
+#include "artdaq/ArtModules/detail/FragmentBufferFile.hh"
 #include "artdaq/TransferPlugins/TransferInterface.hh"
 #include "artdaq/TransferPlugins/MakeTransferPlugin.hh"
 #include "artdaq-core/Data/detail/ParentageMap.hh"
 #include "artdaq/DAQdata/Globals.hh"
 #include "artdaq/DAQdata/NetMonHeader.hh"
+#include "artdaq/ArtModules/detail/ProductSerializationPlan.hh"
 
 #include <iomanip>
 #include <iostream>
@@ -67,8 +69,17 @@ public:
 	* \brief TransferOutput Constructor
 	* \param ps ParameterSet used to configure TransferOutput
 	*
-	* TransferOutput accepts no Parameters beyond those which art::OutputModule takes.
+	* \verbatim
+	* TransferOutput accepts the following Parameters:
+	* "send_timeout_us" (Default: 5000000): Timeout for each send attempt
+	* "send_retry_count" (Default: 5): Number of times to retry a send
+	* "event_size_headroom_percent" (Default: 10): Extra space to allocate for an event, relative to the size of the previous event
+	* \endverbatim
+	* TransferOutput also accepts the Parameters which art::OutputModule takes.
 	* See the art::OutputModule documentation for more details on those Parameters.
+	*
+	* Messages are streamed directly into the payload of the Fragment which is sent, and that Fragment is reused
+	* for every message, so its storage only grows when a message is larger than any before it.
 	*/
 	explicit TransferOutput(fhicl::ParameterSet const& ps);
 
@@ -82,6 +93,8 @@ private:
 
 	virtual void closeFile();
 
+	virtual void respondToOpenInputFile(FileBlock const&);
+
 	virtual void respondToCloseInputFile(FileBlock const&);
 
 	virtual void respondToCloseOutputFiles(FileBlock const&);
@@ -94,16 +107,19 @@ private:
 
 	virtual void writeSubRun(SubRunPrincipal&);
 
-	void writeDataProducts(TBufferFile&, const Principal&,
-						   std::vector<BranchKey*>&);
+	void writeDataProducts(TBufferFile&, const Principal&);
 
 private:
 	bool initMsgSent_;
 	size_t send_timeout_us_;
 	size_t send_retry_count_;
+	size_t event_size_headroom_percent_;
+	size_t last_event_bytes_;
 	std::unique_ptr<artdaq::TransferInterface> transfer_;
+	artdaq::FragmentPtr message_fragment_; // Storage for outgoing messages, reused for each message
+	artdaq::detail::ProductSerializationPlan plan_;
 
-	void sendMessage_(uint64_t sequenceId, uint8_t messageType, TBufferFile& msg);
+	void sendMessage_(uint64_t sequenceId, uint8_t messageType, artdaq::detail::FragmentBufferFile& msg);
 	void send_init_message();
 
 };
@@ -114,6 +130,10 @@ TransferOutput(fhicl::ParameterSet const& ps)
 	, initMsgSent_(false)
 	, send_timeout_us_(ps.get<size_t>("send_timeout_us", 5000000))
 	, send_retry_count_(ps.get<size_t>("send_retry_count", 5))
+	, event_size_headroom_percent_(ps.get<size_t>("event_size_headroom_percent", 10))
+	, last_event_bytes_(0)
+	, message_fragment_(artdaq::Fragment::FragmentBytes(0, artdaq::Fragment::InvalidSequenceID, 0, artdaq::Fragment::DataFragmentType, artdaq::NetMonHeader()))
+	, plan_()
 {
 	TLOG(TLVL_DEBUG) << "Begin: TransferOutput::TransferOutput(ParameterSet const& ps)";
 	transfer_ = artdaq::MakeTransferPlugin(ps, "transfer_plugin", artdaq::TransferInterface::Role::kSend);
@@ -145,6 +165,14 @@ closeFile()
 	TLOG(TLVL_TRACE) << "Begin/End: TransferOutput::closeFile()";
 }
 
+void
+art::TransferOutput::
+respondToOpenInputFile(FileBlock const&)
+{
+	TLOG(TLVL_TRACE) << "Begin/End: TransferOutput::respondToOpenInputFile(FileBlock const&): The kept products may have changed";
+	plan_.Reset();
+}
+
 void
 art::TransferOutput::
 respondToCloseInputFile(FileBlock const&)
@@ -219,8 +247,7 @@ send_init_message()
 	//
 	//  Construct and send the init message.
 	//
-	TBufferFile msg(TBuffer::kWrite);
-	msg.SetWriteMode();
+	artdaq::detail::FragmentBufferFile msg(*message_fragment_, 0);
 	//
 	//  Stream the message type code.
 	//
@@ -335,153 +362,16 @@ send_init_message()
 
 void
 art::TransferOutput::
-writeDataProducts(TBufferFile& msg, const Principal& principal,
-				  std::vector<BranchKey*>& bkv)
+writeDataProducts(TBufferFile& msg, const Principal& principal)
 {
-	TLOG(TLVL_TRACE) << " Begin: TransferOutput::writeDataProducts(...)";
-	//
-	//  Fetch the class dictionaries we need for
-	//  writing out the data products.
-	//
-	static TClass* branch_key_class = TClass::GetClass("art::BranchKey");
-	if (branch_key_class == nullptr)
-	{
-		throw art::Exception(art::errors::DictionaryNotFound) <<
-			"TransferOutput::writeDataProducts(...): "
-			"Could not get TClass for art::BranchKey!";
-	}
-	static TClass* prdprov_class = TClass::GetClass("art::ProductProvenance");
-	if (prdprov_class == nullptr)
-	{
-		throw art::Exception(art::errors::DictionaryNotFound) <<
-			"TransferOutput::writeDataProducts(...): "
-			"Could not get TClass for art::ProductProvenance!";
-	}
+	TLOG(TLVL_TRACE) << "Begin: TransferOutput::writeDataProducts(...)";
 	//
-	//  Calculate the data product count.
+	//  The kept products do not change while an input file is open, so their
+	//  BranchKeys and TClasses are resolved once, by the serialization plan.
 	//
-	unsigned long prd_cnt = 0;
-	//std::map<art::BranchID, std::shared_ptr<art::Group>>::const_iterator
-	for (auto I = principal.begin(), E = principal.end(); I != E; ++I)
-	{
-		auto const& productDescription = I->second->productDescription();
-		auto const& refs = keptProducts()[productDescription.branchType()];
-		bool found = false;
-		for (auto const& ref : refs)
-		{
-			if (*ref == productDescription)
-			{
-				found = true;
-				break;
-			}
-		}
-		if (I->second->productUnavailable() || !found)
-		{
-			continue;
-		}
-		++prd_cnt;
-	}
-	//
-	//  Write the data product count.
-	//
-	{
-		TLOG(TLVL_TRACE) << " TransferOutput::writeDataProducts(...): "
-			"Streaming product count: " << prd_cnt;
-		msg.WriteULong(prd_cnt);
-		TLOG(TLVL_TRACE) << " TransferOutput::writeDataProducts(...): "
-			"Finished streaming product count.";
-	}
-	//
-	//  Loop over the groups in the RunPrincipal and
-	//  write out the data products.
-	//
-	// Note: We need this vector of keys because the ROOT I/O mechanism
-	//       requires that each object inserted in the message has a
-	//       unique address, so we force that by holding on to each
-	//       branch key manufactured in the loop until after we are
-	//       done constructing the message.
-	//
-	bkv.reserve(prd_cnt);
-	//std::map<art::BranchID, std::shared_ptr<art::Group>>::const_iterator
-	for (auto I = principal.begin(), E = principal.end(); I != E; ++I)
-	{
-		auto const& productDescription = I->second->productDescription();
-		auto const& refs = keptProducts()[productDescription.branchType()];
-		bool found = false;
-		for (auto const& ref : refs)
-		{
-			if (*ref == productDescription)
-			{
-				found = true;
-				break;
-			}
-		}
-		if (I->second->productUnavailable() || !found)
-		{
-			continue;
-		}
-		const BranchDescription& bd(I->second->productDescription());
-		bkv.push_back(new BranchKey(bd));
-		if (art::debugit() >= 2)
-		{
-			TLOG(TLVL_TRACE) << "TransferOutput::writeDataProducts(...): "
-				"Dumping branch key           of class: '"
-				<< bkv.back()->friendlyClassName_
-				<< "' modlbl: '"
-				<< bkv.back()->moduleLabel_
-				<< "' instnm: '"
-				<< bkv.back()->productInstanceName_
-				<< "' procnm: '"
-				<< bkv.back()->processName_
-				<< "'";
-		}
-		{
-			TLOG(TLVL_TRACE) << " TransferOutput::writeDataProducts(...): "
-				"Streaming branch key         of class: '"
-				+ bd.producedClassName()
-				+ "' modlbl: '"
-				+ bd.moduleLabel()
-				+ "' instnm: '"
-				+ bd.productInstanceName()
-				+ "' procnm: '"
-				+ bd.processName()
-				+ "'";
-			msg.WriteObjectAny(bkv.back(), branch_key_class);
-		}
-		{
-			TLOG(TLVL_TRACE) << " TransferOutput::writeDataProducts(...): "
-				"Streaming product            of class: '"
-				+ bd.producedClassName()
-				+ "' modlbl: '"
-				+ bd.moduleLabel()
-				+ "' instnm: '"
-				+ bd.productInstanceName()
-				+ "' procnm: '"
-				+ bd.processName()
-				+ "'";
-
-			OutputHandle oh = principal.getForOutput(bd.productID(), true);
-			const EDProduct* prd = oh.wrapper();
-			msg.WriteObjectAny(prd, TClass::GetClass(bd.wrappedName().c_str()));
-		}
-		{
-			TLOG(TLVL_TRACE) << " TransferOutput::writeDataProducts(...): "
-				"Streaming product provenance of class: '"
-				+ bd.producedClassName()
-				+ "' modlbl: '"
-				+ bd.moduleLabel()
-				+ "' instnm: '"
-				+ bd.productInstanceName()
-				+ "' procnm: '"
-				+ bd.processName()
-				+ "'";
-			const ProductProvenance* prdprov =
-				I->second->productProvenancePtr().get();
-			msg.WriteObjectAny(prdprov, prdprov_class);
-		}
-	}
-	TLOG(TLVL_TRACE) << " End:   TransferOutput::writeDataProducts(...)";
-	}
+	plan_.WriteDataProducts(msg, principal, keptProducts());
+	TLOG(TLVL_TRACE) << "End:   TransferOutput::writeDataProducts(...)";
+}
 
 void
 art::TransferOutput::
@@ -529,10 +419,9 @@ write(EventPrincipal& ep)
 			"Could not get TClass for art::History!";
 	}
 	//
-	//  Setup message buffer.
+	//  Setup message buffer. Events are usually similar in size, so start from the size of the previous one
 	//
-	TBufferFile msg(TBuffer::kWrite);
-	msg.SetWriteMode();
+	artdaq::detail::FragmentBufferFile msg(*message_fragment_, last_event_bytes_ + last_event_bytes_ * event_size_headroom_percent_ / 100);
 	//
 	//  Write message type code.
 	//
@@ -588,26 +477,18 @@ write(EventPrincipal& ep)
 	//
 	//  Write data products.
 	//
-	std::vector<BranchKey*> bkv;
-	writeDataProducts(msg, ep, bkv);
+	writeDataProducts(msg, ep);
 	//
 	//  Send message.
 	//
 	{
 		TLOG(TLVL_TRACE) << " TransferOutput::write(const EventPrincipal& ep): "
 			"Sending a message ...";
+		last_event_bytes_ = msg.Length();
 		sendMessage_(ep.id().event(), artdaq::Fragment::DataFragmentType, msg);
 		TLOG(TLVL_TRACE) << " TransferOutput::write(const EventPrincipal& ep): "
 			"Message sent.";
 	}
-	//
-	//  Delete the branch keys we created for the message.
-	//
-	for (auto I = bkv.begin(), E = bkv.end(); I != E; ++I)
-	{
-		delete *I;
-		*I = 0;
-	}
 	TLOG(TLVL_TRACE) << " End:   TransferOutput::write(const EventPrincipal& ep)";
 }
 
@@ -705,8 +586,7 @@ writeRun(RunPrincipal& rp)
 	//
 	//  Write data products.
 	//
-	std::vector<BranchKey*> bkv;
-	writeDataProducts(msg, rp, bkv);
+	writeDataProducts(msg, rp);
 	//
 	//  Send message.
 	//
@@ -715,14 +595,6 @@ writeRun(RunPrincipal& rp)
 		sendMessage_(0, artdaq::Fragment::EndOfRunFragmentType, msg);
 		TLOG(TLVL_TRACE) << " writeRun: message sent.");
 	}
-	//
-	//  Delete the branch keys we created for the message.
-	//
-	for (auto I = bkv.begin(), E = bkv.end(); I != E; ++I)
-	{
-		delete *I;
-		*I = 0;
-	}
 #endif // 0
 	TLOG(TLVL_TRACE) << " End:   TransferOutput::writeRun(const RunPrincipal& rp)";
 }
@@ -754,8 +626,7 @@ art::TransferOutput::writeSubRun(SubRunPrincipal& srp)
 	//
 	//  Begin preparing message.
 	//
-	TBufferFile msg(TBuffer::kWrite);
-	msg.SetWriteMode();
+	artdaq::detail::FragmentBufferFile msg(*message_fragment_, 0);
 	//
 	//  Write message type code.
 	//
@@ -831,8 +702,7 @@ art::TransferOutput::writeSubRun(SubRunPrincipal& srp)
 	//
 	//  Write data products.
 	//
-	std::vector<BranchKey*> bkv;
-	writeDataProducts(msg, srp, bkv);
+	writeDataProducts(msg, srp);
 	//
 	//  Send message.
 	//
@@ -844,30 +714,21 @@ art::TransferOutput::writeSubRun(SubRunPrincipal& srp)
 			"EndOfSubrun message(s) sent.";
 
 	}
-	//
-	//  Delete the branch keys we created for the message.
-	//
-	for (auto I = bkv.begin(), E = bkv.end(); I != E; ++I)
-	{
-		delete *I;
-		*I = 0;
-	}
 	TLOG(TLVL_TRACE) << " End:   TransferOutput::writeSubRun(const SubRunPrincipal& srp)";
 	}
 
 
 void
-art::TransferOutput::sendMessage_(uint64_t sequenceId, uint8_t messageType, TBufferFile& msg)
+art::TransferOutput::sendMessage_(uint64_t sequenceId, uint8_t messageType, artdaq::detail::FragmentBufferFile& msg)
 {
 	TLOG(TLVL_DEBUG) << "Sending message with sequenceID=" << sequenceId << ", type=" << (int)messageType << ", length=" << msg.Length();
-	artdaq::NetMonHeader header;
-	header.data_length = static_cast<uint64_t>(msg.Length());
-	artdaq::Fragment
-		fragment(std::ceil(msg.Length() /
-						   static_cast<double>(sizeof(artdaq::RawDataType))),
-				 sequenceId, 0, messageType, header);
-
-	memcpy(&*fragment.dataBegin(), msg.Buffer(), msg.Length());
+	// The message was streamed into message_fragment_, so only its header needs to be filled in
+	msg.Finish();
+	auto& fragment = *message_fragment_;
+	fragment.metadata<artdaq::NetMonHeader>()->data_length = static_cast<uint64_t>(msg.Length());
+	fragment.setSequenceID(sequenceId);
+	fragment.setSystemType(messageType);
+
 	auto sts = artdaq::TransferInterface::CopyStatus::kErrorNotRequiringException;
 	size_t retries = 0;
 	while (sts != artdaq::TransferInterface::CopyStatus::kSuccess && retries <= send_retry_count_)
@@ -0,0 +1,177 @@
+#define TRACE_NAME "AsyncFileWriter"
+
+#include "artdaq/ArtModules/detail/AsyncFileWriter.hh"
+#include "artdaq/DAQdata/Globals.hh"
+
+#include "cetlib_except/exception.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+artdaq::detail::AsyncFileWriter::AsyncFileWriter(std::string const& file_name, size_t buffer_bytes, size_t buffer_count, bool direct_io)
+	: file_name_(file_name)
+	, fd_(-1)
+	, direct_io_(direct_io)
+	, buffer_bytes_(std::max((buffer_bytes + ALIGNMENT - 1) / ALIGNMENT, size_t(1)) * ALIGNMENT)
+	, bytes_(0)
+	, buffers_(std::max(buffer_count, size_t(2)))
+	, current_(nullptr)
+	, mutex_()
+	, cv_()
+	, free_()
+	, full_()
+	, stop_(false)
+	, error_(0)
+	, writer_()
+{
+	fd_ = open(file_name_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | (direct_io_ ? O_DIRECT : 0), 0660);
+	if (fd_ < 0)
+	{
+		throw cet::exception("AsyncFileWriter") << "Could not open " << file_name_ << ": " << strerror(errno);
+	}
+
+	for (auto& buffer : buffers_)
+	{
+		void* data = nullptr;
+		if (posix_memalign(&data, ALIGNMENT, buffer_bytes_) != 0)
+		{
+			for (auto& allocated : buffers_) free(allocated.data);
+			close(fd_);
+			throw cet::exception("AsyncFileWriter") << "Could not allocate " << buffer_bytes_ << " bytes for a write buffer";
+		}
+		buffer.data = static_cast<char*>(data);
+		buffer.used = 0;
+		free_.push_back(&buffer);
+	}
+	current_ = free_.front();
+	free_.pop_front();
+
+	TLOG(TLVL_DEBUG) << "Writing " << file_name_ << " through " << buffers_.size() << " buffers of " << buffer_bytes_ << " bytes, direct_io=" << std::boolalpha << direct_io_;
+	writer_ = std::thread(&AsyncFileWriter::writerLoop_, this);
+}
+
+artdaq::detail::AsyncFileWriter::~AsyncFileWriter()
+{
+	try
+	{
+		Close();
+	}
+	catch (cet::exception const& e)
+	{
+		TLOG(TLVL_ERROR) << "Error closing " << file_name_ << ": " << e.what();
+	}
+	for (auto& buffer : buffers_) free(buffer.data);
+}
+
+void artdaq::detail::AsyncFileWriter::Write(void const* data, size_t bytes)
+{
+	checkError_();
+	auto src = static_cast<char const*>(data);
+	bytes_ += bytes;
+	while (bytes > 0)
+	{
+		auto chunk = std::min(bytes, buffer_bytes_ - current_->used);
+		memcpy(current_->data + current_->used, src, chunk);
+		current_->used += chunk;
+		src += chunk;
+		bytes -= chunk;
+
+		if (current_->used == buffer_bytes_) queueCurrent_();
+	}
+}
+
+void artdaq::detail::AsyncFileWriter::Close()
+{
+	if (fd_ < 0) return;
+
+	std::unique_lock<std::mutex> lk(mutex_);
+	if (current_ && current_->used > 0)
+	{
+		// O_DIRECT only allows whole aligned blocks, so pad the last buffer, and cut the file back afterwards
+		auto padded = (current_->used + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		memset(current_->data + current_->used, 0, padded - current_->used);
+		current_->used = padded;
+		full_.push_back(current_);
+	}
+	current_ = nullptr;
+	stop_ = true;
+	cv_.notify_all();
+	lk.unlock();
+
+	writer_.join();
+
+	if (error_ == 0 && ftruncate(fd_, bytes_) != 0) error_ = errno;
+	close(fd_);
+	fd_ = -1;
+	TLOG(TLVL_DEBUG) << "Closed " << file_name_ << " after writing " << bytes_ << " bytes";
+	checkError_();
+}
+
+void artdaq::detail::AsyncFileWriter::queueCurrent_()
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	full_.push_back(current_);
+	cv_.notify_all();
+
+	if (free_.empty()) TLOG(TLVL_TRACE) << "All buffers are waiting to be written, waiting for the disk";
+	cv_.wait(lk, [this] { return !free_.empty(); });
+	current_ = free_.front();
+	free_.pop_front();
+}
+
+void artdaq::detail::AsyncFileWriter::writerLoop_()
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	while (true)
+	{
+		cv_.wait(lk, [this] { return !full_.empty() || stop_; });
+		if (full_.empty()) break;
+
+		auto buffer = full_.front();
+		auto failed = error_ != 0; // After a failed write, buffers are only recycled, so that Write never blocks
+		lk.unlock();
+		auto write_errno = 0;
+		if (!failed && !writeAll_(buffer->data, buffer->used)) write_errno = errno;
+		lk.lock();
+
+		full_.pop_front();
+		buffer->used = 0;
+		free_.push_back(buffer);
+		if (write_errno != 0)
+		{
+			error_ = write_errno;
+			TLOG(TLVL_ERROR) << "Error writing " << file_name_ << ": " << strerror(error_);
+		}
+		cv_.notify_all();
+	}
+}
+
+bool artdaq::detail::AsyncFileWriter::writeAll_(char const* data, size_t bytes)
+{
+	while (bytes > 0)
+	{
+		auto sts = ::write(fd_, data, bytes);
+		if (sts < 0)
+		{
+			if (errno == EINTR) continue;
+			return false;
+		}
+		data += sts;
+		bytes -= sts;
+	}
+	return true;
+}
+
+void artdaq::detail::AsyncFileWriter::checkError_()
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	if (error_ != 0)
+	{
+		throw cet::exception("AsyncFileWriter") << "Error writing " << file_name_ << ": " << strerror(error_);
+	}
+}
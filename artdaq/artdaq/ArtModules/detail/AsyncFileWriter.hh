@@ -0,0 +1,100 @@
+#ifndef artdaq_ArtModules_detail_AsyncFileWriter_hh
+#define artdaq_ArtModules_detail_AsyncFileWriter_hh
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace artdaq
+{
+	namespace detail
+	{
+		/**
+		 * \brief Writes a file from a background thread, so that the caller does not wait for the disk
+		 *
+		 * Data passed to Write is gathered into large, page-aligned buffers. Each full buffer is handed to the
+		 * writer thread while the caller goes on filling the next one; the caller only waits when every buffer
+		 * is still queued for writing. Because the buffers are aligned and written in whole buffers, the file may
+		 * be opened with O_DIRECT. Close writes out the last partial buffer.
+		 */
+		class AsyncFileWriter
+		{
+		public:
+			/**
+			 * \brief AsyncFileWriter Constructor. Opens the file and starts the writer thread
+			 * \param file_name Name of the file to write. An existing file is truncated
+			 * \param buffer_bytes Size of each buffer. Rounded up to a multiple of the alignment
+			 * \param buffer_count Number of buffers (at least 2)
+			 * \param direct_io Whether to open the file with O_DIRECT
+			 */
+			AsyncFileWriter(std::string const& file_name, size_t buffer_bytes, size_t buffer_count, bool direct_io);
+
+			/**
+			 * \brief AsyncFileWriter Destructor. Closes the file if Close was not called
+			 */
+			~AsyncFileWriter();
+
+			/**
+			 * \brief Append data to the file
+			 * \param data Data to write
+			 * \param bytes Number of bytes to write
+			 * \exception cet::exception If the writer thread failed to write an earlier buffer
+			 */
+			void Write(void const* data, size_t bytes);
+
+			/**
+			 * \brief Write out any buffered data, stop the writer thread and close the file
+			 * \exception cet::exception If any write failed
+			 */
+			void Close();
+
+			/**
+			 * \brief Get the number of bytes passed to Write
+			 * \return The size which the file will have once it is closed
+			 */
+			size_t size() const { return bytes_; }
+
+			/**
+			 * \brief The alignment of the buffers, and of the blocks written to the file
+			 */
+			static const size_t ALIGNMENT = 4096;
+
+		private:
+			AsyncFileWriter(AsyncFileWriter const&) = delete;
+			AsyncFileWriter& operator=(AsyncFileWriter const&) = delete;
+
+			struct Buffer
+			{
+				char* data;
+				size_t used;
+			};
+
+			void queueCurrent_();
+			void writerLoop_();
+			bool writeAll_(char const* data, size_t bytes);
+			void checkError_();
+
+			std::string file_name_;
+			int fd_;
+			bool direct_io_;
+			size_t buffer_bytes_;
+			size_t bytes_;
+
+			std::vector<Buffer> buffers_;
+			Buffer* current_;
+
+			std::mutex mutex_;
+			std::condition_variable cv_;
+			std::deque<Buffer*> free_;
+			std::deque<Buffer*> full_;
+			bool stop_;
+			int error_; // errno of the first failed write
+			std::thread writer_;
+		};
+	}
+}
+
+#endif // artdaq_ArtModules_detail_AsyncFileWriter_hh
@@ -0,0 +1,95 @@
+#ifndef artdaq_ArtModules_detail_ContainedFragmentType_hh
+#define artdaq_ArtModules_detail_ContainedFragmentType_hh
+
+#include "artdaq/DAQdata/FragmentView.hh"
+#include "artdaq-core/Data/ContainerFragment.hh"
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace artdaq
+{
+	namespace detail
+	{
+		/**
+		 * \brief Get the type of the Fragments held by a ContainerFragment
+		 * \param frag A Fragment of ContainerFragmentType
+		 * \return The type of the contained Fragments
+		 */
+		inline Fragment::type_t containedFragmentType(Fragment const& frag)
+		{
+			ContainerFragment cf(frag);
+			return cf.fragment_type();
+		}
+
+		/**
+		 * \brief Get the type of the Fragments held by a ContainerFragment
+		 * \param view A FragmentView of a Fragment of ContainerFragmentType
+		 * \return The type of the contained Fragments, or InvalidFragmentType if the container has no metadata
+		 */
+		inline Fragment::type_t containedFragmentType(FragmentView const& view)
+		{
+			auto metadata = view.metadata<ContainerFragment::Metadata>();
+			return metadata ? metadata->fragment_type : static_cast<Fragment::type_t>(Fragment::InvalidFragmentType);
+		}
+
+		/**
+		 * \brief Append a copy of a Fragment to a Fragments product
+		 * \param out Product to append to
+		 * \param frag Fragment to copy
+		 */
+		inline void appendFragment(Fragments& out, Fragment const& frag) { out.emplace_back(frag); }
+
+		/**
+		 * \brief Append a copy of the viewed Fragment to a Fragments product
+		 * \param out Product to append to
+		 * \param view View of the Fragment to copy
+		 */
+		inline void appendFragment(Fragments& out, FragmentView const& view) { out.emplace_back(view.copy()); }
+
+		/**
+		 * \brief Append a view of a Fragment to a FragmentViews product. Nothing is copied
+		 * \param out Product to append to
+		 * \param frag Fragment to view
+		 */
+		inline void appendFragment(FragmentViews& out, Fragment const& frag) { out.emplace_back(&*frag.headerBegin()); }
+
+		/**
+		 * \brief Append a view of a Fragment to a FragmentViews product. Nothing is copied
+		 * \param out Product to append to
+		 * \param view View of the Fragment
+		 */
+		inline void appendFragment(FragmentViews& out, FragmentView const& view) { out.emplace_back(view); }
+
+		/**
+		 * \brief Sort ContainerFragments into one product per contained Fragment type
+		 * \tparam Product Type of the output products (Fragments or FragmentViews)
+		 * \tparam T Type of the input (Fragment or FragmentView)
+		 * \param containers ContainerFragments to sort
+		 * \param type_map Names of the known Fragment types
+		 * \param instance_prefix Instance name of the containers. Each one goes into the product named instance_prefix + the name of
+		 * its contained type, or instance_prefix if the type is not known
+		 * \param products Output products, by instance name. Missing products are created
+		 */
+		template <class Product, class T>
+		void sortContainerFragments(std::vector<T> const& containers, std::map<Fragment::type_t, std::string> const& type_map,
+		                            std::string const& instance_prefix, std::map<std::string, std::unique_ptr<Product>>& products)
+		{
+			for (auto& container : containers)
+			{
+				auto contained_type = type_map.find(containedFragmentType(container));
+				auto instance = instance_prefix;
+				if (contained_type != type_map.end()) instance += contained_type->second;
+
+				auto& product = products[instance];
+				if (!product) product = std::make_unique<Product>();
+				appendFragment(*product, container);
+			}
+		}
+	}
+}
+
+#endif // artdaq_ArtModules_detail_ContainedFragmentType_hh
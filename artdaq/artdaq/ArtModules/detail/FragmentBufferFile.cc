@@ -0,0 +1,58 @@
+#define TRACE_NAME "FragmentBufferFile"
+
+#include "artdaq/ArtModules/detail/FragmentBufferFile.hh"
+#include "artdaq/DAQdata/Globals.hh"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	// ROOT's reallocation callback does not carry any context, so the buffers in use on this thread are
+	// found by their current memory address
+	thread_local std::vector<artdaq::detail::FragmentBufferFile*> active_buffers;
+
+	// TBuffer needs at least this much space to start with
+	const size_t MINIMUM_BYTES = 1024;
+}
+
+artdaq::detail::FragmentBufferFile::FragmentBufferFile(Fragment& fragment, size_t initial_bytes)
+	: TBufferFile(TBuffer::kWrite, static_cast<Int_t>(std::max(initial_bytes, MINIMUM_BYTES)),
+	              prepare_(fragment, std::max(initial_bytes, MINIMUM_BYTES)), kFALSE, &reAllocFragment_)
+	, fragment_(fragment)
+{
+	SetWriteMode();
+	active_buffers.push_back(this);
+}
+
+artdaq::detail::FragmentBufferFile::~FragmentBufferFile()
+{
+	auto it = std::find(active_buffers.begin(), active_buffers.end(), this);
+	if (it != active_buffers.end()) active_buffers.erase(it);
+}
+
+void artdaq::detail::FragmentBufferFile::Finish()
+{
+	// Shrinking does not reallocate, so Buffer() stays valid
+	fragment_.resizeBytes(Length());
+}
+
+char* artdaq::detail::FragmentBufferFile::prepare_(Fragment& fragment, size_t bytes)
+{
+	fragment.resizeBytes(bytes);
+	return reinterpret_cast<char*>(fragment.dataBeginBytes());
+}
+
+char* artdaq::detail::FragmentBufferFile::reAllocFragment_(char* current, size_t new_size, size_t old_size)
+{
+	for (auto buffer : active_buffers)
+	{
+		if (buffer->Buffer() != current) continue;
+
+		TLOG(TLVL_DEBUG) << "Growing Fragment payload from " << old_size << " to " << new_size << " bytes";
+		// Fragment::resizeBytes keeps the existing payload, which is the data ROOT has streamed so far
+		return prepare_(buffer->fragment_, new_size);
+	}
+	TLOG(TLVL_ERROR) << "Buffer to reallocate does not belong to a FragmentBufferFile on this thread!";
+	return nullptr;
+}
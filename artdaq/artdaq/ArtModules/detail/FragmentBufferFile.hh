@@ -0,0 +1,51 @@
+#ifndef artdaq_ArtModules_detail_FragmentBufferFile_hh
+#define artdaq_ArtModules_detail_FragmentBufferFile_hh
+
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <TBufferFile.h>
+
+namespace artdaq
+{
+	namespace detail
+	{
+		/**
+		 * \brief A TBufferFile which streams directly into the payload of an artdaq::Fragment
+		 *
+		 * When ROOT needs more room, the Fragment payload is grown in place of ROOT's own buffer, so the
+		 * serialized data never has to be copied out of an intermediate buffer before it is sent.
+		 * The Fragment's header and metadata are left untouched.
+		 */
+		class FragmentBufferFile : public TBufferFile
+		{
+		public:
+			/**
+			 * \brief FragmentBufferFile Constructor
+			 * \param fragment Fragment to stream into. Its payload is resized, and must not be modified while the FragmentBufferFile is in use
+			 * \param initial_bytes Expected size of the streamed data. The payload is grown if more is written
+			 */
+			FragmentBufferFile(Fragment& fragment, size_t initial_bytes);
+
+			/**
+			 * \brief FragmentBufferFile Destructor
+			 */
+			virtual ~FragmentBufferFile();
+
+			/**
+			 * \brief Trim the Fragment payload to the length of the streamed data
+			 */
+			void Finish();
+
+		private:
+			FragmentBufferFile(FragmentBufferFile const&) = delete;
+			FragmentBufferFile& operator=(FragmentBufferFile const&) = delete;
+
+			static char* prepare_(Fragment& fragment, size_t bytes);
+			static char* reAllocFragment_(char* current, size_t new_size, size_t old_size);
+
+			Fragment& fragment_;
+		};
+	}
+}
+
+#endif // artdaq_ArtModules_detail_FragmentBufferFile_hh
@@ -0,0 +1,52 @@
+#ifndef artdaq_ArtModules_detail_FragmentReadBufferFile_hh
+#define artdaq_ArtModules_detail_FragmentReadBufferFile_hh
+
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq/DAQdata/NetMonHeader.hh"
+
+#include <TBufferFile.h>
+
+namespace artdaq
+{
+	namespace detail
+	{
+		/**
+		 * \brief A TBufferFile which reads a streamed art message in place from the payload of the artdaq::Fragment it arrived in
+		 *
+		 * The Fragment is owned by the FragmentReadBufferFile, so the payload stays valid for as long as ROOT reads from it,
+		 * and is released along with the buffer. This class is header-only so that services which cannot link
+		 * against artdaq_ArtModules may use it.
+		 */
+		class FragmentReadBufferFile : public TBufferFile
+		{
+		public:
+			/**
+			 * \brief FragmentReadBufferFile Constructor
+			 * \param fragment Fragment with a NetMonHeader and the streamed message as its payload. Ownership is taken
+			 */
+			explicit FragmentReadBufferFile(FragmentPtr fragment)
+				: TBufferFile(TBuffer::kRead, static_cast<Int_t>(fragment->metadata<NetMonHeader>()->data_length),
+				              fragment->dataBeginBytes(), kFALSE, 0)
+				, fragment_(std::move(fragment)) {}
+
+			/**
+			 * \brief FragmentReadBufferFile Destructor
+			 */
+			virtual ~FragmentReadBufferFile() = default;
+
+			/**
+			 * \brief Get the Fragment being read
+			 * \return Reference to the Fragment holding the message
+			 */
+			Fragment const& fragment() const { return *fragment_; }
+
+		private:
+			FragmentReadBufferFile(FragmentReadBufferFile const&) = delete;
+			FragmentReadBufferFile& operator=(FragmentReadBufferFile const&) = delete;
+
+			FragmentPtr fragment_;
+		};
+	}
+}
+
+#endif // artdaq_ArtModules_detail_FragmentReadBufferFile_hh
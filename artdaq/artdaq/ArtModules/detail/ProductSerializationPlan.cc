@@ -0,0 +1,70 @@
+#define TRACE_NAME "ProductSerializationPlan"
+
+#include "artdaq/ArtModules/detail/ProductSerializationPlan.hh"
+#include "artdaq/DAQdata/Globals.hh"
+
+#include "canvas/Utilities/Exception.h"
+
+artdaq::detail::ProductSerializationPlan::ProductSerializationPlan()
+	: branches_()
+	, built_()
+	, branch_key_class_(TClass::GetClass("art::BranchKey"))
+	, provenance_class_(TClass::GetClass("art::ProductProvenance"))
+{
+	if (branch_key_class_ == nullptr)
+	{
+		throw art::Exception(art::errors::DictionaryNotFound) <<
+			"ProductSerializationPlan: Could not get TClass for art::BranchKey!";
+	}
+	if (provenance_class_ == nullptr)
+	{
+		throw art::Exception(art::errors::DictionaryNotFound) <<
+			"ProductSerializationPlan: Could not get TClass for art::ProductProvenance!";
+	}
+	built_.fill(false);
+}
+
+void artdaq::detail::ProductSerializationPlan::Reset()
+{
+	TLOG(TLVL_DEBUG) << "Reset: Forgetting " << branches_.size() << " products";
+	branches_.clear();
+	built_.fill(false);
+}
+
+artdaq::detail::ProductSerializationPlan::Branch const&
+artdaq::detail::ProductSerializationPlan::Add(art::ProductID id, art::BranchKey const& key, std::string const& wrapped_name)
+{
+	auto product_class = TClass::GetClass(wrapped_name.c_str());
+	if (product_class == nullptr)
+	{
+		throw art::Exception(art::errors::DictionaryNotFound) <<
+			"ProductSerializationPlan: Could not get TClass for " << wrapped_name << "!";
+	}
+	TLOG(TLVL_DEBUG) << "Add: Product of class '" << key.friendlyClassName_
+		<< "' modlbl: '" << key.moduleLabel_
+		<< "' instnm: '" << key.productInstanceName_
+		<< "' procnm: '" << key.processName_
+		<< "' uses TClass " << (void*)product_class;
+
+	branches_.erase(id);
+	return branches_.emplace(id, Branch{ key, product_class }).first->second;
+}
+
+artdaq::detail::ProductSerializationPlan::Branch const*
+artdaq::detail::ProductSerializationPlan::Find(art::ProductID id) const
+{
+	auto it = branches_.find(id);
+	return it != branches_.end() ? &it->second : nullptr;
+}
+
+void artdaq::detail::ProductSerializationPlan::WriteProduct(TBufferFile& msg, Branch const& branch, art::EDProduct const* product, art::ProductProvenance const* provenance) const
+{
+	TLOG(TLVL_TRACE) << "WriteProduct: Streaming product of class '" << branch.key.friendlyClassName_
+		<< "' modlbl: '" << branch.key.moduleLabel_
+		<< "' instnm: '" << branch.key.productInstanceName_
+		<< "' procnm: '" << branch.key.processName_ << "'";
+	// ROOT requires each object in a message to have a unique address; the BranchKeys in branches_ do
+	msg.WriteObjectAny(&branch.key, branch_key_class_);
+	msg.WriteObjectAny(product, branch.product_class);
+	msg.WriteObjectAny(provenance, provenance_class_);
+}
@@ -0,0 +1,144 @@
+#ifndef artdaq_ArtModules_detail_ProductSerializationPlan_hh
+#define artdaq_ArtModules_detail_ProductSerializationPlan_hh
+
+#include "art/Framework/Principal/OutputHandle.h"
+#include "art/Framework/Principal/Principal.h"
+#include "canvas/Persistency/Common/EDProduct.h"
+#include "canvas/Persistency/Provenance/BranchDescription.h"
+#include "canvas/Persistency/Provenance/BranchKey.h"
+#include "canvas/Persistency/Provenance/BranchType.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "canvas/Persistency/Provenance/ProductProvenance.h"
+
+#include <TBufferFile.h>
+#include <TClass.h>
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace artdaq
+{
+	namespace detail
+	{
+		/**
+		 * \brief Everything needed to stream the data products kept by an art::OutputModule, resolved once instead of for every event
+		 *
+		 * The set of kept products is fixed once the input file is open, so the BranchKey and the TClass of each kept
+		 * product are built the first time a product of its BranchType is written, and reused afterwards. Reset must be
+		 * called when the kept products may have changed (i.e. when a new input file is opened).
+		 */
+		class ProductSerializationPlan
+		{
+		public:
+			/**
+			 * \brief The resolved streaming information for one kept product
+			 */
+			struct Branch
+			{
+				art::BranchKey key; ///< BranchKey written ahead of the product. Its address is stable, as ROOT requires
+				TClass* product_class; ///< TClass of the product's art::Wrapper
+			};
+
+			/**
+			 * \brief ProductSerializationPlan Constructor
+			 */
+			ProductSerializationPlan();
+
+			/**
+			 * \brief Forget all resolved products
+			 */
+			void Reset();
+
+			/**
+			 * \brief Add a product to the plan
+			 * \param id ProductID of the product
+			 * \param key BranchKey of the product
+			 * \param wrapped_name Class name of the product's art::Wrapper
+			 * \return The plan entry for the product
+			 * \exception art::Exception if there is no dictionary for wrapped_name
+			 */
+			Branch const& Add(art::ProductID id, art::BranchKey const& key, std::string const& wrapped_name);
+
+			/**
+			 * \brief Find a product in the plan
+			 * \param id ProductID of the product
+			 * \return The plan entry for the product, or nullptr if it is not in the plan
+			 */
+			Branch const* Find(art::ProductID id) const;
+
+			/**
+			 * \brief Stream one product (its BranchKey, the product and its provenance)
+			 * \param msg Message to stream into
+			 * \param branch Plan entry of the product
+			 * \param product The product's art::Wrapper
+			 * \param provenance The product's provenance
+			 */
+			void WriteProduct(TBufferFile& msg, Branch const& branch, art::EDProduct const* product, art::ProductProvenance const* provenance) const;
+
+			/**
+			 * \brief Stream the product count, then each available kept product of a Principal
+			 * \tparam SelectionsArray Type of the kept products (art::OutputModule::keptProducts())
+			 * \param msg Message to stream into
+			 * \param principal Principal holding the products
+			 * \param kept Kept products of the art::OutputModule, for each BranchType
+			 */
+			template <class SelectionsArray>
+			void WriteDataProducts(TBufferFile& msg, art::Principal const& principal, SelectionsArray const& kept);
+
+		private:
+			template <class SelectionsArray>
+			Branch const* find_(art::BranchDescription const& bd, SelectionsArray const& kept);
+
+			std::map<art::ProductID, Branch> branches_; // std::map, so that the BranchKeys never move
+			std::array<bool, art::NumBranchTypes> built_;
+			TClass* branch_key_class_;
+			TClass* provenance_class_;
+		};
+	}
+}
+
+template <class SelectionsArray>
+artdaq::detail::ProductSerializationPlan::Branch const*
+artdaq::detail::ProductSerializationPlan::find_(art::BranchDescription const& bd, SelectionsArray const& kept)
+{
+	auto type = bd.branchType();
+	if (!built_[type])
+	{
+		for (auto const& ref : kept[type])
+		{
+			// Transient products (e.g. artdaq::FragmentViews) are never sent
+			if (ref->transient()) continue;
+			Add(ref->productID(), art::BranchKey(*ref), ref->wrappedName());
+		}
+		built_[type] = true;
+	}
+	return Find(bd.productID());
+}
+
+template <class SelectionsArray>
+void
+artdaq::detail::ProductSerializationPlan::WriteDataProducts(TBufferFile& msg, art::Principal const& principal, SelectionsArray const& kept)
+{
+	unsigned long prd_cnt = 0;
+	for (auto I = principal.begin(), E = principal.end(); I != E; ++I)
+	{
+		if (I->second->productUnavailable() || find_(I->second->productDescription(), kept) == nullptr) continue;
+		++prd_cnt;
+	}
+	msg.WriteULong(prd_cnt);
+
+	for (auto I = principal.begin(), E = principal.end(); I != E; ++I)
+	{
+		if (I->second->productUnavailable()) continue;
+		auto const& bd = I->second->productDescription();
+		auto branch = find_(bd, kept);
+		if (branch == nullptr) continue;
+
+		art::OutputHandle oh = principal.getForOutput(bd.productID(), true);
+		WriteProduct(msg, *branch, oh.wrapper(), I->second->productProvenancePtr().get());
+	}
+}
+
+#endif // artdaq_ArtModules_detail_ProductSerializationPlan_hh
@@ -2,6 +2,9 @@
 #define artdaq_ArtModules_detail_SharedMemoryReader_hh
 
 #include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQdata/FragmentView.hh"
+#include "artdaq/ArtModules/detail/ContainedFragmentType.hh"
+#include "artdaq/DAQrate/detail/SharedMemoryEventSignal.hh"
 #include "artdaq-core/Utilities/ExceptionHandler.hh"
 #include "art/Framework/Core/Frameworkfwd.h"
 
@@ -19,11 +22,16 @@
 #include "artdaq-core/Core/SharedMemoryEventReceiver.hh"
 #include "art/Framework/IO/Sources/put_product_in_principal.h"
 #include "canvas/Persistency/Provenance/FileFormatVersion.h"
+#include "cetlib_except/exception.h"
 #include <sys/time.h>
 
 
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <map>
+#include <set>
+#include <thread>
 #include "artdaq-core/Data/RawEvent.hh"
 
 namespace artdaq
@@ -56,6 +64,10 @@ namespace artdaq
 			bool shutdownMsgReceived; ///< Whether a shutdown message has been received
 			bool outputFileCloseNeeded; ///< If an explicit output file close message is needed
 			size_t bytesRead; ///< running total of number of bytes received
+			bool use_fragment_views; ///< Whether FragmentViews of the shared memory buffer are put into the event instead of Fragments
+			bool unpack_container_fragments; ///< Whether ContainerFragments are sorted into products by the type of Fragment they hold
+			size_t shared_memory_buffer_size; ///< Size of the data shared memory buffers, which bounds the search for FragmentViews
+			size_t stale_buffer_timeout_usec; ///< Time after which an untouched shared memory buffer may be taken back from this reader
 			//std::unique_ptr<SharedMemoryManager> data_shm; ///< SharedMemoryManager containing data
 			//std::unique_ptr<SharedMemoryManager> broadcast_shm; ///< SharedMemoryManager containing broadcasts (control Fragments)
 
@@ -71,6 +83,16 @@ namespace artdaq
 			 * "resume_after_timeout" (Default: true): Whether to continue receiving data after a timeout
 			 * "raw_data_label" (Default: "daq"): The label to use for all raw data
 			 * "shared_memory_key" (Default: 0xBEE7): The key for the shared memory segment
+			 * "use_fragment_views" (Default: false): Put artdaq::FragmentViews into the event instead of artdaq::Fragments. The views
+			 *   refer to the data in place in the shared memory buffer, which is held until the next event is read. While it is held,
+			 *   the buffer is touched every stale_buffer_timeout_usec / 4, so that it is not declared stale and given to another reader
+			 * "shared_memory_buffer_size" (Default: 0): Size of the data shared memory buffers. Set by SharedMemoryEventManager. If 0,
+			 *   FragmentViews of the copied Fragments are used
+			 * "stale_buffer_timeout_usec" (Default: 0): The stale_buffer_timeout_usec of the data shared memory. Set by
+			 *   SharedMemoryEventManager. 0 means buffers are never declared stale, so held buffers are not touched
+			 * "unpack_container_fragments" (Default: true): Put ContainerFragments into the "Container<type>" instance for the type of
+			 *   Fragment they hold. If false, all ContainerFragments go into the "Container" instance, and a ContainerFragmentUnpacker
+			 *   module can sort them later, only for the events which reach it
 			 * \endverbatim
 			 */
 			SharedMemoryReader(fhicl::ParameterSet const& ps,
@@ -84,8 +106,19 @@ namespace artdaq
 				, shutdownMsgReceived(false)
 				, outputFileCloseNeeded(false)
 				, bytesRead(0)
+				, use_fragment_views(ps.get<bool>("use_fragment_views", false))
+				, unpack_container_fragments(ps.get<bool>("unpack_container_fragments", true))
+				, shared_memory_buffer_size(ps.get<size_t>("shared_memory_buffer_size", 0))
+				, stale_buffer_timeout_usec(ps.get<size_t>("stale_buffer_timeout_usec", 0))
 				, fragment_type_map_(getDefaultTypes())
 				, readNext_calls_(0)
+				, holding_buffer_(false)
+				, copied_fragments_()
+				, event_signal_()
+				, hold_mutex_()
+				, hold_cv_()
+				, stop_hold_refresh_(false)
+				, hold_refresh_thread_()
 			{
 				try {
 					if (metricMan)
@@ -106,20 +139,37 @@ namespace artdaq
 				//	broadcast_shm.reset(new SharedMemoryManager(ps.get<uint32_t>("broadcast_shared_memory_key", 0xCEE70000 + getppid()), ps.get<int>("broadcast_buffer_count", 5), ps.get<size_t>("broadcast_buffer_size", 0x100000)));
 				//}
 				incoming_events.reset(new SharedMemoryEventReceiver(ps.get<uint32_t>("shared_memory_key", 0xBEE70000 + getppid()), ps.get<uint32_t>("broadcast_shared_memory_key", 0xCEE70000 + getppid())));
+				event_signal_.reset(new SharedMemoryEventSignal(ps.get<uint32_t>("shared_memory_key", 0xBEE70000 + getppid()), false));
 				my_rank = incoming_events->GetRank();
+				if (use_fragment_views && stale_buffer_timeout_usec > 0)
+				{
+					hold_refresh_thread_ = std::thread([this] { refreshHeldBuffer_(); });
+				}
+
+				auto reconstitutes = [&](std::string const& instance)
+				{
+					if (use_fragment_views)
+					{
+						help.reconstitutes<FragmentViews, art::InEvent>(pretend_module_name, instance);
+					}
+					else
+					{
+						help.reconstitutes<Fragments, art::InEvent>(pretend_module_name, instance);
+					}
+				};
 
-				help.reconstitutes<Fragments, art::InEvent>(pretend_module_name, unidentified_instance_name);
+				reconstitutes(unidentified_instance_name);
 				for (auto it = fragment_type_map_.begin(); it != fragment_type_map_.end(); ++it)
 				{
-					help.reconstitutes<Fragments, art::InEvent>(pretend_module_name, it->second);
-					help.reconstitutes<Fragments, art::InEvent>(pretend_module_name, "Container" + it->second);
+					reconstitutes(it->second);
+					reconstitutes("Container" + it->second);
 				}
 				auto extraTypes = ps.get<std::vector<std::pair<Fragment::type_t, std::string>>>("fragment_type_map", std::vector<std::pair<Fragment::type_t, std::string>>());
 				for (auto it = extraTypes.begin(); it != extraTypes.end(); ++it)
 				{
 					fragment_type_map_[it->first] = it->second;
-					help.reconstitutes<Fragments, art::InEvent>(pretend_module_name, it->second);
-					help.reconstitutes<Fragments, art::InEvent>(pretend_module_name, "Container" + it->second);
+					reconstitutes(it->second);
+					reconstitutes("Container" + it->second);
 				}
 				TLOG_INFO("SharedMemoryReader") << "SharedMemoryReader initialized with ParameterSet: " << ps.to_string();
 				//for(auto& type : fragment_type_map_)
@@ -146,6 +196,16 @@ namespace artdaq
 			 * \brief SharedMemoryReader destructor
 			 */
 			virtual ~SharedMemoryReader() {
+				if (hold_refresh_thread_.joinable())
+				{
+					{
+						std::unique_lock<std::mutex> lk(hold_mutex_);
+						stop_hold_refresh_ = true;
+					}
+					hold_cv_.notify_all();
+					hold_refresh_thread_.join();
+				}
+				releaseHeldBuffer_();
 				artdaq::Globals::CleanUpGlobals();
 			}
 
@@ -195,6 +255,8 @@ namespace artdaq
 				outR = 0;
 				outSR = 0;
 				outE = 0;
+				// art is done with the previous event, and with any FragmentViews into its buffer
+				releaseHeldBuffer_();
 				// Try to get an event from the queue. We'll continuously loop, either until:
 				//   1) we have read a RawEvent off the queue, or
 				//   2) we have timed out, AND we are told the when we timeout we
@@ -217,20 +279,13 @@ namespace artdaq
 				  TLOG_TRACE("SharedMemoryReader") << "ReadyForRead loops BEGIN";
 					keep_looping = false;
 					auto start_time = std::chrono::steady_clock::now();
-					while (!got_event && TimeUtils::GetElapsedTimeMicroseconds(start_time) < 1000)
-					{
-						// BURN CPU for 1 ms!
-						got_event = incoming_events->ReadyForRead();
-					}
-					TLOG_TRACE("SharedMemoryReader") << "ReadyForRead spin end, poll begin";
+					got_event = incoming_events->ReadyForRead();
 					while (!got_event && TimeUtils::GetElapsedTime(start_time) < waiting_time)
 					{
+						// Sleep until SharedMemoryEventManager signals that an event is available. Another art process may
+						// have taken it by the time we look, and the timeout covers any signal which does not arrive
+						event_signal_->Wait(static_cast<size_t>(sleepTimeUsec));
 						got_event = incoming_events->ReadyForRead();
-						if (!got_event)
-						{
-							usleep(sleepTimeUsec);
-							//TLOG_INFO("SharedMemoryReader") << "Waited " << TimeUtils::GetElapsedTime(start_time) << " of " << waiting_time ;
-						}
 					}
 					TLOG_TRACE("SharedMemoryReader") << "ReadyForRead loops END";
 					if (!got_event)
@@ -376,73 +431,49 @@ namespace artdaq
 					currentTime);
 
 				// insert the Fragments of each type into the EventPrincipal
-				std::map<Fragment::type_t, std::string>::const_iterator iter_end =
-					fragment_type_map_.end();
-				for (auto& type_code : fragmentTypes)
+				if (use_fragment_views)
 				{
-					std::map<Fragment::type_t, std::string>::const_iterator iter =
-						fragment_type_map_.find(type_code);
-					auto product = incoming_events->GetFragmentsByType(errflag, type_code);
-					if (errflag) goto start; // Buffer was changed out from under reader!
-					for (auto &frag : *product)
-						bytesRead += frag.sizeBytes();
-					if (iter != iter_end)
+					std::map<Fragment::type_t, std::unique_ptr<FragmentViews>> views;
+					// Broadcast buffers (e.g. Init Fragments) are not shared_memory_buffer_size long, so those events are always copied
+					if (!fragmentTypes.count(Fragment::InitFragmentType) && findFragmentViews_(evtHeader, fragmentTypes, views))
 					{
-						if (type_code == artdaq::Fragment::ContainerFragmentType)
-						{
-							std::unordered_map<std::string, std::unique_ptr<Fragments>> derived_fragments;
-							derived_fragments[iter->second] = std::make_unique<Fragments>();
-
-							for (size_t ii = 0; ii < product->size(); ++ii)
-							{
-								ContainerFragment cf(product->at(ii));
-								auto contained_type = fragment_type_map_.find(cf.fragment_type());
-								if (contained_type != iter_end)
-								{
-									auto label = iter->second + contained_type->second;
-									if (!derived_fragments.count(label))
-									{
-										derived_fragments[label] = std::make_unique<Fragments>();
-									}
-									derived_fragments[label]->emplace_back(std::move(product->at(ii)));
-								}
-								else
-								{
-									derived_fragments[iter->second]->emplace_back(std::move(product->at(ii)));
-								}
-							}
-
-							for (auto& type : derived_fragments)
-							{
-								put_product_in_principal(std::move(type.second),
-									*outE,
-									pretend_module_name,
-									type.first);
-							}
-
-						}
-						else
+						std::unique_lock<std::mutex> lk(hold_mutex_);
+						holding_buffer_ = true;
+					}
+					else
+					{
+						TLOG_WARNING("SharedMemoryReader") << "Could not find the Fragments of event " << evtHeader->sequence_id
+							<< " in place in the shared memory buffer, copying them instead";
+						views.clear();
+						copied_fragments_ = incoming_events->GetFragmentsByType(errflag, Fragment::InvalidFragmentType);
+						if (errflag || !copied_fragments_) goto start; // Buffer was changed out from under reader!
+						for (auto& frag : *copied_fragments_)
 						{
-							put_product_in_principal(std::move(product),
-								*outE,
-								pretend_module_name,
-								iter->second);
+							auto& product = views[frag.type()];
+							if (!product) product = std::make_unique<FragmentViews>();
+							product->emplace_back(frag.headerAddress());
 						}
 					}
-					else
+
+					for (auto& type : views)
 					{
-						put_product_in_principal(std::move(product),
-							*outE,
-							pretend_module_name,
-							unidentified_instance_name);
-						TLOG_WARNING("SharedMemoryReader")
-							<< "UnknownFragmentType: The product instance name mapping for fragment type \""
-							<< ((int)type_code) << "\" is not known. Fragments of this "
-							<< "type will be stored in the event with an instance name of \""
-							<< unidentified_instance_name << "\".";
+						for (auto& view : *type.second)
+							bytesRead += view.sizeBytes();
+						putFragments_(std::move(type.second), type.first, *outE);
 					}
 				}
-				incoming_events->ReleaseBuffer();
+				else
+				{
+					for (auto& type_code : fragmentTypes)
+					{
+						auto product = incoming_events->GetFragmentsByType(errflag, type_code);
+						if (errflag) goto start; // Buffer was changed out from under reader!
+						for (auto &frag : *product)
+							bytesRead += frag.sizeBytes();
+						putFragments_(std::move(product), type_code, *outE);
+					}
+				}
+				if (!holding_buffer_) incoming_events->ReleaseBuffer();
 				TLOG_ARB(10, "SharedMemoryReader") << "readNext: bytesRead=" << bytesRead << " qsize=" << qsize << " cap=" << incoming_events->size() << " metricMan=" << (void*)metricMan.get();
 				if (metricMan)
 				{
@@ -455,6 +486,132 @@ namespace artdaq
 
 			std::map<Fragment::type_t, std::string> fragment_type_map_; ///< The Fragment type names that this SharedMemoryReader knows about
 			unsigned readNext_calls_; ///< The number of times readNext has been called
+
+		private:
+			bool holding_buffer_; // The current event's FragmentViews refer to its shared memory buffer. Protected by hold_mutex_
+			std::unique_ptr<Fragments> copied_fragments_; // Storage for FragmentViews of an event which could not be used in place
+			std::unique_ptr<SharedMemoryEventSignal> event_signal_;
+			std::mutex hold_mutex_; // Serializes use of incoming_events by refreshHeldBuffer_ with the release of the held buffer
+			std::condition_variable hold_cv_;
+			bool stop_hold_refresh_;
+			std::thread hold_refresh_thread_;
+
+			void releaseHeldBuffer_()
+			{
+				std::unique_lock<std::mutex> lk(hold_mutex_);
+				if (holding_buffer_) incoming_events->ReleaseBuffer();
+				holding_buffer_ = false;
+				copied_fragments_.reset(nullptr);
+			}
+
+			// While art processes an event whose FragmentViews refer to the shared memory buffer, touch the buffer often enough
+			// that it is not declared stale (and given to another reader) underneath them. Walking the event's Fragment headers
+			// updates the buffer's last touch time
+			void refreshHeldBuffer_()
+			{
+				std::unique_lock<std::mutex> lk(hold_mutex_);
+				while (!stop_hold_refresh_)
+				{
+					hold_cv_.wait_for(lk, std::chrono::microseconds(stale_buffer_timeout_usec / 4 + 1));
+					if (!holding_buffer_ || stop_hold_refresh_) continue;
+
+					auto errflag = false;
+					incoming_events->GetFragmentTypes(errflag);
+					if (errflag)
+					{
+						TLOG_WARNING("SharedMemoryReader") << "The shared memory buffer of the current event is no longer held by this reader; its FragmentViews may be overwritten";
+					}
+				}
+			}
+
+			// Walk the Fragments which follow the event header in the shared memory buffer. Returns false if the buffer
+			// does not hold exactly the Fragments of this event, ending with the end-of-event marker within shared_memory_buffer_size
+			bool findFragmentViews_(detail::RawEventHeader const* evtHeader, std::set<Fragment::type_t> const& fragmentTypes,
+			                        std::map<Fragment::type_t, std::unique_ptr<FragmentViews>>& views) const
+			{
+				if (shared_memory_buffer_size < sizeof(detail::RawEventHeader)) return false;
+				auto remaining = shared_memory_buffer_size - sizeof(detail::RawEventHeader); // bytes
+				auto pos = reinterpret_cast<RawDataType const*>(reinterpret_cast<uint8_t const*>(evtHeader) + sizeof(detail::RawEventHeader));
+				while (true)
+				{
+					if (remaining < sizeof(detail::RawFragmentHeader)) return false;
+					auto fragHdr = reinterpret_cast<detail::RawFragmentHeader const*>(pos);
+					if (fragHdr->word_count == 0) break; // End-of-event marker written by SharedMemoryEventManager
+					if (fragHdr->word_count < detail::RawFragmentHeader::num_words() || fragHdr->sequence_id != evtHeader->sequence_id) return false;
+					if (fragHdr->word_count > remaining / sizeof(RawDataType)) return false;
+
+					auto& product = views[fragHdr->type];
+					if (!product) product = std::make_unique<FragmentViews>();
+					product->emplace_back(pos);
+					pos += fragHdr->word_count;
+					remaining -= fragHdr->word_count * sizeof(RawDataType);
+				}
+
+				if (views.size() != fragmentTypes.size()) return false;
+				for (auto& type : fragmentTypes)
+				{
+					if (!views.count(type)) return false;
+				}
+				return true;
+			}
+
+			// Put the Fragments (or FragmentViews) of one type into the event, splitting ContainerFragments by the type they hold
+			template <class T>
+			void putFragments_(std::unique_ptr<std::vector<T>> product, Fragment::type_t type_code, art::EventPrincipal& outE)
+			{
+				auto iter = fragment_type_map_.find(type_code);
+				if (iter == fragment_type_map_.end())
+				{
+					put_product_in_principal(std::move(product),
+						outE,
+						pretend_module_name,
+						unidentified_instance_name);
+					TLOG_WARNING("SharedMemoryReader")
+						<< "UnknownFragmentType: The product instance name mapping for fragment type \""
+						<< ((int)type_code) << "\" is not known. Fragments of this "
+						<< "type will be stored in the event with an instance name of \""
+						<< unidentified_instance_name << "\".";
+					return;
+				}
+
+				if (type_code != artdaq::Fragment::ContainerFragmentType || !unpack_container_fragments)
+				{
+					put_product_in_principal(std::move(product),
+						outE,
+						pretend_module_name,
+						iter->second);
+					return;
+				}
+
+				std::unordered_map<std::string, std::unique_ptr<std::vector<T>>> derived_fragments;
+				derived_fragments[iter->second] = std::make_unique<std::vector<T>>();
+
+				for (size_t ii = 0; ii < product->size(); ++ii)
+				{
+					auto contained_type = fragment_type_map_.find(containedFragmentType(product->at(ii)));
+					if (contained_type != fragment_type_map_.end())
+					{
+						auto label = iter->second + contained_type->second;
+						if (!derived_fragments.count(label))
+						{
+							derived_fragments[label] = std::make_unique<std::vector<T>>();
+						}
+						derived_fragments[label]->emplace_back(std::move(product->at(ii)));
+					}
+					else
+					{
+						derived_fragments[iter->second]->emplace_back(std::move(product->at(ii)));
+					}
+				}
+
+				for (auto& type : derived_fragments)
+				{
+					put_product_in_principal(std::move(type.second),
+						outE,
+						pretend_module_name,
+						type.first);
+				}
+			}
 		};
 	} // detail
 } // artdaq
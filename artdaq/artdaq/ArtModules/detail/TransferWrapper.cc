@@ -1,6 +1,7 @@
 #define TRACE_NAME "TransferWrapper"
 
 #include "artdaq/ArtModules/detail/TransferWrapper.hh"
+#include "artdaq/ArtModules/detail/FragmentReadBufferFile.hh"
 #include "artdaq/TransferPlugins/MakeTransferPlugin.hh"
 #include "artdaq/ExternalComms/MakeCommanderPlugin.hh"
 #include "artdaq/DAQdata/NetMonHeader.hh"
@@ -172,9 +173,12 @@ void artdaq::TransferWrapper::receiveMessage(std::unique_ptr<TBufferFile>& msg)
 			return;
 		}
 
+		checkIntegrity(*fragmentPtr);
+		auto fragmentType = fragmentPtr->type();
+
 		try
 		{
-			extractTBufferFile(*fragmentPtr, msg);
+			extractTBufferFile(std::move(fragmentPtr), msg);
 		}
 		catch (...)
 		{
@@ -182,9 +186,7 @@ void artdaq::TransferWrapper::receiveMessage(std::unique_ptr<TBufferFile>& msg)
 							 "Problem extracting TBufferFile from artdaq::Fragment in TransferWrapper::receiveMessage");
 		}
 
-		checkIntegrity(*fragmentPtr);
-
-		if (initialized || fragmentPtr->type() == artdaq::Fragment::InitFragmentType)
+		if (initialized || fragmentType == artdaq::Fragment::InitFragmentType)
 		{
 			initialized = true;
 			break;
@@ -204,15 +206,11 @@ void artdaq::TransferWrapper::receiveMessage(std::unique_ptr<TBufferFile>& msg)
 
 
 void
-artdaq::TransferWrapper::extractTBufferFile(const artdaq::Fragment& fragment,
+artdaq::TransferWrapper::extractTBufferFile(std::unique_ptr<artdaq::Fragment> fragment,
 											std::unique_ptr<TBufferFile>& tbuffer)
 {
-	const artdaq::NetMonHeader* header = fragment.metadata<artdaq::NetMonHeader>();
-	char* buffer = (char *)malloc(header->data_length);
-	memcpy(buffer, fragment.dataBeginBytes(), header->data_length);
-
-	// TBufferFile takes ownership of the contents of memory passed to it
-	tbuffer.reset(new TBufferFile(TBuffer::kRead, header->data_length, buffer, kTRUE, 0));
+	// The TBufferFile reads the message directly from the Fragment payload, and keeps the Fragment alive
+	tbuffer.reset(new artdaq::detail::FragmentReadBufferFile(std::move(fragment)));
 }
 
 void
@@ -75,7 +75,7 @@ namespace artdaq
 
 	private:
 
-		void extractTBufferFile(const artdaq::Fragment&, std::unique_ptr<TBufferFile>&);
+		void extractTBufferFile(std::unique_ptr<artdaq::Fragment>, std::unique_ptr<TBufferFile>&);
 
 		void checkIntegrity(const artdaq::Fragment&) const;
 
@@ -0,0 +1,182 @@
+#define TRACE_NAME "BinaryFileIndex"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQdata/BinaryFileIndex.hh"
+
+#include "cetlib_except/exception.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <tuple>
+
+namespace
+{
+	const char INDEX_MAGIC[8] = {'A', 'D', 'Q', 'I', 'N', 'D', 'E', 'X'};
+	const uint32_t INDEX_VERSION = 1;
+
+	struct IndexFileHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t entry_size;
+	};
+
+	bool entryLess(artdaq::BinaryFileIndexEntry const& a, artdaq::BinaryFileIndexEntry const& b)
+	{
+		return std::tie(a.sequence_id, a.fragment_id) < std::tie(b.sequence_id, b.fragment_id);
+	}
+}
+
+static_assert(sizeof(artdaq::BinaryFileIndexEntry) == 32, "BinaryFileIndexEntry is part of the index file format");
+
+artdaq::BinaryFileIndexWriter::BinaryFileIndexWriter(std::string const& index_file_name)
+	: file_name_(index_file_name)
+	, file_(index_file_name, std::ofstream::binary | std::ofstream::trunc)
+{
+	if (!file_)
+	{
+		throw cet::exception("BinaryFileIndex") << "Could not open index file " << file_name_ << ": " << strerror(errno);
+	}
+
+	IndexFileHeader hdr;
+	memcpy(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic));
+	hdr.version = INDEX_VERSION;
+	hdr.entry_size = sizeof(BinaryFileIndexEntry);
+	file_.write(reinterpret_cast<char const*>(&hdr), sizeof(hdr));
+	TLOG(TLVL_DEBUG) << "Writing index file " << file_name_;
+}
+
+void artdaq::BinaryFileIndexWriter::Add(Fragment const& frag, uint64_t offset)
+{
+	BinaryFileIndexEntry entry;
+	memset(&entry, 0, sizeof(entry));
+	entry.sequence_id = frag.sequenceID();
+	entry.offset = offset;
+	entry.size_bytes = frag.sizeBytes();
+	entry.fragment_id = frag.fragmentID();
+	entry.type = frag.type();
+	file_.write(reinterpret_cast<char const*>(&entry), sizeof(entry));
+}
+
+void artdaq::BinaryFileIndexWriter::Flush()
+{
+	if (!file_.is_open()) return;
+	file_.flush();
+	if (!file_)
+	{
+		TLOG(TLVL_ERROR) << "Error writing index file " << file_name_;
+	}
+}
+
+void artdaq::BinaryFileIndexWriter::Close()
+{
+	if (!file_.is_open()) return;
+	file_.close();
+	if (!file_)
+	{
+		TLOG(TLVL_ERROR) << "Error writing index file " << file_name_;
+	}
+}
+
+artdaq::BinaryFileIndex::BinaryFileIndex(std::string const& data_file_name)
+	: data_file_name_(data_file_name)
+	, fd_(-1)
+	, entries_()
+{
+	auto index_file_name = IndexFileName(data_file_name_);
+	std::ifstream index(index_file_name, std::ifstream::binary);
+	if (!index)
+	{
+		throw cet::exception("BinaryFileIndex") << "Could not open index file " << index_file_name << ": " << strerror(errno);
+	}
+
+	IndexFileHeader hdr;
+	if (!index.read(reinterpret_cast<char*>(&hdr), sizeof(hdr)) || memcmp(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic)) != 0)
+	{
+		throw cet::exception("BinaryFileIndex") << index_file_name << " is not a binary file index";
+	}
+	if (hdr.version != INDEX_VERSION || hdr.entry_size != sizeof(BinaryFileIndexEntry))
+	{
+		throw cet::exception("BinaryFileIndex") << index_file_name << " has unsupported version " << hdr.version << " (entry size " << hdr.entry_size << ")";
+	}
+
+	index.seekg(0, std::ios::end);
+	auto entry_count = (static_cast<size_t>(index.tellg()) - sizeof(hdr)) / sizeof(BinaryFileIndexEntry); // A partial last entry is ignored
+	index.seekg(sizeof(hdr));
+	entries_.resize(entry_count);
+	index.read(reinterpret_cast<char*>(entries_.data()), entry_count * sizeof(BinaryFileIndexEntry));
+
+	// Entries are in the order the Fragments were written, which is usually already sorted
+	if (!std::is_sorted(entries_.begin(), entries_.end(), entryLess))
+	{
+		std::stable_sort(entries_.begin(), entries_.end(), entryLess);
+	}
+
+	fd_ = open(data_file_name_.c_str(), O_RDONLY);
+	if (fd_ < 0)
+	{
+		throw cet::exception("BinaryFileIndex") << "Could not open data file " << data_file_name_ << ": " << strerror(errno);
+	}
+	TLOG(TLVL_DEBUG) << "Read " << entries_.size() << " entries from index file " << index_file_name;
+}
+
+artdaq::BinaryFileIndex::~BinaryFileIndex()
+{
+	if (fd_ >= 0) close(fd_);
+}
+
+artdaq::BinaryFileIndexEntry const* artdaq::BinaryFileIndex::Find(Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id) const
+{
+	BinaryFileIndexEntry key;
+	key.sequence_id = sequence_id;
+	key.fragment_id = fragment_id;
+	auto it = std::lower_bound(entries_.begin(), entries_.end(), key, entryLess);
+	if (it == entries_.end() || it->sequence_id != sequence_id || it->fragment_id != fragment_id) return nullptr;
+	return &*it;
+}
+
+std::pair<artdaq::BinaryFileIndex::const_iterator, artdaq::BinaryFileIndex::const_iterator>
+artdaq::BinaryFileIndex::FindRange(Fragment::sequence_id_t first, Fragment::sequence_id_t last) const
+{
+	auto begin = std::lower_bound(entries_.begin(), entries_.end(), first,
+	                              [](BinaryFileIndexEntry const& e, Fragment::sequence_id_t seq) { return e.sequence_id < seq; });
+	auto end = std::upper_bound(begin, entries_.end(), last,
+	                            [](Fragment::sequence_id_t seq, BinaryFileIndexEntry const& e) { return seq < e.sequence_id; });
+	return std::make_pair(begin, end);
+}
+
+artdaq::FragmentPtr artdaq::BinaryFileIndex::ReadFragment(BinaryFileIndexEntry const& entry) const
+{
+	auto words = entry.size_bytes / sizeof(RawDataType);
+	if (words < detail::RawFragmentHeader::num_words() || entry.size_bytes % sizeof(RawDataType) != 0)
+	{
+		throw cet::exception("BinaryFileIndex") << "Index entry for sequence ID " << entry.sequence_id << ", fragment ID " << entry.fragment_id
+		                                        << " has invalid size " << entry.size_bytes;
+	}
+
+	auto frag = std::make_unique<Fragment>(words - detail::RawFragmentHeader::num_words());
+	auto dest = reinterpret_cast<char*>(frag->headerAddress());
+	size_t done = 0;
+	while (done < entry.size_bytes)
+	{
+		auto sts = pread(fd_, dest + done, entry.size_bytes - done, entry.offset + done);
+		if (sts < 0 && errno == EINTR) continue;
+		if (sts <= 0)
+		{
+			throw cet::exception("BinaryFileIndex") << "Could not read " << entry.size_bytes << " bytes at offset " << entry.offset
+			                                        << " from " << data_file_name_ << ": " << (sts < 0 ? strerror(errno) : "end of file");
+		}
+		done += sts;
+	}
+
+	if (frag->sequenceID() != entry.sequence_id || frag->fragmentID() != entry.fragment_id || frag->sizeBytes() != entry.size_bytes)
+	{
+		throw cet::exception("BinaryFileIndex") << "Fragment at offset " << entry.offset << " of " << data_file_name_ << " (sequence ID "
+		                                        << frag->sequenceID() << ", fragment ID " << frag->fragmentID() << ") does not match its index entry (sequence ID "
+		                                        << entry.sequence_id << ", fragment ID " << entry.fragment_id << ")";
+	}
+	return frag;
+}
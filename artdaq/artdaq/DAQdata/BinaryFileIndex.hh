@@ -0,0 +1,140 @@
+#ifndef ARTDAQ_DAQDATA_BINARYFILEINDEX_HH
+#define ARTDAQ_DAQDATA_BINARYFILEINDEX_HH
+
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace artdaq
+{
+	/**
+	 * \brief One record of a binary file index: where a Fragment is stored in the data file
+	 */
+	struct BinaryFileIndexEntry
+	{
+		uint64_t sequence_id; ///< Sequence ID of the Fragment
+		uint64_t offset; ///< Offset of the Fragment header from the start of the data file, in bytes
+		uint64_t size_bytes; ///< Size of the Fragment, including header and metadata, in bytes
+		uint16_t fragment_id; ///< Fragment ID of the Fragment
+		uint8_t type; ///< Type of the Fragment
+		uint8_t unused[5]; ///< Padding, always zero
+	};
+
+	/**
+	 * \brief Writes the index ("sidecar") file for a binary file of concatenated Fragments, as written by BinaryFileOutput
+	 *
+	 * The index file starts with a header (magic number, version and entry size), followed by one BinaryFileIndexEntry per
+	 * Fragment, in the order the Fragments were written. BinaryFileOutput flushes the index after each event, so if the
+	 * process stops before Close is called, the index is usable up to the last event flushed. With asyncIO, the data of
+	 * the last events may still have been in memory, so readers should check entries against the size of the data file.
+	 */
+	class BinaryFileIndexWriter
+	{
+	public:
+		/**
+		 * \brief BinaryFileIndexWriter Constructor
+		 * \param index_file_name Name of the index file to write. An existing file is truncated
+		 * \exception cet::exception If the index file cannot be opened
+		 */
+		explicit BinaryFileIndexWriter(std::string const& index_file_name);
+
+		/**
+		 * \brief Record a Fragment
+		 * \param frag The Fragment which was written
+		 * \param offset Offset of the Fragment from the start of the data file, in bytes
+		 */
+		void Add(Fragment const& frag, uint64_t offset);
+
+		/**
+		 * \brief Write the entries added so far to the index file
+		 */
+		void Flush();
+
+		/**
+		 * \brief Flush and close the index file
+		 */
+		void Close();
+
+	private:
+		std::string file_name_;
+		std::ofstream file_;
+	};
+
+	/**
+	 * \brief Finds Fragments in a binary file of concatenated Fragments by Sequence ID and Fragment ID, using its index file
+	 *
+	 * The index is read into memory and sorted by (Sequence ID, Fragment ID), so Fragments are found with a binary search
+	 * rather than by scanning the data file, and are read from the data file with one pread each.
+	 */
+	class BinaryFileIndex
+	{
+	public:
+		/**
+		 * \brief Type of an iterator over the index entries
+		 */
+		typedef std::vector<BinaryFileIndexEntry>::const_iterator const_iterator;
+
+		/**
+		 * \brief Get the name of the index file belonging to a data file
+		 * \param data_file_name Name of the data file
+		 * \return The name of the index file
+		 */
+		static std::string IndexFileName(std::string const& data_file_name) { return data_file_name + ".idx"; }
+
+		/**
+		 * \brief BinaryFileIndex Constructor
+		 * \param data_file_name Name of the data file. The index is read from IndexFileName(data_file_name)
+		 * \exception cet::exception If either file cannot be opened, or the index file is not valid
+		 */
+		explicit BinaryFileIndex(std::string const& data_file_name);
+
+		/**
+		 * \brief BinaryFileIndex Destructor. Closes the data file
+		 */
+		~BinaryFileIndex();
+
+		/**
+		 * \brief Find a Fragment
+		 * \param sequence_id Sequence ID of the Fragment
+		 * \param fragment_id Fragment ID of the Fragment
+		 * \return Pointer to the index entry of the Fragment, or nullptr if it is not in the file
+		 */
+		BinaryFileIndexEntry const* Find(Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id) const;
+
+		/**
+		 * \brief Find all Fragments with Sequence IDs in a range
+		 * \param first First Sequence ID of the range
+		 * \param last Last Sequence ID of the range (inclusive)
+		 * \return Iterators to the first and one past the last matching index entries
+		 */
+		std::pair<const_iterator, const_iterator> FindRange(Fragment::sequence_id_t first, Fragment::sequence_id_t last) const;
+
+		/**
+		 * \brief Read a Fragment from the data file
+		 * \param entry Index entry of the Fragment
+		 * \return The Fragment
+		 * \exception cet::exception If the Fragment cannot be read, or does not match the index entry
+		 */
+		FragmentPtr ReadFragment(BinaryFileIndexEntry const& entry) const;
+
+		/**
+		 * \brief Get all index entries, sorted by Sequence ID and Fragment ID
+		 * \return Reference to the index entries
+		 */
+		std::vector<BinaryFileIndexEntry> const& entries() const { return entries_; }
+
+	private:
+		BinaryFileIndex(BinaryFileIndex const&) = delete;
+		BinaryFileIndex& operator=(BinaryFileIndex const&) = delete;
+
+		std::string data_file_name_;
+		int fd_;
+		std::vector<BinaryFileIndexEntry> entries_;
+	};
+}
+
+#endif // ARTDAQ_DAQDATA_BINARYFILEINDEX_HH
@@ -0,0 +1,86 @@
+#define TRACE_NAME "BinaryFileMap"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQdata/BinaryFileMap.hh"
+
+#include "cetlib_except/exception.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+artdaq::BinaryFileMap::BinaryFileMap(std::string const& file_name)
+	: file_name_(file_name)
+	, begin_(nullptr)
+	, size_(0)
+	, pos_(0)
+{
+	int fd = open(file_name_.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		throw cet::exception("BinaryFileMap") << "Could not open " << file_name_ << ": " << strerror(errno);
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		auto err = errno;
+		close(fd);
+		throw cet::exception("BinaryFileMap") << "Could not stat " << file_name_ << ": " << strerror(err);
+	}
+	size_ = st.st_size;
+
+	if (size_ > 0)
+	{
+		auto addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED)
+		{
+			auto err = errno;
+			close(fd);
+			throw cet::exception("BinaryFileMap") << "Could not map " << file_name_ << ": " << strerror(err);
+		}
+		begin_ = static_cast<uint8_t const*>(addr);
+		// The file is read front to back, so let the kernel read ahead aggressively
+		madvise(addr, size_, MADV_SEQUENTIAL);
+	}
+	close(fd); // The mapping stays valid without the descriptor
+	TLOG(TLVL_DEBUG) << "Mapped " << size_ << " bytes of " << file_name_;
+}
+
+artdaq::BinaryFileMap::~BinaryFileMap()
+{
+	if (begin_) munmap(const_cast<uint8_t*>(begin_), size_);
+}
+
+bool artdaq::BinaryFileMap::NextEvent(FragmentViews& frags)
+{
+	frags.clear();
+	while (auto frag = fragmentAt_(pos_))
+	{
+		FragmentView view(frag);
+		if (!frags.empty() && view.sequenceID() != frags.front().sequenceID()) break;
+		frags.push_back(view);
+		pos_ += view.sizeBytes();
+	}
+	return !frags.empty();
+}
+
+artdaq::RawDataType const* artdaq::BinaryFileMap::fragmentAt_(size_t pos)
+{
+	if (pos >= size_) return nullptr;
+
+	auto remaining = size_ - pos;
+	auto frag = reinterpret_cast<RawDataType const*>(begin_ + pos);
+	if (remaining < detail::RawFragmentHeader::num_words() * sizeof(RawDataType)
+		|| FragmentView(frag).size() < detail::RawFragmentHeader::num_words()
+		|| FragmentView(frag).sizeBytes() > remaining)
+	{
+		TLOG(TLVL_WARNING) << file_name_ << " does not hold a whole Fragment at offset " << pos << "; ignoring the last " << remaining << " bytes";
+		pos_ = size_;
+		return nullptr;
+	}
+	return frag;
+}
@@ -0,0 +1,74 @@
+#ifndef ARTDAQ_DAQDATA_BINARYFILEMAP_HH
+#define ARTDAQ_DAQDATA_BINARYFILEMAP_HH
+
+#include "artdaq/DAQdata/FragmentView.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace artdaq
+{
+	/**
+	 * \brief Maps a binary file of concatenated Fragments, as written by BinaryFileOutput, into memory and reads it event by event
+	 *
+	 * The Fragments are returned as FragmentViews into the mapping, so nothing is copied until the caller needs to.
+	 * The views are valid for as long as the BinaryFileMap exists. BinaryFileOutput writes all of the Fragments of an
+	 * event one after another, so an event is the run of consecutive Fragments with the same Sequence ID.
+	 */
+	class BinaryFileMap
+	{
+	public:
+		/**
+		 * \brief BinaryFileMap Constructor
+		 * \param file_name Name of the file to map
+		 * \exception cet::exception If the file cannot be opened or mapped
+		 */
+		explicit BinaryFileMap(std::string const& file_name);
+
+		/**
+		 * \brief BinaryFileMap Destructor. Unmaps the file
+		 */
+		~BinaryFileMap();
+
+		/**
+		 * \brief Get the Fragments of the next event
+		 * \param[out] frags Views of the Fragments of the event. Cleared first
+		 * \return False if there are no more events in the file
+		 *
+		 * If the rest of the file does not hold a whole Fragment (for example, because the file was truncated),
+		 * a warning is logged and the file is treated as ending there.
+		 */
+		bool NextEvent(FragmentViews& frags);
+
+		/**
+		 * \brief Start reading from the beginning of the file again
+		 */
+		void Rewind() { pos_ = 0; }
+
+		/**
+		 * \brief Get the name of the mapped file
+		 * \return The name of the file
+		 */
+		std::string const& fileName() const { return file_name_; }
+
+		/**
+		 * \brief Get the size of the mapped file
+		 * \return The size of the file, in bytes
+		 */
+		size_t sizeBytes() const { return size_; }
+
+	private:
+		BinaryFileMap(BinaryFileMap const&) = delete;
+		BinaryFileMap& operator=(BinaryFileMap const&) = delete;
+
+		RawDataType const* fragmentAt_(size_t pos);
+
+		std::string file_name_;
+		uint8_t const* begin_;
+		size_t size_;
+		size_t pos_; // Offset of the next Fragment, in bytes
+	};
+}
+
+#endif // ARTDAQ_DAQDATA_BINARYFILEMAP_HH
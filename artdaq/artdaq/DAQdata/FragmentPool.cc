@@ -0,0 +1,190 @@
+#define TRACE_NAME "FragmentPool"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQdata/FragmentPool.hh"
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+	// Number of size classes; class N holds Fragments of at least 2^N words
+	const size_t NUM_SIZE_CLASSES = 48;
+
+	// A request may be served from a class up to this many steps larger than it needs (i.e. a Fragment up to 4x too big)
+	const size_t MAX_CLASS_SLACK = 2;
+
+	size_t floorLog2(size_t words)
+	{
+		size_t out = 0;
+		while (words >>= 1) ++out;
+		return out;
+	}
+
+	size_t ceilLog2(size_t words)
+	{
+		return words <= 1 ? 0 : floorLog2(words - 1) + 1;
+	}
+}
+
+artdaq::FragmentPool& artdaq::FragmentPool::Instance()
+{
+	static FragmentPool instance;
+	return instance;
+}
+
+artdaq::FragmentPool::FragmentPool(size_t max_fragments_per_class, size_t max_bytes)
+	: mutex_()
+	, classes_(NUM_SIZE_CLASSES)
+	, max_fragments_per_class_(max_fragments_per_class)
+	, max_bytes_(max_bytes)
+	, bytes_(0)
+	, count_(0)
+	, active_(false)
+	, hits_(0)
+	, misses_(0)
+{}
+
+void artdaq::FragmentPool::SetLimits(size_t max_fragments_per_class, size_t max_bytes)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	max_fragments_per_class_ = max_fragments_per_class;
+	max_bytes_ = max_bytes;
+	trim_();
+}
+
+artdaq::FragmentPtr artdaq::FragmentPool::Get(size_t payload_words,
+                                              Fragment::sequence_id_t sequence_id,
+                                              Fragment::fragment_id_t fragment_id,
+                                              Fragment::type_t type,
+                                              Fragment::timestamp_t timestamp)
+{
+	active_ = true;
+	auto frag = take_(detail::RawFragmentHeader::num_words() + payload_words);
+	if (!frag)
+	{
+		++misses_;
+		frag.reset(new Fragment(payload_words));
+	}
+	else
+	{
+		++hits_;
+		clearMetadata_(*frag);
+		frag->resize(payload_words);
+	}
+	setHeader_(*frag, sequence_id, fragment_id, type, timestamp);
+	return frag;
+}
+
+void artdaq::FragmentPool::Return(Fragment&& frag)
+{
+	// A Fragment whose storage was taken by a move has no header left to look at
+	if (!active_ || frag.headerAddress() == nullptr) return;
+	Return(FragmentPtr(new Fragment(std::move(frag))));
+}
+
+void artdaq::FragmentPool::Return(FragmentPtr frag)
+{
+	if (!active_ || !frag || frag->headerAddress() == nullptr) return;
+
+	auto words = frag->size();
+	auto bytes = words * sizeof(RawDataType);
+	auto size_class = std::min(floorLog2(words), NUM_SIZE_CLASSES - 1);
+
+	std::unique_lock<std::mutex> lk(mutex_);
+	if (classes_[size_class].size() >= max_fragments_per_class_ || bytes_ + bytes > max_bytes_)
+	{
+		TLOG(20) << "Pool is full, releasing Fragment of " << words << " words";
+		return;
+	}
+	classes_[size_class].emplace_back(std::move(frag));
+	bytes_ += bytes;
+	++count_;
+}
+
+void artdaq::FragmentPool::Clear()
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	for (auto& size_class : classes_)
+	{
+		size_class.clear();
+	}
+	bytes_ = 0;
+	count_ = 0;
+}
+
+size_t artdaq::FragmentPool::size() const
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	return count_;
+}
+
+size_t artdaq::FragmentPool::sizeBytes() const
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	return bytes_;
+}
+
+artdaq::FragmentPtr artdaq::FragmentPool::take_(size_t total_words)
+{
+	auto first_class = ceilLog2(total_words);
+	std::unique_lock<std::mutex> lk(mutex_);
+
+	// The class below the first one that is always large enough may still hold a Fragment which fits
+	auto partial_class = std::min(floorLog2(total_words), NUM_SIZE_CLASSES - 1);
+	if (partial_class != first_class)
+	{
+		auto& candidates = classes_[partial_class];
+		for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+		{
+			if ((*it)->size() < total_words) continue;
+
+			auto frag = std::move(*it);
+			candidates.erase(std::next(it).base());
+			bytes_ -= frag->size() * sizeof(RawDataType);
+			--count_;
+			return frag;
+		}
+	}
+
+	for (auto size_class = first_class; size_class < NUM_SIZE_CLASSES && size_class <= first_class + MAX_CLASS_SLACK; ++size_class)
+	{
+		if (classes_[size_class].empty()) continue;
+
+		auto frag = std::move(classes_[size_class].back());
+		classes_[size_class].pop_back();
+		bytes_ -= frag->size() * sizeof(RawDataType);
+		--count_;
+		return frag;
+	}
+	return nullptr;
+}
+
+void artdaq::FragmentPool::trim_()
+{
+	// Release the largest Fragments first
+	for (auto size_class = classes_.rbegin(); size_class != classes_.rend(); ++size_class)
+	{
+		while (!size_class->empty() && (size_class->size() > max_fragments_per_class_ || bytes_ > max_bytes_))
+		{
+			bytes_ -= size_class->back()->size() * sizeof(RawDataType);
+			--count_;
+			size_class->pop_back();
+		}
+	}
+}
+
+void artdaq::FragmentPool::setHeader_(Fragment& frag, Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id,
+                                      Fragment::type_t type, Fragment::timestamp_t timestamp)
+{
+	frag.setSequenceID(sequence_id);
+	frag.setFragmentID(fragment_id);
+	frag.setTimestamp(timestamp);
+	// setUserType and setSystemType each reject the other kind of type; the pool is asked for both
+	reinterpret_cast<detail::RawFragmentHeader*>(frag.headerAddress())->type = type;
+}
+
+void artdaq::FragmentPool::clearMetadata_(Fragment& frag)
+{
+	// Fragment only allows metadata to be set once; a recycled Fragment starts over without any
+	reinterpret_cast<detail::RawFragmentHeader*>(frag.headerAddress())->metadata_word_count = 0;
+}
@@ -0,0 +1,171 @@
+#ifndef ARTDAQ_DAQDATA_FRAGMENTPOOL_HH
+#define ARTDAQ_DAQDATA_FRAGMENTPOOL_HH
+
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace artdaq
+{
+	/**
+	 * \brief A process-wide cache of Fragment storage, so that FragmentGenerators do not have to allocate a new payload for every event
+	 *
+	 * Fragments which have been sent are returned to the pool (DataSenderManager does this after each send), and are kept in
+	 * size classes by the number of words they can hold. Get and GetBytes hand out a pooled Fragment which is large enough, or
+	 * allocate a new one if there is none. The pool only starts keeping Fragments once Get or GetBytes has been called, so
+	 * processes whose generators do not use it do not hold on to any memory.
+	 */
+	class FragmentPool
+	{
+	public:
+		/**
+		 * \brief Get the FragmentPool instance for this process
+		 * \return Reference to the process-wide FragmentPool
+		 */
+		static FragmentPool& Instance();
+
+		/**
+		 * \brief FragmentPool Constructor
+		 * \param max_fragments_per_class Maximum number of Fragments to keep in each size class
+		 * \param max_bytes Maximum total size of the Fragments kept in the pool
+		 */
+		explicit FragmentPool(size_t max_fragments_per_class = 64, size_t max_bytes = 0x10000000);
+
+		/**
+		 * \brief Set the limits on the amount of memory held by the pool. Fragments beyond the new limits are released
+		 * \param max_fragments_per_class Maximum number of Fragments to keep in each size class
+		 * \param max_bytes Maximum total size of the Fragments kept in the pool
+		 */
+		void SetLimits(size_t max_fragments_per_class, size_t max_bytes);
+
+		/**
+		 * \brief Get a Fragment without metadata, equivalent to new Fragment(payload_words, ...)
+		 * \param payload_words Size of the payload, in RawDataType words. The payload contents are not initialized
+		 * \param sequence_id Sequence ID of the Fragment
+		 * \param fragment_id Fragment ID of the Fragment
+		 * \param type Type of the Fragment
+		 * \param timestamp Timestamp of the Fragment
+		 * \return A Fragment with the requested size and header fields
+		 */
+		FragmentPtr Get(size_t payload_words,
+		                Fragment::sequence_id_t sequence_id = Fragment::InvalidSequenceID,
+		                Fragment::fragment_id_t fragment_id = Fragment::InvalidFragmentID,
+		                Fragment::type_t type = Fragment::DataFragmentType,
+		                Fragment::timestamp_t timestamp = Fragment::InvalidTimestamp);
+
+		/**
+		 * \brief Get a Fragment with metadata, equivalent to Fragment::FragmentBytes
+		 * \tparam T Type of the metadata
+		 * \param payload_bytes Size of the payload, in bytes. The payload contents are not initialized
+		 * \param sequence_id Sequence ID of the Fragment
+		 * \param fragment_id Fragment ID of the Fragment
+		 * \param type Type of the Fragment
+		 * \param metadata Metadata to store in the Fragment
+		 * \param timestamp Timestamp of the Fragment
+		 * \return A Fragment with the requested size, metadata and header fields
+		 */
+		template <class T>
+		FragmentPtr GetBytes(size_t payload_bytes,
+		                     Fragment::sequence_id_t sequence_id,
+		                     Fragment::fragment_id_t fragment_id,
+		                     Fragment::type_t type,
+		                     T const& metadata,
+		                     Fragment::timestamp_t timestamp = Fragment::InvalidTimestamp);
+
+		/**
+		 * \brief Give the storage of a Fragment to the pool
+		 * \param frag Fragment to recycle. A Fragment which was already moved from is ignored
+		 */
+		void Return(Fragment&& frag);
+
+		/**
+		 * \brief Give a Fragment to the pool
+		 * \param frag Fragment to recycle
+		 */
+		void Return(FragmentPtr frag);
+
+		/**
+		 * \brief Release all Fragments held by the pool
+		 */
+		void Clear();
+
+		/**
+		 * \brief Get the number of Fragments held by the pool
+		 * \return The number of Fragments held by the pool
+		 */
+		size_t size() const;
+
+		/**
+		 * \brief Get the total size of the Fragments held by the pool
+		 * \return The total size of the Fragments held by the pool, in bytes
+		 */
+		size_t sizeBytes() const;
+
+		/**
+		 * \brief Get the number of Get/GetBytes calls which were satisfied from the pool
+		 * \return The number of pooled Fragments handed out
+		 */
+		size_t hits() const { return hits_.load(); }
+
+		/**
+		 * \brief Get the number of Get/GetBytes calls which needed a new allocation
+		 * \return The number of Fragments allocated by the pool
+		 */
+		size_t misses() const { return misses_.load(); }
+
+	private:
+		FragmentPool(FragmentPool const&) = delete;
+		FragmentPool& operator=(FragmentPool const&) = delete;
+
+		FragmentPtr take_(size_t total_words);
+		void trim_();
+		static void setHeader_(Fragment& frag, Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id,
+		                       Fragment::type_t type, Fragment::timestamp_t timestamp);
+		static void clearMetadata_(Fragment& frag);
+
+		mutable std::mutex mutex_;
+		std::vector<std::vector<FragmentPtr>> classes_; // Class N holds Fragments of at least 2^N words
+		size_t max_fragments_per_class_;
+		size_t max_bytes_;
+		size_t bytes_;
+		size_t count_;
+		std::atomic<bool> active_;
+		std::atomic<size_t> hits_;
+		std::atomic<size_t> misses_;
+	};
+}
+
+template <class T>
+artdaq::FragmentPtr
+artdaq::FragmentPool::GetBytes(size_t payload_bytes,
+                               Fragment::sequence_id_t sequence_id,
+                               Fragment::fragment_id_t fragment_id,
+                               Fragment::type_t type,
+                               T const& metadata,
+                               Fragment::timestamp_t timestamp)
+{
+	active_ = true;
+	auto payload_words = static_cast<size_t>(ceil(payload_bytes / static_cast<double>(sizeof(RawDataType))));
+	auto metadata_words = static_cast<size_t>(ceil(sizeof(T) / static_cast<double>(sizeof(RawDataType))));
+
+	auto frag = take_(detail::RawFragmentHeader::num_words() + metadata_words + payload_words);
+	if (!frag)
+	{
+		++misses_;
+		return Fragment::FragmentBytes(payload_bytes, sequence_id, fragment_id, type, metadata, timestamp);
+	}
+	++hits_;
+
+	// The storage is already large enough, so none of these reallocate
+	clearMetadata_(*frag);
+	frag->resize(0);
+	frag->setMetadata(metadata);
+	frag->resizeBytes(payload_bytes);
+	setHeader_(*frag, sequence_id, fragment_id, type, timestamp);
+	return frag;
+}
+
+#endif // ARTDAQ_DAQDATA_FRAGMENTPOOL_HH
@@ -0,0 +1,143 @@
+#ifndef ARTDAQ_DAQDATA_FRAGMENTVIEW_HH
+#define ARTDAQ_DAQDATA_FRAGMENTVIEW_HH
+
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <algorithm>
+#include <vector>
+
+namespace artdaq
+{
+	/**
+	 * \brief A read-only view of a Fragment which is stored somewhere else, usually in the shared memory buffer of an event
+	 *
+	 * SharedMemoryReader can put FragmentViews into the art::Event in place of Fragments (see its "use_fragment_views" parameter),
+	 * so that analyzers can read the data without it being copied out of shared memory first. A FragmentView is only valid while
+	 * the event it was read with is being processed, and it cannot be written to an output file; use copy() to make a Fragment
+	 * which can be kept.
+	 */
+	class FragmentView
+	{
+	public:
+		/**
+		 * \brief Default Constructor, required by ROOT. The view does not refer to any data
+		 */
+		FragmentView() : header_(nullptr) {}
+
+		/**
+		 * \brief FragmentView Constructor
+		 * \param header Pointer to the first word of the Fragment (its RawFragmentHeader)
+		 */
+		explicit FragmentView(RawDataType const* header) : header_(header) {}
+
+		/**
+		 * \brief Get the header of the Fragment
+		 * \return Reference to the RawFragmentHeader of the Fragment
+		 */
+		detail::RawFragmentHeader const& header() const { return *reinterpret_cast<detail::RawFragmentHeader const*>(header_); }
+
+		/**
+		 * \brief Get the address of the Fragment
+		 * \return Pointer to the first word of the Fragment (its RawFragmentHeader)
+		 */
+		RawDataType const* headerAddress() const { return header_; }
+
+		/**
+		 * \brief Get the size of the Fragment, including header and metadata
+		 * \return The size of the Fragment, in RawDataType words
+		 */
+		size_t size() const { return header().word_count; }
+
+		/**
+		 * \brief Get the size of the Fragment, including header and metadata
+		 * \return The size of the Fragment, in bytes
+		 */
+		size_t sizeBytes() const { return size() * sizeof(RawDataType); }
+
+		/**
+		 * \brief Get the Sequence ID of the Fragment
+		 * \return The Sequence ID of the Fragment
+		 */
+		Fragment::sequence_id_t sequenceID() const { return header().sequence_id; }
+
+		/**
+		 * \brief Get the Fragment ID of the Fragment
+		 * \return The Fragment ID of the Fragment
+		 */
+		Fragment::fragment_id_t fragmentID() const { return header().fragment_id; }
+
+		/**
+		 * \brief Get the type of the Fragment
+		 * \return The type of the Fragment
+		 */
+		Fragment::type_t type() const { return header().type; }
+
+		/**
+		 * \brief Get the timestamp of the Fragment
+		 * \return The timestamp of the Fragment
+		 */
+		Fragment::timestamp_t timestamp() const { return header().timestamp; }
+
+		/**
+		 * \brief Determine whether the Fragment has metadata
+		 * \return Whether the Fragment has metadata
+		 */
+		bool hasMetadata() const { return header().metadata_word_count != 0; }
+
+		/**
+		 * \brief Get the metadata of the Fragment
+		 * \tparam T Type of the metadata
+		 * \return Pointer to the metadata, or nullptr if the Fragment has none
+		 */
+		template <class T>
+		T const* metadata() const
+		{
+			return hasMetadata() ? reinterpret_cast<T const*>(header_ + detail::RawFragmentHeader::num_words()) : nullptr;
+		}
+
+		/**
+		 * \brief Get the start of the Fragment payload
+		 * \return Pointer to the first word of the payload
+		 */
+		RawDataType const* dataBegin() const { return header_ + detail::RawFragmentHeader::num_words() + header().metadata_word_count; }
+
+		/**
+		 * \brief Get the end of the Fragment payload
+		 * \return Pointer to one past the last word of the payload
+		 */
+		RawDataType const* dataEnd() const { return header_ + size(); }
+
+		/**
+		 * \brief Get the start of the Fragment payload
+		 * \return Pointer to the first byte of the payload
+		 */
+		uint8_t const* dataBeginBytes() const { return reinterpret_cast<uint8_t const*>(dataBegin()); }
+
+		/**
+		 * \brief Get the size of the Fragment payload
+		 * \return The size of the payload, in bytes
+		 */
+		size_t dataSizeBytes() const { return (dataEnd() - dataBegin()) * sizeof(RawDataType); }
+
+		/**
+		 * \brief Copy the viewed data into a Fragment
+		 * \return A Fragment which holds a copy of the data
+		 */
+		Fragment copy() const
+		{
+			Fragment out(size() - detail::RawFragmentHeader::num_words());
+			std::copy(header_, header_ + size(), out.headerAddress());
+			return out;
+		}
+
+	private:
+		RawDataType const* header_; // Transient, see classes_def.xml
+	};
+
+	/**
+	 * \brief A std::vector of FragmentView objects
+	 */
+	typedef std::vector<FragmentView> FragmentViews;
+}
+
+#endif // ARTDAQ_DAQDATA_FRAGMENTVIEW_HH
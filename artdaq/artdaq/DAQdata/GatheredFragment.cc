@@ -0,0 +1,217 @@
+#define TRACE_NAME "GatheredFragment"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQdata/GatheredFragment.hh"
+
+#include "artdaq-core/Data/ContainerFragmentLoader.hh"
+
+#include <cstring>
+#include <mutex>
+
+namespace
+{
+	const size_t HEADER_WORDS = artdaq::detail::RawFragmentHeader::num_words();
+
+	// A copy of the header of frag, with extra_words of payload, which stands in for frag when asking ContainerFragmentLoader for the container layout
+	artdaq::Fragment makeStandIn(artdaq::Fragment const& frag, size_t extra_words)
+	{
+		artdaq::Fragment standIn(extra_words);
+		memcpy(standIn.headerAddress(), frag.headerBeginBytes(), HEADER_WORDS * sizeof(artdaq::RawDataType));
+		auto hdr = reinterpret_cast<artdaq::detail::RawFragmentHeader*>(standIn.headerAddress());
+		hdr->word_count = HEADER_WORDS + extra_words;
+		hdr->metadata_word_count = 0;
+		return standIn;
+	}
+
+	// A ContainerFragment holding stand-ins for parts, the first of which is given first_extra_words of payload
+	artdaq::Fragment makeProbe(artdaq::Fragment::sequence_id_t sequence_id, artdaq::Fragment::fragment_id_t fragment_id, artdaq::Fragment::timestamp_t timestamp,
+	                           bool missing_data, std::vector<artdaq::GatheredFragment::ContainerPart> const& parts, size_t first_extra_words)
+	{
+		artdaq::Fragment probe(sequence_id, fragment_id);
+		probe.setTimestamp(timestamp);
+		artdaq::ContainerFragmentLoader cfl(probe);
+		cfl.set_missing_data(missing_data);
+		for (size_t ii = 0; ii < parts.size(); ++ii)
+		{
+			auto standIn = makeStandIn(*parts[ii].first, ii == 0 ? first_extra_words : 0);
+			cfl.addFragment(standIn);
+		}
+		return probe;
+	}
+}
+
+artdaq::GatheredFragment::GatheredFragment(std::vector<RawDataType>&& head)
+	: head_(std::move(head))
+	, parts_()
+	, trailer_()
+{
+	if (head_.size() < HEADER_WORDS) head_.resize(HEADER_WORDS);
+	updateWordCount_();
+}
+
+void artdaq::GatheredFragment::addPart(RawDataType const* data, size_t words, std::shared_ptr<void> owner)
+{
+	parts_.push_back(Part{ data, words, std::move(owner) });
+	updateWordCount_();
+}
+
+void artdaq::GatheredFragment::setTrailer(std::vector<RawDataType>&& trailer)
+{
+	trailer_ = std::move(trailer);
+	updateWordCount_();
+}
+
+std::vector<iovec> artdaq::GatheredFragment::payloadIovecs() const
+{
+	std::vector<iovec> output;
+	output.reserve(parts_.size() + 2);
+	if (head_.size() > HEADER_WORDS)
+	{
+		output.push_back(iovec{ const_cast<RawDataType*>(&head_[HEADER_WORDS]), (head_.size() - HEADER_WORDS) * sizeof(RawDataType) });
+	}
+	for (auto& part : parts_)
+	{
+		if (part.words > 0) output.push_back(iovec{ const_cast<RawDataType*>(part.data), part.words * sizeof(RawDataType) });
+	}
+	if (trailer_.size() > 0)
+	{
+		output.push_back(iovec{ const_cast<RawDataType*>(&trailer_[0]), trailer_.size() * sizeof(RawDataType) });
+	}
+	return output;
+}
+
+artdaq::Fragment artdaq::GatheredFragment::toFragment() const
+{
+	Fragment output(header().word_count - HEADER_WORDS);
+	auto dest = reinterpret_cast<uint8_t*>(output.headerAddress());
+	memcpy(dest, &head_[0], HEADER_WORDS * sizeof(RawDataType));
+	dest += HEADER_WORDS * sizeof(RawDataType);
+	for (auto& iov : payloadIovecs())
+	{
+		memcpy(dest, iov.iov_base, iov.iov_len);
+		dest += iov.iov_len;
+	}
+	return output;
+}
+
+artdaq::GatheredFragmentPtr artdaq::GatheredFragment::MakeContainer(Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id, Fragment::timestamp_t timestamp,
+                                                                    bool missing_data, std::vector<ContainerPart> const& parts)
+{
+	if (!ContainerGatheringSupported()) return nullptr;
+	return makeContainer_(sequence_id, fragment_id, timestamp, missing_data, parts);
+}
+
+bool artdaq::GatheredFragment::ContainerGatheringSupported()
+{
+	static std::once_flag checked;
+	static bool supported = false;
+	std::call_once(checked, []() {
+		// Compare a gathered container with one filled by ContainerFragmentLoader, for Fragments of different sizes
+		std::vector<Fragment> frags;
+		std::vector<ContainerPart> parts;
+		for (size_t words : { 1, 3, 2 })
+		{
+			frags.emplace_back(words);
+			frags.back().setSequenceID(1);
+			frags.back().setFragmentID(2);
+			frags.back().setUserType(Fragment::FirstUserFragmentType);
+			frags.back().setTimestamp(0x10 + words);
+			for (size_t ii = 0; ii < words; ++ii) frags.back().dataBegin()[ii] = 0x1000 * words + ii;
+		}
+		for (auto& frag : frags) parts.emplace_back(&frag, nullptr);
+
+		Fragment expected(1, 2);
+		expected.setTimestamp(0x10);
+		{
+			ContainerFragmentLoader cfl(expected);
+			cfl.set_missing_data(true);
+			for (auto& frag : frags) cfl.addFragment(frag);
+		}
+
+		auto gathered = makeContainer_(1, 2, 0x10, true, parts);
+		if (gathered)
+		{
+			auto result = gathered->toFragment();
+			supported = result.sizeBytes() == expected.sizeBytes() && memcmp(result.headerAddress(), expected.headerAddress(), expected.sizeBytes()) == 0;
+		}
+		if (supported)
+		{
+			TLOG(TLVL_DEBUG) << "ContainerGatheringSupported: ContainerFragments can be gathered without copying their contents";
+		}
+		else
+		{
+			TLOG(TLVL_WARNING) << "ContainerGatheringSupported: The ContainerFragment layout of this artdaq_core version is not understood, ContainerFragments will be filled by copying";
+		}
+	});
+	return supported;
+}
+
+artdaq::GatheredFragmentPtr artdaq::GatheredFragment::makeContainer_(Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id, Fragment::timestamp_t timestamp,
+                                                                     bool missing_data, std::vector<ContainerPart> const& parts)
+{
+	auto probe = makeProbe(sequence_id, fragment_id, timestamp, missing_data, parts, 0);
+	auto probeWords = probe.headerAddress();
+	size_t dataOffset = probe.dataBegin() - probe.headerAddress();
+	size_t standInsEnd = dataOffset + parts.size() * HEADER_WORDS;
+	if (probe.size() < standInsEnd) return nullptr;
+
+	GatheredFragmentPtr output;
+	if (parts.size() == 0)
+	{
+		output.reset(new GatheredFragment(std::vector<RawDataType>(probeWords, probeWords + probe.size())));
+		return output;
+	}
+
+	// Growing the first Fragment by one word shows which metadata and index words depend on the Fragment sizes.
+	// Each of those counts, in words or bytes, up to the end of one of the stand-ins, and moves by the payload of the real Fragments up to that point.
+	auto grown = makeProbe(sequence_id, fragment_id, timestamp, missing_data, parts, 1);
+	if (grown.size() != probe.size() + 1 || grown.dataBegin() - grown.headerAddress() != static_cast<ptrdiff_t>(dataOffset)) return nullptr;
+	auto grownWords = grown.headerAddress();
+
+	std::vector<size_t> extraWords(parts.size());
+	size_t extra = 0;
+	for (size_t ii = 0; ii < parts.size(); ++ii)
+	{
+		extra += parts[ii].first->size() - HEADER_WORDS;
+		extraWords[ii] = extra;
+	}
+
+	auto adjust = [&](RawDataType value, RawDataType grownValue, RawDataType& out) {
+		if (value == grownValue)
+		{
+			out = value;
+			return true;
+		}
+		auto unit = grownValue - value;  // 1 if the word counts words, sizeof(RawDataType) if it counts bytes
+		if (grownValue < value || (unit != 1 && unit != sizeof(RawDataType)) || value % (unit * HEADER_WORDS) != 0) return false;
+		auto count = value / (unit * HEADER_WORDS);
+		if (count < 1 || count > parts.size()) return false;
+		out = value + unit * extraWords[count - 1];
+		return true;
+	};
+
+	std::vector<RawDataType> head(probeWords, probeWords + dataOffset);
+	for (size_t ii = HEADER_WORDS; ii < dataOffset; ++ii)
+	{
+		if (!adjust(probeWords[ii], grownWords[ii], head[ii])) return nullptr;
+	}
+	std::vector<RawDataType> trailer(probe.size() - standInsEnd);
+	for (size_t ii = 0; ii < trailer.size(); ++ii)
+	{
+		if (!adjust(probeWords[standInsEnd + ii], grownWords[standInsEnd + 1 + ii], trailer[ii])) return nullptr;
+	}
+
+	output.reset(new GatheredFragment(std::move(head)));
+	for (auto& part : parts)
+	{
+		output->addPart(reinterpret_cast<RawDataType const*>(part.first->headerBeginBytes()), part.first->size(), part.second);
+	}
+	output->setTrailer(std::move(trailer));
+	return output;
+}
+
+void artdaq::GatheredFragment::updateWordCount_()
+{
+	size_t words = head_.size() + trailer_.size();
+	for (auto& part : parts_) words += part.words;
+	reinterpret_cast<detail::RawFragmentHeader*>(&head_[0])->word_count = words;
+}
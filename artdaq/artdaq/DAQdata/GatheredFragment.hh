@@ -0,0 +1,151 @@
+#ifndef ARTDAQ_DAQDATA_GATHEREDFRAGMENT_HH
+#define ARTDAQ_DAQDATA_GATHEREDFRAGMENT_HH
+
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <sys/uio.h>
+
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace artdaq
+{
+	class GatheredFragment;
+
+	/**
+	 * \brief A std::unique_ptr to a GatheredFragment
+	 */
+	typedef std::unique_ptr<GatheredFragment> GatheredFragmentPtr;
+
+	/**
+	 * \brief A std::list of GatheredFragmentPtr
+	 */
+	typedef std::list<GatheredFragmentPtr> GatheredFragmentPtrs;
+
+	/**
+	 * \brief A Fragment whose bytes are spread over several buffers, and are only gathered together when it is sent
+	 *
+	 * A GatheredFragment is made of a head (the RawFragmentHeader and metadata), a list of parts which are referenced
+	 * in place, and a trailer. The head and trailer belong to the GatheredFragment. Each part keeps a reference to its
+	 * owner, so that the data stays valid for as long as the GatheredFragment exists. The word_count in the header always
+	 * covers the head, parts and trailer.
+	 *
+	 * Transfer plugins which can write several buffers at once send the pieces directly (see
+	 * TransferInterface::transfer_gathered_fragment_reliable_mode); the others send the Fragment returned by toFragment.
+	 */
+	class GatheredFragment
+	{
+	public:
+		/**
+		 * \brief A Fragment to gather into a container, and the object whose lifetime keeps its data valid
+		 */
+		typedef std::pair<Fragment const*, std::shared_ptr<void>> ContainerPart;
+
+		/**
+		 * \brief GatheredFragment Constructor
+		 * \param head RawFragmentHeader and metadata of the Fragment. Must be at least RawFragmentHeader::num_words() long
+		 */
+		explicit GatheredFragment(std::vector<RawDataType>&& head);
+
+		/**
+		 * \brief Append a buffer which is referenced in place
+		 * \param data Start of the buffer
+		 * \param words Size of the buffer, in RawDataType words
+		 * \param owner Object which keeps the buffer valid. It is released when the GatheredFragment is destroyed
+		 */
+		void addPart(RawDataType const* data, size_t words, std::shared_ptr<void> owner);
+
+		/**
+		 * \brief Set the words which follow the last part
+		 * \param trailer Trailer words
+		 */
+		void setTrailer(std::vector<RawDataType>&& trailer);
+
+		/**
+		 * \brief Get the RawFragmentHeader of the GatheredFragment
+		 * \return Reference to the header, which is the start of the head
+		 */
+		detail::RawFragmentHeader const& header() const { return *reinterpret_cast<detail::RawFragmentHeader const*>(&head_[0]); }
+
+		/**
+		 * \brief Get the Sequence ID of the GatheredFragment
+		 * \return The Sequence ID from the header
+		 */
+		Fragment::sequence_id_t sequenceID() const { return header().sequence_id; }
+
+		/**
+		 * \brief Get the Fragment ID of the GatheredFragment
+		 * \return The Fragment ID from the header
+		 */
+		Fragment::fragment_id_t fragmentID() const { return header().fragment_id; }
+
+		/**
+		 * \brief Get the type of the GatheredFragment
+		 * \return The type from the header
+		 */
+		Fragment::type_t type() const { return header().type; }
+
+		/**
+		 * \brief Get the size of the GatheredFragment, including the header
+		 * \return The size, in bytes
+		 */
+		size_t sizeBytes() const { return header().word_count * sizeof(RawDataType); }
+
+		/**
+		 * \brief Get the buffers which follow the RawFragmentHeader, in order
+		 * \return One iovec for the rest of the head, each part and the trailer (empty pieces are left out)
+		 */
+		std::vector<iovec> payloadIovecs() const;
+
+		/**
+		 * \brief Copy the GatheredFragment into a Fragment
+		 * \return A Fragment with the same bytes as the GatheredFragment
+		 */
+		Fragment toFragment() const;
+
+		/**
+		 * \brief Make a GatheredFragment with the same bytes as a ContainerFragment holding the given Fragments
+		 * \param sequence_id Sequence ID of the container
+		 * \param fragment_id Fragment ID of the container
+		 * \param timestamp Timestamp of the container
+		 * \param missing_data Value of the container's missing_data flag
+		 * \param parts Fragments to put in the container, in order, with the objects which keep them valid
+		 * \return A GatheredFragment, or nullptr if the container layout of this artdaq_core version is not understood,
+		 * in which case the caller should fill a ContainerFragment with ContainerFragmentLoader
+		 *
+		 * The container header, metadata and index are taken from ContainerFragmentLoader, run on header-only copies of
+		 * the Fragments. Only those few words are built; the Fragments themselves are not copied.
+		 */
+		static GatheredFragmentPtr MakeContainer(Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id, Fragment::timestamp_t timestamp,
+		                                         bool missing_data, std::vector<ContainerPart> const& parts);
+
+		/**
+		 * \brief Check, once per process, that MakeContainer gives the same bytes as ContainerFragmentLoader
+		 * \return Whether MakeContainer may be used
+		 */
+		static bool ContainerGatheringSupported();
+
+	private:
+		GatheredFragment(GatheredFragment const&) = delete;
+		GatheredFragment& operator=(GatheredFragment const&) = delete;
+
+		struct Part
+		{
+			RawDataType const* data;
+			size_t words;
+			std::shared_ptr<void> owner;
+		};
+
+		static GatheredFragmentPtr makeContainer_(Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id, Fragment::timestamp_t timestamp,
+		                                          bool missing_data, std::vector<ContainerPart> const& parts);
+		void updateWordCount_();
+
+		std::vector<RawDataType> head_;
+		std::vector<Part> parts_;
+		std::vector<RawDataType> trailer_;
+	};
+}
+
+#endif  // ARTDAQ_DAQDATA_GATHEREDFRAGMENT_HH
@@ -1,4 +1,5 @@
 #include "artdaq/DAQdata/GenericFragmentSimulator.hh"
+#include "artdaq/DAQdata/FragmentPool.hh"
 
 #include "artdaq-core/Generators/GeneratorMacros.hh"
 #include "fhiclcpp/ParameterSet.h"
@@ -46,13 +47,14 @@ getNext(Fragment::sequence_id_t sequence_id,
 		Fragment::fragment_id_t fragment_id,
 		FragmentPtr& frag_ptr)
 {
-	frag_ptr.reset(new Fragment(sequence_id, fragment_id));
 	size_t payload_size = generateFragmentSize_();
-	frag_ptr->resize(payload_size, 0);
+	frag_ptr = FragmentPool::Instance().Get(payload_size, sequence_id, fragment_id);
 	switch (content_selection_)
 	{
 	case content_selector_t::EMPTY:
-		break; // values are already correct
+		// Fragments from the pool may hold old data
+		std::fill_n(frag_ptr->dataBegin(), payload_size, 0);
+		break;
 	case content_selector_t::FRAG_ID:
 		std::fill_n(frag_ptr->dataBegin(), payload_size, fragment_id);
 		break;
@@ -0,0 +1,69 @@
+#define TRACE_NAME "ReplayPacer"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQdata/ReplayPacer.hh"
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+#include <thread>
+
+artdaq::ReplayPacer::Mode artdaq::ReplayPacer::ModeFromString(std::string const& name)
+{
+	if (name == "none") return Mode::AsFastAsPossible;
+	if (name == "fixed") return Mode::FixedRate;
+	if (name == "recorded") return Mode::AsRecorded;
+	throw cet::exception("ReplayPacer") << "Unknown pacing mode \"" << name << "\". Valid modes are \"none\", \"fixed\" and \"recorded\"";
+}
+
+artdaq::ReplayPacer::ReplayPacer(Mode mode, double rate_hz, double timestamp_ticks_per_second)
+	: mode_(mode)
+	, rate_hz_(rate_hz)
+	, timestamp_ticks_per_second_(timestamp_ticks_per_second)
+	, events_(0)
+	, start_time_()
+	, start_timestamp_(0)
+{
+	if (mode_ == Mode::FixedRate && rate_hz_ <= 0)
+	{
+		throw cet::exception("ReplayPacer") << "Fixed-rate pacing needs a positive rate, not " << rate_hz_ << " Hz";
+	}
+	if (mode_ == Mode::AsRecorded && timestamp_ticks_per_second_ <= 0)
+	{
+		throw cet::exception("ReplayPacer") << "Pacing by timestamp needs a positive timestamp frequency, not " << timestamp_ticks_per_second_;
+	}
+}
+
+bool artdaq::ReplayPacer::Wait(Fragment::timestamp_t timestamp, size_t max_wait_us)
+{
+	if (events_ == 0)
+	{
+		start_time_ = std::chrono::steady_clock::now();
+		start_timestamp_ = timestamp;
+		++events_;
+		return true;
+	}
+
+	auto due = dueTime_(timestamp);
+	auto latest = std::chrono::steady_clock::now() + std::chrono::microseconds(max_wait_us);
+	std::this_thread::sleep_until(std::min(due, latest));
+	if (std::chrono::steady_clock::now() < due) return false;
+
+	++events_;
+	return true;
+}
+
+std::chrono::steady_clock::time_point artdaq::ReplayPacer::dueTime_(Fragment::timestamp_t timestamp) const
+{
+	switch (mode_)
+	{
+	case Mode::FixedRate:
+		return start_time_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(events_ / rate_hz_));
+	case Mode::AsRecorded:
+		// Timestamps which go backwards (e.g. at the start of a new file) are due immediately
+		if (timestamp <= start_timestamp_) return start_time_;
+		return start_time_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>((timestamp - start_timestamp_) / timestamp_ticks_per_second_));
+	case Mode::AsFastAsPossible:
+	default:
+		return start_time_;
+	}
+}
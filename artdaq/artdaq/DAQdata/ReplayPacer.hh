@@ -0,0 +1,71 @@
+#ifndef ARTDAQ_DAQDATA_REPLAYPACER_HH
+#define ARTDAQ_DAQDATA_REPLAYPACER_HH
+
+#include "artdaq-core/Data/Fragment.hh"
+
+#include <chrono>
+#include <string>
+
+namespace artdaq
+{
+	/**
+	 * \brief Decides when each event of a replayed data file is due, so that replay can run at a configurable rate
+	 */
+	class ReplayPacer
+	{
+	public:
+		/**
+		 * \brief How replayed events are paced
+		 */
+		enum class Mode
+		{
+			AsFastAsPossible, ///< Events are always due ("none")
+			FixedRate, ///< Events are due at a fixed rate ("fixed")
+			AsRecorded ///< Events are due at the intervals given by their timestamps ("recorded")
+		};
+
+		/**
+		 * \brief Convert the name of a mode to a Mode
+		 * \param name "none", "fixed" or "recorded"
+		 * \return The Mode
+		 * \exception cet::exception If the name is not known
+		 */
+		static Mode ModeFromString(std::string const& name);
+
+		/**
+		 * \brief ReplayPacer Constructor
+		 * \param mode How events are paced
+		 * \param rate_hz Rate of events, for Mode::FixedRate
+		 * \param timestamp_ticks_per_second Frequency of the Fragment timestamp clock, for Mode::AsRecorded
+		 */
+		ReplayPacer(Mode mode, double rate_hz, double timestamp_ticks_per_second);
+
+		/**
+		 * \brief Wait until the next event is due
+		 * \param timestamp Timestamp of the event
+		 * \param max_wait_us Maximum time to wait, so that the caller can check whether it should stop
+		 * \return True if the event is due. If false, the event is not due yet, and Wait should be called again for it
+		 *
+		 * The first event is due immediately; the times of later events are counted from it. Once Wait has returned
+		 * true, the event counts as sent.
+		 */
+		bool Wait(Fragment::timestamp_t timestamp, size_t max_wait_us = 100000);
+
+		/**
+		 * \brief Start pacing again, with the next event due immediately
+		 */
+		void Reset() { events_ = 0; }
+
+	private:
+		std::chrono::steady_clock::time_point dueTime_(Fragment::timestamp_t timestamp) const;
+
+		Mode mode_;
+		double rate_hz_;
+		double timestamp_ticks_per_second_;
+		size_t events_;
+		std::chrono::steady_clock::time_point start_time_;
+		Fragment::timestamp_t start_timestamp_;
+	};
+}
+
+#endif // ARTDAQ_DAQDATA_REPLAYPACER_HH
@@ -0,0 +1,2 @@
+#include "canvas/Persistency/Common/Wrapper.h"
+#include "artdaq/DAQdata/FragmentView.hh"
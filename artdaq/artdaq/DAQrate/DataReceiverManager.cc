@@ -1,4 +1,6 @@
 #include <chrono>
+#include <poll.h>
+#include <sys/eventfd.h>
 
 #define TRACE_NAME (app_name + "_DataReceiverManager").c_str()
 #include "artdaq/DAQdata/Globals.hh"
@@ -13,6 +15,14 @@ artdaq::DataReceiverManager::DataReceiverManager(const fhicl::ParameterSet& pset
 	, stop_requested_time_(0)
 	, source_threads_()
 	, source_plugins_()
+	, receiver_state_()
+	, receiver_thread_count_(pset.get<size_t>("receiver_thread_count", 0))
+	, pool_receive_timeout_(pset.get<size_t>("receiver_pool_receive_timeout_usec", 1000))
+	, pool_threads_()
+	, ready_sources_()
+	, parked_sources_()
+	, pool_running_count_(0)
+	, pool_wakeup_fd_(-1)
 	, source_metric_data_()
 	, source_metric_send_time_()
 	, enabled_sources_()
@@ -21,12 +31,14 @@ artdaq::DataReceiverManager::DataReceiverManager(const fhicl::ParameterSet& pset
 	, recv_frag_size_()
 	, recv_seq_count_()
 	, receive_timeout_(pset.get<size_t>("receive_timeout_usec", 100000))
+	, sleep_time_(receive_timeout_ / 100 > 100000 ? 100000 : receive_timeout_ / 100)
 	, stop_timeout_ms_(pset.get<size_t>("stop_timeout_ms", 1500))
 	, shm_manager_(shm)
 	, non_reliable_mode_enabled_(pset.get<bool>("non_reliable_mode", false))
 	, non_reliable_mode_retry_count_(pset.get<size_t>("non_reliable_mode_retry_count", -1))
 {
 	TLOG(TLVL_DEBUG) << "Constructor";
+	if (sleep_time_ < 5000) sleep_time_ = 5000;
 	auto enabled_srcs = pset.get<std::vector<int>>("enabled_sources", std::vector<int>());
 	auto enabled_srcs_empty = enabled_srcs.size() == 0;
 
@@ -91,6 +103,7 @@ artdaq::DataReceiverManager::DataReceiverManager(const fhicl::ParameterSet& pset
 			source_plugins_[source_rank] = std::move(transfer);
 			source_metric_send_time_[source_rank] = std::chrono::steady_clock::now();
 			source_metric_data_[source_rank] = source_metric_data();
+			receiver_state_[source_rank] = receiver_state();
 		}
 		catch (cet::exception ex)
 		{
@@ -115,6 +128,7 @@ artdaq::DataReceiverManager::~DataReceiverManager()
 {
 	TLOG(TLVL_TRACE) << "~DataReceiverManager: BEGIN";
 	stop_threads();
+	if (pool_wakeup_fd_ != -1) close(pool_wakeup_fd_);
 	shm_manager_.reset();
 	TLOG(TLVL_TRACE) << "Destructor END";
 }
@@ -124,6 +138,12 @@ void artdaq::DataReceiverManager::start_threads()
 {
 	stop_requested_ = false;
 	if (shm_manager_) shm_manager_->setRequestMode(artdaq::detail::RequestMessageMode::Normal);
+	{
+		std::unique_lock<std::mutex> lk(pool_mutex_);
+		ready_sources_.clear();
+		parked_sources_.clear();
+		pool_running_count_ = 0;
+	}
 	for (auto& source : source_plugins_)
 	{
 		auto& rank = source.first;
@@ -131,12 +151,22 @@ void artdaq::DataReceiverManager::start_threads()
 		{
 			source_metric_data_[rank] = source_metric_data();
 			source_metric_send_time_[rank] = std::chrono::steady_clock::now();
+			receiver_state_[rank] = receiver_state();
 
 			recv_frag_count_.setSlot(rank, 0);
 			recv_frag_size_.setSlot(rank,0);
 			recv_seq_count_.setSlot(rank,0);
 
 			running_sources_[rank] = true;
+			if (receiver_thread_count_ > 0)
+			{
+				source_plugins_[rank]->setSharedReceiveThread(true);
+				std::unique_lock<std::mutex> lk(pool_mutex_);
+				ready_sources_.push_back(rank);
+				pool_running_count_++;
+				continue;
+			}
+
 			boost::thread::attributes attrs;
 			attrs.set_stack_size(4096 * 2000); // 2000 KB
 			try {
@@ -150,6 +180,36 @@ void artdaq::DataReceiverManager::start_threads()
 			}
 		}
 	}
+
+	if (receiver_thread_count_ > 0 && pool_running_count_ > 0)
+	{
+		if (pool_wakeup_fd_ == -1)
+		{
+			pool_wakeup_fd_ = eventfd(0, EFD_NONBLOCK);
+			if (pool_wakeup_fd_ == -1)
+			{
+				TLOG(TLVL_ERROR) << "Could not create eventfd for receiver pool, errno=" << errno;
+				exit(5);
+			}
+		}
+
+		TLOG(TLVL_INFO) << "Starting receiver pool with " << receiver_thread_count_ << " threads for " << pool_running_count_ << " sources";
+		boost::thread::attributes attrs;
+		attrs.set_stack_size(4096 * 2000); // 2000 KB
+		try {
+			pool_poller_thread_ = boost::thread(attrs, boost::bind(&DataReceiverManager::runPoolPoller_, this));
+			for (size_t ii = 0; ii < receiver_thread_count_; ++ii)
+			{
+				pool_threads_.emplace_back(attrs, boost::bind(&DataReceiverManager::runPoolWorker_, this));
+			}
+		}
+		catch (const boost::exception& e)
+		{
+			TLOG(TLVL_ERROR) << "Caught boost::exception starting receiver pool thread: " << boost::diagnostic_information(e) << ", errno=" << errno;
+			std::cerr << "Caught boost::exception starting receiver pool thread: " << boost::diagnostic_information(e) << ", errno=" << errno << std::endl;
+			exit(5);
+		}
+	}
 }
 
 void artdaq::DataReceiverManager::stop_threads()
@@ -165,6 +225,27 @@ void artdaq::DataReceiverManager::stop_threads()
 		auto& thread = s.second;
 		if (thread.joinable()) thread.join();
 	}
+
+	{
+		// Taking the lock ensures that no worker is between checking stop_requested_ and waiting
+		std::unique_lock<std::mutex> lk(pool_mutex_);
+		pool_cv_.notify_all();
+	}
+	wakePoolPoller_();
+	for (auto& thread : pool_threads_)
+	{
+		if (thread.joinable()) thread.join();
+	}
+	pool_threads_.clear();
+	if (pool_poller_thread_.joinable()) pool_poller_thread_.join();
+
+	// Sources still assigned to the pool when the stop timeout expired
+	std::unique_lock<std::mutex> lk(pool_mutex_);
+	for (auto rank : ready_sources_) running_sources_[rank] = false;
+	for (auto& parked : parked_sources_) running_sources_[parked.first] = false;
+	ready_sources_.clear();
+	parked_sources_.clear();
+	pool_running_count_ = 0;
 }
 
 std::set<int> artdaq::DataReceiverManager::enabled_sources() const
@@ -187,195 +268,362 @@ std::set<int> artdaq::DataReceiverManager::running_sources() const
 	return output;
 }
 
-void artdaq::DataReceiverManager::runReceiver_(int source_rank)
+
+bool artdaq::DataReceiverManager::stopTimeoutExpired_() const
 {
-	std::chrono::steady_clock::time_point start_time, after_header, before_body,after_body, end_time = std::chrono::steady_clock::now();
-	int ret;
-	detail::RawFragmentHeader header;
-	size_t endOfDataCount = -1;
-	auto sleep_time = receive_timeout_ / 100 > 100000 ? 100000 : receive_timeout_ / 100;
-	if (sleep_time < 5000) sleep_time = 5000;
-	auto max_retries = non_reliable_mode_retry_count_ * ceil(receive_timeout_ / sleep_time);
+	return stop_requested_ && TimeUtils::gettimeofday_us() - stop_requested_time_ > stop_timeout_ms_ * 1000;
+}
 
-	while (!(stop_requested_ && TimeUtils::gettimeofday_us() - stop_requested_time_ > stop_timeout_ms_ * 1000) && enabled_sources_.count(source_rank))
+void artdaq::DataReceiverManager::runReceiver_(int source_rank)
+{
+	while (!stopTimeoutExpired_() && enabled_sources_.count(source_rank))
 	{
 		TLOG(16) << "runReceiver_: Begin loop";
 		std::this_thread::yield();
 
-		// Don't stop receiving until we haven't received anything for 1 second
-		if (endOfDataCount <= recv_frag_count_.slotCount(source_rank) && !source_plugins_[source_rank]->isRunning())
-		{
-			TLOG(TLVL_DEBUG) << "runReceiver_: End of Data conditions met, ending runReceiver loop";
-			break;
-		}
+		// A dedicated thread may block for a shared memory buffer; receiveFragment_ returns Blocked every sleep_time_ so that stop is noticed
+		auto result = receiveFragment_(source_rank, receive_timeout_, sleep_time_);
+		if (result == ReceiveResult::Done) break;
+		if (result == ReceiveResult::Timeout) usleep(sleep_time_);
+	}
 
-		start_time = std::chrono::steady_clock::now();
+	TLOG(TLVL_DEBUG) << "runReceiver_ " << source_rank << " receive loop exited";
+	running_sources_[source_rank] = false;
+}
 
-		TLOG(16) << "runReceiver_: Calling receiveFragmentHeader tmo=" << receive_timeout_;
-		ret = source_plugins_[source_rank]->receiveFragmentHeader(header, receive_timeout_);
-		TLOG(16) << "runReceiver_: Done with receiveFragmentHeader, ret=" << ret << " (should be " << source_rank << ")";
-		if (ret != source_rank)
+void artdaq::DataReceiverManager::runPoolWorker_()
+{
+	while (true)
+	{
+		int source_rank;
 		{
-			if (ret >= 0) {
-				TLOG(TLVL_WARNING) << "Received Fragment from rank " << ret << ", but was expecting one from rank " << source_rank << "!";
-			}
-			else if (ret == TransferInterface::DATA_END)
+			std::unique_lock<std::mutex> lk(pool_mutex_);
+			auto has_work = [this] { return !ready_sources_.empty() || pool_running_count_ == 0; };
+			if (!stop_requested_)
 			{
-				TLOG(TLVL_ERROR) << "Transfer Plugin returned DATA_END, ending receive loop!";
-				break;
+				// Sources are only queued by the poller, or by another worker, which both notify pool_cv_
+				pool_cv_.wait(lk, [&] { return has_work() || stop_requested_; });
 			}
-			if ((*running_sources_.begin()).first == source_rank) // Only do this for the first sender in the running_sources_ map
+			if (stop_requested_)
 			{
-				TLOG(TLVL_DEBUG) << "Calling SMEM::CheckPendingBuffers from DRM receiver thread for " << source_rank << " to make sure that things aren't stuck";
-				shm_manager_->CheckPendingBuffers();
+				auto stop_elapsed_us = TimeUtils::gettimeofday_us() - stop_requested_time_;
+				auto stop_remaining_us = stop_timeout_ms_ * 1000 > stop_elapsed_us ? stop_timeout_ms_ * 1000 - stop_elapsed_us : 0;
+				pool_cv_.wait_for(lk, std::chrono::microseconds(stop_remaining_us), has_work);
 			}
+			if (pool_running_count_ == 0 || stopTimeoutExpired_()) break;
+			if (ready_sources_.empty()) continue;
+			source_rank = ready_sources_.front();
+			ready_sources_.pop_front();
+		}
+
+		TLOG(16) << "runPoolWorker_: Servicing source " << source_rank;
+		auto result = receiveFragment_(source_rank, pool_receive_timeout_, pool_receive_timeout_);
 
-			usleep(sleep_time);
-			continue; // Receive timeout or other oddness
+		std::unique_lock<std::mutex> lk(pool_mutex_);
+		switch (result)
+		{
+		case ReceiveResult::Received:
+		case ReceiveResult::Blocked:
+			// Back of the line, so that busy sources cannot starve the others. A Blocked source keeps its Fragment header in
+			// receiver_state_ and tries again for a buffer on its next turn, so that it does not hold a pool thread while waiting
+			ready_sources_.push_back(source_rank);
+			pool_cv_.notify_one();
+			break;
+		case ReceiveResult::Timeout:
+			parked_sources_[source_rank] = std::chrono::steady_clock::now();
+			wakePoolPoller_();
+			break;
+		case ReceiveResult::Done:
+			TLOG(TLVL_DEBUG) << "runPoolWorker_: Source " << source_rank << " is done";
+			running_sources_[source_rank] = false;
+			if (--pool_running_count_ == 0)
+			{
+				pool_cv_.notify_all();
+				wakePoolPoller_();
+			}
+			break;
 		}
+	}
+	TLOG(TLVL_DEBUG) << "runPoolWorker_: receiver pool thread exiting";
+}
 
-		after_header = std::chrono::steady_clock::now();
+void artdaq::DataReceiverManager::runPoolPoller_()
+{
+	std::vector<pollfd> pollfds;
+	std::vector<int> pollranks;
+	while (true)
+	{
+		pollfds.clear();
+		pollranks.clear();
+		pollfds.push_back(pollfd{ pool_wakeup_fd_, POLLIN, 0 });
+		pollranks.push_back(-1);
 
-		if (Fragment::isUserFragmentType(header.type) || header.type == Fragment::DataFragmentType || header.type == Fragment::EmptyFragmentType || header.type == Fragment::ContainerFragmentType) {
-			TLOG(TLVL_TRACE) << "Received Fragment Header from rank " << source_rank << ", sequence ID " << header.sequence_id << ", timestamp " << header.timestamp;
-			RawDataType* loc = nullptr;
-			size_t retries = 0;
-			while (loc == nullptr)//&& TimeUtils::GetElapsedTimeMicroseconds(after_header)) < receive_timeout_) 
+		std::set<int> unpollable;
+		{
+			std::unique_lock<std::mutex> lk(pool_mutex_);
+			if (pool_running_count_ == 0 || stopTimeoutExpired_()) break;
+			for (auto& parked : parked_sources_)
 			{
-				loc = shm_manager_->WriteFragmentHeader(header);
-				if (loc == nullptr && stop_requested_) return;
-				if (loc == nullptr) usleep(sleep_time);
-				retries++;
-				if (non_reliable_mode_enabled_ && retries > max_retries)
+				auto fds = source_plugins_[parked.first]->receiveReadinessFDs();
+				if (fds.empty()) unpollable.insert(parked.first);
+				for (auto fd : fds)
 				{
-					loc = shm_manager_->WriteFragmentHeader(header, true);
+					pollfds.push_back(pollfd{ fd, POLLIN | POLLPRI, 0 });
+					pollranks.push_back(parked.first);
 				}
 			}
-			if (loc == nullptr)
+		}
+
+		// Sources without readiness notification are retried after the same back-off as a dedicated receiver thread would use.
+		// All parked sources are retried after receive_timeout_usec, so that End of Data conditions are re-evaluated.
+		auto timeout_ms = (unpollable.empty() ? receive_timeout_ : sleep_time_) / 1000;
+		if (timeout_ms < 1) timeout_ms = 1;
+		TLOG(17) << "runPoolPoller_: Polling " << pollfds.size() - 1 << " fds, " << unpollable.size() << " sources without readiness notification, timeout=" << timeout_ms << " ms";
+		auto sts = poll(&pollfds[0], pollfds.size(), timeout_ms);
+		if (sts < 0 && errno != EINTR)
+		{
+			TLOG(TLVL_ERROR) << "runPoolPoller_: poll returned error, errno=" << errno;
+		}
+
+		std::set<int> ready;
+		for (size_t ii = 1; sts > 0 && ii < pollfds.size(); ++ii)
+		{
+			if (pollfds[ii].revents != 0) ready.insert(pollranks[ii]);
+		}
+		if (pollfds[0].revents & POLLIN)
+		{
+			uint64_t count;
+			if (read(pool_wakeup_fd_, &count, sizeof(count)) != sizeof(count))
 			{
-				// Could not enqueue event!
-				TLOG(TLVL_ERROR) << "runReceiver_: Could not get data location for event " << header.sequence_id;
-				continue;
+				TLOG(TLVL_WARNING) << "runPoolPoller_: Error reading from wakeup eventfd, errno=" << errno;
 			}
-			before_body = std::chrono::steady_clock::now();
+		}
 
-			auto hdrLoc = reinterpret_cast<artdaq::detail::RawFragmentHeader*>(loc - artdaq::detail::RawFragmentHeader::num_words());
-			TLOG(16) << "runReceiver_: Calling receiveFragmentData from rank " << source_rank << ", sequence ID " << header.sequence_id << ", timestamp " << header.timestamp;
-			auto ret2 = source_plugins_[source_rank]->receiveFragmentData(loc, header.word_count - header.num_words());
-			TLOG(16) << "runReceiver_: Done with receiveFragmentData, ret2=" << ret2 << " (should be " << source_rank << ")";
+		std::unique_lock<std::mutex> lk(pool_mutex_);
+		auto now = std::chrono::steady_clock::now();
+		for (auto it = parked_sources_.begin(); it != parked_sources_.end();)
+		{
+			auto parked_us = std::chrono::duration_cast<std::chrono::microseconds>(now - it->second).count();
+			if (ready.count(it->first)
+				|| (unpollable.count(it->first) && static_cast<size_t>(parked_us) >= sleep_time_)
+				|| static_cast<size_t>(parked_us) >= receive_timeout_)
+			{
+				ready_sources_.push_back(it->first);
+				it = parked_sources_.erase(it);
+				pool_cv_.notify_one();
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+	TLOG(TLVL_DEBUG) << "runPoolPoller_: receiver pool poller thread exiting";
+}
 
-			if (ret != ret2) {
-				TLOG(TLVL_ERROR) << "Unexpected return code from receiveFragmentData after receiveFragmentHeader! (Expected: " << ret << ", Got: " << ret2 << ")";
-				TLOG(TLVL_ERROR) << "Error receiving data from rank " << source_rank << ", data has been lost! Event " << header.sequence_id << " will most likely be Incomplete!";
+void artdaq::DataReceiverManager::wakePoolPoller_()
+{
+	if (pool_wakeup_fd_ == -1) return;
+	uint64_t one = 1;
+	if (write(pool_wakeup_fd_, &one, sizeof(one)) != sizeof(one))
+	{
+		TLOG(TLVL_WARNING) << "wakePoolPoller_: Error writing to wakeup eventfd, errno=" << errno;
+	}
+}
 
-				// Mark the Fragment as invalid
-				/* \todo Make a RawFragmentHeader field that marks it as invalid while maintaining previous type! */
-				hdrLoc->type = Fragment::ErrorFragmentType;
+artdaq::DataReceiverManager::ReceiveResult artdaq::DataReceiverManager::receiveFragment_(int source_rank, size_t receive_timeout, size_t buffer_timeout)
+{
+	std::chrono::steady_clock::time_point start_time, after_header, before_body, after_body;
+	int ret;
+	detail::RawFragmentHeader header;
+	auto& state = receiver_state_[source_rank];
+	// In non-reliable mode, a Fragment is dropped after waiting about this long for a buffer
+	auto max_buffer_wait_us = non_reliable_mode_retry_count_ * receive_timeout_;
 
-				shm_manager_->DoneWritingFragment(header);
-				//throw cet::exception("DataReceiverManager") << "Unexpected return code from receiveFragmentData after receiveFragmentHeader! (Expected: " << ret << ", Got: " << ret2 << ")";
-				continue;
-			}
+	if (state.header_pending)
+	{
+		// The header was received on an earlier call, but there was no buffer for it
+		header = state.pending_header;
+		start_time = state.header_start_time;
+		after_header = state.header_time;
+		ret = source_rank;
+	}
+	else
+	{
+		// Don't stop receiving until we haven't received anything for 1 second
+		if (state.endOfDataCount <= recv_frag_count_.slotCount(source_rank) && !source_plugins_[source_rank]->isRunning())
+		{
+			TLOG(TLVL_DEBUG) << "runReceiver_: End of Data conditions met, ending runReceiver loop";
+			return ReceiveResult::Done;
+		}
 
-			shm_manager_->DoneWritingFragment(header);
-			TLOG(TLVL_TRACE) << "Done receiving fragment with sequence ID " << header.sequence_id << " from rank " << source_rank;
+		start_time = std::chrono::steady_clock::now();
+
+		TLOG(16) << "runReceiver_: Calling receiveFragmentHeader tmo=" << receive_timeout;
+		ret = source_plugins_[source_rank]->receiveFragmentHeader(header, receive_timeout);
+		TLOG(16) << "runReceiver_: Done with receiveFragmentHeader, ret=" << ret << " (should be " << source_rank << ")";
+		after_header = std::chrono::steady_clock::now();
+	}
+	if (ret != source_rank)
+	{
+		if (ret >= 0) {
+			TLOG(TLVL_WARNING) << "Received Fragment from rank " << ret << ", but was expecting one from rank " << source_rank << "!";
+		}
+		else if (ret == TransferInterface::DATA_END)
+		{
+			TLOG(TLVL_ERROR) << "Transfer Plugin returned DATA_END, ending receive loop!";
+			return ReceiveResult::Done;
+		}
+		if ((*running_sources_.begin()).first == source_rank) // Only do this for the first sender in the running_sources_ map
+		{
+			TLOG(TLVL_DEBUG) << "Calling SMEM::CheckPendingBuffers from DRM receiver thread for " << source_rank << " to make sure that things aren't stuck";
+			shm_manager_->CheckPendingBuffers();
+		}
+
+		return ReceiveResult::Timeout; // Receive timeout or other oddness
+	}
 
-			recv_frag_count_.incSlot(source_rank);
-			recv_frag_size_.incSlot(source_rank, header.word_count * sizeof(RawDataType));
-			recv_seq_count_.setSlot(source_rank, header.sequence_id);
-			if (endOfDataCount != static_cast<size_t>(-1))
+	if (Fragment::isUserFragmentType(header.type) || header.type == Fragment::DataFragmentType || header.type == Fragment::EmptyFragmentType || header.type == Fragment::ContainerFragmentType) {
+		TLOG(TLVL_TRACE) << "Received Fragment Header from rank " << source_rank << ", sequence ID " << header.sequence_id << ", timestamp " << header.timestamp;
+
+		// Waits until a buffer is available (or buffer_timeout has elapsed)
+		auto loc = shm_manager_->WriteFragmentHeader(header, buffer_timeout, false, after_header);
+		if (loc == nullptr && non_reliable_mode_enabled_ && static_cast<size_t>(TimeUtils::GetElapsedTimeMicroseconds(after_header)) > max_buffer_wait_us)
+		{
+			loc = shm_manager_->WriteFragmentHeader(header, 0, true, after_header);
+		}
+		if (loc == nullptr)
+		{
+			if (stop_requested_)
 			{
-				TLOG(TLVL_DEBUG) << "Received fragment " << header.sequence_id << " from rank " << source_rank
-					<< " (" << recv_frag_count_.slotCount(source_rank) << "/" << endOfDataCount << ")";
+				TLOG(TLVL_WARNING) << "runReceiver_: Stopping while no buffer is available for event " << header.sequence_id << " from rank " << source_rank << ", the Fragment is lost";
+				state.header_pending = false;
+				return ReceiveResult::Done;
 			}
+			TLOG(16) << "runReceiver_: No buffer available yet for event " << header.sequence_id << " from rank " << source_rank << ", will retry";
+			state.header_pending = true;
+			state.pending_header = header;
+			state.header_start_time = start_time;
+			state.header_time = after_header;
+			return ReceiveResult::Blocked;
+		}
+		state.header_pending = false;
+		before_body = std::chrono::steady_clock::now();
 
-			after_body = std::chrono::steady_clock::now();
+		auto hdrLoc = reinterpret_cast<artdaq::detail::RawFragmentHeader*>(loc - artdaq::detail::RawFragmentHeader::num_words());
+		TLOG(16) << "runReceiver_: Calling receiveFragmentData from rank " << source_rank << ", sequence ID " << header.sequence_id << ", timestamp " << header.timestamp;
+		auto ret2 = source_plugins_[source_rank]->receiveFragmentData(loc, header.word_count - header.num_words());
+		TLOG(16) << "runReceiver_: Done with receiveFragmentData, ret2=" << ret2 << " (should be " << source_rank << ")";
 
-			source_metric_data_[source_rank].hdr_delta_t += TimeUtils::GetElapsedTime(start_time, after_header);
-			source_metric_data_[source_rank].store_delta_t += TimeUtils::GetElapsedTime(after_header, before_body);
-			source_metric_data_[source_rank].data_delta_t += TimeUtils::GetElapsedTime(before_body, after_body);
-			source_metric_data_[source_rank].delta_t += TimeUtils::GetElapsedTime(start_time, after_body);
-			source_metric_data_[source_rank].dead_t += TimeUtils::GetElapsedTime(end_time, start_time);
+		if (ret != ret2) {
+			TLOG(TLVL_ERROR) << "Unexpected return code from receiveFragmentData after receiveFragmentHeader! (Expected: " << ret << ", Got: " << ret2 << ")";
+			TLOG(TLVL_ERROR) << "Error receiving data from rank " << source_rank << ", data has been lost! Event " << header.sequence_id << " will most likely be Incomplete!";
+
+			// Mark the Fragment as invalid
+			/* \todo Make a RawFragmentHeader field that marks it as invalid while maintaining previous type! */
+			hdrLoc->type = Fragment::ErrorFragmentType;
+
+			shm_manager_->DoneWritingFragment(header);
+			//throw cet::exception("DataReceiverManager") << "Unexpected return code from receiveFragmentData after receiveFragmentHeader! (Expected: " << ret << ", Got: " << ret2 << ")";
+			return ReceiveResult::Received;
+		}
 
-			source_metric_data_[source_rank].data_size += header.word_count * sizeof(RawDataType);
-			source_metric_data_[source_rank].header_size += header.num_words() * sizeof(RawDataType);
-			source_metric_data_[source_rank].data_point_count++;
+		shm_manager_->DoneWritingFragment(header);
+		TLOG(TLVL_TRACE) << "Done receiving fragment with sequence ID " << header.sequence_id << " from rank " << source_rank;
 
-			if (metricMan && TimeUtils::GetElapsedTime(source_metric_send_time_[source_rank]) > 1)
-			{//&& recv_frag_count_.slotCount(source_rank) % 100 == 0) {
-				TLOG(6) << "runReceiver_: Sending receive stats for rank " << source_rank;
-				metricMan->sendMetric("Total Receive Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].delta_t, "s", 5, MetricMode::Accumulate);
-				metricMan->sendMetric("Total Receive Size From Rank " + std::to_string(source_rank), static_cast<unsigned long>(source_metric_data_[source_rank].data_size), "B", 5, MetricMode::Accumulate);
-				metricMan->sendMetric("Total Receive Rate From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].data_size / source_metric_data_[source_rank].delta_t, "B/s", 5, MetricMode::Average);
+		recv_frag_count_.incSlot(source_rank);
+		recv_frag_size_.incSlot(source_rank, header.word_count * sizeof(RawDataType));
+		recv_seq_count_.setSlot(source_rank, header.sequence_id);
+		if (state.endOfDataCount != static_cast<size_t>(-1))
+		{
+			TLOG(TLVL_DEBUG) << "Received fragment " << header.sequence_id << " from rank " << source_rank
+				<< " (" << recv_frag_count_.slotCount(source_rank) << "/" << state.endOfDataCount << ")";
+		}
 
-				metricMan->sendMetric("Header Receive Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].hdr_delta_t, "s", 5, MetricMode::Accumulate);
-				metricMan->sendMetric("Header Receive Size From Rank " + std::to_string(source_rank), static_cast<unsigned long>(source_metric_data_[source_rank].header_size), "B", 5, MetricMode::Accumulate);
-				metricMan->sendMetric("Header Receive Rate From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].header_size / source_metric_data_[source_rank].hdr_delta_t, "B/s", 5, MetricMode::Average);
+		after_body = std::chrono::steady_clock::now();
 
-				auto payloadSize = source_metric_data_[source_rank].data_size - source_metric_data_[source_rank].header_size;
-				metricMan->sendMetric("Data Receive Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].data_delta_t, "s", 5, MetricMode::Accumulate);
-				metricMan->sendMetric("Data Receive Size From Rank " + std::to_string(source_rank), static_cast<unsigned long>(payloadSize), "B", 5, MetricMode::Accumulate);
-				metricMan->sendMetric("Data Receive Rate From Rank " + std::to_string(source_rank), payloadSize / source_metric_data_[source_rank].data_delta_t, "B/s", 5, MetricMode::Average);
+		source_metric_data_[source_rank].hdr_delta_t += TimeUtils::GetElapsedTime(start_time, after_header);
+		source_metric_data_[source_rank].store_delta_t += TimeUtils::GetElapsedTime(after_header, before_body);
+		source_metric_data_[source_rank].data_delta_t += TimeUtils::GetElapsedTime(before_body, after_body);
+		source_metric_data_[source_rank].delta_t += TimeUtils::GetElapsedTime(start_time, after_body);
+		source_metric_data_[source_rank].dead_t += TimeUtils::GetElapsedTime(state.end_time, start_time);
 
-				metricMan->sendMetric("Data Receive Count From Rank " + std::to_string(source_rank), recv_frag_count_.slotCount(source_rank), "fragments", 3, MetricMode::LastPoint);
+		source_metric_data_[source_rank].data_size += header.word_count * sizeof(RawDataType);
+		source_metric_data_[source_rank].header_size += header.num_words() * sizeof(RawDataType);
+		source_metric_data_[source_rank].data_point_count++;
 
-				metricMan->sendMetric("Total Shared Memory Wait Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].store_delta_t, "s", 3, MetricMode::Accumulate);
-				metricMan->sendMetric("Avg Shared Memory Wait Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].store_delta_t / source_metric_data_[source_rank].data_point_count, "s", 3, MetricMode::Average);
-				metricMan->sendMetric("Avg Fragment Wait Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].dead_t / source_metric_data_[source_rank].data_point_count, "s", 3, MetricMode::Average);
+		if (metricMan && TimeUtils::GetElapsedTime(source_metric_send_time_[source_rank]) > 1)
+		{//&& recv_frag_count_.slotCount(source_rank) % 100 == 0) {
+			TLOG(6) << "runReceiver_: Sending receive stats for rank " << source_rank;
+			metricMan->sendMetric("Total Receive Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].delta_t, "s", 5, MetricMode::Accumulate);
+			metricMan->sendMetric("Total Receive Size From Rank " + std::to_string(source_rank), static_cast<unsigned long>(source_metric_data_[source_rank].data_size), "B", 5, MetricMode::Accumulate);
+			metricMan->sendMetric("Total Receive Rate From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].data_size / source_metric_data_[source_rank].delta_t, "B/s", 5, MetricMode::Average);
 
-				TLOG(6) << "runReceiver_: Done sending receive stats for rank " << source_rank;
+			metricMan->sendMetric("Header Receive Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].hdr_delta_t, "s", 5, MetricMode::Accumulate);
+			metricMan->sendMetric("Header Receive Size From Rank " + std::to_string(source_rank), static_cast<unsigned long>(source_metric_data_[source_rank].header_size), "B", 5, MetricMode::Accumulate);
+			metricMan->sendMetric("Header Receive Rate From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].header_size / source_metric_data_[source_rank].hdr_delta_t, "B/s", 5, MetricMode::Average);
 
-				source_metric_send_time_[source_rank] = std::chrono::steady_clock::now();
-				source_metric_data_[source_rank] = source_metric_data();
-			}
+			auto payloadSize = source_metric_data_[source_rank].data_size - source_metric_data_[source_rank].header_size;
+			metricMan->sendMetric("Data Receive Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].data_delta_t, "s", 5, MetricMode::Accumulate);
+			metricMan->sendMetric("Data Receive Size From Rank " + std::to_string(source_rank), static_cast<unsigned long>(payloadSize), "B", 5, MetricMode::Accumulate);
+			metricMan->sendMetric("Data Receive Rate From Rank " + std::to_string(source_rank), payloadSize / source_metric_data_[source_rank].data_delta_t, "B/s", 5, MetricMode::Average);
 
-			end_time = std::chrono::steady_clock::now();
-		}
-		else if (header.type == Fragment::EndOfDataFragmentType || header.type == Fragment::InitFragmentType || header.type == Fragment::EndOfRunFragmentType || header.type == Fragment::EndOfSubrunFragmentType || header.type == Fragment::ShutdownFragmentType)
-		{
-			TLOG(TLVL_DEBUG) << "Received System Fragment from rank " << source_rank << " of type " << detail::RawFragmentHeader::SystemTypeToString(header.type) << ".";
+			metricMan->sendMetric("Data Receive Count From Rank " + std::to_string(source_rank), recv_frag_count_.slotCount(source_rank), "fragments", 3, MetricMode::LastPoint);
 
-			FragmentPtr frag(new Fragment(header.word_count - header.num_words()));
-			memcpy(frag->headerAddress(), &header, header.num_words() * sizeof(RawDataType));
-			auto ret3 = source_plugins_[source_rank]->receiveFragmentData(frag->headerAddress() + header.num_words(), header.word_count - header.num_words());
-			if (ret3 != source_rank)
-			{
-				TLOG(TLVL_ERROR) << "Unexpected return code from receiveFragmentData after receiveFragmentHeader while receiving System Fragment! (Expected: " << source_rank << ", Got: " << ret3 << ")";
-				throw cet::exception("DataReceiverManager") << "Unexpected return code from receiveFragmentData after receiveFragmentHeader while receiving System Fragment! (Expected: " << source_rank << ", Got: " << ret3 << ")";
-			}
+			metricMan->sendMetric("Total Shared Memory Wait Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].store_delta_t, "s", 3, MetricMode::Accumulate);
+			metricMan->sendMetric("Avg Shared Memory Wait Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].store_delta_t / source_metric_data_[source_rank].data_point_count, "s", 3, MetricMode::Average);
+			metricMan->sendMetric("Avg Fragment Wait Time From Rank " + std::to_string(source_rank), source_metric_data_[source_rank].dead_t / source_metric_data_[source_rank].data_point_count, "s", 3, MetricMode::Average);
 
-			switch (header.type)
-			{
-			case Fragment::EndOfDataFragmentType:
-				shm_manager_->setRequestMode(detail::RequestMessageMode::EndOfRun);
-				if(endOfDataCount == static_cast<size_t>(-1) ) endOfDataCount = *(frag->dataBegin());
-                else endOfDataCount += *(frag->dataBegin());
-				TLOG(TLVL_DEBUG) << "EndOfData Fragment indicates that " << endOfDataCount << " fragments are expected from rank " << source_rank
-					<< " (recvd " << recv_frag_count_.slotCount(source_rank) << ").";
-				break;
-			case Fragment::InitFragmentType:
-				TLOG(TLVL_DEBUG) << "Received Init Fragment from rank " << source_rank << ".";
-				shm_manager_->setRequestMode(detail::RequestMessageMode::Normal);
-				shm_manager_->SetInitFragment(std::move(frag));
-				break;
-			case Fragment::EndOfRunFragmentType:
-				shm_manager_->setRequestMode(detail::RequestMessageMode::EndOfRun);
-				//shm_manager_->endRun();
-				break;
-			case Fragment::EndOfSubrunFragmentType:
-				//shm_manager_->setRequestMode(detail::RequestMessageMode::EndOfRun);
-				TLOG(TLVL_DEBUG) << "Received EndOfSubrun Fragment from rank " << source_rank
-						 << " with sequence_id " << header.sequence_id << ".";
-				if (header.sequence_id != Fragment::InvalidSequenceID) shm_manager_->rolloverSubrun(header.sequence_id);
-				else shm_manager_->rolloverSubrun(recv_seq_count_.slotCount(source_rank));
-				break;
-			case Fragment::ShutdownFragmentType:
-				shm_manager_->setRequestMode(detail::RequestMessageMode::EndOfRun);
-				break;
-			}
+			TLOG(6) << "runReceiver_: Done sending receive stats for rank " << source_rank;
+
+			source_metric_send_time_[source_rank] = std::chrono::steady_clock::now();
+			source_metric_data_[source_rank] = source_metric_data();
 		}
+
+		state.end_time = std::chrono::steady_clock::now();
 	}
+	else if (header.type == Fragment::EndOfDataFragmentType || header.type == Fragment::InitFragmentType || header.type == Fragment::EndOfRunFragmentType || header.type == Fragment::EndOfSubrunFragmentType || header.type == Fragment::ShutdownFragmentType)
+	{
+		TLOG(TLVL_DEBUG) << "Received System Fragment from rank " << source_rank << " of type " << detail::RawFragmentHeader::SystemTypeToString(header.type) << ".";
 
-	TLOG(TLVL_DEBUG) << "runReceiver_ " << source_rank << " receive loop exited";
-	running_sources_[source_rank] = false;
+		FragmentPtr frag(new Fragment(header.word_count - header.num_words()));
+		memcpy(frag->headerAddress(), &header, header.num_words() * sizeof(RawDataType));
+		auto ret3 = source_plugins_[source_rank]->receiveFragmentData(frag->headerAddress() + header.num_words(), header.word_count - header.num_words());
+		if (ret3 != source_rank)
+		{
+			TLOG(TLVL_ERROR) << "Unexpected return code from receiveFragmentData after receiveFragmentHeader while receiving System Fragment! (Expected: " << source_rank << ", Got: " << ret3 << ")";
+			throw cet::exception("DataReceiverManager") << "Unexpected return code from receiveFragmentData after receiveFragmentHeader while receiving System Fragment! (Expected: " << source_rank << ", Got: " << ret3 << ")";
+		}
+
+		switch (header.type)
+		{
+		case Fragment::EndOfDataFragmentType:
+			shm_manager_->setRequestMode(detail::RequestMessageMode::EndOfRun);
+			if(state.endOfDataCount == static_cast<size_t>(-1) ) state.endOfDataCount = *(frag->dataBegin());
+                else state.endOfDataCount += *(frag->dataBegin());
+			TLOG(TLVL_DEBUG) << "EndOfData Fragment indicates that " << state.endOfDataCount << " fragments are expected from rank " << source_rank
+				<< " (recvd " << recv_frag_count_.slotCount(source_rank) << ").";
+			break;
+		case Fragment::InitFragmentType:
+			TLOG(TLVL_DEBUG) << "Received Init Fragment from rank " << source_rank << ".";
+			shm_manager_->setRequestMode(detail::RequestMessageMode::Normal);
+			shm_manager_->SetInitFragment(std::move(frag));
+			break;
+		case Fragment::EndOfRunFragmentType:
+			shm_manager_->setRequestMode(detail::RequestMessageMode::EndOfRun);
+			//shm_manager_->endRun();
+			break;
+		case Fragment::EndOfSubrunFragmentType:
+			//shm_manager_->setRequestMode(detail::RequestMessageMode::EndOfRun);
+			TLOG(TLVL_DEBUG) << "Received EndOfSubrun Fragment from rank " << source_rank
+					 << " with sequence_id " << header.sequence_id << ".";
+			if (header.sequence_id != Fragment::InvalidSequenceID) shm_manager_->rolloverSubrun(header.sequence_id);
+			else shm_manager_->rolloverSubrun(recv_seq_count_.slotCount(source_rank));
+			break;
+		case Fragment::ShutdownFragmentType:
+			shm_manager_->setRequestMode(detail::RequestMessageMode::EndOfRun);
+			break;
+		}
+	}
+	return ReceiveResult::Received;
 }
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <set>
+#include <deque>
 #include <memory>
 #include <condition_variable>
 
@@ -21,8 +22,8 @@ namespace artdaq
 
 /**
  * \brief Receives Fragment objects from one or more DataSenderManager instances using TransferInterface plugins
- * DataReceiverMaanger runs a reception thread for each source, and can automatically suppress reception from
- * sources which are going faster than the others.
+ * DataReceiverMaanger runs a reception thread for each source (or a pool of reception threads shared by all sources),
+ * and can automatically suppress reception from sources which are going faster than the others.
  */
 class artdaq::DataReceiverManager
 {
@@ -39,6 +40,11 @@ public:
 	 * "max_receive_difference" (Default: 50): Threshold (in sequence ID) for suppressing a source
 	 * "receive_timeout_usec" (Default: 100000): The timeout for receive operations
 	 * "enabled_sources" (OPTIONAL): List of sources which are enabled. If not specified, all sources are assumed enabled
+	 * "receiver_thread_count" (Default: 0): If non-zero, this many threads service all sources, instead of one thread per source.
+	 *   Sources are serviced one Fragment at a time in round-robin order; idle sources are parked until their TransferInterface
+	 *   reports readiness (or, for plugins without readiness notification, until a short back-off expires). A source whose
+	 *   Fragment is waiting for a shared memory buffer goes to the back of the line instead of holding a thread.
+	 * "receiver_pool_receive_timeout_usec" (Default: 1000): The timeout for receive operations when using the receiver pool
 	 * "sources" (Default: blank table): FHiCL table containing TransferInterface configurations for each source.
 	 *   NOTE: "source_rank" MUST be specified (and unique) for each source!
 	 * \endverbatim
@@ -105,13 +111,49 @@ public:
 	std::shared_ptr<detail::FragCounter> GetReceivedFragmentCount() { return std::shared_ptr<detail::FragCounter>(&recv_frag_count_); }
 
 private:
+	enum class ReceiveResult
+	{
+		Received,
+		Timeout,
+		Blocked, // A Fragment header was received, but no shared memory buffer was available for it yet
+		Done
+	};
+
+	struct receiver_state
+	{
+		receiver_state() : endOfDataCount(-1), end_time(std::chrono::steady_clock::now()), header_pending(false), pending_header(), header_start_time(), header_time() {}
+		size_t endOfDataCount;
+		std::chrono::steady_clock::time_point end_time;
+		bool header_pending; // pending_header has been received, and is waiting for a shared memory buffer
+		detail::RawFragmentHeader pending_header;
+		std::chrono::steady_clock::time_point header_start_time; // When receiveFragmentHeader was called for pending_header
+		std::chrono::steady_clock::time_point header_time; // When pending_header was received
+	};
+
 	void runReceiver_(int);
+	void runPoolWorker_();
+	void runPoolPoller_();
+	void wakePoolPoller_();
+	ReceiveResult receiveFragment_(int source_rank, size_t receive_timeout, size_t buffer_timeout);
+	bool stopTimeoutExpired_() const;
 		
 	std::atomic<bool> stop_requested_;
 	std::atomic<size_t> stop_requested_time_;
 
 	std::map<int, boost::thread> source_threads_;
 	std::map<int, std::unique_ptr<TransferInterface>> source_plugins_;
+	std::unordered_map<int, receiver_state> receiver_state_;
+
+	size_t receiver_thread_count_;
+	size_t pool_receive_timeout_;
+	std::vector<boost::thread> pool_threads_;
+	boost::thread pool_poller_thread_;
+	std::mutex pool_mutex_;
+	std::condition_variable pool_cv_;
+	std::deque<int> ready_sources_; // Sources waiting for a pool thread, in service order
+	std::map<int, std::chrono::steady_clock::time_point> parked_sources_; // Idle sources waiting for readiness, and when they were parked
+	size_t pool_running_count_;
+	int pool_wakeup_fd_;
 
 	struct source_metric_data
 	{
@@ -136,6 +178,7 @@ private:
 	detail::FragCounter recv_seq_count_; // For counting sequence IDs
 
 	size_t receive_timeout_;
+	size_t sleep_time_;
 	size_t stop_timeout_ms_;
 	std::shared_ptr<SharedMemoryEventManager> shm_manager_;
 
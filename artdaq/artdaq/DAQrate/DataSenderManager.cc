@@ -1,6 +1,7 @@
 #define TRACE_NAME (app_name + "_DataSenderManager").c_str()
 #include "artdaq/DAQdata/Globals.hh"
 #include "artdaq/DAQrate/DataSenderManager.hh"
+#include "artdaq/DAQdata/FragmentPool.hh"
 #include "artdaq/TransferPlugins/MakeTransferPlugin.hh"
 #include "artdaq/TransferPlugins/detail/HostMap.hh"
 
@@ -23,6 +24,7 @@ artdaq::DataSenderManager::DataSenderManager(const fhicl::ParameterSet& pset)
 	, non_blocking_mode_(pset.get<bool>("nonblocking_sends", false))
 	, send_timeout_us_(pset.get<size_t>("send_timeout_usec", 5000000))
 	, send_retry_count_(pset.get<size_t>("send_retry_count", 2))
+	, recycle_fragments_(pset.get<bool>("recycle_fragments", true))
 	, routing_master_mode_(detail::RoutingMasterMode::INVALID)
 	, should_stop_(false)
 	, ack_socket_(-1)
@@ -35,6 +37,10 @@ artdaq::DataSenderManager::DataSenderManager(const fhicl::ParameterSet& pset)
 
 	// Validate parameters
 	if (send_timeout_us_ == 0) send_timeout_us_ = std::numeric_limits<size_t>::max();
+	if (recycle_fragments_)
+	{
+		FragmentPool::Instance().SetLimits(pset.get<size_t>("fragment_pool_max_per_size", 64), pset.get<size_t>("fragment_pool_max_bytes", 0x10000000));
+	}
 
 	auto rmConfig = pset.get<fhicl::ParameterSet>("routing_table_config", fhicl::ParameterSet());
 	use_routing_master_ = rmConfig.get<bool>("use_routing_master", false);
@@ -418,36 +424,66 @@ std::pair<int, artdaq::TransferInterface::CopyStatus> artdaq::DataSenderManager:
 {
 	// Precondition: Fragment must be complete and consistent (including
 	// header information).
-	auto start_time = std::chrono::steady_clock::now();
 	if (frag.type() == Fragment::EndOfDataFragmentType)
 	{
 		throw cet::exception("LogicError")
 			<< "EOD fragments should not be sent on as received: "
 			<< "use sendEODFrag() instead.";
 	}
-	size_t seqID = frag.sequenceID();
-	size_t fragSize = frag.sizeBytes();
-	TLOG(13) << "sendFragment start frag.fragmentHeader()=" << std::hex << (void*)(frag.headerBeginBytes()) << ", szB=" << std::dec << fragSize
+	auto seqID = frag.sequenceID();
+	TLOG(13) << "sendFragment start frag.fragmentHeader()=" << std::hex << (void*)(frag.headerBeginBytes()) << ", szB=" << std::dec << frag.sizeBytes()
 		<< ", seqID=" << seqID << ", type=" << frag.typeString();
+
+	auto res = sendFragment_(seqID, frag.type(), frag.sizeBytes(), [&](TransferInterface& transfer, SendMode mode) {
+		if (mode == SendMode::MinBlocking) return transfer.transfer_fragment_min_blocking_mode(frag, send_timeout_us_);
+		// Gross, we have to copy.
+		if (mode == SendMode::BroadcastReliable) return transfer.transfer_fragment_reliable_mode(Fragment(frag));
+		return transfer.transfer_fragment_reliable_mode(std::move(frag));
+	});
+
+	// The transfer is complete, so the Fragment's storage can be reused by the FragmentGenerator
+	if (recycle_fragments_) FragmentPool::Instance().Return(std::move(frag));
+
+	TLOG(5) << "sendFragment: Done sending fragment " << seqID;
+	return res;
+}   // artdaq::DataSenderManager::sendFragment
+
+std::pair<int, artdaq::TransferInterface::CopyStatus> artdaq::DataSenderManager::sendFragment(GatheredFragment const& frag)
+{
+	TLOG(13) << "sendFragment start gathered fragment szB=" << frag.sizeBytes() << ", seqID=" << frag.sequenceID() << ", type=" << static_cast<int>(frag.type());
+
+	// Each destination writes the pieces of the GatheredFragment in place; none of them consumes it, so broadcasts need no copy
+	auto res = sendFragment_(frag.sequenceID(), frag.type(), frag.sizeBytes(), [&](TransferInterface& transfer, SendMode mode) {
+		if (mode == SendMode::MinBlocking) return transfer.transfer_gathered_fragment_min_blocking_mode(frag, send_timeout_us_);
+		return transfer.transfer_gathered_fragment_reliable_mode(frag);
+	});
+
+	TLOG(5) << "sendFragment: Done sending gathered fragment " << frag.sequenceID();
+	return res;
+}
+
+std::pair<int, artdaq::TransferInterface::CopyStatus> artdaq::DataSenderManager::sendFragment_(Fragment::sequence_id_t seqID, Fragment::type_t type, size_t fragSize,
+                                                                                               std::function<TransferInterface::CopyStatus(TransferInterface&, SendMode)> const& send)
+{
+	auto start_time = std::chrono::steady_clock::now();
 	int dest = TransferInterface::RECV_TIMEOUT;
 	auto outsts = TransferInterface::CopyStatus::kSuccess;
-	if (broadcast_sends_ || frag.type() == Fragment::EndOfRunFragmentType || frag.type() == Fragment::EndOfSubrunFragmentType || frag.type() == Fragment::InitFragmentType)
+	if (broadcast_sends_ || type == Fragment::EndOfRunFragmentType || type == Fragment::EndOfSubrunFragmentType || type == Fragment::InitFragmentType)
 	{
 		for (auto& bdest : enabled_destinations_)
 		{
 			TLOG(TLVL_TRACE) << "sendFragment: Sending fragment with seqId " << seqID << " to destination " << bdest << " (broadcast)";
-			// Gross, we have to copy.
 			auto sts = TransferInterface::CopyStatus::kTimeout;
 			size_t retries = 0; // Tried once, so retries < send_retry_count_ will have it retry send_retry_count_ times
 			while (sts == TransferInterface::CopyStatus::kTimeout && retries < send_retry_count_)
 			{
 				if (!non_blocking_mode_)
 				{
-					sts = destinations_[bdest]->transfer_fragment_reliable_mode(Fragment(frag));
+					sts = send(*destinations_[bdest], SendMode::BroadcastReliable);
 				}
 				else
 				{
-					sts = destinations_[bdest]->transfer_fragment_min_blocking_mode(frag, send_timeout_us_);
+					sts = send(*destinations_[bdest], SendMode::MinBlocking);
 				}
 				retries++;
 			}
@@ -475,7 +511,7 @@ std::pair<int, artdaq::TransferInterface::CopyStatus> artdaq::DataSenderManager:
 			size_t retries = 0; // Have NOT yet tried, so retries <= send_retry_count_ will have it RETRY send_retry_count_ times
 			while (sts != TransferInterface::CopyStatus::kSuccess && retries <= send_retry_count_)
 			{
-				sts = destinations_[dest]->transfer_fragment_min_blocking_mode(frag, send_timeout_us_);
+				sts = send(*destinations_[dest], SendMode::MinBlocking);
 				if (sts != TransferInterface::CopyStatus::kSuccess && TimeUtils::GetElapsedTime(lastWarnTime) >= 1)
 				{
 					TLOG(TLVL_WARNING) << "sendFragment: Sending fragment " << seqID << " to destination " << dest << " failed! Retrying...";
@@ -507,7 +543,7 @@ std::pair<int, artdaq::TransferInterface::CopyStatus> artdaq::DataSenderManager:
 			TLOG(5) << "DataSenderManager::sendFragment: Sending fragment with seqId " << seqID << " to destination " << dest;
 			TransferInterface::CopyStatus sts = TransferInterface::CopyStatus::kErrorNotRequiringException;
 
-			sts = destinations_[dest]->transfer_fragment_reliable_mode(std::move(frag));
+			sts = send(*destinations_[dest], SendMode::Reliable);
 			if (sts != TransferInterface::CopyStatus::kSuccess)
 				TLOG(TLVL_ERROR) << "sendFragment: Sending fragment " << seqID << " to destination "
 				<< dest << " failed! Data has been lost!";
@@ -545,6 +581,10 @@ std::pair<int, artdaq::TransferInterface::CopyStatus> artdaq::DataSenderManager:
 		metricMan->sendMetric("Data Send Size to Rank " + std::to_string(dest), destination_metric_data_[dest].first, "B", 5, MetricMode::Accumulate);
 		metricMan->sendMetric("Data Send Rate to Rank " + std::to_string(dest), destination_metric_data_[dest].first / destination_metric_data_[dest].second, "B/s", 5, MetricMode::Average);
 		metricMan->sendMetric("Data Send Count to Rank " + std::to_string(dest), sent_frag_count_.slotCount(dest), "fragments", 3, MetricMode::LastPoint);
+		if (recycle_fragments_)
+		{
+			metricMan->sendMetric("Fragment Pool Size", FragmentPool::Instance().sizeBytes(), "B", 5, MetricMode::LastPoint);
+		}
 
 		destination_metric_send_time_[dest] = std::chrono::steady_clock::now();
 		destination_metric_data_[dest].first = 0;
@@ -560,6 +600,5 @@ std::pair<int, artdaq::TransferInterface::CopyStatus> artdaq::DataSenderManager:
 			}
 		}
 	}
-	TLOG(5) << "sendFragment: Done sending fragment " << seqID;
 	return std::make_pair(dest, outsts);
-}   // artdaq::DataSenderManager::sendFragment
+}   // artdaq::DataSenderManager::sendFragment_
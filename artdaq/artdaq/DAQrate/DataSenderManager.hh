@@ -1,6 +1,7 @@
 #ifndef ARTDAQ_DAQRATE_DATASENDERMANAGER_HH
 #define ARTDAQ_DAQRATE_DATASENDERMANAGER_HH
 
+#include <functional>
 #include <map>
 #include <set>
 #include <memory>
@@ -77,6 +78,12 @@ public:
 		fhicl::Atom<size_t> send_timeout_us{ fhicl::Name{"send_timeout_usec"}, fhicl::Comment{"Timeout for sends in non-reliable modes (broadcast and nonblocking)"},5000000 };
 		/// "send_retry_count" (Default: 2): Number of times to retry a send in non-reliable mode
 		fhicl::Atom<size_t> send_retry_count{ fhicl::Name{"send_retry_count"}, fhicl::Comment{"Number of times to retry a send in non-reliable mode"}, 2 };
+		/// "recycle_fragments" (Default: true): Give the storage of sent Fragments to artdaq::FragmentPool, for reuse by FragmentGenerators
+		fhicl::Atom<bool> recycle_fragments{ fhicl::Name{"recycle_fragments"}, fhicl::Comment{"Give the storage of sent Fragments to the FragmentPool, for reuse by FragmentGenerators"}, true };
+		/// "fragment_pool_max_bytes" (Default: 268435456 (256 MB)): Maximum amount of memory held by the FragmentPool
+		fhicl::Atom<size_t> fragment_pool_max_bytes{ fhicl::Name{"fragment_pool_max_bytes"}, fhicl::Comment{"Maximum amount of memory held by the FragmentPool"}, 0x10000000 };
+		/// "fragment_pool_max_per_size" (Default: 64): Maximum number of Fragments of each size class held by the FragmentPool
+		fhicl::Atom<size_t> fragment_pool_max_per_size{ fhicl::Name{"fragment_pool_max_per_size"}, fhicl::Comment{"Maximum number of Fragments of each size class held by the FragmentPool"}, 64 };
 		fhicl::OptionalTable<RoutingTableConfig> routing_table_config{ fhicl::Name{"routing_table_config"} }; ///< Configuration for Routing Table reception. See artdaq::DataSenderManager::RoutingTableConfig
 		/// "destinations" (Default: Empty ParameterSet): FHiCL table for TransferInterface configurations for each destaintion. See artdaq::DataSenderManager::DestinationsConfig
 	    ///   NOTE: "destination_rank" MUST be specified (and unique) for each destination!
@@ -105,6 +112,15 @@ public:
 	 */
 	std::pair<int, TransferInterface::CopyStatus> sendFragment(Fragment&& frag);
 
+	/**
+	 * \brief Send the given GatheredFragment. Return the rank of the destination to which it was sent.
+	 * \param frag GatheredFragment to send. Its pieces are sent in place, so it must stay valid until sendFragment returns
+	 * \return Pair containing Rank of destination for the GatheredFragment and the CopyStatus from the send call
+	 *
+	 * The GatheredFragment is routed exactly as a Fragment with the same header would be.
+	 */
+	std::pair<int, TransferInterface::CopyStatus> sendFragment(GatheredFragment const& frag);
+
 	/**
 	* \brief Return the count of Fragment objects sent by this DataSenderManagerq
 	* \return The count of Fragment objects sent by this DataSenderManager
@@ -152,6 +168,18 @@ private:
 	// Calculate where the fragment with this sequenceID should go.
 	int calcDest_(Fragment::sequence_id_t) const;
 
+	// How a Fragment is to be handed to one of the destinations
+	enum class SendMode
+	{
+		BroadcastReliable, // Reliable send of a Fragment which is also sent to other destinations
+		MinBlocking,
+		Reliable
+	};
+
+	// Route a Fragment (or GatheredFragment) with the given header fields, calling send for each destination, and report metrics
+	std::pair<int, TransferInterface::CopyStatus> sendFragment_(Fragment::sequence_id_t seqID, Fragment::type_t type, size_t fragSize,
+	                                                            std::function<TransferInterface::CopyStatus(TransferInterface&, SendMode)> const& send);
+
 	void setupTableListener_();
 
 	void startTableReceiverThread_();
@@ -170,6 +198,7 @@ private:
 	bool non_blocking_mode_;
 	size_t send_timeout_us_;
 	size_t send_retry_count_;
+	bool recycle_fragments_;
 
 	bool use_routing_master_;
 	detail::RoutingMasterMode routing_master_mode_;
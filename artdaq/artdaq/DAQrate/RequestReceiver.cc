@@ -28,6 +28,7 @@
 #include <iomanip>
 #include <algorithm>
 #include <sys/poll.h>
+#include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include "artdaq/DAQdata/TCPConnect.hh"
@@ -45,6 +46,7 @@ artdaq::RequestReceiver::RequestReceiver()
 	, highest_seen_request_(0)
 	, out_of_order_requests_()
 	, request_increment_(1)
+	, receive_batch_size_(16)
 {}
 
 artdaq::RequestReceiver::RequestReceiver(const fhicl::ParameterSet& ps)
@@ -61,6 +63,7 @@ artdaq::RequestReceiver::RequestReceiver(const fhicl::ParameterSet& ps)
 	, highest_seen_request_(0)
 	, out_of_order_requests_()
 	, request_increment_(ps.get<artdaq::Fragment::sequence_id_t>("request_increment", 1))
+	, receive_batch_size_(std::max(ps.get<size_t>("request_receive_batch_size", 16), static_cast<size_t>(1)))
 {
 	setupRequestListener();
 }
@@ -179,6 +182,20 @@ void artdaq::RequestReceiver::startRequestReceiverThread()
 
 void artdaq::RequestReceiver::receiveRequestsLoop()
 {
+	// Receive buffers are allocated once, and filled by recvmmsg up to receive_batch_size_ datagrams at a time
+	std::vector<uint8_t> buffer(receive_batch_size_ * MAX_REQUEST_MESSAGE_SIZE);
+	std::vector<struct iovec> iovecs(receive_batch_size_);
+	std::vector<struct sockaddr_in> from(receive_batch_size_);
+	std::vector<struct mmsghdr> msgs(receive_batch_size_);
+	for (size_t ii = 0; ii < receive_batch_size_; ++ii)
+	{
+		iovecs[ii].iov_base = &buffer[ii * MAX_REQUEST_MESSAGE_SIZE];
+		iovecs[ii].iov_len = MAX_REQUEST_MESSAGE_SIZE;
+		memset(&msgs[ii], 0, sizeof(struct mmsghdr));
+		msgs[ii].msg_hdr.msg_iov = &iovecs[ii];
+		msgs[ii].msg_hdr.msg_iovlen = 1;
+	}
+
 	while (!should_stop_)
 	{
 		TLOG(16) << "receiveRequestsLoop: Polling Request socket for new requests";
@@ -209,64 +226,30 @@ void artdaq::RequestReceiver::receiveRequestsLoop()
 			continue;
 		}
 
-		TLOG(11) << "Received packet on Request channel";
-		std::vector<uint8_t> buffer(MAX_REQUEST_MESSAGE_SIZE);
-		struct sockaddr_in from;
-		socklen_t          len = sizeof(from);
-		auto sts = recvfrom(request_socket_, &buffer[0], MAX_REQUEST_MESSAGE_SIZE, 0, (struct sockaddr*)&from, &len);
-		if (sts < 0)
+		for (size_t ii = 0; ii < receive_batch_size_; ++ii)
 		{
+			msgs[ii].msg_hdr.msg_name = &from[ii];
+			msgs[ii].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		}
+		auto count = recvmmsg(request_socket_, &msgs[0], receive_batch_size_, MSG_DONTWAIT, nullptr);
+		if (count < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK) continue;
 			TLOG(TLVL_ERROR) << "Error receiving request message header err=" << strerror(errno);
 			close(request_socket_);
 			request_socket_ = -1;
 			continue;
 		}
-
-		auto hdr_buffer = reinterpret_cast<artdaq::detail::RequestHeader*>(&buffer[0]);
-		TLOG(11) << "Request header word: 0x" << std::hex << hdr_buffer->header /*<< std::dec*/ << ", packet_count: " << hdr_buffer->packet_count << " from rank " << hdr_buffer->rank << ", " << inet_ntoa(from.sin_addr) << ":" << from.sin_port;
-		if (!hdr_buffer->isValid()) continue;
-
-		request_received_ = true;
-		if (hdr_buffer->mode == artdaq::detail::RequestMessageMode::EndOfRun)
-		{
-			TLOG(TLVL_INFO) << "Received Request Message with the EndOfRun marker. (Re)Starting 1-second timeout for receiving all outstanding requests...";
-			request_stop_timeout_ = std::chrono::steady_clock::now();
-			request_stop_requested_ = true;
-		}
-
-		std::vector<artdaq::detail::RequestPacket> pkt_buffer(hdr_buffer->packet_count);
-		memcpy(&pkt_buffer[0], &buffer[sizeof(artdaq::detail::RequestHeader)], sizeof(artdaq::detail::RequestPacket) * hdr_buffer->packet_count);
-		bool anyNew = false;
+		TLOG(11) << "Received " << count << " packets on Request channel";
 
 		if (should_stop_) break;
 
-		for (auto& buffer : pkt_buffer)
+		bool anyNew = false;
 		{
-			TLOG(20) << "Request Packet: hdr=" << /*std::dec <<*/ buffer.header << ", seq=" << buffer.sequence_id << ", ts=" << buffer.timestamp;
-			if (!buffer.isValid()) continue;
 			std::unique_lock<std::mutex> tlk(request_mutex_);
-			if (requests_.count(buffer.sequence_id) && requests_[buffer.sequence_id] != buffer.timestamp)
+			for (int ii = 0; ii < count; ++ii)
 			{
-				TLOG(TLVL_ERROR) << "Received conflicting request for SeqID "
-					<< buffer.sequence_id << "!"
-					<< " Old ts=" << requests_[buffer.sequence_id]
-					<< ", new ts=" << buffer.timestamp << ". Keeping OLD!";
-			}
-			else if (!requests_.count(buffer.sequence_id))
-			{
-				int delta = buffer.sequence_id - highest_seen_request_;
-				TLOG(11) << "Received request for sequence ID " << buffer.sequence_id
-					<< " and timestamp " << buffer.timestamp << " (delta: " << delta << ")";
-				if (delta <= 0 || out_of_order_requests_.count(buffer.sequence_id))
-				{
-					TLOG(11) << "Already serviced this request ( sequence ID " << buffer.sequence_id << ")! Ignoring...";
-				}
-				else
-				{
-					requests_[buffer.sequence_id] = buffer.timestamp;
-					request_timing_[buffer.sequence_id] = std::chrono::steady_clock::now();
-					anyNew = true;
-				}
+				if (handleRequestMessage_(&buffer[ii * MAX_REQUEST_MESSAGE_SIZE], msgs[ii].msg_len, from[ii])) anyNew = true;
 			}
 		}
 		if (anyNew)
@@ -278,6 +261,69 @@ void artdaq::RequestReceiver::receiveRequestsLoop()
 	running_ = false;
 }
 
+bool artdaq::RequestReceiver::handleRequestMessage_(uint8_t const* buffer, size_t size, struct sockaddr_in const& from)
+{
+	if (size < sizeof(artdaq::detail::RequestHeader)) return false;
+
+	artdaq::detail::RequestHeader hdr;
+	memcpy(&hdr, buffer, sizeof(artdaq::detail::RequestHeader));
+	TLOG(11) << "Request header word: 0x" << std::hex << hdr.header /*<< std::dec*/ << ", packet_count: " << hdr.packet_count << " from rank " << hdr.rank << ", " << inet_ntoa(from.sin_addr) << ":" << from.sin_port;
+	if (!hdr.isValid()) return false;
+
+	request_received_ = true;
+	if (hdr.mode == artdaq::detail::RequestMessageMode::EndOfRun)
+	{
+		TLOG(TLVL_INFO) << "Received Request Message with the EndOfRun marker. (Re)Starting 1-second timeout for receiving all outstanding requests...";
+		request_stop_timeout_ = std::chrono::steady_clock::now();
+		request_stop_requested_ = true;
+	}
+
+	bool anyNew = false;
+	auto now = std::chrono::steady_clock::now();
+	auto complete = artdaq::detail::RequestMessage::DecodeRequests(buffer, size, [&](artdaq::Fragment::sequence_id_t seq, artdaq::Fragment::timestamp_t ts)
+	{
+		TLOG(20) << "Request Packet: seq=" << seq << ", ts=" << ts;
+		// Requests which were already serviced are the common case for resent messages; drop them before any lookups
+		if (seq <= highest_seen_request_)
+		{
+			TLOG(11) << "Already serviced this request ( sequence ID " << seq << ")! Ignoring...";
+			return;
+		}
+
+		// New requests usually belong at the end of the map, so one lookup gives both the duplicate check and the insert position
+		auto it = requests_.lower_bound(seq);
+		if (it != requests_.end() && it->first == seq)
+		{
+			if (it->second != ts)
+			{
+				TLOG(TLVL_ERROR) << "Received conflicting request for SeqID "
+					<< seq << "!"
+					<< " Old ts=" << it->second
+					<< ", new ts=" << ts << ". Keeping OLD!";
+			}
+			return;
+		}
+
+		TLOG(11) << "Received request for sequence ID " << seq
+			<< " and timestamp " << ts << " (delta: " << static_cast<int>(seq - highest_seen_request_) << ")";
+		if (out_of_order_requests_.count(seq))
+		{
+			TLOG(11) << "Already serviced this request ( sequence ID " << seq << ")! Ignoring...";
+		}
+		else
+		{
+			requests_.emplace_hint(it, seq, ts);
+			request_timing_[seq] = now;
+			anyNew = true;
+		}
+	});
+	if (!complete)
+	{
+		TLOG(TLVL_WARNING) << "Request message from rank " << hdr.rank << " was truncated or corrupt; some requests may have been lost";
+	}
+	return anyNew;
+}
+
 void artdaq::RequestReceiver::RemoveRequest(artdaq::Fragment::sequence_id_t reqID)
 {
 	TLOG(10) << "RemoveRequest: Removing request for id " << reqID;
@@ -7,8 +7,11 @@
 #include "fhiclcpp/types/Atom.h"
 #include "fhiclcpp/types/ConfigurationTable.h"
 
+#include <map>
 #include <mutex>
 #include <condition_variable>
+#include <unordered_map>
+#include <netinet/in.h>
 
 namespace artdaq
 {
@@ -34,6 +37,8 @@ namespace artdaq
 			fhicl::Atom<size_t> end_of_run_timeout_ms{ fhicl::Name{"end_of_run_quiet_timeout_ms"}, fhicl::Comment{"Amount of time (in ms) to wait for no new requests when a Stop transition is pending"}, 1000 };
 			/// "request_increment" (Default: 1) : Expected increment of sequence ID between each request
 			fhicl::Atom<artdaq::Fragment::sequence_id_t> request_increment{ fhicl::Name{"request_increment"}, fhicl::Comment{"Expected increment of sequence ID between each request"}, 1 };
+			/// "request_receive_batch_size" (Default: 16) : Maximum number of request datagrams to read from the socket at once
+			fhicl::Atom<size_t> request_receive_batch_size{ fhicl::Name{"request_receive_batch_size"}, fhicl::Comment{"Maximum number of request datagrams to read from the socket at once"}, 16 };
 		};
 		using Parameters = fhicl::WrappedTable<Config>;
 
@@ -77,12 +82,7 @@ namespace artdaq
 		std::map<artdaq::Fragment::sequence_id_t, artdaq::Fragment::timestamp_t> GetRequests() const
 		{
 			std::unique_lock<std::mutex> lk(request_mutex_);
-			std::map<artdaq::Fragment::sequence_id_t, Fragment::timestamp_t> out;
-			for (auto& in : requests_)
-			{
-				out[in.first] = in.second;
-			}
-			return out;
+			return requests_;
 		}
 
 		/// <summary>
@@ -114,11 +114,7 @@ namespace artdaq
 		{
 			std::unique_lock<std::mutex> lk(request_mutex_);
 			std::map<artdaq::Fragment::sequence_id_t, Fragment::timestamp_t> out;
-			for (auto& in : requests_)
-			{
-				out[in.first] = in.second;
-			}
-			requests_.clear();
+			out.swap(requests_);
 			return out;
 		}
 
@@ -153,7 +149,8 @@ namespace artdaq
 		std::chrono::steady_clock::time_point GetRequestTime(artdaq::Fragment::sequence_id_t reqID)
 		{
 			std::unique_lock<std::mutex> lk(request_mutex_);
-			return request_timing_.count(reqID) ? request_timing_[reqID] : std::chrono::steady_clock::now();
+			auto it = request_timing_.find(reqID);
+			return it != request_timing_.end() ? it->second : std::chrono::steady_clock::now();
 		}
 	private:
 		// FHiCL-configurable variables. Note that the C++ variable names
@@ -166,7 +163,7 @@ namespace artdaq
 		//Socket parameters
 		int request_socket_;
 		std::map<artdaq::Fragment::sequence_id_t, artdaq::Fragment::timestamp_t> requests_;
-		std::map<artdaq::Fragment::sequence_id_t, std::chrono::steady_clock::time_point> request_timing_;
+		std::unordered_map<artdaq::Fragment::sequence_id_t, std::chrono::steady_clock::time_point> request_timing_;
 		std::atomic<bool> request_stop_requested_;
 		std::chrono::steady_clock::time_point request_stop_timeout_;
 		std::atomic<bool> request_received_;
@@ -180,6 +177,9 @@ namespace artdaq
 		std::atomic<artdaq::Fragment::sequence_id_t> highest_seen_request_;
 		std::set<artdaq::Fragment::sequence_id_t> out_of_order_requests_;
 		artdaq::Fragment::sequence_id_t request_increment_;
+		size_t receive_batch_size_;
+
+		bool handleRequestMessage_(uint8_t const* buffer, size_t size, struct sockaddr_in const& from);
 	};
 }
 
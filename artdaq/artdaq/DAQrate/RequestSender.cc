@@ -21,15 +21,26 @@ namespace artdaq
 		: send_requests_(pset.get<bool>("send_requests", false))
 		, initialized_(false)
 		, active_requests_()
+		, unsent_requests_()
+		, full_request_pending_(false)
+		, flush_requested_(false)
+		, batch_start_time_(std::chrono::steady_clock::now())
+		, last_full_request_time_(std::chrono::steady_clock::now())
+		, request_thread_stop_(false)
 		, request_address_(pset.get<std::string>("request_address", "227.128.12.26"))
 		, request_port_(pset.get<int>("request_port", 3001))
 		, request_delay_(pset.get<size_t>("request_delay_ms", 0) * 1000)
+		, request_max_batch_size_(pset.get<size_t>("request_max_batch_size", 100))
+		, request_full_refresh_interval_us_(pset.get<size_t>("request_full_refresh_interval_ms", 1000) * 1000)
+		, compact_request_messages_(pset.get<bool>("compact_request_messages", false))
 		, request_shutdown_timeout_us_(pset.get<size_t>("request_shutdown_timeout_us", 100000))
 		, multicast_out_addr_(pset.get<std::string>("multicast_interface_ip", pset.get<std::string>("output_address", "0.0.0.0")))
 		, request_mode_(detail::RequestMessageMode::Normal)
 		, token_socket_(-1)
-		, request_sending_(0)
 	        , tokens_sent_(0)
+		, token_buffers_occupied_(0)
+		, token_buffer_count_(0)
+		, token_art_latency_us_(0)
 	{
 		TLOG(TLVL_DEBUG) << "RequestSender CONSTRUCTOR";
 		setup_requests_();
@@ -39,6 +50,10 @@ namespace artdaq
 		token_port_ = rmConfig.get<int>("routing_token_port", 35555);
 		token_address_ = rmConfig.get<std::string>("routing_master_hostname", "localhost");
 		setup_tokens_();
+		if (send_requests_)
+		{
+			request_thread_ = boost::thread(&RequestSender::request_thread_loop_, this);
+		}
 		TLOG(12) << "artdaq::RequestSender::RequestSender ctor - reader_thread_ initialized";
 		initialized_ = true;
 	}
@@ -46,17 +61,19 @@ namespace artdaq
 
 	RequestSender::~RequestSender()
 	{
-		TLOG(TLVL_INFO) << "Shutting down RequestSender: Waiting for " << request_sending_.load() << " requests to be sent";
-
-		auto start_time = std::chrono::steady_clock::now();
-
-		while (request_sending_.load() > 0 && request_shutdown_timeout_us_ + request_delay_ > TimeUtils::GetElapsedTimeMicroseconds(start_time))
 		{
-			usleep(1000);
+			std::unique_lock<std::mutex> lk(request_mutex_);
+			TLOG(TLVL_INFO) << "Shutting down RequestSender: Sending " << unsent_requests_.size() << " pending requests";
+			request_thread_stop_ = true;
 		}
+		request_cv_.notify_all();
+		if (request_thread_.joinable())
 		{
-			std::unique_lock<std::mutex> lk(request_mutex_);
-			std::unique_lock<std::mutex> lk2(request_send_mutex_);
+			if (!request_thread_.try_join_for(boost::chrono::microseconds(request_shutdown_timeout_us_ + request_delay_)))
+			{
+				TLOG(TLVL_WARNING) << "Request sending thread did not finish within the shutdown timeout, waiting for it";
+				request_thread_.join();
+			}
 		}
 		TLOG(TLVL_INFO) << "Shutting down RequestSender";
 		if (request_socket_ > 0)
@@ -164,44 +181,104 @@ namespace artdaq
 		}
 	}
 
-	void RequestSender::do_send_request_()
+	void RequestSender::request_thread_loop_()
 	{
-		if (!send_requests_) {
-			request_sending_--;
-			return;
-		}
-		if (request_socket_ == -1) setup_requests_();
+		std::unique_lock<std::mutex> lk(request_mutex_);
+		while (true)
+		{
+			auto refresh_due = [this]() {
+				return request_full_refresh_interval_us_ > 0 && active_requests_.size() > 0
+					&& TimeUtils::GetElapsedTimeMicroseconds(last_full_request_time_) >= request_full_refresh_interval_us_;
+			};
 
-		TLOG(TLVL_TRACE) << "Waiting for " << request_delay_ << " microseconds.";
-		std::this_thread::sleep_for(std::chrono::microseconds(request_delay_));
+			// Sleep until there is something to send, or the next full refresh is due
+			while (!request_thread_stop_ && unsent_requests_.empty() && !full_request_pending_ && !flush_requested_ && !refresh_due())
+			{
+				if (request_full_refresh_interval_us_ > 0 && active_requests_.size() > 0)
+				{
+					request_cv_.wait_until(lk, last_full_request_time_ + std::chrono::microseconds(request_full_refresh_interval_us_));
+				}
+				else
+				{
+					request_cv_.wait(lk);
+				}
+			}
+			if (request_thread_stop_ && unsent_requests_.empty() && !full_request_pending_) break;
 
-		TLOG(TLVL_TRACE) << "Creating RequestMessage";
-		detail::RequestMessage message;
-		{
-			std::unique_lock<std::mutex> lk(request_mutex_);
-			for (auto& req : active_requests_)
+			// Give other requests a chance to join this message
+			auto batch_end = batch_start_time_ + std::chrono::microseconds(request_delay_);
+			while (!request_thread_stop_ && !flush_requested_ && unsent_requests_.size() < request_max_batch_size_
+				&& std::chrono::steady_clock::now() < batch_end)
+			{
+				request_cv_.wait_until(lk, batch_end);
+			}
+
+			auto full = full_request_pending_ || refresh_due();
+			std::vector<std::pair<Fragment::sequence_id_t, Fragment::timestamp_t>> requests;
+			if (full)
 			{
-				TLOG(12) << "Adding a request with sequence ID " << req.first << ", timestamp " << req.second << " to request message";
-				message.addRequest(req.first, req.second);
+				TLOG(TLVL_TRACE) << "Sending all " << active_requests_.size() << " active requests";
+				requests.reserve(active_requests_.size());
+				for (auto& req : active_requests_)
+				{
+					requests.emplace_back(req.first, req.second);
+				}
+				last_full_request_time_ = std::chrono::steady_clock::now();
+			}
+			else
+			{
+				TLOG(TLVL_TRACE) << "Sending " << unsent_requests_.size() << " new requests";
+				requests.reserve(unsent_requests_.size());
+				for (auto& seq : unsent_requests_)
+				{
+					// Requests removed before they could be sent are skipped
+					if (active_requests_.count(seq)) requests.emplace_back(seq, active_requests_[seq]);
+				}
 			}
+			unsent_requests_.clear();
+			full_request_pending_ = false;
+			flush_requested_ = false;
+			auto mode = request_mode_.load();
+
+			lk.unlock();
+			if (full || requests.size() > 0) send_request_message_(requests, mode);
+			lk.lock();
 		}
-		TLOG(TLVL_TRACE) << "Setting mode flag in Message Header";
-		message.setMode(request_mode_);
+		TLOG(TLVL_DEBUG) << "Ending request sending thread";
+	}
+
+	void RequestSender::send_request_message_(std::vector<std::pair<Fragment::sequence_id_t, Fragment::timestamp_t>> const& requests, detail::RequestMessageMode mode)
+	{
+		if (request_socket_ == -1) setup_requests_();
+
 		char str[INET_ADDRSTRLEN];
 		inet_ntop(AF_INET, &(request_addr_.sin_addr), str, INET_ADDRSTRLEN);
-		std::unique_lock<std::mutex> lk2(request_send_mutex_);
-		TLOG(TLVL_TRACE) << "Sending request for " << message.size() << " events to multicast group " << str;
-		auto buf = message.GetMessage();
-		auto sts=sendto(request_socket_, &buf[0], buf.size(), 0, (struct sockaddr *)&request_addr_, sizeof(request_addr_));
-		if (sts < 0 || static_cast<size_t>(sts) != buf.size())
+
+		// Split the requests so that each message fits in a datagram. An empty list still sends one message, to carry the mode.
+		size_t next = 0;
+		do
 		{
-			TLOG(TLVL_ERROR) << "Error sending request message err=" << strerror(errno)<< "sts="<<sts;
-			request_socket_ = -1;
-			request_sending_--;
-			return;
-		}
-		TLOG(TLVL_TRACE) << "Done sending request sts="<<sts;
-		request_sending_--;
+			TLOG(TLVL_TRACE) << "Creating RequestMessage";
+			detail::RequestMessage message(compact_request_messages_);
+			for (; next < requests.size() && !message.full(); ++next)
+			{
+				TLOG(12) << "Adding a request with sequence ID " << requests[next].first << ", timestamp " << requests[next].second << " to request message";
+				message.addRequest(requests[next].first, requests[next].second);
+			}
+			TLOG(TLVL_TRACE) << "Setting mode flag in Message Header";
+			message.setMode(mode);
+
+			TLOG(TLVL_TRACE) << "Sending request for " << message.size() << " events to multicast group " << str;
+			auto buf = message.GetMessage();
+			auto sts = sendto(request_socket_, &buf[0], buf.size(), 0, (struct sockaddr *)&request_addr_, sizeof(request_addr_));
+			if (sts < 0 || static_cast<size_t>(sts) != buf.size())
+			{
+				TLOG(TLVL_ERROR) << "Error sending request message err=" << strerror(errno) << "sts=" << sts;
+				request_socket_ = -1;
+				return;
+			}
+			TLOG(TLVL_TRACE) << "Done sending request sts=" << sts;
+		} while (next < requests.size());
 	}
 
 	void RequestSender::send_routing_token_(int nSlots)
@@ -213,6 +290,9 @@ namespace artdaq
 		token.header = TOKEN_MAGIC;
 		token.rank = my_rank;
 		token.new_slots_free = nSlots;
+		token.buffers_occupied = token_buffers_occupied_.load();
+		token.buffer_count = token_buffer_count_.load();
+		token.art_latency_us = token_art_latency_us_.load();
 
 		TLOG(TLVL_TRACE) << "Sending RoutingToken to " << token_address_ << ":" << token_port_;
 		size_t sts = 0;
@@ -242,29 +322,53 @@ namespace artdaq
 		usleep(0); // Give up time slice
 	}
 
+	void RequestSender::SetRoutingTokenStatus(unsigned buffers_occupied, unsigned buffer_count, uint32_t art_latency_us)
+	{
+		token_buffers_occupied_ = buffers_occupied;
+		token_buffer_count_ = buffer_count;
+		token_art_latency_us_ = art_latency_us;
+	}
+
 	void RequestSender::SendRequest(bool endOfRunOnly)
 	{
 		while (!initialized_) usleep(1000);
 
 		if (!send_requests_) return;
 		if (endOfRunOnly && request_mode_ != detail::RequestMessageMode::EndOfRun) return;
-		request_sending_++;
-		boost::thread request([=] { do_send_request_(); });
-		request.detach();
+		{
+			std::lock_guard<std::mutex> lk(request_mutex_);
+			if (request_mode_ == detail::RequestMessageMode::EndOfRun)
+			{
+				if (!full_request_pending_ && unsent_requests_.empty()) batch_start_time_ = std::chrono::steady_clock::now();
+				full_request_pending_ = true;
+			}
+			else if (!unsent_requests_.empty())
+			{
+				flush_requested_ = true;
+			}
+			else
+			{
+				return;
+			}
+		}
+		request_cv_.notify_all();
 	}
 
 	void RequestSender::AddRequest(Fragment::sequence_id_t seqID, Fragment::timestamp_t timestamp)
 	{
 		while (!initialized_) usleep(1000);
 
+		if (!send_requests_) return;
 		{
 			std::lock_guard<std::mutex> lk(request_mutex_);
-			if (!active_requests_.count(seqID)) {
-				TLOG(12) << "Adding request for sequence ID " << seqID << " and timestamp " << timestamp << " to request list.";
-				active_requests_[seqID] = timestamp;
-			}
+			if (active_requests_.count(seqID)) return;
+
+			TLOG(12) << "Adding request for sequence ID " << seqID << " and timestamp " << timestamp << " to request list.";
+			active_requests_[seqID] = timestamp;
+			if (!full_request_pending_ && unsent_requests_.empty()) batch_start_time_ = std::chrono::steady_clock::now();
+			unsent_requests_.insert(seqID);
 		}
-		SendRequest();
+		request_cv_.notify_all();
 	}
 
 	void RequestSender::RemoveRequest(Fragment::sequence_id_t seqID)
@@ -273,5 +377,6 @@ namespace artdaq
 		std::lock_guard<std::mutex> lk(request_mutex_);
 		TLOG(12) << "Removing request for sequence ID " << seqID << " from request list.";
 		active_requests_.erase(seqID);
+		unsent_requests_.erase(seqID);
 	}
 }
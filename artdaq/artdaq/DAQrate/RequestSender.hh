@@ -9,9 +9,12 @@
 #include "fhiclcpp/types/Table.h"
 
 #include <map>
+#include <set>
 #include <memory>
 #include <chrono>
 #include <future>
+#include <condition_variable>
+#include <boost/thread.hpp>
 #include <stdint.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -51,8 +54,14 @@ namespace artdaq
 			fhicl::Atom<bool> send_requests{ fhicl::Name{ "send_requests" }, fhicl::Comment{ "Enable sending Data Request messages" }, false };
 			/// "request_port" (Default: 3001): Port to send DataRequests on
 			fhicl::Atom<int> request_port{ fhicl::Name{"request_port"}, fhicl::Comment{"Port to send DataRequests on"},3001 };
-			/// "request_delay_ms" (Default: 10): How long to wait before sending new DataRequests
-			fhicl::Atom<size_t> request_delay_ms{ fhicl::Name{"request_delay_ms"}, fhicl::Comment{"How long to wait before sending new DataRequests"}, 10 };
+			/// "request_delay_ms" (Default: 10): How long to wait before sending new DataRequests. New requests arriving during this time are sent in the same message
+			fhicl::Atom<size_t> request_delay_ms{ fhicl::Name{"request_delay_ms"}, fhicl::Comment{"How long to wait before sending new DataRequests. New requests arriving during this time are sent in the same message"}, 10 };
+			/// "request_max_batch_size" (Default: 100): Send new DataRequests without waiting for request_delay_ms once this many are waiting
+			fhicl::Atom<size_t> request_max_batch_size{ fhicl::Name{"request_max_batch_size"}, fhicl::Comment{"Send new DataRequests without waiting for request_delay_ms once this many are waiting"}, 100 };
+			/// "request_full_refresh_interval_ms" (Default: 1000): How often to re-send all active DataRequests, in case a message was lost (0 to disable)
+			fhicl::Atom<size_t> request_full_refresh_interval_ms{ fhicl::Name{"request_full_refresh_interval_ms"}, fhicl::Comment{"How often to re-send all active DataRequests, in case a message was lost (0 to disable)"}, 1000 };
+			/// "compact_request_messages" (Default: false): Send DataRequests in the compact, delta-encoded format. Requires receivers which understand this format
+			fhicl::Atom<bool> compact_request_messages{ fhicl::Name{"compact_request_messages"}, fhicl::Comment{"Send DataRequests in the compact, delta-encoded format. Requires receivers which understand this format"}, false };
 			/// "request_shutdown_timeout_us" (Default: 100000 us): How long to wait for pending requests to be sent at shutdown
 			fhicl::Atom<size_t> request_shutdown_timeout_us{ fhicl::Name{ "request_shutdown_timeout_us"},fhicl::Comment{"How long to wait for pending requests to be sent at shutdown"}, 100000 };
 			/// "multicast_interface_ip" (Default: "0.0.0.0"): Use this hostname for multicast output (to assign to the proper NIC)
@@ -103,8 +112,12 @@ namespace artdaq
 		detail::RequestMessageMode GetRequestMode() const { return request_mode_; }
 
 		/**
-		 * \brief Send a request message containing all current requests
+		 * \brief Make sure that the current requests are sent
 		 * \param endOfRunOnly Whether the request should only be sent in EndOfRun RequestMessageMode (default: false)
+		 *
+		 * In Normal mode, new requests which have not yet been sent are sent without waiting for a full batch. Requests
+		 * which were already sent are re-sent with the next full refresh. In EndOfRun mode, a message containing all current
+		 * requests is sent, so that receivers see the EndOfRun marker promptly.
 		 */
 		void SendRequest(bool endOfRunOnly = false);
 
@@ -112,6 +125,8 @@ namespace artdaq
 		 * \brief Add a request to the request list
 		 * \param seqID Sequence ID for request
 		 * \param timestamp Timestamp to request
+		 *
+		 * The request is sent by the request sending thread, together with any other requests added within request_delay_ms
 		 */
 		void AddRequest(Fragment::sequence_id_t seqID, Fragment::timestamp_t timestamp);
 
@@ -127,6 +142,14 @@ namespace artdaq
 		 */
 		void SendRoutingToken(int nSlots);
 
+		/**
+		 * \brief Set the occupancy and latency information which will be sent with subsequent RoutingTokens
+		 * \param buffers_occupied Number of buffers currently in use
+		 * \param buffer_count Total number of buffers
+		 * \param art_latency_us Recent average art processing latency, in microseconds (0 if unknown)
+		 */
+		void SetRoutingTokenStatus(unsigned buffers_occupied, unsigned buffer_count, uint32_t art_latency_us);
+
 		/**
 		 * \brief Get the count of number of tokens sent
 		 * \return The number of tokens sent by RequestSender
@@ -138,28 +161,42 @@ namespace artdaq
 		bool send_requests_;
 		std::atomic<bool> initialized_;
 		mutable std::mutex request_mutex_;
-		mutable std::mutex request_send_mutex_;
+		std::condition_variable request_cv_;
 		std::map<Fragment::sequence_id_t, Fragment::timestamp_t> active_requests_;
+		std::set<Fragment::sequence_id_t> unsent_requests_; // Requests added since the last message
+		bool full_request_pending_; // Whether the next message should contain all active requests
+		bool flush_requested_; // Whether the next message should be sent without waiting for request_delay_
+		std::chrono::steady_clock::time_point batch_start_time_;
+		std::chrono::steady_clock::time_point last_full_request_time_;
+		bool request_thread_stop_;
+		boost::thread request_thread_;
 		std::string request_address_;
 		int request_port_;
 		size_t request_delay_;
+		size_t request_max_batch_size_;
+		size_t request_full_refresh_interval_us_;
+		bool compact_request_messages_;
 		size_t request_shutdown_timeout_us_;
 		int request_socket_;
 		struct sockaddr_in request_addr_;
 		std::string multicast_out_addr_;
-		detail::RequestMessageMode request_mode_;
+		std::atomic<detail::RequestMessageMode> request_mode_; // Set by SetRequestMode, read by the request sender thread
 
 		bool send_routing_tokens_;
 		int token_port_;
 		int token_socket_;
 		std::string token_address_;
-		std::atomic<int> request_sending_;
 		std::atomic<size_t> tokens_sent_;
+		std::atomic<unsigned> token_buffers_occupied_;
+		std::atomic<unsigned> token_buffer_count_;
+		std::atomic<uint32_t> token_art_latency_us_;
 
 	private:
 		void setup_requests_();
 
-		void do_send_request_();
+		void request_thread_loop_();
+
+		void send_request_message_(std::vector<std::pair<Fragment::sequence_id_t, Fragment::timestamp_t>> const& requests, detail::RequestMessageMode mode);
 
 		void setup_tokens_();
 
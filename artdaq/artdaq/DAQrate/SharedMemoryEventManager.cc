@@ -5,6 +5,7 @@
 #include "artdaq-core/Core/StatisticsCollection.hh"
 #include "artdaq-core/Utilities/TraceLock.hh"
 #include <sys/wait.h>
+#include <cstring>
 
 #define TLVL_BUFFER 40
 #define TLVL_BUFLCK 41
@@ -14,7 +15,8 @@ std::mutex artdaq::SharedMemoryEventManager::sequence_id_mutex_;
 artdaq::SharedMemoryEventManager::SharedMemoryEventManager(fhicl::ParameterSet pset, fhicl::ParameterSet art_pset)
 	: SharedMemoryManager(pset.get<uint32_t>("shared_memory_key", 0xBEE70000 + getpid()),
 		pset.get<size_t>("buffer_count"),
-		pset.has_key("max_event_size_bytes") ? pset.get<size_t>("max_event_size_bytes") : pset.get<size_t>("expected_fragments_per_event") * pset.get<size_t>("max_fragment_size_bytes"),
+		(pset.has_key("max_event_size_bytes") ? pset.get<size_t>("max_event_size_bytes") : pset.get<size_t>("expected_fragments_per_event") * pset.get<size_t>("max_fragment_size_bytes"))
+		+ (art_pset.get<bool>("source.use_fragment_views", false) ? sizeof(detail::RawFragmentHeader) : 0), // Room for the end-of-event marker
 		pset.get<size_t>("stale_buffer_timeout_usec", pset.get<size_t>("event_queue_wait_time", 5) * 1000000),
 		!pset.get<bool>("broadcast_mode", false))
 	, num_art_processes_(pset.get<size_t>("art_analyzer_count", 1))
@@ -48,6 +50,18 @@ artdaq::SharedMemoryEventManager::SharedMemoryEventManager(fhicl::ParameterSet p
 	, current_art_pset_(art_pset)
 	, minimum_art_lifetime_s_(pset.get<double>("minimum_art_lifetime_s", 2.0))
 	, art_event_processing_time_us_(pset.get<size_t>("expected_art_event_processing_time_us", 100000))
+	, stale_buffer_timeout_usec_(pset.get<size_t>("stale_buffer_timeout_usec", pset.get<size_t>("event_queue_wait_time", 5) * 1000000))
+	, end_of_event_marker_(art_pset.get<bool>("source.use_fragment_views", false))
+	, buffer_release_times_()
+	, art_latency_us_(0)
+	, last_art_latency_check_(std::chrono::steady_clock::now())
+	, buffer_available_generation_(0)
+	, buffer_available_waiters_(0)
+	, buffer_wait_polling_(false)
+	, buffer_wait_recheck_interval_us_(pset.get<size_t>("buffer_wait_recheck_interval_us", 1000))
+	, header_wait_histogram_()
+	, header_wait_total_us_(0)
+	, header_wait_max_us_(0)
 	, requests_(nullptr)
 	, data_pset_(pset)
 	, dropped_data_()
@@ -55,6 +69,7 @@ artdaq::SharedMemoryEventManager::SharedMemoryEventManager(fhicl::ParameterSet p
 		pset.get<size_t>("broadcast_buffer_count", 10),
 		pset.get<size_t>("broadcast_buffer_size", 0x100000),
 		pset.get<int>("expected_art_event_processing_time_us", 100000) * pset.get<size_t>("buffer_count"), false)
+	, event_signal_(pset.get<uint32_t>("shared_memory_key", 0xBEE70000 + getpid()), true)
 {
 	SetMinWriteSize(sizeof(detail::RawEventHeader) + sizeof(detail::RawFragmentHeader));
 	broadcasts_.SetMinWriteSize(sizeof(detail::RawEventHeader) + sizeof(detail::RawFragmentHeader));
@@ -69,7 +84,7 @@ artdaq::SharedMemoryEventManager::SharedMemoryEventManager(fhicl::ParameterSet p
 		TLOG(TLVL_INFO) << "BEGIN SharedMemoryEventManager CONSTRUCTOR with use_art:true";
 		TLOG(TLVL_TRACE) << "art_pset is " << art_pset.to_string();
 	}
-	current_art_config_file_ = std::make_shared<art_config_file>(art_pset/*, GetKey(), GetBroadcastKey()*/);
+	current_art_config_file_ = std::make_shared<art_config_file>(art_pset, BufferSize(), stale_buffer_timeout_usec_/*, GetKey(), GetBroadcastKey()*/);
 
 	if (overwrite_mode_ && num_art_processes_ > 0)
 	{
@@ -84,6 +99,7 @@ artdaq::SharedMemoryEventManager::SharedMemoryEventManager(fhicl::ParameterSet p
 	{
 		buffer_writes_pending_[ii] = 0;
 	}
+	buffer_release_times_.resize(size());
 
 	if (!IsValid()) throw cet::exception(app_name + "_SharedMemoryEventManager") << "Unable to attach to Shared Memory!";
 
@@ -201,9 +217,12 @@ artdaq::RawDataType* artdaq::SharedMemoryEventManager::WriteFragmentHeader(detai
 	Write(buffer, &frag, frag.num_words() * sizeof(RawDataType));
 
 	auto pos = reinterpret_cast<RawDataType*>(GetWritePos(buffer));
-	if (frag.word_count - frag.num_words() > 0)
+	auto payload_bytes = (frag.word_count - frag.num_words()) * sizeof(RawDataType);
+	if (payload_bytes > 0)
 	{
-		auto sts = IncrementWritePos(buffer, (frag.word_count - frag.num_words()) * sizeof(RawDataType));
+		// When art uses the Fragments in place, the last RawFragmentHeader's worth of the buffer is kept free for the end-of-event marker
+		auto sts = BufferDataSize(buffer) + payload_bytes + (end_of_event_marker_ ? sizeof(detail::RawFragmentHeader) : 0) <= BufferSize()
+			&& IncrementWritePos(buffer, payload_bytes);
 
 		if (!sts)
 		{
@@ -228,6 +247,54 @@ artdaq::RawDataType* artdaq::SharedMemoryEventManager::WriteFragmentHeader(detai
 
 }
 
+artdaq::RawDataType* artdaq::SharedMemoryEventManager::WriteFragmentHeader(detail::RawFragmentHeader frag, size_t timeout_usec, bool dropIfNoBuffersAvailable, std::chrono::steady_clock::time_point wait_start)
+{
+	auto start = std::chrono::steady_clock::now();
+	if (wait_start == std::chrono::steady_clock::time_point()) wait_start = start;
+
+	// Read the generation before trying, so that a buffer freed between the attempt and the wait is not missed
+	std::unique_lock<std::mutex> lk(buffer_available_mutex_);
+	auto generation = buffer_available_generation_;
+	lk.unlock();
+
+	auto pos = WriteFragmentHeader(frag, false);
+	if (pos == nullptr)
+	{
+		TLOG(14) << "WriteFragmentHeader: No buffer available for sequence ID " << frag.sequence_id << ", waiting up to " << timeout_usec << " us";
+		buffer_available_waiters_++;
+		while (pos == nullptr)
+		{
+			auto elapsed_us = static_cast<size_t>(TimeUtils::GetElapsedTimeMicroseconds(start));
+			if (elapsed_us >= timeout_usec) break;
+			auto wait_us = timeout_usec - elapsed_us;
+
+			// Buffers released by art can only be found by polling. One waiter at a time does so (and wakes the others through
+			// check_pending_buffers_ when it finds a free buffer); the rest wait for a notification, or to take over polling.
+			lk.lock();
+			auto polling = !buffer_wait_polling_;
+			if (polling)
+			{
+				buffer_wait_polling_ = true;
+				wait_us = std::min(wait_us, buffer_wait_recheck_interval_us_);
+			}
+			buffer_available_cv_.wait_for(lk, std::chrono::microseconds(wait_us), [&] { return buffer_available_generation_ != generation || (!polling && !buffer_wait_polling_); });
+			if (polling) buffer_wait_polling_ = false;
+			generation = buffer_available_generation_;
+			lk.unlock();
+
+			pos = WriteFragmentHeader(frag, false);
+		}
+		// Another waiter may need to take over polling
+		if (--buffer_available_waiters_ > 0) buffer_available_cv_.notify_all();
+	}
+
+	if (pos == nullptr && dropIfNoBuffersAvailable) pos = WriteFragmentHeader(frag, true);
+	// The caller retries with the same wait_start after a timeout, so that each Fragment is only counted once
+	if (pos != nullptr) record_header_wait_(static_cast<size_t>(TimeUtils::GetElapsedTimeMicroseconds(wait_start)));
+	TLOG(14) << "WriteFragmentHeader: Done waiting for sequence ID " << frag.sequence_id << ", pos=" << (void*)pos;
+	return pos;
+}
+
 void artdaq::SharedMemoryEventManager::DoneWritingFragment(detail::RawFragmentHeader frag)
 {
 	TLOG(TLVL_TRACE) << "DoneWritingFragment BEGIN";
@@ -419,7 +486,7 @@ pid_t artdaq::SharedMemoryEventManager::StartArtProcess(fhicl::ParameterSet pset
 	if (pset != current_art_pset_ || !current_art_config_file_)
 	{
 		current_art_pset_ = pset;
-		current_art_config_file_ = std::make_shared<art_config_file>(pset/*, GetKey(), GetBroadcastKey()*/);
+		current_art_config_file_ = std::make_shared<art_config_file>(pset, BufferSize(), stale_buffer_timeout_usec_/*, GetKey(), GetBroadcastKey()*/);
 	}
 	std::shared_ptr<std::atomic<pid_t>> pid(new std::atomic<pid_t>(-1));
 	boost::thread thread([&] { RunArt(current_art_config_file_, pid); });
@@ -574,7 +641,7 @@ void artdaq::SharedMemoryEventManager::ReconfigureArt(fhicl::ParameterSet art_ps
 	if (art_pset != current_art_pset_ || !current_art_config_file_)
 	{
 		current_art_pset_ = art_pset;
-		current_art_config_file_ = std::make_shared<art_config_file>(art_pset/*, GetKey(), GetBroadcastKey()*/);
+		current_art_config_file_ = std::make_shared<art_config_file>(art_pset, BufferSize(), stale_buffer_timeout_usec_/*, GetKey(), GetBroadcastKey()*/);
 	}
 
 	if (n_art_processes != -1)
@@ -678,6 +745,7 @@ bool artdaq::SharedMemoryEventManager::endOfData()
 	{
 		MarkBufferEmpty(ii, true);
 	}
+	notify_buffer_available_();
 	// ELF 06/04/2018: Cannot clear broadcasts here, we want the EndOfDataFragment to persist until it's time to start art again...
 	// TLOG(TLVL_TRACE) << "endOfData: Clearing broadcast buffers";
 	// for (size_t ii = 0; ii < broadcasts_.size(); ++ii)
@@ -708,9 +776,11 @@ void artdaq::SharedMemoryEventManager::startRun(run_id_t runID)
 	subrun_id_ = 1;
 	subrun_rollover_event_ = Fragment::InvalidSequenceID;
 	last_released_event_ = 0;
+	std::fill(buffer_release_times_.begin(), buffer_release_times_.end(), std::chrono::steady_clock::time_point());
 	requests_.reset(new RequestSender(data_pset_));
 	if (requests_)
 	{
+		requests_->SetRoutingTokenStatus(0, queue_size_, static_cast<uint32_t>(art_latency_us_));
 	    requests_->SendRoutingToken(queue_size_);
 	}
 	TLOG(TLVL_DEBUG) << "Starting run " << run_id_
@@ -846,6 +916,16 @@ void artdaq::SharedMemoryEventManager::sendMetrics()
 bool artdaq::SharedMemoryEventManager::broadcastFragment_(FragmentPtr frag, FragmentPtr& outFrag)
 {
 	TLOG(TLVL_DEBUG) << "Broadcasting Fragment with seqID=" << frag->sequenceID() << ", type " << detail::RawFragmentHeader::SystemTypeToString(frag->type()) << ", size=" << frag->sizeBytes() << "B.";
+
+	// As for data buffers, the last RawFragmentHeader's worth of the buffer is kept free for the end-of-event marker
+	if (sizeof(detail::RawEventHeader) + frag->sizeBytes() + (end_of_event_marker_ ? sizeof(detail::RawFragmentHeader) : 0) > broadcasts_.BufferSize())
+	{
+		TLOG(TLVL_ERROR) << "Broadcast of fragment type " << frag->typeString() << " failed because it does not fit in a broadcast buffer (fragment size="
+		                 << frag->sizeBytes() << "B, broadcast_buffer_size=" << broadcasts_.BufferSize() << "B)!";
+		outFrag.swap(frag);
+		return false;
+	}
+
 	auto buffer = broadcasts_.GetBufferForWriting(false);
 	TLOG(TLVL_DEBUG) << "broadcastFragment_: after getting buffer 1st buffer=" << buffer;
 	auto start_time = std::chrono::steady_clock::now();
@@ -874,7 +954,9 @@ bool artdaq::SharedMemoryEventManager::broadcastFragment_(FragmentPtr frag, Frag
 	broadcasts_.Write(buffer, frag->headerAddress(), frag->size() * sizeof(RawDataType));
 
 	TLOG(TLVL_DEBUG) << "broadcastFragment_ Marking buffer full";
+	if (end_of_event_marker_) writeEndOfEventMarker_(broadcasts_, buffer);
 	broadcasts_.MarkBufferFull(buffer, -1);
+	event_signal_.Notify(num_art_processes_, queue_size_ + num_art_processes_); // Every art process reads each broadcast
 	outFrag.swap(frag);
 	TLOG(TLVL_DEBUG) << "broadcastFragment_ Complete";
 	return true;
@@ -885,6 +967,14 @@ artdaq::detail::RawEventHeader* artdaq::SharedMemoryEventManager::getEventHeader
 	return reinterpret_cast<detail::RawEventHeader*>(GetBufferStart(buffer));
 }
 
+void artdaq::SharedMemoryEventManager::writeEndOfEventMarker_(SharedMemoryManager& shm, int buffer)
+{
+	// Readers which use the Fragments in place (e.g. SharedMemoryReader with use_fragment_views) stop at a zero-length header,
+	// rather than reading on into whatever a previous event left in the buffer
+	if (shm.BufferDataSize(buffer) + sizeof(detail::RawFragmentHeader) > shm.BufferSize()) return;
+	memset(shm.GetWritePos(buffer), 0, sizeof(detail::RawFragmentHeader));
+}
+
 int artdaq::SharedMemoryEventManager::getBufferForSequenceID_(Fragment::sequence_id_t seqID, bool create_new, Fragment::timestamp_t timestamp)
 {
 	TLOG(14) << "getBufferForSequenceID " << seqID << " BEGIN";
@@ -916,9 +1006,15 @@ int artdaq::SharedMemoryEventManager::getBufferForSequenceID_(Fragment::sequence
 	check_pending_buffers_(lk);
 	int new_buffer = GetBufferForWriting(false);
 
-	if (new_buffer == -1)
+	if (new_buffer != -1)
+	{
+		// check_pending_buffers_ just looked at the buffers which art holds, so this one became Empty very recently
+		record_art_latency_(new_buffer, std::chrono::steady_clock::now());
+	}
+	else
 	{
 		new_buffer = GetBufferForWriting(overwrite_mode_);
+		if (new_buffer != -1) buffer_release_times_[new_buffer] = std::chrono::steady_clock::time_point();
 	}
 
 	if (new_buffer == -1) return -1;
@@ -959,6 +1055,9 @@ int artdaq::SharedMemoryEventManager::getBufferForSequenceID_(Fragment::sequence
 			requests_->SendRequest();
 		}
 	}
+	// Other sources may be waiting for a buffer for this sequence ID
+	notify_buffer_available_();
+
 	TLOG(14) << "getBufferForSequenceID " << seqID << " returning newly initialized buffer " << new_buffer;
 	return new_buffer;
 }
@@ -1086,7 +1185,10 @@ void artdaq::SharedMemoryEventManager::check_pending_buffers_(std::unique_lock<s
 			<< "event_size=" << BufferDataSize(buf) << ", buffer_size=" << BufferSize();
 
 		TLOG(TLVL_BUFFER) << "check_pending_buffers_ removing buffer " << buf << " moving from pending to full";
+		if (end_of_event_marker_) writeEndOfEventMarker_(*this, buf);
 		MarkBufferFull(buf);
+		event_signal_.Notify(1, queue_size_ + num_art_processes_);
+		buffer_release_times_[buf] = std::chrono::steady_clock::now();
 		subrun_event_count_++;
 		run_event_count_++;
 		counter++;
@@ -1101,6 +1203,8 @@ void artdaq::SharedMemoryEventManager::check_pending_buffers_(std::unique_lock<s
 			<< active_buffers_.size() << ")";
 	}
 
+	check_art_latency_();
+
 	if (requests_)
 	{
 		auto outstanding_tokens = requests_->GetSentTokenCount() - run_event_count_;
@@ -1113,6 +1217,8 @@ void artdaq::SharedMemoryEventManager::check_pending_buffers_(std::unique_lock<s
 		{
 			auto tokens_to_send = available_buffers - outstanding_tokens;
 
+			requests_->SetRoutingTokenStatus(size() - available_buffers, size(), static_cast<uint32_t>(art_latency_us_));
+
 			while (tokens_to_send > 0)
 			{
 				TLOG(35) << "check_pending_buffers_: Sending a Routing Token";
@@ -1125,6 +1231,11 @@ void artdaq::SharedMemoryEventManager::check_pending_buffers_(std::unique_lock<s
 	metric_data_.event_count += counter;
 	metric_data_.event_size += eventSize;
 
+	if (buffer_available_waiters_ > 0 && WriteReadyCount(overwrite_mode_) > 0)
+	{
+		notify_buffer_available_();
+	}
+
 	if (metricMan && TimeUtils::GetElapsedTimeMilliseconds(last_shmem_buffer_metric_update_) > 500) // Limit to 2 Hz updates
 	{
 		TLOG(TLVL_TRACE) << "check_pending_buffers_: Sending Metrics";
@@ -1137,8 +1248,10 @@ void artdaq::SharedMemoryEventManager::check_pending_buffers_(std::unique_lock<s
 		metricMan->sendMetric("Events Released to art this subrun", subrun_event_count_, "Events", 2, MetricMode::LastPoint);
 		metricMan->sendMetric("Incomplete Events Released to art this subrun", subrun_incomplete_event_count_, "Events", 2, MetricMode::LastPoint);
 		if (requests_) metricMan->sendMetric("Tokens sent", requests_->GetSentTokenCount(), "Tokens", 2, MetricMode::LastPoint);
+		send_header_wait_metrics_();
 
 		auto bufferReport = GetBufferReport();
+		if (art_latency_us_ > 0) metricMan->sendMetric("Average art Latency", art_latency_us_ / 1000000.0, "s", 2, MetricMode::Average);
 		int full = std::count_if(bufferReport.begin(), bufferReport.end(), [](std::pair<int, BufferSemaphoreFlags> p) {return p.second == BufferSemaphoreFlags::Full; });
 		int empty = std::count_if(bufferReport.begin(), bufferReport.end(), [](std::pair<int, BufferSemaphoreFlags> p) {return p.second == BufferSemaphoreFlags::Empty; });
 		int writing = std::count_if(bufferReport.begin(), bufferReport.end(), [](std::pair<int, BufferSemaphoreFlags> p) {return p.second == BufferSemaphoreFlags::Writing; });
@@ -1161,6 +1274,86 @@ void artdaq::SharedMemoryEventManager::check_pending_buffers_(std::unique_lock<s
 	TLOG(TLVL_TRACE) << "check_pending_buffers_ END";
 }
 
+void artdaq::SharedMemoryEventManager::check_art_latency_()
+{
+	// Buffers released to art are checked often enough that the time a buffer sits Empty is not counted as art latency
+	if (TimeUtils::GetElapsedTimeMicroseconds(last_art_latency_check_) < ART_LATENCY_CHECK_INTERVAL_US) return;
+	auto now = std::chrono::steady_clock::now();
+	last_art_latency_check_ = now;
+
+	for (size_t ii = 0; ii < buffer_release_times_.size(); ++ii)
+	{
+		if (buffer_release_times_[ii] != std::chrono::steady_clock::time_point() && CheckBuffer(ii, BufferSemaphoreFlags::Empty))
+		{
+			record_art_latency_(ii, now);
+		}
+	}
+}
+
+void artdaq::SharedMemoryEventManager::record_art_latency_(int buffer, std::chrono::steady_clock::time_point empty_time)
+{
+	// The clock starts when the buffer is marked Full, and stops when it is first seen Empty again
+	auto& release_time = buffer_release_times_[buffer];
+	if (release_time == std::chrono::steady_clock::time_point()) return;
+
+	double latency_us = std::chrono::duration_cast<std::chrono::microseconds>(empty_time - release_time).count();
+	art_latency_us_ = art_latency_us_ > 0 ? 0.9 * art_latency_us_ + 0.1 * latency_us : latency_us;
+	release_time = std::chrono::steady_clock::time_point();
+	TLOG(TLVL_TRACE) << "record_art_latency_: buffer " << buffer << " took " << latency_us << " us, art latency is now " << art_latency_us_ << " us";
+}
+
+void artdaq::SharedMemoryEventManager::notify_buffer_available_()
+{
+	if (buffer_available_waiters_ == 0) return;
+	{
+		std::unique_lock<std::mutex> lk(buffer_available_mutex_);
+		buffer_available_generation_++;
+	}
+	buffer_available_cv_.notify_all();
+}
+
+void artdaq::SharedMemoryEventManager::record_header_wait_(size_t wait_us)
+{
+	size_t bin = 0;
+	while (bin < header_wait_histogram_.size() - 1 && (wait_us >> bin) > 0) ++bin;
+	header_wait_histogram_[bin]++;
+	header_wait_total_us_ += wait_us;
+
+	auto max = header_wait_max_us_.load();
+	while (wait_us > max && !header_wait_max_us_.compare_exchange_weak(max, wait_us)) {}
+}
+
+void artdaq::SharedMemoryEventManager::send_header_wait_metrics_()
+{
+	std::array<size_t, 24> histogram;
+	size_t count = 0;
+	for (size_t ii = 0; ii < histogram.size(); ++ii)
+	{
+		histogram[ii] = header_wait_histogram_[ii].exchange(0);
+		count += histogram[ii];
+	}
+	auto total_us = header_wait_total_us_.exchange(0);
+	auto max_us = header_wait_max_us_.exchange(0);
+	if (count == 0) return;
+
+	// Report the upper edge of the bin containing each quantile
+	auto quantile = [&](double q) {
+		size_t seen = 0;
+		for (size_t ii = 0; ii < histogram.size(); ++ii)
+		{
+			seen += histogram[ii];
+			if (seen >= q * count) return (static_cast<size_t>(1) << ii) / 1000000.0;
+		}
+		return max_us / 1000000.0;
+	};
+
+	metricMan->sendMetric("Fragment Header Wait Count", count, "Fragments", 2, MetricMode::Accumulate);
+	metricMan->sendMetric("Average Fragment Header Wait Time", total_us / 1000000.0 / count, "s", 2, MetricMode::Average);
+	metricMan->sendMetric("Fragment Header Wait Time 50th Percentile", quantile(0.5), "s", 3, MetricMode::LastPoint);
+	metricMan->sendMetric("Fragment Header Wait Time 99th Percentile", quantile(0.99), "s", 3, MetricMode::LastPoint);
+	metricMan->sendMetric("Maximum Fragment Header Wait Time", max_us / 1000000.0, "s", 3, MetricMode::LastPoint);
+}
+
 void artdaq::SharedMemoryEventManager::send_init_frag_()
 {
 	if (init_fragment_ != nullptr)
@@ -1198,7 +1391,7 @@ void artdaq::SharedMemoryEventManager::UpdateArtConfiguration(fhicl::ParameterSe
 	if (art_pset != current_art_pset_ || !current_art_config_file_)
 	{
 		current_art_pset_ = art_pset;
-		current_art_config_file_ = std::make_shared<art_config_file>(art_pset/*, GetKey(), GetBroadcastKey()*/);
+		current_art_config_file_ = std::make_shared<art_config_file>(art_pset, BufferSize(), stale_buffer_timeout_usec_/*, GetKey(), GetBroadcastKey()*/);
 	}
 	TLOG(TLVL_DEBUG) << "UpdateArtConfiguration END";
 }
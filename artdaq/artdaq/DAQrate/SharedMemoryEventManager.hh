@@ -3,10 +3,13 @@
 
 #include "artdaq/DAQdata/Globals.hh" // Before trace.h gets included in ConcurrentQueue (from GlobalQueue)
 #include "artdaq-core/Core/SharedMemoryManager.hh"
+#include "artdaq/DAQrate/detail/SharedMemoryEventSignal.hh"
 #include "artdaq-core/Data/RawEvent.hh"
 #include "artdaq/DAQrate/RequestSender.hh"
 #include <set>
 #include <deque>
+#include <array>
+#include <condition_variable>
 #include <fstream>
 #include <iomanip>
 #include <sys/stat.h>
@@ -26,8 +29,10 @@ namespace artdaq {
 		/**
 		 * \brief art_config_file Constructor
 		 * \param ps ParameterSet to write to temporary file
+		 * \param buffer_size Size of the data shared memory buffers, passed to the source as shared_memory_buffer_size
+		 * \param stale_buffer_timeout_usec Stale buffer timeout of the data shared memory, passed to the source as stale_buffer_timeout_usec
 		 */
-		art_config_file(fhicl::ParameterSet ps/*, uint32_t shm_key, uint32_t broadcast_key*/)
+		art_config_file(fhicl::ParameterSet ps, size_t buffer_size, size_t stale_buffer_timeout_usec/*, uint32_t shm_key, uint32_t broadcast_key*/)
 			: dir_name_("/tmp/partition_" + std::to_string(GetPartitionNumber()))
 			, file_name_(dir_name_ + "/artConfig_" + std::to_string(my_rank) + "_" + std::to_string(artdaq::TimeUtils::gettimeofday_us()) + ".fcl")
 		{
@@ -59,6 +64,15 @@ namespace artdaq {
 			{
 				of << " services.message: { " << generateMessageFacilityConfiguration("art") << "} ";
 			}
+			// SharedMemoryReader needs these to use the Fragments in place in the shared memory buffers
+			if (ps.has_key("source") && !ps.has_key("source.shared_memory_buffer_size"))
+			{
+				of << " source.shared_memory_buffer_size: " << std::dec << buffer_size;
+			}
+			if (ps.has_key("source") && !ps.has_key("source.stale_buffer_timeout_usec"))
+			{
+				of << " source.stale_buffer_timeout_usec: " << std::dec << stale_buffer_timeout_usec;
+			}
 			//of << " source.shared_memory_key: 0x" << std::hex << shm_key;
 			//of << " source.broadcast_shared_memory_key: 0x" << std::hex << broadcast_key;
 			//of << " source.rank: " << std::dec << my_rank;
@@ -147,6 +161,8 @@ namespace artdaq {
 			fhicl::Atom<bool> use_art{ fhicl::Name{ "use_art"}, fhicl::Comment{"Whether to start and manage art threads (Sets art_analyzer count to 0 and overwrite_mode to true when false)"}, true };
 			/// "manual_art" (Default: false): Prints the startup command line for the art process so that the user may (for example) run it in GDB or valgrind
 			fhicl::Atom<bool> manual_art{ fhicl::Name{"manual_art"}, fhicl::Comment{"Prints the startup command line for the art process so that the user may (for example) run it in GDB or valgrind"}, false };
+			/// "buffer_wait_recheck_interval_us" (Default: 1000): While blocked in WriteFragmentHeader, how often to re-check for buffers released by art. Only one blocked thread re-checks at a time. Buffers made available by this process wake waiters immediately.
+			fhicl::Atom<size_t> buffer_wait_recheck_interval_us{ fhicl::Name{"buffer_wait_recheck_interval_us"}, fhicl::Comment{"While blocked in WriteFragmentHeader, how often to re-check for buffers released by art. Only one blocked thread re-checks at a time. Buffers made available by this process wake waiters immediately."}, 1000 };
 
 			fhicl::TableFragment<artdaq::RequestSender::Config> requestSenderConfig; ///< Configuration of the RequestSender. See artdaq::RequestSender::Config
 		};
@@ -190,6 +206,21 @@ namespace artdaq {
 		 */
 		RawDataType* WriteFragmentHeader(detail::RawFragmentHeader frag, bool dropIfNoBuffersAvailable = false);
 
+		/**
+		 * \brief Get a pointer to a reserved memory area for the given Fragment header, waiting up to timeout_usec for a buffer to become available
+		 * \param frag Fragment header (contains sequence ID and size information)
+		 * \param timeout_usec Maximum time to wait for a buffer, in microseconds
+		 * \param dropIfNoBuffersAvailable Whether to drop the fragment (instead of returning nullptr) when no buffers are available after the timeout
+		 * \param wait_start When the caller started waiting for a buffer for this Fragment (Default: now). Pass the same value when retrying after a timeout
+		 * \return Pointer to memory location for Fragment body (Header is copied into buffer here), or nullptr on timeout
+		 *
+		 * The caller is woken as soon as this SharedMemoryEventManager creates a buffer for the Fragment's sequence ID or
+		 * sees a buffer return to the Empty state. Buffers released by art (in another process) are noticed within
+		 * buffer_wait_recheck_interval_us. The time from wait_start until the Fragment gets a location (including zero waits)
+		 * is reported once per Fragment in the "Fragment Header Wait Time" metrics.
+		 */
+		RawDataType* WriteFragmentHeader(detail::RawFragmentHeader frag, size_t timeout_usec, bool dropIfNoBuffersAvailable, std::chrono::steady_clock::time_point wait_start = std::chrono::steady_clock::time_point());
+
 		/**
 		 * \brief Used to indicate that the given Fragment is now completely in the buffer. Will check for buffer completeness, and unset the pending flag.
 		 * \param frag Fragment that is now completely in the buffer.
@@ -428,6 +459,23 @@ namespace artdaq {
 		std::shared_ptr<art_config_file> current_art_config_file_;
 		double minimum_art_lifetime_s_;
 		size_t art_event_processing_time_us_;
+		size_t stale_buffer_timeout_usec_;
+		bool end_of_event_marker_; ///< Whether events end with an end-of-event marker, for art processes which use the Fragments in place (source.use_fragment_views)
+
+		std::vector<std::chrono::steady_clock::time_point> buffer_release_times_; ///< When each buffer was released to art, used for art latency measurement
+		double art_latency_us_; ///< Moving average of the time between release to art and the buffer becoming Empty
+		std::chrono::steady_clock::time_point last_art_latency_check_; ///< When the buffers released to art were last checked for the Empty state
+		static const size_t ART_LATENCY_CHECK_INTERVAL_US = 1000; ///< Minimum time between checks of the buffers released to art
+
+		std::mutex buffer_available_mutex_;
+		std::condition_variable buffer_available_cv_;
+		size_t buffer_available_generation_; ///< Incremented each time waiters in WriteFragmentHeader should re-check for a buffer
+		std::atomic<int> buffer_available_waiters_;
+		bool buffer_wait_polling_; ///< Whether a waiter in WriteFragmentHeader is re-checking for buffers released by art. Protected by buffer_available_mutex_
+		size_t buffer_wait_recheck_interval_us_;
+		std::array<std::atomic<size_t>, 24> header_wait_histogram_; ///< WriteFragmentHeader wait times, bin N holds waits in [2^(N-1), 2^N) us
+		std::atomic<size_t> header_wait_total_us_;
+		std::atomic<size_t> header_wait_max_us_;
 
 		std::unique_ptr<RequestSender> requests_;
 		fhicl::ParameterSet data_pset_;
@@ -438,15 +486,22 @@ namespace artdaq {
 		bool broadcastFragment_(FragmentPtr frag, FragmentPtr& outFrag);
 
 		detail::RawEventHeader* getEventHeader_(int buffer);
+		static void writeEndOfEventMarker_(SharedMemoryManager& shm, int buffer);
 
 		int getBufferForSequenceID_(Fragment::sequence_id_t seqID, bool create_new, Fragment::timestamp_t timestamp = Fragment::InvalidTimestamp);
 		bool hasFragments_(int buffer);
 		void complete_buffer_(int buffer);
 		bool bufferComparator(int bufA, int bufB);
 		void check_pending_buffers_(std::unique_lock<std::mutex> const& lock);
+		void check_art_latency_();
+		void record_art_latency_(int buffer, std::chrono::steady_clock::time_point empty_time);
+		void notify_buffer_available_();
+		void record_header_wait_(size_t wait_us);
+		void send_header_wait_metrics_();
 
 		void send_init_frag_();
 		SharedMemoryManager broadcasts_;
+		detail::SharedMemoryEventSignal event_signal_; // Wakes art processes waiting for an event
 		};
 	}
 
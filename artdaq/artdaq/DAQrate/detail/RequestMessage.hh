@@ -2,6 +2,8 @@
 #define artdaq_DAQrate_detail_RequestMessage_hh
 
 #include "artdaq-core/Data/Fragment.hh"
+#include <cstring>
+#include <cassert>
 #define MAX_REQUEST_MESSAGE_SIZE 65000
 
 namespace artdaq
@@ -84,12 +86,16 @@ public:
 
 /**
  * \brief Header of a RequestMessage. Contains magic bytes for validation and a count of expected RequestPackets
+ *
+ * The magic bytes also identify the format of the rest of the message:
+ * HEDR messages are followed by packet_count RequestPackets. HDRC (compact) messages are followed by the sequence ID and
+ * timestamp of the first request, then each subsequent request as a pair of ZigZag/LEB128 varint deltas from the previous one.
  */
 struct artdaq::detail::RequestHeader
 {
 	/** The magic bytes for the request header */
-	uint32_t header; //HEDR, or 0x48454452
-	uint32_t packet_count; ///< The number of RequestPackets in this Request message
+	uint32_t header; //HEDR, or 0x48454452 (HDRC, or 0x48445243, for compact messages)
+	uint32_t packet_count; ///< The number of requests in this Request message
 	int      rank; ///< Rank of the sender
 	RequestMessageMode mode; ///< Communicates additional information to the Request receiver
 
@@ -106,31 +112,59 @@ struct artdaq::detail::RequestHeader
 	* \brief Check the magic bytes of the packet
 	* \return Whether the correct magic bytes were found
 	*/
-	bool isValid() const { return header == 0x48454452; }
+	bool isValid() const { return header == 0x48454452 || header == 0x48445243; }
+
+	/**
+	 * \brief Check whether the message uses the compact (delta-encoded) format
+	 * \return Whether the compact magic bytes were found
+	 */
+	bool isCompact() const { return header == 0x48445243; }
 };
 
 /**
- * \brief A RequestMessage consists of a RequestHeader and zero or more RequestPackets. They will usually be sent in two calls to send()
+ * \brief A RequestMessage consists of a RequestHeader and zero or more requests, either as RequestPackets or in the compact format
  */
 class artdaq::detail::RequestMessage
 {
 public:
+	/// Maximum number of bytes that a single request adds to a message
+	static constexpr size_t max_request_bytes = sizeof(RequestPacket);
+	static_assert(max_request_bytes >= 20, "Two 64-bit varints must fit in max_request_bytes");
+
 	/**
-	 * \brief Default Constructor
+	 * \brief RequestMessage Constructor
+	 * \param compact Whether to use the compact (delta-encoded) format. Receivers older than the compact format will ignore these messages
 	 */
-	RequestMessage() : header_()
+	explicit RequestMessage(bool compact = false) : header_()
 		, packets_()
-	{}
+		, payload_()
+		, count_(0)
+		, last_seq_(0)
+		, last_ts_(0)
+	{
+		if (compact) header_.header = 0x48445243;
+	}
 
+	/**
+	 * \brief Serialize the RequestMessage
+	 * \return A buffer containing the RequestHeader and the encoded requests
+	 */
 	std::vector<uint8_t> GetMessage()
 	{
-		auto size = sizeof(RequestHeader) + packets_.size() * sizeof(RequestPacket);
-		header_.packet_count = packets_.size();
+		auto size = byte_size();
+		header_.packet_count = count_;
 		assert(size < MAX_REQUEST_MESSAGE_SIZE);
 		auto output = std::vector<uint8_t>(size);
 		memcpy(&output[0], &header_, sizeof(RequestHeader));
-		memcpy(&output[sizeof(RequestHeader)], &packets_[0], packets_.size() * sizeof(RequestPacket));
-		
+		if (header_.isCompact())
+		{
+			if (payload_.size()) memcpy(&output[sizeof(RequestHeader)], &payload_[0], payload_.size());
+		}
+		else if (packets_.size())
+		{
+			memcpy(&output[sizeof(RequestHeader)], &packets_[0], packets_.size() * sizeof(RequestPacket));
+		}
+
 		return output;
 	}
 
@@ -144,10 +178,25 @@ public:
 	}
 
 	/**
-	 * \brief Get the number of RequestPackets in the RequestMessage
-	 * \return The number of RequestPackets in the RequestMessage
+	 * \brief Get the number of requests in the RequestMessage
+	 * \return The number of requests in the RequestMessage
 	 */
-	size_t size() const { return packets_.size(); }
+	size_t size() const { return count_; }
+
+	/**
+	 * \brief Get the size of the serialized RequestMessage
+	 * \return The number of bytes GetMessage will return
+	 */
+	size_t byte_size() const
+	{
+		return sizeof(RequestHeader) + (header_.isCompact() ? payload_.size() : packets_.size() * sizeof(RequestPacket));
+	}
+
+	/**
+	 * \brief Determine whether another request may not fit in the message
+	 * \return Whether adding another request could exceed MAX_REQUEST_MESSAGE_SIZE
+	 */
+	bool full() const { return byte_size() + max_request_bytes >= MAX_REQUEST_MESSAGE_SIZE; }
 
 	/**
 	 * \brief Add a request for a sequence ID and timestamp combination
@@ -156,12 +205,112 @@ public:
 	 */
 	void addRequest(const Fragment::sequence_id_t& seq, const Fragment::timestamp_t& time)
 	{
-		packets_.emplace_back(RequestPacket(seq, time));
+		if (!header_.isCompact())
+		{
+			packets_.emplace_back(RequestPacket(seq, time));
+		}
+		else if (count_ == 0)
+		{
+			auto pos = payload_.size();
+			payload_.resize(pos + sizeof(seq) + sizeof(time));
+			memcpy(&payload_[pos], &seq, sizeof(seq));
+			memcpy(&payload_[pos + sizeof(seq)], &time, sizeof(time));
+		}
+		else
+		{
+			write_varint_(zigzag_(seq - last_seq_));
+			write_varint_(zigzag_(time - last_ts_));
+		}
+		last_seq_ = seq;
+		last_ts_ = time;
+		++count_;
+	}
+
+	/**
+	 * \brief Decode a received RequestMessage, in either format
+	 * \tparam F Callable with signature void(Fragment::sequence_id_t, Fragment::timestamp_t)
+	 * \param data Pointer to the start of the message (the RequestHeader)
+	 * \param size Number of bytes received
+	 * \param func Called for each valid request in the message, in order
+	 * \return Whether the message was completely decoded. Requests before a truncated or corrupt section are still passed to func
+	 *
+	 * The requests are decoded in place, without allocating memory.
+	 */
+	template<typename F>
+	static bool DecodeRequests(uint8_t const* data, size_t size, F&& func)
+	{
+		if (size < sizeof(RequestHeader)) return false;
+		RequestHeader hdr;
+		memcpy(&hdr, data, sizeof(RequestHeader));
+		if (!hdr.isValid()) return false;
+
+		auto pos = data + sizeof(RequestHeader);
+		auto end = data + size;
+		if (!hdr.isCompact())
+		{
+			for (uint32_t ii = 0; ii < hdr.packet_count; ++ii, pos += sizeof(RequestPacket))
+			{
+				if (end - pos < static_cast<ptrdiff_t>(sizeof(RequestPacket))) return false;
+				RequestPacket pkt;
+				memcpy(&pkt, pos, sizeof(RequestPacket));
+				if (pkt.isValid()) func(pkt.sequence_id, pkt.timestamp);
+			}
+			return true;
+		}
+
+		if (hdr.packet_count == 0) return true;
+		Fragment::sequence_id_t seq;
+		Fragment::timestamp_t ts;
+		if (end - pos < static_cast<ptrdiff_t>(sizeof(seq) + sizeof(ts))) return false;
+		memcpy(&seq, pos, sizeof(seq));
+		memcpy(&ts, pos + sizeof(seq), sizeof(ts));
+		pos += sizeof(seq) + sizeof(ts);
+		func(seq, ts);
+
+		for (uint32_t ii = 1; ii < hdr.packet_count; ++ii)
+		{
+			uint64_t seq_delta, ts_delta;
+			if (!read_varint_(pos, end, seq_delta) || !read_varint_(pos, end, ts_delta)) return false;
+			seq += unzigzag_(seq_delta);
+			ts += unzigzag_(ts_delta);
+			func(seq, ts);
+		}
+		return true;
 	}
 
 private:
+	// Deltas are computed modulo 2^64, then mapped so that small negative values also have short encodings
+	static uint64_t zigzag_(uint64_t delta) { return (delta << 1) ^ (0 - (delta >> 63)); }
+	static uint64_t unzigzag_(uint64_t value) { return (value >> 1) ^ (0 - (value & 1)); }
+
+	void write_varint_(uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			payload_.push_back(static_cast<uint8_t>(value) | 0x80);
+			value >>= 7;
+		}
+		payload_.push_back(static_cast<uint8_t>(value));
+	}
+
+	static bool read_varint_(uint8_t const*& pos, uint8_t const* end, uint64_t& value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 64 && pos < end; shift += 7)
+		{
+			auto byte = *pos++;
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) return true;
+		}
+		return false;
+	}
+
 	RequestHeader header_;
 	std::vector<RequestPacket> packets_;
+	std::vector<uint8_t> payload_;
+	uint32_t count_;
+	Fragment::sequence_id_t last_seq_;
+	Fragment::timestamp_t last_ts_;
 };
 
 #endif // artdaq_DAQrate_detail_RequestMessage
@@ -88,18 +88,27 @@ struct artdaq::detail::RoutingAckPacket
 
 /**
  * \brief Magic bytes expected in every RoutingToken
+ *
+ * Changed from 0xbeefcafe when the occupancy and latency fields were added, so that a RoutingMaster
+ * receiving the older, shorter RoutingToken rejects it instead of misreading the token stream.
  */
-#define TOKEN_MAGIC 0xbeefcafe
+#define TOKEN_MAGIC 0xbeefcaf2
 
 /**
  * \brief The RoutingToken contains the magic bytes, the rank of the token sender, and the number of slots free. This is 
  * a TCP message, so additional verification is not necessary.
+ *
+ * The token also carries a snapshot of the sender's shared memory occupancy and recent art latency, which
+ * RoutingMasterPolicy plugins may use to decide where to send events.
  */
 struct artdaq::detail::RoutingToken
 {
 	uint32_t header; ///< The magic bytes that help validate the RoutingToken
 	int rank; ///< The rank from which the RoutingToken came
 	unsigned new_slots_free; ///< The number of slots free in the token sender (usually 1)
+	unsigned buffers_occupied; ///< The number of shared memory buffers in use in the token sender (building, pending, or in art)
+	unsigned buffer_count; ///< The total number of shared memory buffers in the token sender (0 if unknown)
+	uint32_t art_latency_us; ///< Recent average time between an event being released to art and its buffer being freed, in microseconds (0 if unknown)
 };
 
 #endif //artdaq_Application_Routing_RoutingPacket_hh
\ No newline at end of file
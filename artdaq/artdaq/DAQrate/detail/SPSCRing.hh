@@ -0,0 +1,140 @@
+#ifndef artdaq_DAQrate_detail_SPSCRing_hh
+#define artdaq_DAQrate_detail_SPSCRing_hh
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace artdaq
+{
+	namespace detail
+	{
+		template <typename T>
+		class SPSCRing;
+	}
+}
+
+/**
+ * \brief A fixed-capacity, lock-free queue for handing objects from exactly one producer thread to exactly one consumer thread
+ * \tparam T Type of the objects in the queue. Must be default-constructible and move-assignable
+ *
+ * push may only be called from the producer thread, and pop from the consumer thread. size and empty may be called
+ * from either thread, but are only a snapshot.
+ */
+template <typename T>
+class artdaq::detail::SPSCRing
+{
+public:
+	/**
+	 * \brief SPSCRing Constructor
+	 * \param capacity Maximum number of objects in the queue. Rounded up to the next power of two
+	 */
+	explicit SPSCRing(size_t capacity);
+
+	/**
+	 * \brief Add an object to the end of the queue (producer thread only)
+	 * \param item Object to add. It is only moved from if the push succeeds
+	 * \return Whether there was room in the queue
+	 */
+	bool push(T&& item);
+
+	/**
+	 * \brief Take the object at the front of the queue (consumer thread only)
+	 * \param[out] item Destination for the object
+	 * \return Whether an object was available
+	 */
+	bool pop(T& item);
+
+	/**
+	 * \brief Get the number of objects in the queue
+	 * \return The number of objects in the queue
+	 */
+	size_t size() const;
+
+	/**
+	 * \brief Determine whether the queue is empty
+	 * \return Whether the queue is empty
+	 */
+	bool empty() const { return size() == 0; }
+
+	/**
+	 * \brief Get the maximum number of objects in the queue
+	 * \return The maximum number of objects in the queue
+	 */
+	size_t capacity() const { return slots_.size(); }
+
+private:
+	static size_t roundCapacity_(size_t capacity);
+
+	std::vector<T> slots_;
+	size_t mask_;
+
+	// head_ is only written by the consumer and tail_ only by the producer; keep them on separate cache lines.
+	// Padding is used rather than alignas, so that objects containing an SPSCRing do not need over-aligned allocation
+	char pad0_[64];
+	std::atomic<size_t> head_;
+	char pad1_[64 - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> tail_;
+	char pad2_[64 - sizeof(std::atomic<size_t>)];
+};
+
+template <typename T>
+inline
+artdaq::detail::SPSCRing<T>::
+SPSCRing(size_t capacity)
+	: slots_(roundCapacity_(capacity))
+	, mask_(slots_.size() - 1)
+	, head_(0)
+	, tail_(0) {}
+
+template <typename T>
+inline
+size_t
+artdaq::detail::SPSCRing<T>::
+roundCapacity_(size_t capacity)
+{
+	size_t out = 1;
+	while (out < capacity) out <<= 1;
+	return out;
+}
+
+template <typename T>
+inline
+bool
+artdaq::detail::SPSCRing<T>::
+push(T&& item)
+{
+	auto tail = tail_.load(std::memory_order_relaxed);
+	if (tail - head_.load(std::memory_order_acquire) >= slots_.size()) return false;
+
+	slots_[tail & mask_] = std::move(item);
+	tail_.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+inline
+bool
+artdaq::detail::SPSCRing<T>::
+pop(T& item)
+{
+	auto head = head_.load(std::memory_order_relaxed);
+	if (head == tail_.load(std::memory_order_acquire)) return false;
+
+	item = std::move(slots_[head & mask_]);
+	slots_[head & mask_] = T();
+	head_.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+inline
+size_t
+artdaq::detail::SPSCRing<T>::
+size() const
+{
+	return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+}
+
+#endif /* artdaq_DAQrate_detail_SPSCRing_hh */
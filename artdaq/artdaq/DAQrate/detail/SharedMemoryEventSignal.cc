@@ -0,0 +1,107 @@
+#define TRACE_NAME "SharedMemoryEventSignal"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQrate/detail/SharedMemoryEventSignal.hh"
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+// sem_clockwait is available from glibc 2.30
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2, 30)
+#define SHM_EVENT_SIGNAL_HAVE_CLOCKWAIT 1
+#endif
+#endif
+#ifndef SHM_EVENT_SIGNAL_HAVE_CLOCKWAIT
+#define SHM_EVENT_SIGNAL_HAVE_CLOCKWAIT 0
+#endif
+
+namespace
+{
+	void addMicroseconds_(timespec& ts, size_t us)
+	{
+		ts.tv_sec += us / 1000000;
+		ts.tv_nsec += (us % 1000000) * 1000;
+		if (ts.tv_nsec >= 1000000000)
+		{
+			ts.tv_sec += 1;
+			ts.tv_nsec -= 1000000000;
+		}
+	}
+}
+
+artdaq::detail::SharedMemoryEventSignal::SharedMemoryEventSignal(uint32_t shm_key, bool owner)
+	: name_()
+	, sem_(SEM_FAILED)
+	, owner_(owner)
+{
+	std::ostringstream name;
+	name << "/artdaq_events_" << std::hex << shm_key;
+	name_ = name.str();
+
+	// Either side may start first, so both create the semaphore if it does not exist yet
+	sem_ = sem_open(name_.c_str(), O_CREAT, 0666, 0);
+	if (sem_ == SEM_FAILED)
+	{
+		TLOG(TLVL_WARNING) << "Could not open semaphore " << name_ << ": " << strerror(errno) << ". Readers will poll for events instead.";
+	}
+}
+
+artdaq::detail::SharedMemoryEventSignal::~SharedMemoryEventSignal()
+{
+	if (sem_ == SEM_FAILED) return;
+	sem_close(sem_);
+	if (owner_) sem_unlink(name_.c_str());
+}
+
+void artdaq::detail::SharedMemoryEventSignal::Notify(size_t count, size_t max_pending)
+{
+	if (sem_ == SEM_FAILED) return;
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		int value = 0;
+		if (sem_getvalue(sem_, &value) == 0 && value >= 0 && static_cast<size_t>(value) >= max_pending) return;
+		sem_post(sem_);
+	}
+}
+
+bool artdaq::detail::SharedMemoryEventSignal::Wait(size_t timeout_us)
+{
+	if (sem_ == SEM_FAILED)
+	{
+		usleep(timeout_us);
+		return false;
+	}
+
+#if SHM_EVENT_SIGNAL_HAVE_CLOCKWAIT
+	// The deadline is on the monotonic clock, so that setting the system time does not change the wait
+	timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	addMicroseconds_(deadline, timeout_us);
+	while (sem_clockwait(sem_, CLOCK_MONOTONIC, &deadline) != 0)
+	{
+		if (errno != EINTR) return false;
+	}
+	return true;
+#else
+	// sem_timedwait only takes a CLOCK_REALTIME deadline. The wait is bounded by steady_clock instead, and the
+	// realtime deadline is recomputed after each timeout, in case the system time was changed during the wait
+	auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+	while (true)
+	{
+		auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(end - std::chrono::steady_clock::now()).count();
+		if (remaining <= 0) return false;
+
+		timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		addMicroseconds_(deadline, remaining);
+		if (sem_timedwait(sem_, &deadline) == 0) return true;
+		if (errno != EINTR && errno != ETIMEDOUT) return false;
+	}
+#endif
+}
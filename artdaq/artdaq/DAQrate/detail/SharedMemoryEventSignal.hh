@@ -0,0 +1,71 @@
+#ifndef artdaq_DAQrate_detail_SharedMemoryEventSignal_hh
+#define artdaq_DAQrate_detail_SharedMemoryEventSignal_hh
+
+#include <semaphore.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace artdaq
+{
+	namespace detail
+	{
+		class SharedMemoryEventSignal;
+	}
+}
+
+/**
+ * \brief A named POSIX semaphore which SharedMemoryEventManager posts to when it makes an event available to art,
+ * so that readers can sleep until there is something to read instead of polling the shared memory
+ *
+ * Each Notify wakes at most one waiting process per count, so waiting readers take turns rather than all
+ * waking up for every event. A reader which is woken must still check the shared memory, as another reader
+ * may have taken the event first.
+ */
+class artdaq::detail::SharedMemoryEventSignal
+{
+public:
+	/**
+	 * \brief SharedMemoryEventSignal Constructor
+	 * \param shm_key Key of the shared memory segment which holds the events
+	 * \param owner Whether this instance removes the semaphore name when it is destroyed (the writer)
+	 */
+	SharedMemoryEventSignal(uint32_t shm_key, bool owner);
+
+	/**
+	 * \brief SharedMemoryEventSignal Destructor
+	 */
+	~SharedMemoryEventSignal();
+
+	/**
+	 * \brief Signal that events are available
+	 * \param count Number of waiting processes to wake
+	 * \param max_pending The semaphore is not incremented beyond this value, so that a backlog of signals
+	 * built up while no-one was waiting only causes a limited number of spurious wakeups
+	 */
+	void Notify(size_t count, size_t max_pending);
+
+	/**
+	 * \brief Wait for an event to be signaled
+	 * \param timeout_us Maximum time to wait, in microseconds
+	 * \return Whether a signal was received before the timeout
+	 */
+	bool Wait(size_t timeout_us);
+
+	/**
+	 * \brief Whether the semaphore could be opened. If not, Wait sleeps for the timeout and Notify does nothing
+	 * \return Whether the semaphore is usable
+	 */
+	bool IsValid() const { return sem_ != SEM_FAILED; }
+
+private:
+	SharedMemoryEventSignal(SharedMemoryEventSignal const&) = delete;
+	SharedMemoryEventSignal& operator=(SharedMemoryEventSignal const&) = delete;
+
+	std::string name_;
+	sem_t* sem_;
+	bool owner_;
+};
+
+#endif /* artdaq_DAQrate_detail_SharedMemoryEventSignal_hh */
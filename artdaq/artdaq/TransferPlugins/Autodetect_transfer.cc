@@ -83,12 +83,39 @@ namespace artdaq
 			return theTransfer_->transfer_fragment_reliable_mode(std::move(fragment));
 		}
 
+		/**
+		 * \brief Send a GatheredFragment in non-reliable mode, using the underlying transfer plugin
+		 * \param fragment The GatheredFragment to send
+		 * \param send_timeout_usec How long to wait before aborting
+		 * \return A TransferInterface::CopyStatus result variable
+		 */
+		CopyStatus transfer_gathered_fragment_min_blocking_mode(artdaq::GatheredFragment const& fragment, size_t send_timeout_usec) override
+		{
+			return theTransfer_->transfer_gathered_fragment_min_blocking_mode(fragment, send_timeout_usec);
+		}
+
+		/**
+		* \brief Send a GatheredFragment in reliable mode, using the underlying transfer plugin
+		* \param fragment The GatheredFragment to send
+		* \return A TransferInterface::CopyStatus result variable
+		*/
+		CopyStatus transfer_gathered_fragment_reliable_mode(artdaq::GatheredFragment const& fragment) override
+		{
+			return theTransfer_->transfer_gathered_fragment_reliable_mode(fragment);
+		}
+
 		/**
 		* \brief Determine whether the TransferInterface plugin is able to send/receive data
 		* \return True if the TransferInterface plugin is currently able to send/receive data
 		*/
 		bool isRunning() override { return theTransfer_->isRunning(); }
 
+		/**
+		* \brief Get the file descriptors which become readable when data from this TransferInterface is available
+		* \return List of file descriptors which may be polled, or an empty list if the plugin does not support readiness notification
+		*/
+		std::vector<int> receiveReadinessFDs() override { return theTransfer_->receiveReadinessFDs(); }
+
 	private:
 		std::unique_ptr<TransferInterface> theTransfer_;
 	};
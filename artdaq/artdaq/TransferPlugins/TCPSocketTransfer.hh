@@ -93,11 +93,32 @@ public:
 	*/
 	CopyStatus transfer_fragment_reliable_mode(Fragment&& frag) override { return sendFragment_(std::move(frag), 0); }
 
+	/**
+	* \brief Transfer a GatheredFragment to the destination, writing its pieces directly. May not necessarily be reliable, but will not block longer than send_timeout_usec.
+	* \param frag GatheredFragment to transfer
+	* \param timeout_usec Timeout for send, in microseconds
+	* \return CopyStatus detailing result of transfer
+	*/
+	CopyStatus transfer_gathered_fragment_min_blocking_mode(GatheredFragment const& frag, size_t timeout_usec) override { return sendGatheredFragment_(frag, timeout_usec); }
+
+	/**
+	* \brief Transfer a GatheredFragment to the destination, writing its pieces directly
+	* \param frag GatheredFragment to transfer
+	* \return CopyStatus detailing result of copy
+	*/
+	CopyStatus transfer_gathered_fragment_reliable_mode(GatheredFragment const& frag) override { return sendGatheredFragment_(frag, 0); }
+
 	/**
 	* \brief Determine whether the TransferInterface plugin is able to send/receive data
 	* \return True if the TransferInterface plugin is currently able to send/receive data
 	*/
 	bool isRunning() override;
+
+	/**
+	* \brief Get the file descriptors which become readable when data from this TransferInterface is available
+	* \return The connected receive sockets for this source rank
+	*/
+	std::vector<int> receiveReadinessFDs() override;
 private:
 
 	static std::atomic<int> listen_thread_refcount_;
@@ -142,6 +163,10 @@ private:
 private: // methods
 	CopyStatus sendFragment_(Fragment&& frag, size_t timeout_usec);
 
+	CopyStatus sendGatheredFragment_(GatheredFragment const& frag, size_t timeout_usec);
+
+	CopyStatus sendPieces_(Fragment::sequence_id_t sequence_id, const iovec* header, const iovec* data, int datacnt, size_t timeout_usec);
+
 	CopyStatus sendData_(const void* buf, size_t bytes, size_t tmo, bool isHeader = false);
 
 	CopyStatus sendData_(const struct iovec* iov, int iovcnt, size_t tmo, bool isHeader = false);
@@ -135,7 +135,7 @@ int artdaq::TCPSocketTransfer::receiveFragmentHeader(detail::RawFragmentHeader&
 		//		}
 		//if (++not_connected_count_ > receive_err_threshold_) { return DATA_END; }
 		TLOG(7) << GetTraceName() << ": receiveFragmentHeader: Receive socket not connected, returning RECV_TIMEOUT";
-		usleep(receive_err_wait_us_);
+		if (!shared_receive_thread_) usleep(receive_err_wait_us_);
 		return RECV_TIMEOUT;
 	}
 	receive_socket_has_been_connected_ = true;
@@ -261,7 +261,7 @@ int artdaq::TCPSocketTransfer::receiveFragmentHeader(detail::RawFragmentHeader&
 		if (++loop_guard > 10010)
 		{
 			TLOG(TLVL_WARNING) << GetTraceName() << ": receiveFragmentHeader: loop guard triggered, returning RECV_TIMEOUT";
-			usleep(receive_err_wait_us_);
+			if (!shared_receive_thread_) usleep(receive_err_wait_us_);
 			active_receive_fd_ = -1;
 			return RECV_TIMEOUT;
 		}
@@ -581,12 +581,44 @@ bool artdaq::TCPSocketTransfer::isRunning()
 	return false;
 }
 
+std::vector<int> artdaq::TCPSocketTransfer::receiveReadinessFDs()
+{
+	std::vector<int> output;
+	if (role() != TransferInterface::Role::kReceive) return output;
+
+	std::unique_lock<std::mutex> lk(connected_fd_mutex_);
+	if (connected_fds_.count(source_rank()))
+	{
+		output.assign(connected_fds_[source_rank()].begin(), connected_fds_[source_rank()].end());
+	}
+	return output;
+}
+
 // Send the given Fragment. Return the rank of the destination to which
 // the Fragment was sent OR -1 if to none.
 artdaq::TransferInterface::CopyStatus artdaq::TCPSocketTransfer::sendFragment_(Fragment&& frag, size_t send_timeout_usec)
 {
-	TLOG(12) << GetTraceName() << ": sendFragment begin send of fragment with sequenceID="<<frag.sequenceID();
-	artdaq::Fragment grab_ownership_frag = std::move(frag);
+	// The Fragment is written out before this function returns, so it is left with the caller (which may recycle its storage)
+	iovec header = { reinterpret_cast<void*>(frag.headerAddress()),
+		detail::RawFragmentHeader::num_words() * sizeof(RawDataType) };
+	iovec data = { reinterpret_cast<void*>(frag.headerAddress() + detail::RawFragmentHeader::num_words()),
+		frag.sizeBytes() - detail::RawFragmentHeader::num_words() * sizeof(RawDataType)
+	};
+	return sendPieces_(frag.sequenceID(), &header, &data, 1, send_timeout_usec);
+}
+
+artdaq::TransferInterface::CopyStatus artdaq::TCPSocketTransfer::sendGatheredFragment_(GatheredFragment const& frag, size_t send_timeout_usec)
+{
+	// The pieces of the GatheredFragment are written by the same writev calls, so its payload is sent as one message, exactly as for a Fragment
+	iovec header = { const_cast<detail::RawFragmentHeader*>(&frag.header()),
+		detail::RawFragmentHeader::num_words() * sizeof(RawDataType) };
+	auto data = frag.payloadIovecs();
+	return sendPieces_(frag.sequenceID(), &header, data.size() ? &data[0] : nullptr, static_cast<int>(data.size()), send_timeout_usec);
+}
+
+artdaq::TransferInterface::CopyStatus artdaq::TCPSocketTransfer::sendPieces_(Fragment::sequence_id_t sequence_id, const iovec* header, const iovec* data, int datacnt, size_t send_timeout_usec)
+{
+	TLOG(12) << GetTraceName() << ": sendFragment begin send of fragment with sequenceID="<<sequence_id;
 
 	reconnect_();
 	// Send Fragment Header
@@ -596,31 +628,25 @@ artdaq::TransferInterface::CopyStatus artdaq::TCPSocketTransfer::sendFragment_(F
 	while (static_cast<size_t>(send_ack_diff_) > buffer_count_) usleep(10000);
 #endif
 
-	iovec iov = { reinterpret_cast<void*>(grab_ownership_frag.headerAddress()),
-		detail::RawFragmentHeader::num_words() * sizeof(RawDataType) };
-
-	auto sts = sendData_(&iov, 1, send_retry_timeout_us_, true);
+	auto sts = sendData_(header, 1, send_retry_timeout_us_, true);
 	auto start_time = std::chrono::steady_clock::now();
 	//If it takes more than 10 seconds to write a Fragment header, give up
 	while (sts == CopyStatus::kTimeout && (send_timeout_usec == 0 || TimeUtils::GetElapsedTimeMicroseconds(start_time) < send_timeout_usec) && TimeUtils::GetElapsedTimeMicroseconds(start_time) < 10000000)
 	{
 		TLOG(13) << GetTraceName() << ": sendFragment: Timeout sending fragment";
-		sts = sendData_(&iov, 1, send_retry_timeout_us_, true);
+		sts = sendData_(header, 1, send_retry_timeout_us_, true);
 		usleep(1000);
 	}
 	if (sts != CopyStatus::kSuccess) return sts;
 
 	// Send Fragment Data
 
-	iov = { reinterpret_cast<void*>(grab_ownership_frag.headerAddress() + detail::RawFragmentHeader::num_words()),
-		grab_ownership_frag.sizeBytes() - detail::RawFragmentHeader::num_words() * sizeof(RawDataType)
-};
-	sts = sendData_(&iov, 1, send_retry_timeout_us_);
+	sts = sendData_(data, datacnt, send_retry_timeout_us_);
 	start_time = std::chrono::steady_clock::now();
 	while (sts == CopyStatus::kTimeout && (send_timeout_usec == 0 || TimeUtils::GetElapsedTimeMicroseconds(start_time) < send_timeout_usec) && TimeUtils::GetElapsedTimeMicroseconds(start_time) < 10000000)
 	{
 		TLOG(13) << GetTraceName() << ": sendFragment: Timeout sending fragment";
-		sts = sendData_(&iov, 1, send_retry_timeout_us_);
+		sts = sendData_(data, datacnt, send_retry_timeout_us_);
 		usleep(1000);
 	}
 
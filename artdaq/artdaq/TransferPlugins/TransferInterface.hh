@@ -3,12 +3,14 @@
 
 #include "artdaq/DAQdata/Globals.hh"
 #include "artdaq-core/Data/Fragment.hh"
+#include "artdaq/DAQdata/GatheredFragment.hh"
 #include "fhiclcpp/ParameterSet.h"
 #include "cetlib/compiler_macros.h"
 
 #include <limits>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 namespace artdaq
 {
@@ -149,6 +151,31 @@ namespace artdaq
 		*/
 		virtual CopyStatus transfer_fragment_reliable_mode(artdaq::Fragment&& fragment) = 0;
 
+		/**
+		* \brief Transfer a GatheredFragment to the destination. May not necessarily be reliable, but will not block longer than send_timeout_usec.
+		* \param fragment GatheredFragment to transfer
+		* \param send_timeout_usec Timeout for send, in microseconds
+		* \return CopyStatus detailing result of transfer
+		*
+		* The default implementation copies the GatheredFragment into a Fragment. Plugins which can send several buffers at once should override it.
+		*/
+		virtual CopyStatus transfer_gathered_fragment_min_blocking_mode(artdaq::GatheredFragment const& fragment, size_t send_timeout_usec)
+		{
+			return transfer_fragment_min_blocking_mode(fragment.toFragment(), send_timeout_usec);
+		}
+
+		/**
+		* \brief Transfer a GatheredFragment to the destination. This should be reliable, if the underlying transport mechanism supports reliable sending
+		* \param fragment GatheredFragment to transfer
+		* \return CopyStatus detailing result of copy
+		*
+		* The default implementation copies the GatheredFragment into a Fragment. Plugins which can send several buffers at once should override it.
+		*/
+		virtual CopyStatus transfer_gathered_fragment_reliable_mode(artdaq::GatheredFragment const& fragment)
+		{
+			return transfer_fragment_reliable_mode(fragment.toFragment());
+		}
+
 		/**
 		 * \brief Get the unique label of this TransferInterface instance
 		 * \return The unique label of this TransferInterface instance
@@ -172,6 +199,24 @@ namespace artdaq
 		 */
 		virtual bool isRunning() { return false; }
 
+		/**
+		 * \brief Get the file descriptors which become readable when data from this TransferInterface is available
+		 * \return List of file descriptors which may be polled, or an empty list if the plugin does not support readiness notification
+		 *
+		 * Used by the DataReceiverManager receiver pool to avoid calling receiveFragmentHeader on idle sources.
+		 * The returned list may change as senders connect and disconnect.
+		 */
+		virtual std::vector<int> receiveReadinessFDs() { return std::vector<int>(); }
+
+		/**
+		 * \brief Tell a receiving TransferInterface whether its receive calls are made from a thread shared with other sources
+		 * \param shared Whether receive calls are made from the DataReceiverManager receiver pool
+		 *
+		 * When the receiving thread is shared, plugins should return RECV_TIMEOUT at once instead of sleeping while they have
+		 * no connection; the receiver pool backs off idle sources itself.
+		 */
+		void setSharedReceiveThread(bool shared) { shared_receive_thread_ = shared; }
+
 
 		/** \cond */
 		#define GetTraceName() unique_label_ << (role_ == Role::kSend ? "_SEND" : "_RECV")
@@ -186,6 +231,7 @@ namespace artdaq
 
 		size_t buffer_count_; ///< The number of Fragment transfers the TransferInterface can handle simultaneously
 		const size_t max_fragment_size_words_; ///< The maximum size of the transferred Fragment objects, in artdaq::Fragment::RawDataType words
+		bool shared_receive_thread_; ///< Whether receive calls are made from a thread shared with other sources (see setSharedReceiveThread)
 
 	protected:
 		/**
@@ -0,0 +1,127 @@
+#define TRACE_NAME "BinaryFileReplay_t"
+
+#define BOOST_TEST_MODULE BinaryFileReplay_t
+#include <boost/test/auto_unit_test.hpp>
+
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq/Application/BinaryFileReplay.hh"
+#include "fhiclcpp/ParameterSet.h"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// Writes Fragments with the given (sequence ID, fragment ID) to a file, as BinaryFileOutput would, and returns its name
+	std::string writeFile(std::string const& suffix, std::vector<std::pair<size_t, size_t>> const& ids)
+	{
+		std::string name = "/tmp/BinaryFileReplay_t_" + std::to_string(getpid()) + suffix;
+		std::ofstream out(name, std::ofstream::binary);
+		for (auto const& id : ids)
+		{
+			artdaq::Fragment frag(2, id.first, id.second, artdaq::Fragment::DataFragmentType, id.first * 10);
+			out.write(reinterpret_cast<char const*>(frag.headerBeginBytes()), frag.sizeBytes());
+		}
+		return name;
+	}
+
+	// Events 5 and 7 have Fragment IDs 0 and 1, event 6 only has Fragment ID 1
+	std::string writeEvents(std::string const& suffix)
+	{
+		return writeFile(suffix, { { 5, 0 }, { 5, 1 }, { 6, 1 }, { 7, 0 }, { 7, 1 } });
+	}
+
+	fhicl::ParameterSet makeConfig(std::string const& file_name, int fragment_id)
+	{
+		fhicl::ParameterSet ps;
+		ps.put<int>("board_id", fragment_id);
+		ps.put<int>("fragment_id", fragment_id);
+		ps.put<std::vector<std::string>>("fileNames", { file_name });
+		return ps;
+	}
+
+	// The Sequence IDs of the events sent by the generator, until it ends the data or max_events have been sent
+	std::vector<artdaq::Fragment::sequence_id_t> replay(artdaq::BinaryFileReplay& gen, size_t max_events = 100)
+	{
+		std::vector<artdaq::Fragment::sequence_id_t> sequence_ids;
+		artdaq::FragmentPtrs frags;
+		while (sequence_ids.size() < max_events && gen.getNext(frags))
+		{
+			for (auto& frag : frags) sequence_ids.push_back(frag->sequenceID());
+			frags.clear();
+		}
+		return sequence_ids;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(BinaryFileReplay_test)
+
+	BOOST_AUTO_TEST_CASE(RenumberedConsistently)
+	{
+		artdaq::configureMessageFacility("BinaryFileReplay_t");
+		auto name = writeEvents(".renumber");
+
+		// Each generator sees the same recorded event with the same Sequence ID, even though the first skips event 6
+		artdaq::BinaryFileReplay gen0(makeConfig(name, 0));
+		gen0.StartCmd(1, 0xFFFFFFFF, 1);
+		BOOST_REQUIRE(replay(gen0) == std::vector<artdaq::Fragment::sequence_id_t>({ 1, 3 }));
+		gen0.StopCmd(0xFFFFFFFF, 1);
+
+		artdaq::BinaryFileReplay gen1(makeConfig(name, 1));
+		gen1.StartCmd(1, 0xFFFFFFFF, 1);
+		BOOST_REQUIRE(replay(gen1) == std::vector<artdaq::Fragment::sequence_id_t>({ 1, 2, 3 }));
+		gen1.StopCmd(0xFFFFFFFF, 1);
+		unlink(name.c_str());
+	}
+
+	BOOST_AUTO_TEST_CASE(RecordedSequenceIDs)
+	{
+		artdaq::configureMessageFacility("BinaryFileReplay_t");
+		auto name = writeEvents(".recorded");
+		auto ps = makeConfig(name, 1);
+		ps.put("renumber_sequence_ids", false);
+
+		artdaq::BinaryFileReplay gen(ps);
+		gen.StartCmd(1, 0xFFFFFFFF, 1);
+		BOOST_REQUIRE(replay(gen) == std::vector<artdaq::Fragment::sequence_id_t>({ 5, 6, 7 }));
+		gen.StopCmd(0xFFFFFFFF, 1);
+		unlink(name.c_str());
+	}
+
+	BOOST_AUTO_TEST_CASE(Loop)
+	{
+		artdaq::configureMessageFacility("BinaryFileReplay_t");
+		auto name = writeEvents(".loop");
+		auto ps = makeConfig(name, 0);
+		ps.put("loop", true);
+
+		// The second pass continues after the last recorded event of the first, including the skipped event 6
+		artdaq::BinaryFileReplay gen(ps);
+		gen.StartCmd(1, 0xFFFFFFFF, 1);
+		BOOST_REQUIRE(replay(gen, 4) == std::vector<artdaq::Fragment::sequence_id_t>({ 1, 3, 4, 6 }));
+		gen.StopCmd(0xFFFFFFFF, 1);
+		unlink(name.c_str());
+	}
+
+	BOOST_AUTO_TEST_CASE(Restart)
+	{
+		artdaq::configureMessageFacility("BinaryFileReplay_t");
+		auto name = writeEvents(".restart");
+
+		artdaq::BinaryFileReplay gen(makeConfig(name, 1));
+		gen.StartCmd(1, 0xFFFFFFFF, 1);
+		BOOST_REQUIRE(replay(gen, 1) == std::vector<artdaq::Fragment::sequence_id_t>({ 1 }));
+		gen.StopCmd(0xFFFFFFFF, 1);
+
+		// A new run replays the files from the beginning
+		gen.StartCmd(2, 0xFFFFFFFF, 1);
+		BOOST_REQUIRE(replay(gen) == std::vector<artdaq::Fragment::sequence_id_t>({ 1, 2, 3 }));
+		gen.StopCmd(0xFFFFFFFF, 1);
+		unlink(name.c_str());
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,8 @@
 #include "artdaq/Application/CommandableFragmentGenerator.hh"
 #include "artdaq/DAQrate/RequestSender.hh"
 
+#include <set>
+
 #define MULTICAST_MODE 0
 
 namespace artdaqtest
@@ -35,7 +37,7 @@ protected:
 	 * \param frags FragmentPtrs list that new Fragments should be added to
 	 * \return True if data was generated
 	 *
-	 * CommandableFragmentGeneratorTest merely default-constructs Fragments, emplacing them on the frags list.
+	 * CommandableFragmentGeneratorTest merely default-constructs Fragments, emplacing one Fragment for each Fragment ID on the frags list.
 	 */
 	bool getNext_(artdaq::FragmentPtrs& frags) override;
 
@@ -77,6 +79,12 @@ public:
 	 */
 	void setFireCount(size_t count) { fireCount_ = count; }
 
+	/**
+	 * \brief Have getNext_ only generate Fragments for some of the Fragment IDs. Call while no Fragments are being generated
+	 * \param ids Fragment IDs to generate Fragments for. If empty, all Fragment IDs are used
+	 */
+	void setFireIDs(std::vector<artdaq::Fragment::fragment_id_t> const& ids) { fireIDs_ = ids; }
+
 	/**
 	 * \brief Set the hwFail flag
 	 */
@@ -92,6 +100,7 @@ public:
 	}
 private:
 	std::atomic<size_t> fireCount_;
+	std::vector<artdaq::Fragment::fragment_id_t> fireIDs_;
 	std::atomic<bool> hwFail_;
 	artdaq::Fragment::timestamp_t ts_;
 	std::atomic<bool> hw_stop_;
@@ -100,6 +109,7 @@ private:
 artdaqtest::CommandableFragmentGeneratorTest::CommandableFragmentGeneratorTest(const fhicl::ParameterSet& ps)
 	: CommandableFragmentGenerator(ps)
 	, fireCount_(1)
+	, fireIDs_()
 	, hwFail_(false)
 	, ts_(0)
 	, hw_stop_(false)
@@ -113,7 +123,11 @@ artdaqtest::CommandableFragmentGeneratorTest::getNext_(artdaq::FragmentPtrs& fra
 {
 	while (fireCount_ > 0)
 	{
-		frags.emplace_back(new artdaq::Fragment(ev_counter(), fragment_id(), artdaq::Fragment::FirstUserFragmentType, ++ts_));
+		++ts_;
+		for (auto id : fireIDs_.empty() ? fragmentIDs() : fireIDs_)
+		{
+			frags.emplace_back(new artdaq::Fragment(ev_counter(), id, artdaq::Fragment::FirstUserFragmentType, ts_));
+		}
 		fireCount_--;
 	}
 
@@ -990,6 +1004,239 @@ BOOST_AUTO_TEST_CASE(WindowMode_RequestInBuffer)
 	TLOG(TLVL_INFO) << "WindowMode_RequestInBuffer test case END" ;
 
 }
+
+BOOST_AUTO_TEST_CASE(WindowMode_MultipleFragmentIDs)
+{
+	artdaq::configureMessageFacility("CommandableFragmentGenerator_t");
+	TLOG(TLVL_INFO) << "WindowMode_MultipleFragmentIDs test case BEGIN" ;
+	const int REQUEST_PORT = (seedAndRandom() % (32768 - 1024)) + 1024;
+	const int DELAY_TIME = 100;
+	fhicl::ParameterSet ps;
+	ps.put<int>("board_id", 1);
+	ps.put<std::vector<int>>("fragment_ids", { 1, 2, 3 });
+	ps.put<int>("request_port", REQUEST_PORT);
+#if MULTICAST_MODE
+	ps.put<std::string>("request_address", "227.18.12.32");
+#else
+	ps.put<std::string>("request_address", "localhost");
+#endif
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_offset", 0);
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_width", 3);
+	ps.put<bool>("separate_data_thread", true);
+	ps.put<bool>("separate_monitoring_thread", false);
+	ps.put<int64_t>("hardware_poll_interval_us", 0);
+	ps.put<size_t>("data_buffer_depth_fragments", 100);
+	ps.put<size_t>("container_fill_threads", 3);
+	ps.put<size_t>("parallel_container_fill_min_bytes", 0);
+	ps.put<std::string>("request_mode", "window");
+	ps.put("request_delay_ms", DELAY_TIME);
+	ps.put("send_requests", true);
+
+	artdaq::RequestSender t(ps);
+
+	artdaqtest::CommandableFragmentGeneratorTest gen(ps);
+	gen.StartCmd(1, 0xFFFFFFFF, 1);
+
+	artdaq::FragmentPtrs fps;
+	int sts;
+	artdaq::Fragment::type_t type;
+	gen.waitForFrags();
+
+	// Each Fragment ID gets its own ContainerFragment, holding only the Fragments with that ID
+	gen.setFireCount(5); // Buffer start is at ts 1, end at 6, for each Fragment ID
+	gen.waitForFrags();
+	t.AddRequest(1, 3); // Requesting data from ts 3 to 5
+
+	sts = gen.getNext(fps);
+	BOOST_REQUIRE_EQUAL(sts, true);
+	BOOST_REQUIRE_EQUAL(fps.size(), 3);
+	artdaq::Fragment::fragment_id_t expected_id = 1;
+	for (auto& frag : fps)
+	{
+		BOOST_REQUIRE_EQUAL(frag->fragmentID(), expected_id);
+		BOOST_REQUIRE_EQUAL(frag->timestamp(), 3);
+		BOOST_REQUIRE_EQUAL(frag->sequenceID(), 1);
+		type = artdaq::Fragment::ContainerFragmentType;
+		BOOST_REQUIRE_EQUAL(frag->type(), type);
+		auto cf = artdaq::ContainerFragment(*frag);
+		BOOST_REQUIRE_EQUAL(cf.block_count(), 3);
+		BOOST_REQUIRE_EQUAL(cf.missing_data(), false);
+		for (size_t ii = 0; ii < cf.block_count(); ++ii)
+		{
+			BOOST_REQUIRE_EQUAL(cf.at(ii)->fragmentID(), expected_id);
+			BOOST_REQUIRE_EQUAL(cf.at(ii)->timestamp(), 3 + ii);
+		}
+		++expected_id;
+	}
+	fps.clear();
+
+	// The window is only closed once every Fragment ID has data past its end
+	t.AddRequest(2, 6); // Requesting data from ts 6 to 8
+	sts = gen.getNext(fps);
+	BOOST_REQUIRE_EQUAL(sts, true);
+	BOOST_REQUIRE_EQUAL(fps.size(), 0);
+
+	gen.setFireCount(3); // Buffer end is at ts 9, for each Fragment ID
+	gen.waitForFrags();
+	sts = gen.getNext(fps);
+	BOOST_REQUIRE_EQUAL(sts, true);
+	BOOST_REQUIRE_EQUAL(fps.size(), 3);
+	for (auto& frag : fps)
+	{
+		BOOST_REQUIRE_EQUAL(frag->sequenceID(), 2);
+		auto cf = artdaq::ContainerFragment(*frag);
+		BOOST_REQUIRE_EQUAL(cf.block_count(), 3);
+		BOOST_REQUIRE_EQUAL(cf.missing_data(), false);
+	}
+
+	gen.StopCmd(0xFFFFFFFF, 1);
+	gen.joinThreads();
+	TLOG(TLVL_INFO) << "WindowMode_MultipleFragmentIDs test case END" ;
+}
+
+BOOST_AUTO_TEST_CASE(WindowMode_StaleFragments)
+{
+	artdaq::configureMessageFacility("CommandableFragmentGenerator_t");
+	TLOG(TLVL_INFO) << "WindowMode_StaleFragments test case BEGIN" ;
+	const int REQUEST_PORT = (seedAndRandom() % (32768 - 1024)) + 1024;
+	const int DELAY_TIME = 100;
+	fhicl::ParameterSet ps;
+	ps.put<int>("board_id", 1);
+	ps.put<int>("fragment_id", 1);
+	ps.put<int>("request_port", REQUEST_PORT);
+#if MULTICAST_MODE
+	ps.put<std::string>("request_address", "227.18.12.32");
+#else
+	ps.put<std::string>("request_address", "localhost");
+#endif
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_offset", 0);
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_width", 3);
+	ps.put<artdaq::Fragment::timestamp_t>("stale_request_timeout", 3);
+	ps.put<bool>("separate_data_thread", true);
+	ps.put<bool>("separate_monitoring_thread", false);
+	ps.put<int64_t>("hardware_poll_interval_us", 0);
+	ps.put<size_t>("data_buffer_depth_fragments", 20);
+	ps.put<std::string>("request_mode", "window");
+	ps.put("request_delay_ms", DELAY_TIME);
+	ps.put("send_requests", true);
+
+	artdaq::RequestSender t(ps);
+
+	artdaqtest::CommandableFragmentGeneratorTest gen(ps);
+	gen.StartCmd(1, 0xFFFFFFFF, 1);
+
+	artdaq::FragmentPtrs fps;
+	int sts;
+	artdaq::Fragment::type_t type;
+	gen.waitForFrags();
+
+	// Buffer holds ts 1 to 10; everything older than 10 - 3 = 7 is stale
+	gen.setFireCount(9);
+	gen.waitForFrags();
+	t.AddRequest(1, 2); // Requesting data from ts 2 to 4, which has been dropped
+
+	sts = gen.getNext(fps);
+	BOOST_REQUIRE_EQUAL(sts, true);
+	BOOST_REQUIRE_EQUAL(fps.size(), 1);
+	BOOST_REQUIRE_EQUAL(fps.front()->sequenceID(), 1);
+	type = artdaq::Fragment::ContainerFragmentType;
+	BOOST_REQUIRE_EQUAL(fps.front()->type(), type);
+	auto cf = artdaq::ContainerFragment(*fps.front());
+	BOOST_REQUIRE_EQUAL(cf.block_count(), 0);
+	BOOST_REQUIRE_EQUAL(cf.missing_data(), true);
+	fps.clear();
+
+	t.AddRequest(2, 7); // Requesting data from ts 7 to 9, the oldest data remaining in the buffer
+	sts = gen.getNext(fps);
+	BOOST_REQUIRE_EQUAL(sts, true);
+	BOOST_REQUIRE_EQUAL(fps.size(), 1);
+	BOOST_REQUIRE_EQUAL(fps.front()->sequenceID(), 2);
+	BOOST_REQUIRE_EQUAL(fps.front()->timestamp(), 7);
+	auto cf2 = artdaq::ContainerFragment(*fps.front());
+	BOOST_REQUIRE_EQUAL(cf2.block_count(), 3);
+	BOOST_REQUIRE_EQUAL(cf2.missing_data(), false);
+	BOOST_REQUIRE_EQUAL(cf2.at(0)->timestamp(), 7);
+	BOOST_REQUIRE_EQUAL(cf2.at(2)->timestamp(), 9);
+
+	gen.StopCmd(0xFFFFFFFF, 1);
+	TLOG(TLVL_INFO) << "WindowMode_StaleFragments test case END" ;
+
+}
+
+BOOST_AUTO_TEST_CASE(WindowMode_IdleFragmentID)
+{
+	artdaq::configureMessageFacility("CommandableFragmentGenerator_t");
+	TLOG(TLVL_INFO) << "WindowMode_IdleFragmentID test case BEGIN" ;
+	const int REQUEST_PORT = (seedAndRandom() % (32768 - 1024)) + 1024;
+	const int DELAY_TIME = 100;
+	const size_t WINDOW_CLOSE_TIMEOUT_US = 1000000;
+	fhicl::ParameterSet ps;
+	ps.put<int>("board_id", 1);
+	ps.put<std::vector<int>>("fragment_ids", { 1, 2 });
+	ps.put<int>("request_port", REQUEST_PORT);
+#if MULTICAST_MODE
+	ps.put<std::string>("request_address", "227.18.12.32");
+#else
+	ps.put<std::string>("request_address", "localhost");
+#endif
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_offset", 0);
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_width", 3);
+	ps.put<size_t>("window_close_timeout_us", WINDOW_CLOSE_TIMEOUT_US);
+	ps.put<bool>("separate_data_thread", true);
+	ps.put<bool>("separate_monitoring_thread", false);
+	ps.put<int64_t>("hardware_poll_interval_us", 0);
+	ps.put<size_t>("data_buffer_depth_fragments", 100);
+	ps.put<std::string>("request_mode", "window");
+	ps.put("request_delay_ms", DELAY_TIME);
+	ps.put("send_requests", true);
+
+	artdaq::RequestSender t(ps);
+
+	artdaqtest::CommandableFragmentGeneratorTest gen(ps);
+	gen.StartCmd(1, 0xFFFFFFFF, 1);
+
+	artdaq::FragmentPtrs fps;
+	int sts;
+	gen.waitForFrags();
+
+	// Fragment ID 2 stops producing data after ts 1, and is idle for longer than window_close_timeout_us
+	gen.setFireIDs({ 1 });
+	usleep(WINDOW_CLOSE_TIMEOUT_US + 200000);
+	gen.setFireCount(5); // Buffer end is at ts 6 for Fragment ID 1
+	gen.waitForFrags();
+
+	// The window is closed by Fragment ID 1 alone, without waiting for the timeout
+	auto start_time = std::chrono::steady_clock::now();
+	t.AddRequest(1, 2); // Requesting data from ts 2 to 4
+	while (fps.size() == 0)
+	{
+		sts = gen.getNext(fps);
+		BOOST_REQUIRE_EQUAL(sts, true);
+	}
+	auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+	BOOST_REQUIRE_LT(static_cast<size_t>(elapsed_us), WINDOW_CLOSE_TIMEOUT_US);
+	BOOST_REQUIRE_EQUAL(fps.size(), 2);
+	for (auto& frag : fps)
+	{
+		BOOST_REQUIRE_EQUAL(frag->sequenceID(), 1);
+		auto cf = artdaq::ContainerFragment(*frag);
+		if (frag->fragmentID() == 1)
+		{
+			BOOST_REQUIRE_EQUAL(cf.block_count(), 3);
+			BOOST_REQUIRE_EQUAL(cf.missing_data(), false);
+		}
+		else
+		{
+			BOOST_REQUIRE_EQUAL(cf.block_count(), 0);
+			BOOST_REQUIRE_EQUAL(cf.missing_data(), true);
+		}
+	}
+
+	gen.StopCmd(0xFFFFFFFF, 1);
+	gen.joinThreads();
+	TLOG(TLVL_INFO) << "WindowMode_IdleFragmentID test case END" ;
+}
+
 BOOST_AUTO_TEST_CASE(WindowMode_RequestEndsAfterBuffer)
 {
 	artdaq::configureMessageFacility("CommandableFragmentGenerator_t");
@@ -1256,4 +1503,147 @@ BOOST_AUTO_TEST_CASE(HardwareFailure_Threaded)
 	TLOG(TLVL_INFO) << "HardwareFailure_Threaded test case END" ;
 }
 
+BOOST_AUTO_TEST_CASE(WindowMode_LargeBufferTrim)
+{
+	artdaq::configureMessageFacility("CommandableFragmentGenerator_t");
+	TLOG(TLVL_INFO) << "WindowMode_LargeBufferTrim test case BEGIN" ;
+	const int REQUEST_PORT = (seedAndRandom() % (32768 - 1024)) + 1024;
+	const int DELAY_TIME = 100;
+	const size_t FRAGMENT_COUNT = 100000;
+	fhicl::ParameterSet ps;
+	ps.put<int>("board_id", 1);
+	ps.put<int>("fragment_id", 1);
+	ps.put<int>("request_port", REQUEST_PORT);
+#if MULTICAST_MODE
+	ps.put<std::string>("request_address", "227.18.12.32");
+#else
+	ps.put<std::string>("request_address", "localhost");
+#endif
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_offset", 0);
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_width", 3);
+	ps.put<bool>("separate_data_thread", true);
+	ps.put<bool>("separate_monitoring_thread", false);
+	ps.put<int64_t>("hardware_poll_interval_us", 0);
+	ps.put<size_t>("data_buffer_depth_fragments", 1000);
+	ps.put<std::string>("request_mode", "window");
+	ps.put("request_delay_ms", DELAY_TIME);
+	ps.put("send_requests", true);
+
+	artdaq::RequestSender t(ps);
+
+	artdaqtest::CommandableFragmentGeneratorTest gen(ps);
+	gen.StartCmd(1, 0xFFFFFFFF, 1);
+
+	artdaq::FragmentPtrs fps;
+	int sts;
+	gen.waitForFrags();
+
+	// getNext_ returns all of the Fragments at once, so the data buffer holds ts 1 to FRAGMENT_COUNT + 1
+	// until checkDataBuffer trims it down to the last 1000 Fragments
+	gen.setFireCount(FRAGMENT_COUNT);
+	gen.waitForFrags();
+	t.AddRequest(1, FRAGMENT_COUNT - 10);
+
+	auto start_time = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < 10 && fps.size() == 0; ++ii)
+	{
+		sts = gen.getNext(fps);
+		BOOST_REQUIRE_EQUAL(sts, true);
+	}
+	auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+	BOOST_TEST_MESSAGE("Trimming and processing a request from a buffer of " << FRAGMENT_COUNT << " Fragments took " << elapsed_us << " us");
+	TLOG(TLVL_INFO) << "Trimming and processing a request from a buffer of " << FRAGMENT_COUNT << " Fragments took " << elapsed_us << " us";
+
+	BOOST_REQUIRE_EQUAL(fps.size(), 1);
+	BOOST_REQUIRE_EQUAL(fps.front()->sequenceID(), 1);
+	auto cf = artdaq::ContainerFragment(*fps.front());
+	BOOST_REQUIRE_EQUAL(cf.block_count(), 3);
+	BOOST_REQUIRE_EQUAL(cf.missing_data(), false);
+	BOOST_REQUIRE_EQUAL(cf.at(0)->timestamp(), FRAGMENT_COUNT - 10);
+
+	gen.StopCmd(0xFFFFFFFF, 1);
+	TLOG(TLVL_INFO) << "WindowMode_LargeBufferTrim test case END" ;
+}
+
+BOOST_AUTO_TEST_CASE(WindowMode_GatheredContainers)
+{
+	artdaq::configureMessageFacility("CommandableFragmentGenerator_t");
+	TLOG(TLVL_INFO) << "WindowMode_GatheredContainers test case BEGIN" ;
+	const int REQUEST_PORT = (seedAndRandom() % (32768 - 1024)) + 1024;
+	const int DELAY_TIME = 100;
+	fhicl::ParameterSet ps;
+	ps.put<int>("board_id", 1);
+	ps.put<int>("fragment_id", 1);
+	ps.put<int>("request_port", REQUEST_PORT);
+#if MULTICAST_MODE
+	ps.put<std::string>("request_address", "227.18.12.32");
+#else
+	ps.put<std::string>("request_address", "localhost");
+#endif
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_offset", 0);
+	ps.put<artdaq::Fragment::timestamp_t>("request_window_width", 3);
+	ps.put<bool>("request_windows_are_unique", false);
+	ps.put<bool>("gather_window_containers", true);
+	ps.put<bool>("separate_data_thread", true);
+	ps.put<bool>("separate_monitoring_thread", false);
+	ps.put<int64_t>("hardware_poll_interval_us", 0);
+	ps.put<size_t>("data_buffer_depth_fragments", 100);
+	ps.put<std::string>("request_mode", "window");
+	ps.put("request_delay_ms", DELAY_TIME);
+	ps.put("send_requests", true);
+
+	BOOST_REQUIRE(artdaq::GatheredFragment::ContainerGatheringSupported());
+
+	artdaq::RequestSender t(ps);
+
+	artdaqtest::CommandableFragmentGeneratorTest gen(ps);
+	gen.StartCmd(1, 0xFFFFFFFF, 1);
+
+	artdaq::FragmentPtrs fps;
+	artdaq::GatheredFragmentPtrs gathered;
+	int sts;
+	gen.waitForFrags();
+
+	gen.setFireCount(5); // Buffer start is at ts 1, end at 6
+	gen.waitForFrags();
+
+	// Overlapping windows refer to the same buffered Fragments instead of each holding a copy
+	t.AddRequest(1, 2); // Requesting data from ts 2 to 4
+	sts = gen.getNext(fps, gathered);
+	BOOST_REQUIRE_EQUAL(sts, true);
+	t.AddRequest(2, 3); // Requesting data from ts 3 to 5
+	sts = gen.getNext(fps, gathered);
+	BOOST_REQUIRE_EQUAL(sts, true);
+	BOOST_REQUIRE_EQUAL(fps.size(), 0);
+	BOOST_REQUIRE_EQUAL(gathered.size(), 2);
+
+	std::set<void*> firstParts;
+	for (auto& iov : gathered.front()->payloadIovecs()) firstParts.insert(iov.iov_base);
+	size_t shared = 0;
+	for (auto& iov : gathered.back()->payloadIovecs()) shared += firstParts.count(iov.iov_base);
+	BOOST_REQUIRE_EQUAL(shared, 2);
+
+	// Stopping empties the data buffer, but the gathered containers keep the Fragments they refer to
+	gen.StopCmd(0xFFFFFFFF, 1);
+	gen.joinThreads();
+
+	artdaq::Fragment::type_t type = artdaq::Fragment::ContainerFragmentType;
+	artdaq::Fragment::timestamp_t first_ts = 2;
+	for (auto& container : gathered)
+	{
+		auto frag = container->toFragment();
+		BOOST_REQUIRE_EQUAL(frag.type(), type);
+		BOOST_REQUIRE_EQUAL(frag.timestamp(), first_ts);
+		auto cf = artdaq::ContainerFragment(frag);
+		BOOST_REQUIRE_EQUAL(cf.block_count(), 3);
+		BOOST_REQUIRE_EQUAL(cf.missing_data(), false);
+		for (size_t ii = 0; ii < cf.block_count(); ++ii)
+		{
+			BOOST_REQUIRE_EQUAL(cf.at(ii)->timestamp(), first_ts + ii);
+		}
+		++first_ts;
+	}
+	TLOG(TLVL_INFO) << "WindowMode_GatheredContainers test case END" ;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
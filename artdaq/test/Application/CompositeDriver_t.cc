@@ -0,0 +1,172 @@
+#define TRACE_NAME "CompositeDriver_t"
+
+#define BOOST_TEST_MODULE CompositeDriver_t
+#include <boost/test/auto_unit_test.hpp>
+
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq/Application/CompositeDriver.hh"
+#include "fhiclcpp/ParameterSet.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Writes Fragments with the given Fragment ID and sequence IDs 1 to events to a file, as BinaryFileOutput would, and returns its name
+	std::string writeFile(std::string const& suffix, artdaq::Fragment::fragment_id_t fragment_id, size_t events)
+	{
+		std::string name = "/tmp/CompositeDriver_t_" + std::to_string(getpid()) + suffix;
+		std::ofstream out(name, std::ofstream::binary);
+		for (size_t seq = 1; seq <= events; ++seq)
+		{
+			artdaq::Fragment frag(2, seq, fragment_id, artdaq::Fragment::DataFragmentType, seq * 10);
+			out.write(reinterpret_cast<char const*>(frag.headerBeginBytes()), frag.sizeBytes());
+		}
+		return name;
+	}
+
+	// A BinaryFileReplay child generator, as it appears in generator_config_list
+	fhicl::ParameterSet makeChild(std::string const& file_name, int fragment_id, std::string const& pacing = "none", double rate_hz = 10.0, bool loop = false)
+	{
+		fhicl::ParameterSet fr_ps;
+		fr_ps.put<std::string>("generator", "BinaryFileReplay");
+		fr_ps.put<int>("board_id", fragment_id);
+		fr_ps.put<int>("fragment_id", fragment_id);
+		fr_ps.put<std::vector<std::string>>("fileNames", { file_name });
+		fr_ps.put<std::string>("pacing", pacing);
+		fr_ps.put<double>("rate_hz", rate_hz);
+		fr_ps.put<bool>("loop", loop);
+
+		fhicl::ParameterSet daq_ps;
+		daq_ps.put("fragment_receiver", fr_ps);
+		fhicl::ParameterSet ps;
+		ps.put("daq", daq_ps);
+		return ps;
+	}
+
+	fhicl::ParameterSet makeConfig(std::vector<fhicl::ParameterSet> const& children)
+	{
+		fhicl::ParameterSet ps;
+		ps.put<int>("board_id", 100);
+		ps.put<bool>("parallel_children", true);
+		ps.put<std::vector<fhicl::ParameterSet>>("generator_config_list", children);
+		return ps;
+	}
+
+	struct Received
+	{
+		artdaq::Fragment::sequence_id_t sequence_id;
+		artdaq::Fragment::fragment_id_t fragment_id;
+		std::chrono::steady_clock::duration elapsed;
+	};
+
+	// The Fragments sent by the generator, until it ends the data or run_time has passed
+	std::vector<Received> receive(artdaq::CompositeDriver& gen, std::chrono::milliseconds run_time)
+	{
+		std::vector<Received> received;
+		auto start = std::chrono::steady_clock::now();
+		artdaq::FragmentPtrs frags;
+		while (std::chrono::steady_clock::now() - start < run_time && gen.getNext(frags))
+		{
+			for (auto& frag : frags) received.push_back({ frag->sequenceID(), frag->fragmentID(), std::chrono::steady_clock::now() - start });
+			frags.clear();
+		}
+		return received;
+	}
+
+	bool inOrder(std::vector<Received> const& received)
+	{
+		for (size_t ii = 1; ii < received.size(); ++ii)
+		{
+			if (received[ii].sequence_id < received[ii - 1].sequence_id) return false;
+		}
+		return true;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(CompositeDriver_test)
+
+	BOOST_AUTO_TEST_CASE(MergeOrder)
+	{
+		artdaq::configureMessageFacility("CompositeDriver_t");
+		auto name0 = writeFile(".merge0", 0, 5);
+		auto name1 = writeFile(".merge1", 1, 5);
+
+		artdaq::CompositeDriver gen(makeConfig({ makeChild(name0, 0), makeChild(name1, 1) }));
+		gen.StartCmd(1, 0xFFFFFFFF, 1);
+		auto received = receive(gen, std::chrono::seconds(10));
+		gen.StopCmd(0xFFFFFFFF, 1);
+
+		// Both children's Fragments for each sequence ID, in sequence ID order
+		BOOST_REQUIRE_EQUAL(received.size(), 10u);
+		BOOST_REQUIRE(inOrder(received));
+		for (size_t ii = 0; ii < received.size(); ++ii)
+		{
+			BOOST_REQUIRE_EQUAL(received[ii].sequence_id, ii / 2 + 1);
+		}
+		BOOST_REQUIRE(!gen.exception());
+		unlink(name0.c_str());
+		unlink(name1.c_str());
+	}
+
+	BOOST_AUTO_TEST_CASE(StalledChild)
+	{
+		artdaq::configureMessageFacility("CompositeDriver_t");
+		auto name0 = writeFile(".stall0", 0, 3);
+		auto name1 = writeFile(".stall1", 1, 3);
+
+		// Child 0 sends an event every millisecond, child 1 every 500 ms
+		auto ps = makeConfig({ makeChild(name0, 0, "fixed", 1000.0, true), makeChild(name1, 1, "fixed", 2.0) });
+		ps.put<size_t>("child_stall_timeout_ms", 100);
+		artdaq::CompositeDriver gen(ps);
+		gen.StartCmd(1, 0xFFFFFFFF, 1);
+		auto received = receive(gen, std::chrono::milliseconds(1200));
+		gen.StopCmd(0xFFFFFFFF, 1);
+
+		// Child 1 is reported as stalled, so child 0's Fragments are sent before child 1 sends its second event
+		bool sent_past_stall = false;
+		for (auto const& frag : received)
+		{
+			if (frag.fragment_id == 0 && frag.sequence_id > 1 && frag.elapsed < std::chrono::milliseconds(400))
+			{
+				sent_past_stall = true;
+				break;
+			}
+		}
+		BOOST_REQUIRE(sent_past_stall);
+
+		// Child 1's later events arrive behind the sequence IDs already sent, and are dropped
+		for (auto const& frag : received)
+		{
+			if (frag.fragment_id == 1) BOOST_REQUIRE_EQUAL(frag.sequence_id, 1u);
+		}
+		BOOST_REQUIRE(inOrder(received));
+		unlink(name0.c_str());
+		unlink(name1.c_str());
+	}
+
+	BOOST_AUTO_TEST_CASE(ChildException)
+	{
+		artdaq::configureMessageFacility("CompositeDriver_t");
+		auto name0 = writeFile(".exception0", 0, 5);
+		auto missing = "/tmp/CompositeDriver_t_" + std::to_string(getpid()) + ".missing";
+
+		// The child which cannot open its file ends the data of the composite, with its exception reported
+		artdaq::CompositeDriver gen(makeConfig({ makeChild(name0, 0), makeChild(missing, 1) }));
+		gen.StartCmd(1, 0xFFFFFFFF, 1);
+		auto start = std::chrono::steady_clock::now();
+		artdaq::FragmentPtrs frags;
+		while (gen.getNext(frags) && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+		{
+			frags.clear();
+		}
+		BOOST_REQUIRE(gen.exception());
+		gen.StopCmd(0xFFFFFFFF, 1);
+		unlink(name0.c_str());
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,174 @@
+#define BOOST_TEST_MODULE LatencyAware_policy_t
+#include <boost/test/auto_unit_test.hpp>
+
+#include "artdaq/Application/Routing/makeRoutingMasterPolicy.hh"
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/make_ParameterSet.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+
+namespace
+{
+	artdaq::detail::RoutingToken makeToken(int rank, unsigned occupied, unsigned count, uint32_t latency_us)
+	{
+		artdaq::detail::RoutingToken token;
+		token.header = TOKEN_MAGIC;
+		token.rank = rank;
+		token.new_slots_free = 1;
+		token.buffers_occupied = occupied;
+		token.buffer_count = count;
+		token.art_latency_us = latency_us;
+		return token;
+	}
+
+	/**
+	 * Simulates a set of Event Builders with different processing times, fed by a board reader which
+	 * generates an event every arrival_interval ticks and sends events (in order) once they have been routed.
+	 * Returns the 99th percentile of the event completion latency (in ticks), measured from event generation.
+	 */
+	double simulateTailLatency(std::string policy_name, fhicl::ParameterSet const& ps)
+	{
+		const int arrival_interval = 2;
+		const int table_interval = 5;
+		const int run_ticks = 20000;
+		const unsigned buffer_count = 4;
+		const std::map<int, int> service_ticks{ { 1, 4 },{ 2, 4 },{ 3, 4 },{ 4, 20 } };
+
+		struct SimEB
+		{
+			int service;
+			int busy_until;
+			double latency_average;
+			std::deque<std::pair<artdaq::Fragment::sequence_id_t, int>> queue; // sequence ID, delivery tick
+		};
+
+		auto policy = artdaq::makeRoutingMasterPolicy(policy_name, ps);
+		policy->Reset();
+
+		std::map<int, SimEB> ebs;
+		for (auto& s : service_ticks)
+		{
+			ebs[s.first] = SimEB{ s.second, -1, 0, {} };
+			policy->UpdateReceiverStatus(makeToken(s.first, 0, buffer_count, 0));
+			policy->AddReceiverToken(s.first, buffer_count);
+		}
+
+		std::map<artdaq::Fragment::sequence_id_t, int> routes;
+		std::map<artdaq::Fragment::sequence_id_t, int> generated;
+		std::deque<artdaq::Fragment::sequence_id_t> waiting;
+		std::vector<int> latencies;
+		artdaq::Fragment::sequence_id_t next_seq = 1;
+
+		for (int tick = 0; tick < run_ticks; ++tick)
+		{
+			for (auto& eb : ebs)
+			{
+				auto& sim = eb.second;
+				if (sim.busy_until >= 0 && tick >= sim.busy_until)
+				{
+					auto done = sim.queue.front();
+					sim.queue.pop_front();
+					latencies.push_back(tick - generated[done.first]);
+					auto residence = tick - done.second;
+					sim.latency_average = sim.latency_average > 0 ? 0.9 * sim.latency_average + 0.1 * residence : residence;
+					sim.busy_until = -1;
+
+					policy->UpdateReceiverStatus(makeToken(eb.first, sim.queue.size(), buffer_count, static_cast<uint32_t>(sim.latency_average * 1000)));
+					policy->AddReceiverToken(eb.first, 1);
+				}
+				if (sim.busy_until < 0 && !sim.queue.empty()) sim.busy_until = tick + sim.service;
+			}
+
+			if (tick % table_interval == 0)
+			{
+				auto table = policy->GetCurrentTable();
+				for (auto& entry : table) routes[entry.sequence_id] = entry.destination_rank;
+			}
+
+			if (tick % arrival_interval == 0)
+			{
+				generated[next_seq] = tick;
+				waiting.push_back(next_seq++);
+			}
+
+			while (!waiting.empty() && routes.count(waiting.front()))
+			{
+				auto& sim = ebs[routes[waiting.front()]];
+				sim.queue.emplace_back(waiting.front(), tick);
+				BOOST_REQUIRE(sim.queue.size() <= buffer_count);
+				if (sim.busy_until < 0) sim.busy_until = tick + sim.service;
+				waiting.pop_front();
+			}
+		}
+
+		BOOST_REQUIRE(latencies.size() > 0);
+		std::sort(latencies.begin(), latencies.end());
+		return latencies[static_cast<size_t>(0.99 * (latencies.size() - 1))];
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(LatencyAware_policy_t)
+
+BOOST_AUTO_TEST_CASE(Simple)
+{
+	fhicl::ParameterSet ps;
+	fhicl::make_ParameterSet("receiver_ranks: [1,2] max_completion_ratio: 2.0", ps);
+
+	auto la = artdaq::makeRoutingMasterPolicy("LatencyAware", ps);
+
+	BOOST_REQUIRE_EQUAL(la->GetReceiverCount(), 2);
+
+	la->Reset();
+	la->UpdateReceiverStatus(makeToken(1, 0, 4, 1000));
+	la->UpdateReceiverStatus(makeToken(2, 0, 4, 10000));
+	la->AddReceiverToken(2, 1);
+	la->AddReceiverToken(1, 1);
+	la->AddReceiverToken(2, 1);
+	la->AddReceiverToken(1, 1);
+
+	// Rank 2 is more than twice as slow as rank 1, so its tokens are held
+	auto firstTable = la->GetCurrentTable();
+	BOOST_REQUIRE_EQUAL(firstTable.size(), 2);
+	BOOST_REQUIRE_EQUAL(firstTable[0].destination_rank, 1);
+	BOOST_REQUIRE_EQUAL(firstTable[0].sequence_id, 1);
+	BOOST_REQUIRE_EQUAL(firstTable[1].destination_rank, 1);
+	BOOST_REQUIRE_EQUAL(firstTable[1].sequence_id, 2);
+
+	// With no faster receiver available, rank 2 is used
+	auto secondTable = la->GetCurrentTable();
+	BOOST_REQUIRE_EQUAL(secondTable.size(), 2);
+	BOOST_REQUIRE_EQUAL(secondTable[0].destination_rank, 2);
+	BOOST_REQUIRE_EQUAL(secondTable[0].sequence_id, 3);
+	BOOST_REQUIRE_EQUAL(secondTable[1].destination_rank, 2);
+	BOOST_REQUIRE_EQUAL(secondTable[1].sequence_id, 4);
+
+	// A full receiver is less attractive than an empty one with the same latency
+	la->UpdateReceiverStatus(makeToken(1, 3, 4, 1000));
+	la->UpdateReceiverStatus(makeToken(2, 0, 4, 1000));
+	la->AddReceiverToken(1, 1);
+	la->AddReceiverToken(2, 1);
+	auto thirdTable = la->GetCurrentTable();
+	BOOST_REQUIRE_EQUAL(thirdTable.size(), 2);
+	BOOST_REQUIRE_EQUAL(thirdTable[0].destination_rank, 2);
+	BOOST_REQUIRE_EQUAL(thirdTable[1].destination_rank, 1);
+
+	la->AddReceiverToken(1, 0);
+	auto fourthTable = la->GetCurrentTable();
+	BOOST_REQUIRE_EQUAL(fourthTable.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(HeterogeneousSimulation)
+{
+	fhicl::ParameterSet ps;
+	fhicl::make_ParameterSet("receiver_ranks: [1,2,3,4]", ps);
+
+	auto roundRobinTail = simulateTailLatency("RoundRobin", ps);
+	auto latencyAwareTail = simulateTailLatency("LatencyAware", ps);
+
+	BOOST_TEST_MESSAGE("99th percentile event completion latency: RoundRobin=" << roundRobinTail << ", LatencyAware=" << latencyAwareTail);
+	BOOST_REQUIRE(latencyAwareTail < roundRobinTail);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -42,4 +42,33 @@ BOOST_AUTO_TEST_CASE(Simple)
 	BOOST_REQUIRE_EQUAL(thirdTable.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(MultiTokens)
+{
+	fhicl::ParameterSet ps;
+	fhicl::make_ParameterSet("receiver_ranks: [1,2,3,4]", ps);
+
+	auto noop = artdaq::makeRoutingMasterPolicy("NoOp", ps);
+
+	// Multi-slot tokens are interleaved after the single tokens
+	noop->Reset();
+	noop->AddReceiverToken(4, 1);
+	noop->AddReceiverToken(1, 3);
+	noop->AddReceiverToken(2, 2);
+	noop->AddReceiverToken(5, 2);
+	BOOST_REQUIRE_EQUAL(noop->GetMaxNumberOfTokens(), 6);
+
+	auto table = noop->GetCurrentTable();
+	BOOST_REQUIRE_EQUAL(table.size(), 6);
+	BOOST_REQUIRE_EQUAL(table[0].destination_rank, 4);
+	BOOST_REQUIRE_EQUAL(table[1].destination_rank, 1);
+	BOOST_REQUIRE_EQUAL(table[2].destination_rank, 2);
+	BOOST_REQUIRE_EQUAL(table[3].destination_rank, 1);
+	BOOST_REQUIRE_EQUAL(table[4].destination_rank, 2);
+	BOOST_REQUIRE_EQUAL(table[5].destination_rank, 1);
+	BOOST_REQUIRE_EQUAL(table[5].sequence_id, 6);
+
+	auto emptyTable = noop->GetCurrentTable();
+	BOOST_REQUIRE_EQUAL(emptyTable.size(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
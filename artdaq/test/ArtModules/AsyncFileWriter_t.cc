@@ -0,0 +1,59 @@
+#define TRACE_NAME "AsyncFileWriter_t"
+
+#include "artdaq/ArtModules/detail/AsyncFileWriter.hh"
+
+#define BOOST_TEST_MODULE AsyncFileWriter_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+	std::vector<char> readFile(std::string const& name)
+	{
+		std::ifstream in(name, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(AsyncFileWriter_test)
+
+BOOST_AUTO_TEST_CASE(WriteAcrossBuffers)
+{
+	std::string name = "/tmp/AsyncFileWriter_t_" + std::to_string(getpid()) + ".bin";
+	std::vector<char> data(3 * artdaq::detail::AsyncFileWriter::ALIGNMENT + 123);
+	std::iota(data.begin(), data.end(), 0);
+
+	artdaq::detail::AsyncFileWriter writer(name, artdaq::detail::AsyncFileWriter::ALIGNMENT, 2, false);
+	for (size_t ii = 0; ii < data.size(); ii += 1000)
+	{
+		writer.Write(&data[ii], std::min(size_t(1000), data.size() - ii));
+	}
+	BOOST_REQUIRE_EQUAL(writer.size(), data.size());
+	writer.Close();
+
+	BOOST_REQUIRE(readFile(name) == data);
+	unlink(name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(EmptyFile)
+{
+	std::string name = "/tmp/AsyncFileWriter_t_" + std::to_string(getpid()) + ".empty";
+	{
+		artdaq::detail::AsyncFileWriter writer(name, 1, 1, false);
+	}
+	BOOST_REQUIRE_EQUAL(readFile(name).size(), 0u);
+	unlink(name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(OpenFailure)
+{
+	BOOST_REQUIRE_THROW(artdaq::detail::AsyncFileWriter("/nonexistent_directory/file.bin", 4096, 2, false), cet::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,144 @@
+#define TRACE_NAME "ContainerFragmentUnpacker_t"
+
+#include "artdaq/ArtModules/detail/ContainedFragmentType.hh"
+#include "artdaq/DAQdata/FragmentView.hh"
+#include "artdaq-core/Data/ContainerFragmentLoader.hh"
+#include "artdaq-core/Data/Fragment.hh"
+
+#define BOOST_TEST_MODULE ContainerFragmentUnpacker_t
+#include "cetlib/quiet_unit_test.hpp"
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace
+{
+	const artdaq::Fragment::type_t TYPE_A = artdaq::Fragment::FirstUserFragmentType;
+	const artdaq::Fragment::type_t TYPE_B = artdaq::Fragment::FirstUserFragmentType + 1;
+	const artdaq::Fragment::type_t TYPE_UNKNOWN = artdaq::Fragment::FirstUserFragmentType + 2;
+
+	// A ContainerFragment holding two Fragments of the given type
+	artdaq::Fragment makeContainer(artdaq::Fragment::fragment_id_t fragment_id, artdaq::Fragment::type_t contained_type)
+	{
+		artdaq::Fragment container(1, fragment_id);
+		artdaq::ContainerFragmentLoader cfl(container);
+		for (size_t ii = 0; ii < 2; ++ii)
+		{
+			artdaq::Fragment frag(4);
+			frag.setSequenceID(1);
+			frag.setFragmentID(fragment_id);
+			frag.setUserType(contained_type);
+			for (size_t jj = 0; jj < frag.dataSize(); ++jj) *(frag.dataBegin() + jj) = fragment_id * 100 + ii * 10 + jj;
+			cfl.addFragment(frag);
+		}
+		return container;
+	}
+
+	// Containers of TYPE_A, TYPE_B, TYPE_A and an unknown type, with Fragment IDs 0-3
+	artdaq::Fragments makeContainers()
+	{
+		artdaq::Fragments containers;
+		containers.push_back(makeContainer(0, TYPE_A));
+		containers.push_back(makeContainer(1, TYPE_B));
+		containers.push_back(makeContainer(2, TYPE_A));
+		containers.push_back(makeContainer(3, TYPE_UNKNOWN));
+		return containers;
+	}
+
+	std::map<artdaq::Fragment::type_t, std::string> makeTypeMap()
+	{
+		std::map<artdaq::Fragment::type_t, std::string> types;
+		types[TYPE_A] = "A";
+		types[TYPE_B] = "B";
+		return types;
+	}
+
+	template <class T>
+	void requireSameBytes(T const& frag, artdaq::Fragment const& expected)
+	{
+		BOOST_REQUIRE_EQUAL(frag.sizeBytes(), expected.sizeBytes());
+		BOOST_REQUIRE(memcmp(&*frag.headerBegin(), &*expected.headerBegin(), expected.sizeBytes()) == 0);
+	}
+
+	void requireSameBytes(artdaq::FragmentView const& view, artdaq::Fragment const& expected)
+	{
+		requireSameBytes(view.copy(), expected);
+	}
+
+	// Check the products made from makeContainers()
+	template <class Product>
+	void checkSorted(std::map<std::string, std::unique_ptr<Product>> const& products, artdaq::Fragments const& containers)
+	{
+		BOOST_REQUIRE_EQUAL(products.size(), 3u);
+		BOOST_REQUIRE_EQUAL(products.at("ContainerA")->size(), 2u);
+		BOOST_REQUIRE_EQUAL(products.at("ContainerB")->size(), 1u);
+		BOOST_REQUIRE_EQUAL(products.at("Container")->size(), 1u);
+
+		requireSameBytes(products.at("ContainerA")->at(0), containers[0]);
+		requireSameBytes(products.at("ContainerA")->at(1), containers[2]);
+		requireSameBytes(products.at("ContainerB")->at(0), containers[1]);
+		requireSameBytes(products.at("Container")->at(0), containers[3]);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(ContainerFragmentUnpacker_test)
+
+BOOST_AUTO_TEST_CASE(ContainedType)
+{
+	auto containers = makeContainers();
+	BOOST_REQUIRE_EQUAL(artdaq::detail::containedFragmentType(containers[1]), TYPE_B);
+	BOOST_REQUIRE_EQUAL(artdaq::detail::containedFragmentType(artdaq::FragmentView(containers[1].headerAddress())), TYPE_B);
+}
+
+BOOST_AUTO_TEST_CASE(FragmentsToFragments)
+{
+	auto containers = makeContainers();
+	std::map<std::string, std::unique_ptr<artdaq::Fragments>> products;
+	products["Container"] = std::make_unique<artdaq::Fragments>();
+	artdaq::detail::sortContainerFragments(containers, makeTypeMap(), "Container", products);
+
+	checkSorted(products, containers);
+	// The products are copies, which do not depend on the input
+	BOOST_REQUIRE(products.at("ContainerA")->at(0).headerAddress() != containers[0].headerAddress());
+}
+
+BOOST_AUTO_TEST_CASE(FragmentsToViews)
+{
+	auto containers = makeContainers();
+	std::map<std::string, std::unique_ptr<artdaq::FragmentViews>> products;
+	products["Container"] = std::make_unique<artdaq::FragmentViews>();
+	artdaq::detail::sortContainerFragments(containers, makeTypeMap(), "Container", products);
+
+	checkSorted(products, containers);
+	// The views refer to the input in place
+	BOOST_REQUIRE_EQUAL(products.at("ContainerA")->at(1).headerAddress(), containers[2].headerAddress());
+	BOOST_REQUIRE_EQUAL(products.at("Container")->at(0).headerAddress(), containers[3].headerAddress());
+}
+
+BOOST_AUTO_TEST_CASE(ViewsToFragments)
+{
+	auto containers = makeContainers();
+	artdaq::FragmentViews views;
+	for (auto& container : containers) views.emplace_back(container.headerAddress());
+
+	std::map<std::string, std::unique_ptr<artdaq::Fragments>> products;
+	products["Container"] = std::make_unique<artdaq::Fragments>();
+	artdaq::detail::sortContainerFragments(views, makeTypeMap(), "Container", products);
+
+	checkSorted(products, containers);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyInput)
+{
+	artdaq::Fragments containers;
+	std::map<std::string, std::unique_ptr<artdaq::Fragments>> products;
+	products["Container"] = std::make_unique<artdaq::Fragments>();
+	artdaq::detail::sortContainerFragments(containers, makeTypeMap(), "Container", products);
+
+	BOOST_REQUIRE_EQUAL(products.size(), 1u);
+	BOOST_REQUIRE_EQUAL(products.at("Container")->size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+#define TRACE_NAME "FragmentBufferFile_t"
+
+#include "artdaq/ArtModules/detail/FragmentBufferFile.hh"
+#include "artdaq/ArtModules/detail/FragmentReadBufferFile.hh"
+#include "artdaq/DAQdata/NetMonHeader.hh"
+
+#define BOOST_TEST_MODULE FragmentBufferFile_t
+#include "cetlib/quiet_unit_test.hpp"
+
+BOOST_AUTO_TEST_SUITE(FragmentBufferFile_test)
+
+BOOST_AUTO_TEST_CASE(StreamIntoFragment)
+{
+	auto frag = artdaq::Fragment::FragmentBytes(0, 1, 2, artdaq::Fragment::DataFragmentType, artdaq::NetMonHeader());
+
+	artdaq::detail::FragmentBufferFile msg(*frag, 0);
+	msg.WriteULong(4);
+	msg.WriteULong(5);
+	msg.Finish();
+
+	BOOST_REQUIRE_EQUAL(frag->dataSizeBytes(), static_cast<size_t>(msg.Length()));
+	BOOST_REQUIRE_EQUAL(reinterpret_cast<char*>(frag->dataBeginBytes()), msg.Buffer());
+	BOOST_REQUIRE_EQUAL(frag->sequenceID(), 1);
+	BOOST_REQUIRE_EQUAL(frag->fragmentID(), 2);
+	BOOST_REQUIRE(frag->hasMetadata());
+
+	TBufferFile in(TBuffer::kRead, msg.Length(), frag->dataBeginBytes(), kFALSE);
+	ULong_t val = 0;
+	in.ReadULong(val);
+	BOOST_REQUIRE_EQUAL(val, 4ul);
+	in.ReadULong(val);
+	BOOST_REQUIRE_EQUAL(val, 5ul);
+}
+
+BOOST_AUTO_TEST_CASE(GrowFragment)
+{
+	const size_t COUNT = 100000; // Much larger than the initial size
+	auto frag = artdaq::Fragment::FragmentBytes(0, 1, 2, artdaq::Fragment::DataFragmentType, artdaq::NetMonHeader());
+
+	{
+		artdaq::detail::FragmentBufferFile msg(*frag, 16);
+		for (size_t ii = 0; ii < COUNT; ++ii)
+		{
+			msg.WriteULong(ii);
+		}
+		msg.Finish();
+		BOOST_REQUIRE_EQUAL(frag->dataSizeBytes(), static_cast<size_t>(msg.Length()));
+		BOOST_REQUIRE_EQUAL(reinterpret_cast<char*>(frag->dataBeginBytes()), msg.Buffer());
+	}
+
+	TBufferFile in(TBuffer::kRead, frag->dataSizeBytes(), frag->dataBeginBytes(), kFALSE);
+	for (size_t ii = 0; ii < COUNT; ++ii)
+	{
+		ULong_t val = 0;
+		in.ReadULong(val);
+		BOOST_REQUIRE_EQUAL(val, ii);
+	}
+
+	// A second message reuses the storage which the first one grew
+	auto storage = frag->headerBeginBytes();
+	artdaq::detail::FragmentBufferFile msg(*frag, 16);
+	for (size_t ii = 0; ii < COUNT; ++ii)
+	{
+		msg.WriteULong(ii);
+	}
+	msg.Finish();
+	BOOST_REQUIRE_EQUAL(frag->headerBeginBytes(), storage);
+}
+
+BOOST_AUTO_TEST_CASE(ReadFromFragment)
+{
+	auto frag = artdaq::Fragment::FragmentBytes(0, 1, 2, artdaq::Fragment::DataFragmentType, artdaq::NetMonHeader());
+	{
+		artdaq::detail::FragmentBufferFile msg(*frag, 0);
+		msg.WriteULong(4);
+		msg.WriteULong(5);
+		msg.Finish();
+		frag->metadata<artdaq::NetMonHeader>()->data_length = msg.Length();
+	}
+
+	auto payload = reinterpret_cast<char*>(frag->dataBeginBytes());
+	artdaq::detail::FragmentReadBufferFile in(std::move(frag));
+	BOOST_REQUIRE_EQUAL(in.Buffer(), payload);
+	BOOST_REQUIRE_EQUAL(in.fragment().sequenceID(), 1);
+
+	ULong_t val = 0;
+	in.ReadULong(val);
+	BOOST_REQUIRE_EQUAL(val, 4ul);
+	in.ReadULong(val);
+	BOOST_REQUIRE_EQUAL(val, 5ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,167 @@
+#define TRACE_NAME "ProductSerializationPlan_t"
+
+#include "artdaq/ArtModules/detail/ProductSerializationPlan.hh"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq-core/Data/Fragment.hh"
+
+#include "canvas/Persistency/Common/Wrapper.h"
+#include "canvas/Utilities/Exception.h"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE ProductSerializationPlan_t
+#include "cetlib/quiet_unit_test.hpp"
+
+namespace
+{
+	const std::string WRAPPED_NAME = "art::Wrapper<std::vector<artdaq::Fragment> >";
+
+	struct TestProduct
+	{
+		art::ProductID id;
+		art::BranchKey key;
+		std::unique_ptr<art::EDProduct> wrapper;
+	};
+
+	std::vector<TestProduct> makeProducts(size_t count)
+	{
+		std::vector<TestProduct> products;
+		for (size_t ii = 0; ii < count; ++ii)
+		{
+			std::unique_ptr<artdaq::Fragments> frags(new artdaq::Fragments());
+			frags->emplace_back(16, ii, ii, artdaq::Fragment::FirstUserFragmentType);
+			products.push_back(TestProduct{ art::ProductID(static_cast<art::ProductID::value_type>(ii + 1)),
+			                                art::BranchKey("artdaq::Fragments", "daq", "inst" + std::to_string(ii), "DAQ", art::InEvent),
+			                                std::unique_ptr<art::EDProduct>(new art::Wrapper<artdaq::Fragments>(std::move(frags))) });
+		}
+		return products;
+	}
+
+	// What writeDataProducts did for every event before the plan: search the kept products, make a new BranchKey,
+	// and look up the TClass by name, for each product
+	void writeUncached(TBufferFile& msg, std::vector<TestProduct> const& products)
+	{
+		static TClass* branch_key_class = TClass::GetClass("art::BranchKey");
+		static TClass* prdprov_class = TClass::GetClass("art::ProductProvenance");
+		std::vector<art::BranchKey*> bkv;
+		msg.WriteULong(products.size());
+		for (auto const& product : products)
+		{
+			bool found = false;
+			for (auto const& kept : products)
+			{
+				if (kept.id == product.id)
+				{
+					found = true;
+					break;
+				}
+			}
+			if (!found) continue;
+			bkv.push_back(new art::BranchKey(product.key));
+			msg.WriteObjectAny(bkv.back(), branch_key_class);
+			msg.WriteObjectAny(product.wrapper.get(), TClass::GetClass(WRAPPED_NAME.c_str()));
+			msg.WriteObjectAny(nullptr, prdprov_class);
+		}
+		for (auto key : bkv)
+		{
+			delete key;
+		}
+	}
+
+	void writePlanned(TBufferFile& msg, artdaq::detail::ProductSerializationPlan const& plan, std::vector<TestProduct> const& products)
+	{
+		msg.WriteULong(products.size());
+		for (auto const& product : products)
+		{
+			auto branch = plan.Find(product.id);
+			if (branch == nullptr) continue;
+			plan.WriteProduct(msg, *branch, product.wrapper.get(), nullptr);
+		}
+	}
+
+	void fillPlan(artdaq::detail::ProductSerializationPlan& plan, std::vector<TestProduct> const& products)
+	{
+		for (auto const& product : products)
+		{
+			plan.Add(product.id, product.key, WRAPPED_NAME);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(ProductSerializationPlan_test)
+
+BOOST_AUTO_TEST_CASE(Find)
+{
+	auto products = makeProducts(3);
+	artdaq::detail::ProductSerializationPlan plan;
+	BOOST_REQUIRE(plan.Find(products[0].id) == nullptr);
+
+	fillPlan(plan, products);
+	auto branch = plan.Find(products[1].id);
+	BOOST_REQUIRE(branch != nullptr);
+	BOOST_REQUIRE_EQUAL(branch->key.productInstanceName_, "inst1");
+	BOOST_REQUIRE(branch->product_class == TClass::GetClass(WRAPPED_NAME.c_str()));
+
+	plan.Reset();
+	BOOST_REQUIRE(plan.Find(products[1].id) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(MissingDictionary)
+{
+	auto products = makeProducts(1);
+	artdaq::detail::ProductSerializationPlan plan;
+	BOOST_REQUIRE_THROW(plan.Add(products[0].id, products[0].key, "art::Wrapper<NoSuchClass>"), art::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(SameBytes)
+{
+	auto products = makeProducts(10);
+	artdaq::detail::ProductSerializationPlan plan;
+	fillPlan(plan, products);
+
+	TBufferFile uncached(TBuffer::kWrite);
+	writeUncached(uncached, products);
+	TBufferFile planned(TBuffer::kWrite);
+	writePlanned(planned, plan, products);
+
+	BOOST_REQUIRE_EQUAL(uncached.Length(), planned.Length());
+	BOOST_REQUIRE_EQUAL(memcmp(uncached.Buffer(), planned.Buffer(), uncached.Length()), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark)
+{
+	const size_t PRODUCTS_PER_TEST = 100000; // Total number of products serialized for each product count
+
+	for (size_t count : { 10, 100, 1000 })
+	{
+		auto products = makeProducts(count);
+		artdaq::detail::ProductSerializationPlan plan;
+		fillPlan(plan, products);
+		auto events = PRODUCTS_PER_TEST / count;
+
+		auto start = std::chrono::steady_clock::now();
+		for (size_t ii = 0; ii < events; ++ii)
+		{
+			TBufferFile msg(TBuffer::kWrite);
+			writeUncached(msg, products);
+		}
+		auto uncached_us = std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(std::chrono::steady_clock::now() - start).count() / events;
+
+		start = std::chrono::steady_clock::now();
+		for (size_t ii = 0; ii < events; ++ii)
+		{
+			TBufferFile msg(TBuffer::kWrite);
+			writePlanned(msg, plan, products);
+		}
+		auto planned_us = std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(std::chrono::steady_clock::now() - start).count() / events;
+
+		BOOST_TEST_MESSAGE("Serializing " << count << " products: " << uncached_us << " us/event without plan, " << planned_us << " us/event with plan");
+		TLOG(TLVL_INFO) << "Serializing " << count << " products: " << uncached_us << " us/event without plan, " << planned_us << " us/event with plan";
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
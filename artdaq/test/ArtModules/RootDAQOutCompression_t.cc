@@ -0,0 +1,44 @@
+#define TRACE_NAME "RootDAQOutCompression_t"
+
+#include "artdaq/ArtModules/RootDAQOutput/RootDAQOutFile.h"
+
+#include "canvas/Utilities/Exception.h"
+
+#include "Compression.h"
+
+#include <string>
+
+#define BOOST_TEST_MODULE RootDAQOutCompression_t
+#include "cetlib/quiet_unit_test.hpp"
+
+BOOST_AUTO_TEST_SUITE(RootDAQOutCompression_test)
+
+BOOST_AUTO_TEST_CASE(KnownNames)
+{
+	BOOST_REQUIRE_EQUAL(art::detail::compressionAlgorithmFromName("ZLIB"), static_cast<int>(ROOT::kZLIB));
+	BOOST_REQUIRE_EQUAL(art::detail::compressionAlgorithmFromName("LZMA"), static_cast<int>(ROOT::kLZMA));
+	BOOST_REQUIRE_EQUAL(art::detail::compressionAlgorithmFromName("LZ4"), static_cast<int>(ROOT::kLZ4));
+	BOOST_REQUIRE_EQUAL(art::detail::compressionAlgorithmFromName("Global"), static_cast<int>(ROOT::kUseGlobalCompressionSetting));
+}
+
+BOOST_AUTO_TEST_CASE(UnknownNames)
+{
+	// Names are case-sensitive, as in the module documentation
+	for (std::string name : { "", "zlib", "ZSTD", "Global " })
+	{
+		bool thrown = false;
+		try
+		{
+			art::detail::compressionAlgorithmFromName(name);
+		}
+		catch (art::Exception const& e)
+		{
+			thrown = true;
+			BOOST_REQUIRE(e.categoryCode() == art::errors::Configuration);
+			BOOST_REQUIRE(std::string(e.what()).find("Unknown compressionAlgorithm") != std::string::npos);
+		}
+		BOOST_REQUIRE(thrown);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
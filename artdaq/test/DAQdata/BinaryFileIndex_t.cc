@@ -0,0 +1,85 @@
+#define BOOST_TEST_MODULE BinaryFileIndex_t
+#include <boost/test/auto_unit_test.hpp>
+
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq/DAQdata/BinaryFileIndex.hh"
+#include "cetlib_except/exception.h"
+
+#include <unistd.h>
+
+#include <fstream>
+
+namespace
+{
+	// Writes the Fragments (sequence ID, fragment ID, payload words) to a data file and its index, returns the data file name
+	std::string writeFile(std::string const& suffix, std::vector<std::tuple<size_t, size_t, size_t>> const& frags)
+	{
+		std::string name = "/tmp/BinaryFileIndex_t_" + std::to_string(getpid()) + suffix;
+		std::ofstream data(name, std::ofstream::binary);
+		artdaq::BinaryFileIndexWriter index(artdaq::BinaryFileIndex::IndexFileName(name));
+		uint64_t offset = 0;
+		for (auto const& f : frags)
+		{
+			artdaq::Fragment frag(std::get<2>(f), std::get<0>(f), std::get<1>(f));
+			for (size_t ii = 0; ii < frag.dataSize(); ++ii) *(frag.dataBegin() + ii) = std::get<0>(f) * 100 + ii;
+			data.write(reinterpret_cast<char const*>(frag.headerBeginBytes()), frag.sizeBytes());
+			index.Add(frag, offset);
+			offset += frag.sizeBytes();
+		}
+		index.Close();
+		return name;
+	}
+
+	void removeFile(std::string const& name)
+	{
+		unlink(name.c_str());
+		unlink(artdaq::BinaryFileIndex::IndexFileName(name).c_str());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(BinaryFileIndex_test)
+
+	BOOST_AUTO_TEST_CASE(FindAndRead)
+	{
+		// Fragments of an event are not always written in Fragment ID order, nor events in Sequence ID order
+		auto name = writeFile(".find", {{1, 1, 4}, {1, 0, 2}, {3, 0, 7}, {2, 0, 1}, {2, 1, 3}});
+		artdaq::BinaryFileIndex index(name);
+		BOOST_REQUIRE_EQUAL(index.entries().size(), 5u);
+
+		auto entry = index.Find(3, 0);
+		BOOST_REQUIRE(entry != nullptr);
+		BOOST_REQUIRE_EQUAL(entry->sequence_id, 3u);
+		BOOST_REQUIRE_EQUAL(entry->fragment_id, 0);
+
+		auto frag = index.ReadFragment(*entry);
+		BOOST_REQUIRE_EQUAL(frag->sequenceID(), 3u);
+		BOOST_REQUIRE_EQUAL(frag->dataSize(), 7u);
+		BOOST_REQUIRE_EQUAL(*(frag->dataBegin() + 6), 306u);
+
+		BOOST_REQUIRE(index.Find(2, 2) == nullptr);
+		BOOST_REQUIRE(index.Find(4, 0) == nullptr);
+		removeFile(name);
+	}
+
+	BOOST_AUTO_TEST_CASE(Range)
+	{
+		auto name = writeFile(".range", {{1, 0, 1}, {2, 1, 1}, {2, 0, 1}, {3, 0, 1}, {5, 0, 1}});
+		artdaq::BinaryFileIndex index(name);
+
+		auto range = index.FindRange(2, 4);
+		BOOST_REQUIRE_EQUAL(std::distance(range.first, range.second), 3);
+		BOOST_REQUIRE_EQUAL(range.first->sequence_id, 2u);
+		BOOST_REQUIRE_EQUAL(range.first->fragment_id, 0);
+		BOOST_REQUIRE_EQUAL((range.second - 1)->sequence_id, 3u);
+
+		range = index.FindRange(6, 10);
+		BOOST_REQUIRE(range.first == range.second);
+		removeFile(name);
+	}
+
+	BOOST_AUTO_TEST_CASE(MissingIndex)
+	{
+		BOOST_REQUIRE_THROW(artdaq::BinaryFileIndex("/tmp/BinaryFileIndex_t_does_not_exist"), cet::exception);
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
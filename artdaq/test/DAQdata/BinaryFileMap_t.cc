@@ -0,0 +1,99 @@
+#define BOOST_TEST_MODULE BinaryFileMap_t
+#include <boost/test/auto_unit_test.hpp>
+
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq/DAQdata/BinaryFileMap.hh"
+#include "artdaq/DAQdata/ReplayPacer.hh"
+#include "cetlib_except/exception.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+
+namespace
+{
+	// Writes Fragments with the given (sequence ID, fragment ID) to a file, as BinaryFileOutput would, and returns its name
+	std::string writeFile(std::string const& suffix, std::vector<std::pair<size_t, size_t>> const& ids, size_t extra_bytes = 0)
+	{
+		std::string name = "/tmp/BinaryFileMap_t_" + std::to_string(getpid()) + suffix;
+		std::ofstream out(name, std::ofstream::binary);
+		for (auto const& id : ids)
+		{
+			artdaq::Fragment frag(id.first + 1, id.first, id.second, artdaq::Fragment::DataFragmentType, id.first * 10);
+			out.write(reinterpret_cast<char const*>(frag.headerBeginBytes()), frag.sizeBytes());
+		}
+		std::string junk(extra_bytes, 'x');
+		out.write(junk.data(), junk.size());
+		return name;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(BinaryFileMap_test)
+
+	BOOST_AUTO_TEST_CASE(Events)
+	{
+		auto name = writeFile(".events", {{1, 0}, {1, 1}, {2, 0}, {3, 1}, {3, 0}});
+		artdaq::BinaryFileMap file(name);
+		artdaq::FragmentViews frags;
+
+		BOOST_REQUIRE(file.NextEvent(frags));
+		BOOST_REQUIRE_EQUAL(frags.size(), 2u);
+		BOOST_REQUIRE_EQUAL(frags[0].sequenceID(), 1u);
+		BOOST_REQUIRE_EQUAL(frags[1].fragmentID(), 1);
+		BOOST_REQUIRE_EQUAL(frags[1].size(), artdaq::detail::RawFragmentHeader::num_words() + 2);
+
+		BOOST_REQUIRE(file.NextEvent(frags));
+		BOOST_REQUIRE_EQUAL(frags.size(), 1u);
+		BOOST_REQUIRE_EQUAL(frags[0].timestamp(), 20u);
+
+		BOOST_REQUIRE(file.NextEvent(frags));
+		BOOST_REQUIRE_EQUAL(frags.size(), 2u);
+		BOOST_REQUIRE_EQUAL(frags[0].fragmentID(), 1);
+		BOOST_REQUIRE(!file.NextEvent(frags));
+		BOOST_REQUIRE(frags.empty());
+
+		file.Rewind();
+		BOOST_REQUIRE(file.NextEvent(frags));
+		BOOST_REQUIRE_EQUAL(frags[0].sequenceID(), 1u);
+		unlink(name.c_str());
+	}
+
+	BOOST_AUTO_TEST_CASE(Truncated)
+	{
+		auto name = writeFile(".truncated", {{1, 0}, {2, 0}}, 12);
+		artdaq::BinaryFileMap file(name);
+		artdaq::FragmentViews frags;
+		BOOST_REQUIRE(file.NextEvent(frags));
+		BOOST_REQUIRE(file.NextEvent(frags));
+		BOOST_REQUIRE(!file.NextEvent(frags));
+		unlink(name.c_str());
+	}
+
+	BOOST_AUTO_TEST_CASE(MissingFile)
+	{
+		BOOST_REQUIRE_THROW(artdaq::BinaryFileMap("/tmp/BinaryFileMap_t_does_not_exist"), cet::exception);
+	}
+
+	BOOST_AUTO_TEST_CASE(FixedRatePacing)
+	{
+		artdaq::ReplayPacer pacer(artdaq::ReplayPacer::ModeFromString("fixed"), 100.0, 1.0);
+		auto start = std::chrono::steady_clock::now();
+		for (size_t ii = 0; ii < 5; ++ii)
+		{
+			while (!pacer.Wait(0, 1000)) {}
+		}
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		BOOST_REQUIRE_GE(elapsed, 40);
+	}
+
+	BOOST_AUTO_TEST_CASE(RecordedPacing)
+	{
+		artdaq::ReplayPacer pacer(artdaq::ReplayPacer::Mode::AsRecorded, 0, 1000.0);
+		BOOST_REQUIRE(pacer.Wait(1000, 0));
+		BOOST_REQUIRE(!pacer.Wait(1100, 1000)); // Due 100 ms after the first
+		BOOST_REQUIRE(pacer.Wait(900, 0)); // Earlier than the first, so due at once
+		BOOST_REQUIRE_THROW(artdaq::ReplayPacer::ModeFromString("sometimes"), cet::exception);
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
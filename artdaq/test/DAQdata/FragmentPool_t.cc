@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE FragmentPool_t
+#include <boost/test/auto_unit_test.hpp>
+
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq-core/Data/detail/RawFragmentHeader.hh"
+#include "artdaq/DAQdata/FragmentPool.hh"
+
+struct TestMetadata
+{
+	uint64_t a;
+	uint32_t b;
+};
+
+BOOST_AUTO_TEST_SUITE(FragmentPool_test)
+
+	BOOST_AUTO_TEST_CASE(Inactive)
+	{
+		artdaq::FragmentPool pool;
+		pool.Return(artdaq::FragmentPtr(new artdaq::Fragment(100)));
+		BOOST_REQUIRE_EQUAL(pool.size(), 0ul);
+	}
+
+	BOOST_AUTO_TEST_CASE(Get)
+	{
+		artdaq::FragmentPool pool;
+		auto frag = pool.Get(100, 1, 2, artdaq::Fragment::FirstUserFragmentType, 3);
+		BOOST_REQUIRE_EQUAL(pool.misses(), 1ul);
+		BOOST_REQUIRE_EQUAL(frag->dataSize(), 100ul);
+		BOOST_REQUIRE_EQUAL(frag->sequenceID(), 1ul);
+		BOOST_REQUIRE_EQUAL(frag->fragmentID(), 2);
+		BOOST_REQUIRE_EQUAL(frag->type(), artdaq::Fragment::FirstUserFragmentType);
+		BOOST_REQUIRE_EQUAL(frag->timestamp(), 3ul);
+
+		auto storage = frag->dataBegin();
+		pool.Return(std::move(*frag));
+		BOOST_REQUIRE_EQUAL(pool.size(), 1ul);
+
+		// A smaller request is served from the same storage
+		frag = pool.Get(90, 4, 5, artdaq::Fragment::EndOfSubrunFragmentType, 6);
+		BOOST_REQUIRE_EQUAL(pool.hits(), 1ul);
+		BOOST_REQUIRE_EQUAL(pool.size(), 0ul);
+		BOOST_REQUIRE(frag->dataBegin() == storage);
+		BOOST_REQUIRE_EQUAL(frag->dataSize(), 90ul);
+		BOOST_REQUIRE_EQUAL(frag->sequenceID(), 4ul);
+		BOOST_REQUIRE_EQUAL(frag->fragmentID(), 5);
+		BOOST_REQUIRE_EQUAL(frag->type(), artdaq::Fragment::EndOfSubrunFragmentType);
+		BOOST_REQUIRE_EQUAL(frag->timestamp(), 6ul);
+
+		// A much larger request is not
+		pool.Return(std::move(frag));
+		frag = pool.Get(1000);
+		BOOST_REQUIRE_EQUAL(pool.misses(), 2ul);
+		BOOST_REQUIRE_EQUAL(pool.size(), 1ul);
+	}
+
+	BOOST_AUTO_TEST_CASE(GetBytes)
+	{
+		artdaq::FragmentPool pool;
+		TestMetadata md = { 1, 2 };
+		auto frag = pool.GetBytes(1000, 1, 2, artdaq::Fragment::FirstUserFragmentType, md);
+		BOOST_REQUIRE(frag->hasMetadata());
+		BOOST_REQUIRE_EQUAL(frag->dataSizeBytes(), 1000ul);
+		pool.Return(std::move(frag));
+
+		md = { 3, 4 };
+		frag = pool.GetBytes(800, 5, 6, artdaq::Fragment::FirstUserFragmentType, md);
+		BOOST_REQUIRE_EQUAL(pool.hits(), 1ul);
+		BOOST_REQUIRE_EQUAL(frag->dataSizeBytes(), 800ul);
+		BOOST_REQUIRE_EQUAL(frag->metadata<TestMetadata>()->a, 3ul);
+		BOOST_REQUIRE_EQUAL(frag->metadata<TestMetadata>()->b, 4u);
+		BOOST_REQUIRE_EQUAL(frag->sequenceID(), 5ul);
+		pool.Return(std::move(frag));
+
+		// A Fragment with metadata can be reused for one without
+		frag = pool.Get(100);
+		BOOST_REQUIRE_EQUAL(pool.hits(), 2ul);
+		BOOST_REQUIRE(!frag->hasMetadata());
+		BOOST_REQUIRE_EQUAL(frag->dataSize(), 100ul);
+	}
+
+	BOOST_AUTO_TEST_CASE(Limits)
+	{
+		artdaq::FragmentPool pool(2);
+		pool.Get(0);
+		for (int ii = 0; ii < 4; ++ii) pool.Return(artdaq::FragmentPtr(new artdaq::Fragment(100)));
+		BOOST_REQUIRE_EQUAL(pool.size(), 2ul);
+
+		pool.SetLimits(2, 0);
+		BOOST_REQUIRE_EQUAL(pool.size(), 0ul);
+		BOOST_REQUIRE_EQUAL(pool.sizeBytes(), 0ul);
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,59 @@
+#define BOOST_TEST_MODULE FragmentView_t
+#include <boost/test/auto_unit_test.hpp>
+
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq/DAQdata/FragmentView.hh"
+
+struct TestMetadata
+{
+	uint64_t a;
+	uint32_t b;
+};
+
+BOOST_AUTO_TEST_SUITE(FragmentView_test)
+
+	BOOST_AUTO_TEST_CASE(View)
+	{
+		TestMetadata md{ 4, 5 };
+		auto frag = artdaq::Fragment::FragmentBytes(24, 1, 2, artdaq::Fragment::FirstUserFragmentType, md, 3);
+		for (size_t ii = 0; ii < frag->dataSize(); ++ii) *(frag->dataBegin() + ii) = ii;
+
+		artdaq::FragmentView view(frag->headerAddress());
+		BOOST_REQUIRE_EQUAL(view.headerAddress(), frag->headerAddress());
+		BOOST_REQUIRE_EQUAL(view.size(), frag->size());
+		BOOST_REQUIRE_EQUAL(view.sizeBytes(), frag->sizeBytes());
+		BOOST_REQUIRE_EQUAL(view.sequenceID(), 1ul);
+		BOOST_REQUIRE_EQUAL(view.fragmentID(), 2);
+		BOOST_REQUIRE_EQUAL(view.type(), artdaq::Fragment::FirstUserFragmentType);
+		BOOST_REQUIRE_EQUAL(view.timestamp(), 3ul);
+		BOOST_REQUIRE(view.hasMetadata());
+		BOOST_REQUIRE_EQUAL(view.metadata<TestMetadata>()->a, 4ul);
+		BOOST_REQUIRE_EQUAL(view.metadata<TestMetadata>()->b, 5u);
+		BOOST_REQUIRE_EQUAL(view.dataBegin(), &*frag->dataBegin());
+		BOOST_REQUIRE_EQUAL(view.dataSizeBytes(), frag->dataSizeBytes());
+	}
+
+	BOOST_AUTO_TEST_CASE(NoMetadata)
+	{
+		artdaq::Fragment frag(3);
+		artdaq::FragmentView view(frag.headerAddress());
+		BOOST_REQUIRE(!view.hasMetadata());
+		BOOST_REQUIRE(view.metadata<TestMetadata>() == nullptr);
+		BOOST_REQUIRE_EQUAL(view.dataEnd() - view.dataBegin(), 3);
+	}
+
+	BOOST_AUTO_TEST_CASE(Copy)
+	{
+		TestMetadata md{ 4, 5 };
+		auto frag = artdaq::Fragment::FragmentBytes(24, 1, 2, artdaq::Fragment::FirstUserFragmentType, md, 3);
+		for (size_t ii = 0; ii < frag->dataSize(); ++ii) *(frag->dataBegin() + ii) = ii;
+
+		auto copy = artdaq::FragmentView(frag->headerAddress()).copy();
+		BOOST_REQUIRE_EQUAL(copy.size(), frag->size());
+		BOOST_REQUIRE_EQUAL(copy.sequenceID(), 1ul);
+		BOOST_REQUIRE_EQUAL(copy.metadata<TestMetadata>()->b, 5u);
+		BOOST_REQUIRE(std::equal(frag->dataBegin(), frag->dataEnd(), copy.dataBegin()));
+		BOOST_REQUIRE(copy.headerAddress() != frag->headerAddress());
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+#define BOOST_TEST_MODULE GatheredFragment_t
+#include <boost/test/auto_unit_test.hpp>
+
+#include "artdaq-core/Data/ContainerFragmentLoader.hh"
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq/DAQdata/GatheredFragment.hh"
+
+#include <cstring>
+
+namespace
+{
+	// Fragments with the given payload sizes, and distinct contents
+	std::vector<artdaq::Fragment> makeFragments(std::vector<size_t> const& sizes)
+	{
+		std::vector<artdaq::Fragment> frags;
+		for (size_t ii = 0; ii < sizes.size(); ++ii)
+		{
+			frags.emplace_back(sizes[ii]);
+			frags.back().setSequenceID(7);
+			frags.back().setFragmentID(3);
+			frags.back().setUserType(artdaq::Fragment::FirstUserFragmentType);
+			frags.back().setTimestamp(100 + ii);
+			for (size_t jj = 0; jj < sizes[ii]; ++jj) *(frags.back().dataBegin() + jj) = ii * 1000 + jj;
+		}
+		return frags;
+	}
+
+	std::vector<artdaq::GatheredFragment::ContainerPart> makeParts(std::vector<artdaq::Fragment>& frags)
+	{
+		std::vector<artdaq::GatheredFragment::ContainerPart> parts;
+		for (auto& frag : frags) parts.emplace_back(&frag, nullptr);
+		return parts;
+	}
+
+	artdaq::Fragment makeExpected(std::vector<artdaq::Fragment>& frags, bool missing_data)
+	{
+		artdaq::Fragment expected(7, 3);
+		expected.setTimestamp(100);
+		artdaq::ContainerFragmentLoader cfl(expected);
+		cfl.set_missing_data(missing_data);
+		for (auto& frag : frags) cfl.addFragment(frag);
+		return expected;
+	}
+
+	void requireSameBytes(artdaq::Fragment const& a, artdaq::Fragment const& b)
+	{
+		BOOST_REQUIRE_EQUAL(a.sizeBytes(), b.sizeBytes());
+		BOOST_REQUIRE(memcmp(a.headerBeginBytes(), b.headerBeginBytes(), a.sizeBytes()) == 0);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(GatheredFragment_test)
+
+BOOST_AUTO_TEST_CASE(MakeContainerMatchesLoader)
+{
+	BOOST_REQUIRE(artdaq::GatheredFragment::ContainerGatheringSupported());
+
+	auto frags = makeFragments({ 0, 5, 2, 7 });
+	frags[2].setMetadata<uint64_t>(0xFEED);
+	auto expected = makeExpected(frags, false);
+
+	auto gathered = artdaq::GatheredFragment::MakeContainer(7, 3, 100, false, makeParts(frags));
+	BOOST_REQUIRE(gathered);
+	BOOST_REQUIRE_EQUAL(gathered->sizeBytes(), expected.sizeBytes());
+	BOOST_REQUIRE_EQUAL(gathered->sequenceID(), 7);
+	BOOST_REQUIRE_EQUAL(gathered->fragmentID(), 3);
+	requireSameBytes(gathered->toFragment(), expected);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyContainer)
+{
+	std::vector<artdaq::Fragment> frags;
+	auto expected = makeExpected(frags, true);
+
+	auto gathered = artdaq::GatheredFragment::MakeContainer(7, 3, 100, true, makeParts(frags));
+	BOOST_REQUIRE(gathered);
+	requireSameBytes(gathered->toFragment(), expected);
+}
+
+BOOST_AUTO_TEST_CASE(PartsAreReferencedInPlace)
+{
+	auto frags = makeFragments({ 4, 4 });
+	auto owner = std::make_shared<int>(0);
+	std::weak_ptr<int> watcher(owner);
+
+	std::vector<artdaq::GatheredFragment::ContainerPart> parts;
+	for (auto& frag : frags) parts.emplace_back(&frag, owner);
+	auto gathered = artdaq::GatheredFragment::MakeContainer(7, 3, 100, false, parts);
+	parts.clear();
+	owner.reset();
+	BOOST_REQUIRE(gathered);
+	BOOST_REQUIRE(!watcher.expired());
+
+	auto iovs = gathered->payloadIovecs();
+	size_t bytes = 0;
+	bool foundFirst = false;
+	for (auto& iov : iovs)
+	{
+		bytes += iov.iov_len;
+		if (iov.iov_base == frags[0].headerAddress()) foundFirst = true;
+	}
+	BOOST_REQUIRE(foundFirst);
+	BOOST_REQUIRE_EQUAL(bytes + artdaq::detail::RawFragmentHeader::num_words() * sizeof(artdaq::RawDataType), gathered->sizeBytes());
+
+	gathered.reset(nullptr);
+	BOOST_REQUIRE(watcher.expired());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -81,4 +81,68 @@ BOOST_AUTO_TEST_CASE(ReceiveData)
 
 }
 
+BOOST_AUTO_TEST_CASE(ReceiveDataPool)
+{
+	artdaq::configureMessageFacility("DataReceiverManager_t");
+	fhicl::ParameterSet pset;
+	pset.put("use_art", false);
+	pset.put("buffer_count", 2);
+	pset.put("max_event_size_bytes", 1000);
+	pset.put("expected_fragments_per_event", 2);
+	pset.put("receiver_thread_count", 1);
+
+	fhicl::ParameterSet sources_fhicl;
+	std::vector<fhicl::ParameterSet> source_fhicls;
+	for (int rank : { 0, 2 })
+	{
+		fhicl::ParameterSet source_fhicl;
+		source_fhicl.put("transferPluginType", "Shmem");
+		source_fhicl.put("destination_rank", 1);
+		source_fhicl.put("source_rank", rank);
+		source_fhicl.put("shm_key", 0xFEEF0000 + 0x100 * rank + getpid() % 0x100);
+		sources_fhicl.put("shmem" + std::to_string(rank), source_fhicl);
+		source_fhicls.push_back(source_fhicl);
+	}
+	pset.put("sources", sources_fhicl);
+	auto shm = std::make_shared<artdaq::SharedMemoryEventManager>(pset, pset);
+	artdaq::DataReceiverManager t(pset, shm);
+	std::unique_ptr<artdaq::ShmemTransfer> transfer0(new artdaq::ShmemTransfer(source_fhicls[0], artdaq::TransferInterface::Role::kSend));
+	std::unique_ptr<artdaq::ShmemTransfer> transfer2(new artdaq::ShmemTransfer(source_fhicls[1], artdaq::TransferInterface::Role::kSend));
+	BOOST_REQUIRE_EQUAL(t.enabled_sources().size(), 2);
+	BOOST_REQUIRE_EQUAL(t.running_sources().size(), 0);
+	t.start_threads();
+	BOOST_REQUIRE_EQUAL(t.running_sources().size(), 2);
+
+	for (auto transfer : { transfer0.get(), transfer2.get() })
+	{
+		artdaq::Fragment testFrag(10);
+		testFrag.setSequenceID(1);
+		testFrag.setFragmentID(transfer == transfer0.get() ? 0 : 2);
+		testFrag.setTimestamp(0x100);
+		testFrag.setSystemType(artdaq::Fragment::DataFragmentType);
+		transfer->transfer_fragment_reliable_mode(std::move(testFrag));
+	}
+
+	sleep(1);
+	BOOST_REQUIRE_EQUAL(t.count(), 2);
+	BOOST_REQUIRE_EQUAL(t.slotCount(0), 1);
+	BOOST_REQUIRE_EQUAL(t.slotCount(2), 1);
+
+	// One source finishes before the other, and the pool keeps servicing the remaining one
+	artdaq::FragmentPtr eodFrag = artdaq::Fragment::eodFrag(1);
+	transfer0->transfer_fragment_reliable_mode(std::move(*(eodFrag.get())));
+	transfer0.reset(nullptr);
+	sleep(2);
+	BOOST_REQUIRE_EQUAL(t.running_sources().size(), 1);
+	BOOST_REQUIRE_EQUAL(t.running_sources().count(2), 1);
+
+	eodFrag = artdaq::Fragment::eodFrag(1);
+	transfer2->transfer_fragment_reliable_mode(std::move(*(eodFrag.get())));
+	transfer2.reset(nullptr);
+	sleep(2);
+	BOOST_REQUIRE_EQUAL(t.count(), 2);
+	BOOST_REQUIRE_EQUAL(t.enabled_sources().size(), 2);
+	BOOST_REQUIRE_EQUAL(t.running_sources().size(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQrate/detail/RequestMessage.hh"
+
+#define BOOST_TEST_MODULE RequestMessage_t
+#include "cetlib/quiet_unit_test.hpp"
+
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<artdaq::Fragment::sequence_id_t, artdaq::Fragment::timestamp_t>> request_list;
+
+static request_list decode(std::vector<uint8_t> const& buf, bool expect_complete = true)
+{
+	request_list out;
+	auto sts = artdaq::detail::RequestMessage::DecodeRequests(&buf[0], buf.size(), [&](artdaq::Fragment::sequence_id_t seq, artdaq::Fragment::timestamp_t ts) { out.emplace_back(seq, ts); });
+	BOOST_REQUIRE_EQUAL(sts, expect_complete);
+	return out;
+}
+
+BOOST_AUTO_TEST_SUITE(RequestMessage_test)
+
+BOOST_AUTO_TEST_CASE(Legacy)
+{
+	artdaq::detail::RequestMessage msg;
+	msg.addRequest(1, 0x10);
+	msg.addRequest(2, 0x20);
+	msg.setMode(artdaq::detail::RequestMessageMode::EndOfRun);
+	auto buf = msg.GetMessage();
+	BOOST_REQUIRE_EQUAL(buf.size(), sizeof(artdaq::detail::RequestHeader) + 2 * sizeof(artdaq::detail::RequestPacket));
+
+	artdaq::detail::RequestHeader hdr;
+	memcpy(&hdr, &buf[0], sizeof(hdr));
+	BOOST_REQUIRE(hdr.isValid());
+	BOOST_REQUIRE(!hdr.isCompact());
+	BOOST_REQUIRE_EQUAL(hdr.packet_count, 2u);
+	BOOST_REQUIRE(hdr.mode == artdaq::detail::RequestMessageMode::EndOfRun);
+
+	auto reqs = decode(buf);
+	BOOST_REQUIRE(reqs == request_list({ {1, 0x10}, {2, 0x20} }));
+}
+
+BOOST_AUTO_TEST_CASE(Compact)
+{
+	request_list in = { {100, 1000000}, {101, 1000025}, {102, 1000050}, {105, 1000010}, {106, 0xFFFFFFFFFFFFFFF0ull}, {0x100000000ull, 3} };
+	artdaq::detail::RequestMessage msg(true);
+	for (auto& req : in) msg.addRequest(req.first, req.second);
+	auto buf = msg.GetMessage();
+	BOOST_REQUIRE_EQUAL(buf.size(), msg.byte_size());
+
+	artdaq::detail::RequestHeader hdr;
+	memcpy(&hdr, &buf[0], sizeof(hdr));
+	BOOST_REQUIRE(hdr.isValid());
+	BOOST_REQUIRE(hdr.isCompact());
+	BOOST_REQUIRE_EQUAL(hdr.packet_count, in.size());
+
+	BOOST_REQUIRE(decode(buf) == in);
+}
+
+BOOST_AUTO_TEST_CASE(CompactEmpty)
+{
+	artdaq::detail::RequestMessage msg(true);
+	auto buf = msg.GetMessage();
+	BOOST_REQUIRE_EQUAL(buf.size(), sizeof(artdaq::detail::RequestHeader));
+	BOOST_REQUIRE(decode(buf).empty());
+}
+
+BOOST_AUTO_TEST_CASE(CompactSize)
+{
+	artdaq::detail::RequestMessage legacy;
+	artdaq::detail::RequestMessage compact(true);
+	artdaq::Fragment::sequence_id_t seq = 1;
+	while (!legacy.full())
+	{
+		legacy.addRequest(seq, seq * 50);
+		compact.addRequest(seq, seq * 50);
+		++seq;
+	}
+	// Consecutive sequence IDs with small timestamp steps take 2 bytes per request after the first
+	BOOST_REQUIRE_EQUAL(compact.byte_size(), sizeof(artdaq::detail::RequestHeader) + 16 + 2 * (compact.size() - 1));
+	while (!compact.full())
+	{
+		compact.addRequest(seq, seq * 50);
+		++seq;
+	}
+	BOOST_REQUIRE_GT(compact.size(), 10 * legacy.size());
+	BOOST_REQUIRE_LT(compact.byte_size(), static_cast<size_t>(MAX_REQUEST_MESSAGE_SIZE));
+	BOOST_REQUIRE_EQUAL(decode(compact.GetMessage()).size(), compact.size());
+}
+
+BOOST_AUTO_TEST_CASE(Truncated)
+{
+	artdaq::detail::RequestMessage msg(true);
+	msg.addRequest(1, 0x10);
+	msg.addRequest(2, 0x1000000);
+	auto buf = msg.GetMessage();
+	buf.resize(buf.size() - 1);
+	auto reqs = decode(buf, false);
+	BOOST_REQUIRE(reqs == request_list({ {1, 0x10} }));
+
+	artdaq::detail::RequestMessage legacy;
+	legacy.addRequest(1, 0x10);
+	buf = legacy.GetMessage();
+	buf.resize(buf.size() - 1);
+	BOOST_REQUIRE(decode(buf, false).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#define TRACE_NAME "RequestReceiver_t"
+
+#include "artdaq/DAQrate/RequestReceiver.hh"
+#include "artdaq/DAQdata/Globals.hh"
+#include "artdaq/DAQrate/detail/RequestMessage.hh"
+
+#define BOOST_TEST_MODULE RequestReceiver_t
+#include "cetlib/quiet_unit_test.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <map>
+#include <utility>
+#include <vector>
+
+typedef std::map<artdaq::Fragment::sequence_id_t, artdaq::Fragment::timestamp_t> request_map;
+typedef std::vector<std::pair<artdaq::Fragment::sequence_id_t, artdaq::Fragment::timestamp_t>> request_list;
+
+static fhicl::ParameterSet makeConfig(int port)
+{
+	fhicl::ParameterSet ps;
+	ps.put<int>("request_port", port);
+	ps.put<std::string>("request_address", "localhost");
+	return ps;
+}
+
+// Sends one request message datagram to the RequestReceiver on localhost
+static void sendRequests(int port, request_list const& requests, bool compact = false)
+{
+	artdaq::detail::RequestMessage msg(compact);
+	for (auto const& req : requests) msg.addRequest(req.first, req.second);
+	auto buf = msg.GetMessage();
+
+	int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	BOOST_REQUIRE(sock >= 0);
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	auto sts = sendto(sock, &buf[0], buf.size(), 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+	BOOST_REQUIRE_EQUAL(sts, static_cast<ssize_t>(buf.size()));
+	close(sock);
+}
+
+// Waits for the RequestReceiver to hold the given number of requests
+static bool waitForRequests(artdaq::RequestReceiver& recvr, size_t count)
+{
+	auto start = std::chrono::steady_clock::now();
+	while (recvr.size() < count && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+	{
+		recvr.WaitForRequests(10);
+		usleep(1000);
+	}
+	return recvr.size() == count;
+}
+
+BOOST_AUTO_TEST_SUITE(RequestReceiver_test)
+
+BOOST_AUTO_TEST_CASE(Batch)
+{
+	artdaq::configureMessageFacility("RequestReceiver_t", true, true);
+	const int port = (seedAndRandom() % (32768 - 1024)) + 1024;
+	artdaq::RequestReceiver recvr(makeConfig(port));
+
+	// The socket is bound by the constructor, so these datagrams are all waiting when the receive thread first reads it
+	sendRequests(port, { { 3, 0x30 }, { 4, 0x40 } });
+	sendRequests(port, { { 1, 0x10 } }, true);
+	sendRequests(port, { { 5, 0x50 }, { 2, 0x20 } });
+	recvr.startRequestReceiverThread();
+
+	BOOST_REQUIRE(waitForRequests(recvr, 5));
+	BOOST_REQUIRE(recvr.GetRequests() == request_map({ { 1, 0x10 }, { 2, 0x20 }, { 3, 0x30 }, { 4, 0x40 }, { 5, 0x50 } }));
+	BOOST_REQUIRE(recvr.GetAndClearRequests() == request_map({ { 1, 0x10 }, { 2, 0x20 }, { 3, 0x30 }, { 4, 0x40 }, { 5, 0x50 } }));
+	BOOST_REQUIRE_EQUAL(recvr.size(), 0u);
+	recvr.stopRequestReceiverThread();
+}
+
+BOOST_AUTO_TEST_CASE(Duplicates)
+{
+	artdaq::configureMessageFacility("RequestReceiver_t", true, true);
+	const int port = (seedAndRandom() % (32768 - 1024)) + 1024;
+	artdaq::RequestReceiver recvr(makeConfig(port));
+	recvr.startRequestReceiverThread();
+
+	sendRequests(port, { { 1, 0x10 }, { 2, 0x20 } });
+	BOOST_REQUIRE(waitForRequests(recvr, 2));
+
+	// Resent requests, including one with a conflicting timestamp, keep the first ones received
+	sendRequests(port, { { 1, 0x10 }, { 2, 0x22 }, { 3, 0x30 } });
+	BOOST_REQUIRE(waitForRequests(recvr, 3));
+	BOOST_REQUIRE(recvr.GetRequests() == request_map({ { 1, 0x10 }, { 2, 0x20 }, { 3, 0x30 } }));
+
+	// Requests which were already serviced are not added again
+	recvr.RemoveRequest(1);
+	recvr.RemoveRequest(2);
+	sendRequests(port, { { 1, 0x10 }, { 2, 0x20 }, { 3, 0x30 }, { 4, 0x40 } });
+	BOOST_REQUIRE(waitForRequests(recvr, 2));
+	BOOST_REQUIRE(recvr.GetRequests() == request_map({ { 3, 0x30 }, { 4, 0x40 } }));
+	recvr.stopRequestReceiverThread();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -79,7 +79,11 @@ BOOST_AUTO_TEST_CASE(Tokens)
 	TRACE_REQUIRE_EQUAL(buff.new_slots_free, 120);
 	TRACE_REQUIRE_EQUAL(buff.rank, 0);
 
+	TRACE_REQUIRE_EQUAL(buff.buffer_count, 0);
+	TRACE_REQUIRE_EQUAL(buff.art_latency_us, 0);
+
 	my_rank = 13;
+	t.SetRoutingTokenStatus(7, 20, 1500);
 	t.SendRoutingToken(335);
 
 	sts = read(conn_sock, &buff, sizeof(artdaq::detail::RoutingToken));
@@ -88,6 +92,9 @@ BOOST_AUTO_TEST_CASE(Tokens)
 	TRACE_REQUIRE_EQUAL(buff.header, TOKEN_MAGIC);
 	TRACE_REQUIRE_EQUAL(buff.new_slots_free, 335);
 	TRACE_REQUIRE_EQUAL(buff.rank, 13);
+	TRACE_REQUIRE_EQUAL(buff.buffers_occupied, 7);
+	TRACE_REQUIRE_EQUAL(buff.buffer_count, 20);
+	TRACE_REQUIRE_EQUAL(buff.art_latency_us, 1500);
 
 	close(conn_sock);
 	close(token_socket);
@@ -102,6 +109,7 @@ BOOST_AUTO_TEST_CASE(Requests)
 	TLOG(TLVL_INFO) << "Requests Test Case BEGIN" ;
 	const int REQUEST_PORT = (seedAndRandom() % (32768 - 1024)) + 1024;
 	const int DELAY_TIME = 100;
+	const int REFRESH_TIME = 500;
 #if 0
 	const std::string MULTICAST_IP = "227.28.12.28";
 #else
@@ -110,6 +118,7 @@ BOOST_AUTO_TEST_CASE(Requests)
 	fhicl::ParameterSet pset;
 	pset.put("request_port", REQUEST_PORT);
 	pset.put("request_delay_ms", DELAY_TIME);
+	pset.put("request_full_refresh_interval_ms", REFRESH_TIME);
 	pset.put("send_requests", true);
 	pset.put("request_address", MULTICAST_IP);
 	artdaq::RequestSender t(pset);
@@ -215,7 +224,7 @@ BOOST_AUTO_TEST_CASE(Requests)
 		return;
 	}
 
-	// SetRequestMode and AddRequest BOTH send requests...
+	// SetRequestMode and AddRequest are combined into one message
 	start_time = std::chrono::steady_clock::now();
 	t.SetRequestMode(artdaq::detail::RequestMessageMode::EndOfRun);
 	t.AddRequest(2, 0x20);
@@ -269,7 +278,10 @@ BOOST_AUTO_TEST_CASE(Requests)
 		BOOST_REQUIRE_EQUAL(false, true);
 		return;
 	}
-	rv = poll(ufds, 1, 1000);
+
+	// All active requests are re-sent periodically
+	start_time = std::chrono::steady_clock::now();
+	rv = poll(ufds, 1, 2 * REFRESH_TIME);
 	if (rv > 0)
 	{
 		if (ufds[0].revents == POLLIN || ufds[0].revents == POLLPRI)
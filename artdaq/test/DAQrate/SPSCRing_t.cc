@@ -0,0 +1,73 @@
+#include "artdaq/DAQrate/detail/SPSCRing.hh"
+
+#include <memory>
+#include <thread>
+
+using artdaq::detail::SPSCRing;
+
+#define BOOST_TEST_MODULE SPSCRing_t
+#include <boost/test/auto_unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(SPSCRing_test)
+
+	BOOST_AUTO_TEST_CASE(Construct)
+	{
+		SPSCRing<int> r(5);
+		BOOST_REQUIRE_EQUAL(r.capacity(), 8ul);
+		BOOST_REQUIRE_EQUAL(r.size(), 0ul);
+		BOOST_REQUIRE(r.empty());
+	}
+
+	BOOST_AUTO_TEST_CASE(PushPop)
+	{
+		SPSCRing<std::unique_ptr<int>> r(2);
+		std::unique_ptr<int> item(new int(1));
+		BOOST_REQUIRE(r.push(std::move(item)));
+		BOOST_REQUIRE(!item);
+		item.reset(new int(2));
+		BOOST_REQUIRE(r.push(std::move(item)));
+		item.reset(new int(3));
+		BOOST_REQUIRE(!r.push(std::move(item)));
+		BOOST_REQUIRE(item); // Not moved from when the ring is full
+		BOOST_REQUIRE_EQUAL(r.size(), 2ul);
+
+		std::unique_ptr<int> out;
+		BOOST_REQUIRE(r.pop(out));
+		BOOST_REQUIRE_EQUAL(*out, 1);
+		BOOST_REQUIRE(r.push(std::move(item)));
+		BOOST_REQUIRE(r.pop(out));
+		BOOST_REQUIRE_EQUAL(*out, 2);
+		BOOST_REQUIRE(r.pop(out));
+		BOOST_REQUIRE_EQUAL(*out, 3);
+		BOOST_REQUIRE(!r.pop(out));
+		BOOST_REQUIRE(r.empty());
+	}
+
+	BOOST_AUTO_TEST_CASE(Threaded)
+	{
+		const size_t COUNT = 100000;
+		SPSCRing<size_t> r(64);
+
+		std::thread producer([&]() {
+			for (size_t ii = 1; ii <= COUNT; ++ii)
+			{
+				auto val = ii;
+				while (!r.push(std::move(val))) std::this_thread::yield();
+			}
+		});
+
+		size_t expected = 1;
+		size_t val = 0;
+		while (expected <= COUNT)
+		{
+			if (r.pop(val))
+			{
+				BOOST_REQUIRE_EQUAL(val, expected);
+				++expected;
+			}
+		}
+		producer.join();
+		BOOST_REQUIRE(r.empty());
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
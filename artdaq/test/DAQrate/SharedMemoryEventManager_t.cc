@@ -8,6 +8,8 @@
 #include "cetlib/quiet_unit_test.hpp"
 #include "cetlib_except/exception.h"
 
+#include <thread>
+
 
 BOOST_AUTO_TEST_SUITE(SharedMemoryEventManager_test)
 
@@ -764,4 +766,58 @@ BOOST_AUTO_TEST_CASE(RunNumbers)
 	TLOG(TLVL_INFO) << "Test RunNumbers END" ;
 }
 
+BOOST_AUTO_TEST_CASE(BlockingWriteFragmentHeader)
+{
+	TLOG(TLVL_INFO) << "Test BlockingWriteFragmentHeader BEGIN" ;
+	fhicl::ParameterSet pset;
+	pset.put("use_art", false);
+	pset.put("buffer_count", 2);
+	pset.put("max_event_size_bytes", 1000);
+	pset.put("expected_fragments_per_event", 2);
+	pset.put("buffer_wait_recheck_interval_us", 1000000);
+	artdaq::SharedMemoryEventManager t(pset, pset);
+
+	artdaq::FragmentPtr frag(new artdaq::Fragment(1, 0, artdaq::Fragment::FirstUserFragmentType, 0UL));
+	frag->resize(4);
+
+	// Fill both buffers with incomplete events
+	for (artdaq::Fragment::sequence_id_t seq = 1; seq <= 2; ++seq)
+	{
+		frag->setSequenceID(seq);
+		auto hdr = *reinterpret_cast<artdaq::detail::RawFragmentHeader*>(frag->headerAddress());
+		auto fragLoc = t.WriteFragmentHeader(hdr, 1000, false);
+		BOOST_REQUIRE(fragLoc != nullptr);
+		t.DoneWritingFragment(hdr);
+	}
+	BOOST_REQUIRE_EQUAL(t.GetIncompleteEventCount(), 2);
+
+	frag->setSequenceID(3);
+	auto hdr3 = *reinterpret_cast<artdaq::detail::RawFragmentHeader*>(frag->headerAddress());
+	auto start = std::chrono::steady_clock::now();
+	BOOST_REQUIRE(t.WriteFragmentHeader(hdr3, 10000, false) == nullptr);
+	BOOST_REQUIRE(artdaq::TimeUtils::GetElapsedTimeMicroseconds(start) >= 10000);
+
+	// Completing event 1 frees a buffer; the waiter should wake long before the recheck interval
+	std::thread completer([&]() {
+		usleep(100000);
+		artdaq::Fragment frag2(1, 1, artdaq::Fragment::FirstUserFragmentType, 0UL);
+		frag2.resize(4);
+		auto hdr = *reinterpret_cast<artdaq::detail::RawFragmentHeader*>(frag2.headerAddress());
+		auto fragLoc = t.WriteFragmentHeader(hdr);
+		memcpy(fragLoc, frag2.dataBegin(), 4 * sizeof(artdaq::RawDataType));
+		t.DoneWritingFragment(hdr);
+	});
+
+	start = std::chrono::steady_clock::now();
+	auto fragLoc3 = t.WriteFragmentHeader(hdr3, 5000000, false);
+	auto waited = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start);
+	completer.join();
+	BOOST_REQUIRE(fragLoc3 != nullptr);
+	BOOST_REQUIRE(waited >= 100000);
+	BOOST_REQUIRE(waited < 1000000);
+	t.DoneWritingFragment(hdr3);
+	BOOST_REQUIRE_EQUAL(t.GetFragmentCount(3), 1);
+	TLOG(TLVL_INFO) << "Test BlockingWriteFragmentHeader END" ;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,55 @@
+#include "artdaq/DAQrate/detail/SharedMemoryEventSignal.hh"
+
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+
+using artdaq::detail::SharedMemoryEventSignal;
+
+#define BOOST_TEST_MODULE SharedMemoryEventSignal_t
+#include <boost/test/auto_unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(SharedMemoryEventSignal_test)
+
+	BOOST_AUTO_TEST_CASE(NotifyWait)
+	{
+		SharedMemoryEventSignal writer(0xFEE70000 + getpid(), true);
+		SharedMemoryEventSignal reader(0xFEE70000 + getpid(), false);
+		BOOST_REQUIRE(writer.IsValid());
+		BOOST_REQUIRE(reader.IsValid());
+
+		BOOST_REQUIRE(!reader.Wait(1000));
+		writer.Notify(2, 10);
+		BOOST_REQUIRE(reader.Wait(1000));
+		BOOST_REQUIRE(reader.Wait(1000));
+		BOOST_REQUIRE(!reader.Wait(1000));
+	}
+
+	BOOST_AUTO_TEST_CASE(MaxPending)
+	{
+		SharedMemoryEventSignal writer(0xFEE70000 + getpid(), true);
+		SharedMemoryEventSignal reader(0xFEE70000 + getpid(), false);
+
+		writer.Notify(5, 2);
+		writer.Notify(1, 2);
+		BOOST_REQUIRE(reader.Wait(1000));
+		BOOST_REQUIRE(reader.Wait(1000));
+		BOOST_REQUIRE(!reader.Wait(1000));
+	}
+
+	BOOST_AUTO_TEST_CASE(WakeWaiter)
+	{
+		SharedMemoryEventSignal writer(0xFEE70000 + getpid(), true);
+		SharedMemoryEventSignal reader(0xFEE70000 + getpid(), false);
+
+		auto start = std::chrono::steady_clock::now();
+		std::thread notifier([&]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			writer.Notify(1, 10);
+		});
+		BOOST_REQUIRE(reader.Wait(5000000));
+		BOOST_REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+		notifier.join();
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
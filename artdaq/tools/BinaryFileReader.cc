@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////
+// BinaryFileReader
+//
+// Lists or extracts Fragments of a file written by BinaryFileOutput with
+// "writeIndex: true", using the index file instead of scanning the data.
+////////////////////////////////////////////////////////////////////////
+
+#define TRACE_NAME "BinaryFileReader"
+
+#include "artdaq/DAQdata/BinaryFileIndex.hh"
+#include "artdaq/DAQdata/Globals.hh"
+#include "cetlib_except/exception.h"
+
+#include <boost/program_options.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace bpo = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+	std::ostringstream descstr;
+	descstr << argv[0]
+		<< " <-f <data-file>> [-s <sequence-id> [-i <fragment-id>] | --first <sequence-id> --last <sequence-id>] [-o <output-file>]";
+	bpo::options_description desc(descstr.str());
+	desc.add_options()
+		("file,f", bpo::value<std::string>(), "Data file written by BinaryFileOutput. Its index file must be next to it")
+		("sequence,s", bpo::value<artdaq::Fragment::sequence_id_t>(), "Select the Fragments with this Sequence ID")
+		("fragment,i", bpo::value<artdaq::Fragment::fragment_id_t>(), "With --sequence, select only the Fragment with this Fragment ID")
+		("first", bpo::value<artdaq::Fragment::sequence_id_t>(), "Select the Fragments with Sequence IDs starting at this one")
+		("last", bpo::value<artdaq::Fragment::sequence_id_t>(), "Select the Fragments with Sequence IDs up to this one (inclusive)")
+		("output,o", bpo::value<std::string>(), "Write the selected Fragments to this file, in the same format as the input, instead of listing them")
+		("help,h", "produce help message");
+	bpo::variables_map vm;
+	try
+	{
+		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+		bpo::notify(vm);
+	}
+	catch (bpo::error const& e)
+	{
+		std::cerr << "Exception from command line processing in " << argv[0]
+			<< ": " << e.what() << "\n";
+		return -1;
+	}
+	if (vm.count("help"))
+	{
+		std::cout << desc << std::endl;
+		return 1;
+	}
+	if (!vm.count("file"))
+	{
+		std::cerr << "Exception from command line processing in " << argv[0]
+			<< ": no data file given.\n"
+			<< "For usage and an options list, please do '"
+			<< argv[0] << " --help"
+			<< "'.\n";
+		return 2;
+	}
+
+	try
+	{
+		artdaq::BinaryFileIndex index(vm["file"].as<std::string>());
+
+		std::vector<artdaq::BinaryFileIndexEntry> selected;
+		if (vm.count("sequence") && vm.count("fragment"))
+		{
+			auto entry = index.Find(vm["sequence"].as<artdaq::Fragment::sequence_id_t>(), vm["fragment"].as<artdaq::Fragment::fragment_id_t>());
+			if (entry) selected.push_back(*entry);
+		}
+		else
+		{
+			auto first = std::numeric_limits<artdaq::Fragment::sequence_id_t>::min();
+			auto last = std::numeric_limits<artdaq::Fragment::sequence_id_t>::max();
+			if (vm.count("sequence")) first = last = vm["sequence"].as<artdaq::Fragment::sequence_id_t>();
+			if (vm.count("first")) first = vm["first"].as<artdaq::Fragment::sequence_id_t>();
+			if (vm.count("last")) last = vm["last"].as<artdaq::Fragment::sequence_id_t>();
+			auto range = index.FindRange(first, last);
+			selected.assign(range.first, range.second);
+		}
+
+		if (vm.count("output"))
+		{
+			std::ofstream out(vm["output"].as<std::string>(), std::ofstream::binary);
+			for (auto const& entry : selected)
+			{
+				auto frag = index.ReadFragment(entry);
+				out.write(reinterpret_cast<char const*>(frag->headerBeginBytes()), frag->sizeBytes());
+			}
+			if (!out)
+			{
+				std::cerr << "Error writing " << vm["output"].as<std::string>() << "\n";
+				return 3;
+			}
+			std::cout << "Wrote " << selected.size() << " Fragments to " << vm["output"].as<std::string>() << std::endl;
+		}
+		else
+		{
+			std::cout << "sequence_id fragment_id type offset size_bytes" << std::endl;
+			for (auto const& entry : selected)
+			{
+				std::cout << entry.sequence_id << " " << entry.fragment_id << " " << static_cast<int>(entry.type) << " "
+				          << entry.offset << " " << entry.size_bytes << std::endl;
+			}
+		}
+	}
+	catch (cet::exception const& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 3;
+	}
+	return 0;
+}
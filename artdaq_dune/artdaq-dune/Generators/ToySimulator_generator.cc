@@ -7,6 +7,7 @@
 #include "canvas/Utilities/Exception.h"
 
 #include "artdaq/Application/GeneratorMacros.hh"
+#include "artdaq/DAQdata/FragmentPool.hh"
 #include "artdaq-core/Utilities/SimpleLookupPolicy.hh"
 
 #include "artdaq-core-dune/Overlays/ToyFragment.hh"
@@ -81,20 +82,21 @@ bool demo::ToySimulator::getNext_(artdaq::FragmentPtrs& frags)
 	std::size_t bytes_read = 0;
 	hardware_interface_->FillBuffer(readout_buffer_, &bytes_read);
 
-	// We'll use the static factory function 
+	// We'll use artdaq::FragmentPool::GetBytes, the recycling equivalent
+	// of the static factory function 
 
 	// artdaq::Fragment::FragmentBytes(std::size_t payload_size_in_bytes, sequence_id_t sequence_id,
 	//  fragment_id_t fragment_id, type_t type, const T & metadata)
 
 	// which will then return a unique_ptr to an artdaq::Fragment
-	// object. 
+	// object. Its storage may come from a Fragment which was already sent.
 
 #if 1
 	std::unique_ptr<artdaq::Fragment> fragptr(
-		artdaq::Fragment::FragmentBytes(bytes_read,
-										ev_counter(), fragment_id(),
-										fragment_type_,
-										metadata_, timestamp_));
+		artdaq::FragmentPool::Instance().GetBytes(bytes_read,
+												  ev_counter(), fragment_id(),
+												  fragment_type_,
+												  metadata_, timestamp_));
 	frags.emplace_back(std::move(fragptr));
 #else
 	std::unique_ptr<artdaq::Fragment> fragptr(
@@ -137,6 +137,9 @@ namespace demo
 
 		bool rawOutput_;
 		std::string rawPath_;
+
+		// Payload size of the last event, used to get a large enough Fragment from the FragmentPool
+		size_t expected_payload_bytes_;
 	};
 }
 
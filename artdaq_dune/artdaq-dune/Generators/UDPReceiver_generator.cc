@@ -6,6 +6,7 @@
 #include "canvas/Utilities/Exception.h"
 
 #include "artdaq/Application/GeneratorMacros.hh"
+#include "artdaq/DAQdata/FragmentPool.hh"
 #include "cetlib_except/exception.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "artdaq-core/Utilities/SimpleLookupPolicy.hh"
@@ -26,6 +27,7 @@ demo::UDPReceiver::UDPReceiver(fhicl::ParameterSet const& ps)
 	, sendCommands_(ps.get<bool>("send_CAPTAN_commands", false))
 	, rawOutput_(ps.get<bool>("raw_output_enabled", false))
 	, rawPath_(ps.get<std::string>("raw_output_path", "/tmp"))
+	, expected_payload_bytes_(0)
 {
 	datasocket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
 	if (datasocket_ < 0)
@@ -87,9 +89,12 @@ bool demo::UDPReceiver::getNext_(artdaq::FragmentPtrs& frags)
 
 	std::size_t initial_payload_size = 0;
 
-	frags.emplace_back(artdaq::Fragment::FragmentBytes(initial_payload_size,
-	                                                   ev_counter(), fragment_id(),
-	                                                   artdaq::Fragment::FirstUserFragmentType, metadata));
+	// Take a Fragment big enough for an event like the last one from the FragmentPool, so that its storage is reused
+	// when the event is filled in. UDPFragmentWriter expects an empty payload to start with.
+	frags.emplace_back(artdaq::FragmentPool::Instance().GetBytes(expected_payload_bytes_,
+	                                                             ev_counter(), fragment_id(),
+	                                                             artdaq::Fragment::FirstUserFragmentType, metadata));
+	frags.back()->resizeBytes(initial_payload_size);
 	// We now have a fragment to contain this event:
 	demo::UDPFragmentWriter thisFrag(*frags.back());
 
@@ -207,6 +212,7 @@ bool demo::UDPReceiver::getNext_(artdaq::FragmentPtrs& frags)
 	packetBuffer_t& firstPacket = packetBuffers_.front();
 	TLOG(TLVL_DEBUG) << "Recieved data, now placing data with UDP sequence number " << (int)firstPacket[1] << " into UDPFragment";
 	thisFrag.resize(1500 * packetBuffers_.size() + 1);
+	expected_payload_bytes_ = frags.back()->dataSizeBytes();
 	std::ofstream output;
 	if (rawOutput_)
 	{